@@ -0,0 +1,44 @@
+#ifndef __BENCH_DEF_H__
+#define __BENCH_DEF_H__
+
+#include "common_inc.h"
+#include "rtp_session.h"
+
+//
+// a benchmark runs iters operations per call to run.
+// setup/teardown are not timed. arg is a benchmark specific size
+// like number of members or timers
+//
+typedef struct
+{
+  const char*   name;
+  uint32_t      arg;
+  void*         (*setup)(uint32_t arg);
+  void          (*run)(void* ctx, uint64_t iters);
+  void          (*teardown)(void* ctx);
+} bench_t;
+
+extern void bench_add(const char* name, uint32_t arg,
+    void* (*setup)(uint32_t arg),
+    void (*run)(void* ctx, uint64_t iters),
+    void (*teardown)(void* ctx));
+
+//
+// keeps results alive so the compiler doesn't drop the measured work
+//
+extern volatile uintptr_t   bench_sink;
+
+//
+// session with no-op callbacks. SSRC is BENCH_OWN_SSRC
+//
+#define BENCH_OWN_SSRC        9999
+#define BENCH_PT              0
+
+extern rtp_session_t* bench_session_new(void);
+extern void bench_session_free(rtp_session_t* sess);
+extern uint32_t bench_build_rtp(uint8_t* buf, uint32_t ssrc, uint16_t seq, uint32_t ts, uint32_t payload_len);
+extern void bench_session_add_senders(rtp_session_t* sess, uint32_t n, uint32_t first_ssrc);
+
+extern struct sockaddr_in   bench_rem_addr;
+
+#endif /* !__BENCH_DEF_H__ */
@@ -0,0 +1,393 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "io_driver.h"
+
+//
+// io_driver scalability.
+//
+// N UDP sockets (or pipes with -p) are watched for RX. every
+// iteration a random fraction of them is made readable, then
+// io_driver_run is called until all of them have been dispatched.
+//
+// reported per fd count:
+//   run_us         average io_driver_run call
+//   ns_per_event   io_driver_run time / dispatched events
+//   cpu_per_event  process CPU per event, making fds readable included
+//   p50/p99_us     dispatch latency, from making a fd readable to its callback
+//
+// select only takes fds below FD_SETSIZE. counts that need more are
+// reported as unsupported rather than run
+//
+#define IOB_DEFAULT_ITERS       2000
+#define IOB_DEFAULT_FRACTION    0.01
+#define IOB_MAX_COUNTS          16
+
+typedef struct
+{
+  io_driver_watcher_t   watcher;
+  int                   wr_fd;          // pipe write end. -1 for UDP
+  struct sockaddr_in    addr;           // UDP
+  uint64_t              armed_ns;
+} iob_fd_t;
+
+static io_driver_t      _io_driver;
+static iob_fd_t*        _fds;
+static uint32_t*        _order;         // distinct picks per iteration
+static uint32_t         _num_fds;
+static int              _tx_sock = -1;
+static uint8_t          _use_pipe;
+
+static uint64_t         _events;
+static uint32_t*        _lat;           // ns
+static uint64_t         _num_lat;
+static uint64_t         _max_lat;
+
+////////////////////////////////////////////////////////////
+//
+// utilities
+//
+////////////////////////////////////////////////////////////
+static inline uint64_t
+iob_now_ns(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double
+iob_cpu_sec(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+iob_compare_u32(const void* a, const void* b)
+{
+  uint32_t  x = *(const uint32_t*)a,
+            y = *(const uint32_t*)b;
+
+  return x < y ? -1 : x > y;
+}
+
+static double
+iob_percentile_us(double p)
+{
+  if(_num_lat == 0)
+  {
+    return 0;
+  }
+  return _lat[(uint64_t)(p * (_num_lat - 1))] / 1000.;
+}
+
+////////////////////////////////////////////////////////////
+//
+// fds
+//
+////////////////////////////////////////////////////////////
+static void
+iob_on_rx(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  iob_fd_t*   f = container_of(watcher, iob_fd_t, watcher);
+  uint8_t     buf[16];
+
+  if(_num_lat < _max_lat)
+  {
+    _lat[_num_lat++] = (uint32_t)(iob_now_ns() - f->armed_ns);
+  }
+  _events++;
+
+  if(_use_pipe)
+  {
+    if(read(watcher->fd, buf, sizeof(buf)) <= 0)
+    {
+      return;
+    }
+  }
+  else
+  {
+    recv(watcher->fd, buf, sizeof(buf), 0);
+  }
+}
+
+static void
+iob_arm(iob_fd_t* f)
+{
+  uint8_t   b = 0;
+
+  f->armed_ns = iob_now_ns();
+
+  if(_use_pipe)
+  {
+    if(write(f->wr_fd, &b, 1) != 1)
+    {
+      return;
+    }
+  }
+  else
+  {
+    sendto(_tx_sock, &b, 1, 0, (struct sockaddr*)&f->addr, sizeof(f->addr));
+  }
+}
+
+static void
+iob_close_fds(void)
+{
+  for(uint32_t i = 0; i < _num_fds; i++)
+  {
+    io_driver_no_watch(&_io_driver, &_fds[i].watcher, IO_DRIVER_EVENT_RX);
+    close(_fds[i].watcher.fd);
+    if(_fds[i].wr_fd >= 0)
+    {
+      close(_fds[i].wr_fd);
+    }
+  }
+
+  free(_fds);
+  free(_order);
+  _fds      = NULL;
+  _order    = NULL;
+  _num_fds  = 0;
+}
+
+/**
+ * false if select can't take that many
+ */
+static uint8_t
+iob_open_fds(uint32_t n)
+{
+  socklen_t   addr_len;
+  int         p[2];
+
+  _fds   = calloc(n, sizeof(iob_fd_t));
+  _order = malloc(n * sizeof(uint32_t));
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    _order[i] = i;
+  }
+
+  io_driver_init(&_io_driver);
+
+  for(_num_fds = 0; _num_fds < n; _num_fds++)
+  {
+    iob_fd_t*   f = &_fds[_num_fds];
+
+    io_driver_watcher_init(&f->watcher);
+    f->watcher.callback = iob_on_rx;
+    f->wr_fd            = -1;
+
+    if(_use_pipe)
+    {
+      if(pipe(p) != 0)
+      {
+        break;
+      }
+      f->watcher.fd = p[0];
+      f->wr_fd      = p[1];
+    }
+    else
+    {
+      f->watcher.fd = socket(AF_INET, SOCK_DGRAM, 0);
+      if(f->watcher.fd < 0)
+      {
+        break;
+      }
+
+      f->addr.sin_family      = AF_INET;
+      f->addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      addr_len                = sizeof(f->addr);
+
+      bind(f->watcher.fd, (struct sockaddr*)&f->addr, sizeof(f->addr));
+      getsockname(f->watcher.fd, (struct sockaddr*)&f->addr, &addr_len);
+    }
+
+    if(f->watcher.fd >= FD_SETSIZE || f->wr_fd >= FD_SETSIZE)
+    {
+      _num_fds++;
+      iob_close_fds();
+      return 0;
+    }
+
+    io_driver_watch(&_io_driver, &f->watcher, IO_DRIVER_EVENT_RX);
+  }
+
+  if(_num_fds != n)
+  {
+    iob_close_fds();
+    return 0;
+  }
+  return 1;
+}
+
+////////////////////////////////////////////////////////////
+//
+// run
+//
+////////////////////////////////////////////////////////////
+static void
+iob_run(uint32_t n, double fraction, uint32_t iters)
+{
+  uint32_t  active = (uint32_t)(n * fraction);
+  uint64_t  run_ns = 0,
+            runs = 0,
+            begin;
+  double    cpu;
+
+  if(active == 0)
+  {
+    active = 1;
+  }
+
+  if(iob_open_fds(n) == 0)
+  {
+    printf("%-7s %-5s %6u %6u %s\n", "select", _use_pipe ? "pipe" : "udp", n, active,
+        "unsupported. fds beyond FD_SETSIZE");
+    fflush(stdout);
+    return;
+  }
+
+  _events   = 0;
+  _num_lat  = 0;
+
+  cpu = iob_cpu_sec();
+
+  for(uint32_t i = 0; i < iters; i++)
+  {
+    uint64_t  target = _events + active;
+
+    // partial shuffle. the first active entries are distinct fds
+    for(uint32_t k = 0; k < active; k++)
+    {
+      uint32_t  j = k + lrand48() % (n - k),
+                t = _order[k];
+
+      _order[k] = _order[j];
+      _order[j] = t;
+
+      iob_arm(&_fds[_order[k]]);
+    }
+
+    while(_events < target)
+    {
+      uint64_t  before = _events;
+
+      begin = iob_now_ns();
+      io_driver_run(&_io_driver);
+      run_ns += iob_now_ns() - begin;
+      runs++;
+
+      if(_events == before)
+      {
+        break;
+      }
+    }
+  }
+
+  cpu = iob_cpu_sec() - cpu;
+
+  iob_close_fds();
+
+  qsort(_lat, _num_lat, sizeof(uint32_t), iob_compare_u32);
+
+  printf("%-7s %-5s %6u %6u %10llu %10.1f %12.0f %13.0f %9.1f %9.1f\n",
+      "select", _use_pipe ? "pipe" : "udp", n, active,
+      (unsigned long long)_events,
+      runs ? run_ns / 1000. / runs : 0,
+      _events ? (double)run_ns / _events : 0,
+      _events ? cpu * 1e9 / _events : 0,
+      iob_percentile_us(0.5), iob_percentile_us(0.99));
+  fflush(stdout);
+}
+
+static void
+usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-f fraction] [-i iters] [-p] [fd count...]\n", prog);
+  fprintf(stderr, "  -f fraction of fds readable per iteration. default %.2f\n", IOB_DEFAULT_FRACTION);
+  fprintf(stderr, "  -i iterations per fd count. default %u\n", IOB_DEFAULT_ITERS);
+  fprintf(stderr, "  -p pipes instead of UDP sockets\n");
+  fprintf(stderr, "  fd counts default to 10 100 1000 10000\n");
+}
+
+int
+main(int argc, char** argv)
+{
+  uint32_t        counts[IOB_MAX_COUNTS] = { 10, 100, 1000, 10000 },
+                  num_counts = 4,
+                  iters = IOB_DEFAULT_ITERS,
+                  max_count = 0;
+  double          fraction = IOB_DEFAULT_FRACTION;
+  struct rlimit   rl;
+  int             opt;
+
+  while((opt = getopt(argc, argv, "f:i:ph")) != -1)
+  {
+    switch(opt)
+    {
+    case 'f': fraction  = atof(optarg); break;
+    case 'i': iters     = atoi(optarg); break;
+    case 'p': _use_pipe = 1;            break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if(fraction <= 0 || fraction > 1 || iters == 0)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  if(optind < argc)
+  {
+    for(num_counts = 0; optind < argc && num_counts < IOB_MAX_COUNTS; optind++)
+    {
+      counts[num_counts++] = atoi(argv[optind]);
+    }
+  }
+
+  for(uint32_t i = 0; i < num_counts; i++)
+  {
+    max_count = counts[i] > max_count ? counts[i] : max_count;
+  }
+
+  // room for both pipe ends
+  if(getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < max_count * 2 + 64)
+  {
+    rl.rlim_cur = MIN(rl.rlim_max, max_count * 2 + 64);
+    setrlimit(RLIMIT_NOFILE, &rl);
+  }
+
+  _tx_sock  = socket(AF_INET, SOCK_DGRAM, 0);
+  _max_lat  = 4 * 1000 * 1000;
+  _lat      = malloc(_max_lat * sizeof(uint32_t));
+
+  srand48(1);
+
+  printf("# backend type fds active events run_us ns_per_event cpu_per_event p50_us p99_us\n");
+
+  for(uint32_t i = 0; i < num_counts; i++)
+  {
+    iob_run(counts[i], fraction, iters);
+  }
+
+  free(_lat);
+  close(_tx_sock);
+
+  return 0;
+}
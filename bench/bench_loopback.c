@@ -0,0 +1,560 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+#include "io_driver.h"
+#include "udp_transport.h"
+#include "rtp_session.h"
+
+//
+// end to end loopback latency.
+//
+// a sender and a receiver session, each on its own UDP socket on
+// 127.0.0.1 with RTCP muxed, run on one io_driver. the sender stamps
+// CLOCK_MONOTONIC into the payload in rtp_session_tx and the receiver
+// takes the difference in rx_rtp. so a sample covers session TX,
+// sendto, the kernel, the io_driver dispatch, recvfrom and session RX.
+//
+// in rate mode packets are paced by a timerfd and one way latency
+// percentiles are reported. with -r 0 the sender keeps a window of
+// packets in flight and the result is the sustainable packets/sec
+// per core for the whole stack, TX and RX on one CPU.
+//
+// sockets are udp_transport. mmsg modes go through it as the demo does.
+// single and drain are hand rolled baselines on the same socket.
+//
+#define LB_MAX_PKT_SIZE           RTP_CONFIG_MAX_RTP_PKT_SIZE
+#define LB_BATCH_MAX              UDP_TRANSPORT_BATCH_MAX
+#define LB_SOCK_BUF_SIZE          (4 * 1024 * 1024)
+#define LB_WINDOW                 256
+#define LB_TICK_NS                (100 * 1000000LL)
+#define LB_STAMP_LEN              8
+
+typedef enum
+{
+  lb_rx_single,       // one recvfrom per readiness event
+  lb_rx_drain,        // recvfrom until EAGAIN
+  lb_rx_mmsg,         // udp_transport. recvmmsg until EAGAIN
+  lb_rx_max,
+} lb_rx_mode_t;
+
+typedef enum
+{
+  lb_tx_single,       // sendto from tx_rtp
+  lb_tx_mmsg,         // udp_transport. tx_rtp queues, one sendmmsg per burst
+  lb_tx_max,
+} lb_tx_mode_t;
+
+static const char*  _rx_mode_str[lb_rx_max] = { "single", "drain", "mmsg" };
+static const char*  _tx_mode_str[lb_tx_max] = { "single", "mmsg" };
+
+typedef struct
+{
+  rtp_session_t         sess;       // must be first
+  udp_transport_t       t;
+  struct sockaddr_in    addr;
+  struct sockaddr_in    peer;
+} lb_node_t;
+
+typedef struct
+{
+  uint32_t      rate;           // pps. 0 for max throughput
+  uint32_t      payload_len;
+  uint32_t      duration_ms;
+  lb_rx_mode_t  rx_mode;
+  lb_tx_mode_t  tx_mode;
+} lb_config_t;
+
+static io_driver_t      _io_driver;
+static lb_node_t        _tx_node;
+static lb_node_t        _rx_node;
+static lb_config_t      _cfg;
+
+static io_driver_watcher_t  _pace_watcher;
+static io_driver_watcher_t  _tick_watcher;
+
+static uint8_t          _payload[LB_MAX_PKT_SIZE];
+static uint32_t         _rtp_ts;
+
+static uint64_t         _sent;
+static uint64_t         _received;
+static uint32_t*        _samples;         // ns
+static uint64_t         _num_samples;
+static uint64_t         _max_samples;
+
+// rx buffer for single and drain
+static uint8_t          _rx_buf[LB_MAX_PKT_SIZE];
+
+////////////////////////////////////////////////////////////
+//
+// utilities
+//
+////////////////////////////////////////////////////////////
+static inline uint64_t
+lb_now_ns(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static double
+lb_cpu_sec(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int
+lb_timerfd(uint64_t period_ns)
+{
+  struct itimerspec   its;
+  int                 fd;
+
+  fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+
+  its.it_interval.tv_sec  = period_ns / 1000000000ULL;
+  its.it_interval.tv_nsec = period_ns % 1000000000ULL;
+  its.it_value            = its.it_interval;
+
+  timerfd_settime(fd, 0, &its, NULL);
+  return fd;
+}
+
+static int
+lb_compare_u32(const void* a, const void* b)
+{
+  uint32_t  x = *(const uint32_t*)a,
+            y = *(const uint32_t*)b;
+
+  return x < y ? -1 : x > y;
+}
+
+static double
+lb_percentile_us(double p)
+{
+  uint64_t  ndx;
+
+  if(_num_samples == 0)
+  {
+    return 0;
+  }
+
+  ndx = (uint64_t)(p * (_num_samples - 1));
+  return _samples[ndx] / 1000.;
+}
+
+////////////////////////////////////////////////////////////
+//
+// session callbacks
+//
+////////////////////////////////////////////////////////////
+static int
+lb_tx(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  lb_node_t*  n = (lb_node_t*)sess;
+
+  if(_cfg.tx_mode == lb_tx_single)
+  {
+    sendto(n->t.watcher.fd, pkt, len, 0, (struct sockaddr*)&n->peer, sizeof(n->peer));
+    return 0;
+  }
+
+  return udp_transport_send(&n->t, pkt, len, &n->peer);
+}
+
+static void
+lb_tx_flush(lb_node_t* n)
+{
+  udp_transport_flush(&n->t);
+}
+
+static int
+lb_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
+{
+  uint64_t  stamp;
+
+  if(rpt->payload_len < LB_STAMP_LEN)
+  {
+    return 0;
+  }
+
+  memcpy(&stamp, rpt->payload, LB_STAMP_LEN);
+
+  _received++;
+  if(_num_samples < _max_samples)
+  {
+    _samples[_num_samples++] = (uint32_t)(lb_now_ns() - stamp);
+  }
+  return 0;
+}
+
+static uint32_t
+lb_rtp_timestamp(rtp_session_t* sess)
+{
+  return _rtp_ts;
+}
+
+static void
+lb_sr_rpt(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_sr_info_t* sr)
+{
+}
+
+static void
+lb_rr_rpt(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_rr_info_t* rr)
+{
+}
+
+////////////////////////////////////////////////////////////
+//
+// io_driver callbacks
+//
+////////////////////////////////////////////////////////////
+static void
+lb_send(uint32_t count)
+{
+  uint64_t  stamp;
+
+  for(uint32_t i = 0; i < count; i++)
+  {
+    stamp = lb_now_ns();
+    memcpy(_payload, &stamp, LB_STAMP_LEN);
+
+    _rtp_ts += 160;
+    rtp_session_tx(&_tx_node.sess, _payload, _cfg.payload_len, _rtp_ts, NULL, 0);
+    _sent++;
+  }
+  lb_tx_flush(&_tx_node);
+}
+
+static void
+lb_on_pace(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  uint64_t  expirations;
+
+  if(read(watcher->fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+  {
+    return;
+  }
+  lb_send((uint32_t)expirations);
+}
+
+/**
+ * max throughput mode. sender socket is always writable so this
+ * runs every loop and keeps LB_WINDOW packets in flight
+ */
+static void
+lb_on_tx_ready(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  uint64_t  inflight = _sent - _received;
+
+  if(inflight < LB_WINDOW)
+  {
+    lb_send(MIN(LB_WINDOW - inflight, LB_BATCH_MAX));
+  }
+}
+
+static void
+lb_on_tick(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  uint64_t  v;
+
+  if(read(watcher->fd, &v, sizeof(v)) != sizeof(v))
+  {
+    return;
+  }
+
+  rtp_session_timer_tick(&_tx_node.sess);
+  rtp_session_timer_tick(&_rx_node.sess);
+  lb_tx_flush(&_tx_node);
+  lb_tx_flush(&_rx_node);
+}
+
+/**
+ * baseline rx modes. takes over the transport's watcher
+ */
+static void
+lb_on_rx(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  lb_node_t*          n = container_of(watcher, lb_node_t, t.watcher);
+  struct sockaddr_in  from;
+  socklen_t           from_len;
+  int                 len;
+
+  if(_cfg.rx_mode == lb_rx_single)
+  {
+    from_len = sizeof(from);
+    len = recvfrom(watcher->fd, _rx_buf, LB_MAX_PKT_SIZE, 0, (struct sockaddr*)&from, &from_len);
+    if(len > 0)
+    {
+      rtp_session_rx(&n->sess, _rx_buf, len, &from);
+    }
+  }
+  else
+  {
+    for(;;)
+    {
+      from_len = sizeof(from);
+      len = recvfrom(watcher->fd, _rx_buf, LB_MAX_PKT_SIZE, MSG_DONTWAIT, (struct sockaddr*)&from, &from_len);
+      if(len <= 0)
+      {
+        break;
+      }
+      rtp_session_rx(&n->sess, _rx_buf, len, &from);
+    }
+  }
+
+  // replies like RTCP from the receiver
+  lb_tx_flush(n);
+}
+
+/**
+ * lb_rx_mmsg. one datagram from udp_transport
+ */
+static void
+lb_transport_rx(udp_transport_t* t, uint8_t* pkt, uint32_t len, struct sockaddr_in* from, uint64_t arrival_ns)
+{
+  lb_node_t*  n = t->priv;
+
+  rtp_session_rx(&n->sess, pkt, len, from);
+}
+
+////////////////////////////////////////////////////////////
+//
+// setup
+//
+////////////////////////////////////////////////////////////
+static void
+lb_node_init(lb_node_t* n, const char* cname)
+{
+  rtp_session_config_t    cfg;
+  udp_transport_config_t  tcfg;
+  socklen_t               addr_len = sizeof(n->addr);
+
+  memset(n, 0, sizeof(*n));
+
+  udp_transport_config_init(&tcfg);
+  tcfg.bind_addr.sin_addr.s_addr  = htonl(INADDR_LOOPBACK);
+  tcfg.rx_batch                   = LB_BATCH_MAX;
+  tcfg.tx_batch                   = LB_BATCH_MAX;
+  tcfg.buf_size                   = LB_MAX_PKT_SIZE;
+  tcfg.rcvbuf                     = LB_SOCK_BUF_SIZE;
+  tcfg.sndbuf                     = LB_SOCK_BUF_SIZE;
+
+  if(udp_transport_init(&_io_driver, &n->t, &tcfg, lb_transport_rx) != 0)
+  {
+    fprintf(stderr, "udp_transport_init failed\n");
+    exit(1);
+  }
+  n->t.priv = n;
+
+  if(_cfg.rx_mode != lb_rx_mmsg)
+  {
+    n->t.watcher.callback = lb_on_rx;
+  }
+
+  getsockname(n->t.watcher.fd, (struct sockaddr*)&n->addr, &addr_len);
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.rtp_addr    = n->addr;
+  cfg.rtcp_addr   = n->addr;
+  cfg.rtcp_mux    = RTP_TRUE;
+  cfg.session_bw  = 64 * 1000;
+  cfg.pt          = 0;
+  cfg.cname_len   = strlen(cname);
+  memcpy(cfg.cname, cname, cfg.cname_len);
+
+  n->sess.rx_rtp        = lb_rx_rtp;
+  n->sess.rtp_timestamp = lb_rtp_timestamp;
+  n->sess.sr_rpt        = lb_sr_rpt;
+  n->sess.rr_rpt        = lb_rr_rpt;
+  n->sess.tx_rtp        = lb_tx;
+  n->sess.tx_rtcp       = lb_tx;
+
+  rtp_session_init(&n->sess, &cfg);
+}
+
+static void
+lb_node_deinit(lb_node_t* n)
+{
+  rtp_session_deinit(&n->sess);
+  udp_transport_deinit(&n->t);
+}
+
+/**
+ * one run of a rx/tx mode combination. prints a result line
+ */
+static void
+lb_run(void)
+{
+  uint64_t  begin,
+            end;
+  double    cpu_begin,
+            cpu,
+            secs;
+
+  io_driver_init(&_io_driver);
+
+  lb_node_init(&_tx_node, "tx@127.0.0.1");
+  lb_node_init(&_rx_node, "rx@127.0.0.1");
+  _tx_node.peer = _rx_node.addr;
+  _rx_node.peer = _tx_node.addr;
+
+  _sent         = 0;
+  _received     = 0;
+  _num_samples  = 0;
+
+  io_driver_watcher_init(&_tick_watcher);
+  _tick_watcher.fd        = lb_timerfd(LB_TICK_NS);
+  _tick_watcher.callback  = lb_on_tick;
+  io_driver_watch(&_io_driver, &_tick_watcher, IO_DRIVER_EVENT_RX);
+
+  io_driver_watcher_init(&_pace_watcher);
+  if(_cfg.rate != 0)
+  {
+    _pace_watcher.fd        = lb_timerfd(1000000000ULL / _cfg.rate);
+    _pace_watcher.callback  = lb_on_pace;
+    io_driver_watch(&_io_driver, &_pace_watcher, IO_DRIVER_EVENT_RX);
+  }
+  else
+  {
+    _pace_watcher.fd        = _tx_node.t.watcher.fd;
+    _pace_watcher.callback  = lb_on_tx_ready;
+    io_driver_watch(&_io_driver, &_pace_watcher, IO_DRIVER_EVENT_TX);
+  }
+
+  cpu_begin = lb_cpu_sec();
+  begin     = lb_now_ns();
+  end       = begin + _cfg.duration_ms * 1000000ULL;
+
+  while(lb_now_ns() < end)
+  {
+    io_driver_run(&_io_driver);
+  }
+
+  cpu   = lb_cpu_sec() - cpu_begin;
+  secs  = (lb_now_ns() - begin) / 1e9;
+
+  io_driver_no_watch(&_io_driver, &_pace_watcher, IO_DRIVER_EVENT_RX | IO_DRIVER_EVENT_TX);
+  io_driver_no_watch(&_io_driver, &_tick_watcher, IO_DRIVER_EVENT_RX);
+  if(_cfg.rate != 0)
+  {
+    close(_pace_watcher.fd);
+  }
+  close(_tick_watcher.fd);
+
+  lb_node_deinit(&_tx_node);
+  lb_node_deinit(&_rx_node);
+
+  qsort(_samples, _num_samples, sizeof(uint32_t), lb_compare_u32);
+
+  printf("%-7s %-7s %-7s %8u %6u %10llu %10llu %9.1f %9.1f %9.1f %9.1f %10.0f %12.0f\n",
+      "select", _rx_mode_str[_cfg.rx_mode], _tx_mode_str[_cfg.tx_mode],
+      _cfg.rate, _cfg.payload_len,
+      (unsigned long long)_sent, (unsigned long long)_received,
+      lb_percentile_us(0.5), lb_percentile_us(0.99), lb_percentile_us(0.999),
+      _num_samples ? _samples[_num_samples - 1] / 1000. : 0,
+      _received / secs,
+      cpu > 0 ? _received / cpu : 0);
+  fflush(stdout);
+}
+
+static int
+lb_parse_mode(const char* arg, const char** names, int max)
+{
+  for(int i = 0; i < max; i++)
+  {
+    if(strcmp(arg, names[i]) == 0)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+static void
+usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-r pps] [-s payload_len] [-d ms] [-R single|drain|mmsg] [-T single|mmsg]\n", prog);
+  fprintf(stderr, "  -r 0 measures max throughput. without -R/-T every combination is run\n");
+  fprintf(stderr, "  output: backend rx tx rate size sent recv p50_us p99_us p999_us max_us pps pps_per_core\n");
+}
+
+int
+main(int argc, char** argv)
+{
+  int   rx_mode = -1,
+        tx_mode = -1,
+        opt;
+
+  _cfg.rate         = 10000;
+  _cfg.payload_len  = 160;
+  _cfg.duration_ms  = 2000;
+
+  while((opt = getopt(argc, argv, "r:s:d:R:T:h")) != -1)
+  {
+    switch(opt)
+    {
+    case 'r': _cfg.rate         = atoi(optarg); break;
+    case 's': _cfg.payload_len  = atoi(optarg); break;
+    case 'd': _cfg.duration_ms  = atoi(optarg); break;
+    case 'R':
+      if((rx_mode = lb_parse_mode(optarg, _rx_mode_str, lb_rx_max)) < 0)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    case 'T':
+      if((tx_mode = lb_parse_mode(optarg, _tx_mode_str, lb_tx_max)) < 0)
+      {
+        usage(argv[0]);
+        return 1;
+      }
+      break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if(_cfg.payload_len < LB_STAMP_LEN || _cfg.payload_len > LB_MAX_PKT_SIZE - 64 || _cfg.duration_ms == 0)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  // one sample per packet. max throughput mode keeps the first ones
+  _max_samples  = 4 * 1000 * 1000;
+  _samples      = malloc(_max_samples * sizeof(uint32_t));
+
+  printf("# backend rx tx rate size sent recv p50_us p99_us p999_us max_us pps pps_per_core\n");
+
+  for(int r = 0; r < lb_rx_max; r++)
+  {
+    for(int t = 0; t < lb_tx_max; t++)
+    {
+      if((rx_mode >= 0 && r != rx_mode) || (tx_mode >= 0 && t != tx_mode))
+      {
+        continue;
+      }
+
+      _cfg.rx_mode = r;
+      _cfg.tx_mode = t;
+      lb_run();
+    }
+  }
+
+  free(_samples);
+  return 0;
+}
@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define BENCH_MAX                 64
+#define BENCH_DEFAULT_TARGET_MS   200
+#define BENCH_DEFAULT_RUNS        5
+#define BENCH_CALIBRATE_NS        10000000ULL
+
+extern void bench_rtp_add(void);
+extern void bench_util_add(void);
+
+volatile uintptr_t    bench_sink;
+
+static bench_t        _benches[BENCH_MAX];
+static uint32_t       _num_benches = 0;
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static inline uint64_t
+bench_now_ns(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t
+bench_time(bench_t* b, void* ctx, uint64_t iters)
+{
+  uint64_t    begin;
+
+  begin = bench_now_ns();
+  b->run(ctx, iters);
+  return bench_now_ns() - begin;
+}
+
+/**
+ * run a benchmark. iteration count is calibrated to take about target_ms
+ * per run and the fastest of runs is reported
+ */
+static void
+bench_run(bench_t* b, uint32_t target_ms, uint32_t runs)
+{
+  void*       ctx;
+  uint64_t    iters = 1,
+              ns,
+              best = UINT64_MAX;
+
+  ctx = b->setup(b->arg);
+
+  // calibrate
+  while((ns = bench_time(b, ctx, iters)) < BENCH_CALIBRATE_NS)
+  {
+    iters *= 2;
+  }
+
+  iters = iters * target_ms * 1000000ULL / ns;
+  if(iters == 0)
+  {
+    iters = 1;
+  }
+
+  for(uint32_t i = 0; i < runs; i++)
+  {
+    ns = bench_time(b, ctx, iters);
+    if(ns < best)
+    {
+      best = ns;
+    }
+  }
+
+  b->teardown(ctx);
+
+  printf("%-24s %8u %12llu %12.1f %14.0f\n",
+      b->name, b->arg, (unsigned long long)iters,
+      (double)best / iters, iters * 1e9 / best);
+  fflush(stdout);
+}
+
+static uint8_t
+bench_match(const char* name, int argc, char** argv)
+{
+  if(argc == 0)
+  {
+    return RTP_TRUE;
+  }
+
+  for(int i = 0; i < argc; i++)
+  {
+    if(strstr(name, argv[i]) != NULL)
+    {
+      return RTP_TRUE;
+    }
+  }
+  return RTP_FALSE;
+}
+
+static void
+usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-t target_ms] [-r runs] [name filter...]\n", prog);
+  fprintf(stderr, "  output: name arg iters ns_per_op ops_per_sec\n");
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+bench_add(const char* name, uint32_t arg,
+    void* (*setup)(uint32_t arg),
+    void (*run)(void* ctx, uint64_t iters),
+    void (*teardown)(void* ctx))
+{
+  bench_t*    b;
+
+  if(_num_benches >= BENCH_MAX)
+  {
+    fprintf(stderr, "too many benchmarks\n");
+    exit(1);
+  }
+
+  b = &_benches[_num_benches++];
+
+  b->name     = name;
+  b->arg      = arg;
+  b->setup    = setup;
+  b->run      = run;
+  b->teardown = teardown;
+}
+
+int
+main(int argc, char** argv)
+{
+  uint32_t    target_ms = BENCH_DEFAULT_TARGET_MS,
+              runs = BENCH_DEFAULT_RUNS;
+  int         opt;
+
+  while((opt = getopt(argc, argv, "t:r:h")) != -1)
+  {
+    switch(opt)
+    {
+    case 't':
+      target_ms = atoi(optarg);
+      break;
+
+    case 'r':
+      runs = atoi(optarg);
+      break;
+
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  if(target_ms == 0 || runs == 0)
+  {
+    usage(argv[0]);
+    return 1;
+  }
+
+  bench_rtp_add();
+  bench_util_add();
+
+  printf("# name arg iters ns_per_op ops_per_sec\n");
+
+  for(uint32_t i = 0; i < _num_benches; i++)
+  {
+    if(bench_match(_benches[i].name, argc - optind, &argv[optind]))
+    {
+      bench_run(&_benches[i], target_ms, runs);
+    }
+  }
+
+  return 0;
+}
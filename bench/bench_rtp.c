@@ -0,0 +1,408 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+#include "rtcp.h"
+#include "rtcp_encoder.h"
+#include "rtp_member_table.h"
+#include "rtp_metrics.h"
+
+#define BENCH_CNAME             "bench@127.0.0.1"
+#define BENCH_FIRST_SSRC        1000
+#define BENCH_PAYLOAD_LEN       160
+#define BENCH_METRICS_CHUNK     4096
+#define BENCH_METRICS_PROBES    64
+
+struct sockaddr_in    bench_rem_addr;
+
+typedef struct
+{
+  rtp_session_t*  sess;
+  uint32_t        n;
+  uint16_t        seq[RTP_CONFIG_MAX_MEMBERS_PER_SESSION];
+  uint32_t        ts;
+  uint8_t         pkt[RTP_CONFIG_MAX_RTP_PKT_SIZE];
+  uint32_t        pkt_len;
+  uint8_t         payload[RTP_CONFIG_MAX_RTP_PKT_SIZE];
+} bench_rtp_ctx_t;
+
+typedef struct
+{
+  bench_rtp_ctx_t*  rtp;
+  rtp_metrics_t     worst;          // cursor before the slowest fill
+  char              buf[BENCH_METRICS_CHUNK];
+} bench_metrics_ctx_t;
+
+////////////////////////////////////////////////////////////
+//
+// session callbacks. all no-op
+//
+////////////////////////////////////////////////////////////
+static int
+bench_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
+{
+  return 0;
+}
+
+static int
+bench_tx(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  return 0;
+}
+
+static uint32_t
+bench_rtp_timestamp(rtp_session_t* sess)
+{
+  return 0;
+}
+
+static void
+bench_sr_rpt(rtp_session_t* sess, uint32_t ssrc, const rtcp_sr_info_t* sr)
+{
+}
+
+static void
+bench_rr_rpt(rtp_session_t* sess, uint32_t ssrc, const rtcp_rr_info_t* rr)
+{
+}
+
+////////////////////////////////////////////////////////////
+//
+// session helpers
+//
+////////////////////////////////////////////////////////////
+rtp_session_t*
+bench_session_new(void)
+{
+  rtp_session_config_t    cfg;
+  rtp_session_t*          sess;
+
+  memset(&cfg, 0, sizeof(cfg));
+
+  cfg.rtp_addr.sin_family       = AF_INET;
+  cfg.rtp_addr.sin_addr.s_addr  = inet_addr("127.0.0.1");
+  cfg.rtp_addr.sin_port         = htons(16000);
+  cfg.rtcp_addr                 = cfg.rtp_addr;
+  cfg.rtcp_addr.sin_port        = htons(16001);
+  cfg.session_bw                = 64 * 1000;
+  cfg.cname_len                 = strlen(BENCH_CNAME);
+  cfg.pt                        = BENCH_PT;
+  memcpy(cfg.cname, BENCH_CNAME, cfg.cname_len);
+
+  bench_rem_addr.sin_family       = AF_INET;
+  bench_rem_addr.sin_addr.s_addr  = inet_addr("127.0.0.2");
+  bench_rem_addr.sin_port         = htons(17000);
+
+  sess = malloc(sizeof(rtp_session_t));
+  memset(sess, 0, sizeof(rtp_session_t));
+
+  sess->rx_rtp        = bench_rx_rtp;
+  sess->rtp_timestamp = bench_rtp_timestamp;
+  sess->sr_rpt        = bench_sr_rpt;
+  sess->rr_rpt        = bench_rr_rpt;
+  sess->tx_rtp        = bench_tx;
+  sess->tx_rtcp       = bench_tx;
+
+  rtp_session_init(sess, &cfg);
+  rtp_member_table_change_ssrc(&sess->member_table, sess->self, BENCH_OWN_SSRC);
+
+  return sess;
+}
+
+void
+bench_session_free(rtp_session_t* sess)
+{
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+uint32_t
+bench_build_rtp(uint8_t* buf, uint32_t ssrc, uint16_t seq, uint32_t ts, uint32_t payload_len)
+{
+  rtp_hdr_t*    hdr = (rtp_hdr_t*)buf;
+
+  memset(buf, 0, sizeof(rtp_hdr_t) - 4 + payload_len);
+
+  hdr->version  = RTP_VERSION;
+  hdr->pt       = BENCH_PT;
+  hdr->seq      = htons(seq);
+  hdr->ts       = htonl(ts);
+  hdr->ssrc     = htonl(ssrc);
+
+  return sizeof(rtp_hdr_t) - 4 + payload_len;
+}
+
+/**
+ * n validated senders with SSRC first_ssrc and up. seq of each is at 100
+ */
+void
+bench_session_add_senders(rtp_session_t* sess, uint32_t n, uint32_t first_ssrc)
+{
+  uint8_t     pkt[64];
+  uint32_t    len;
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    for(uint16_t seq = 100 - RTP_CONFIG_MIN_SEQUENTIAL - 1; seq < 100; seq++)
+    {
+      len = bench_build_rtp(pkt, first_ssrc + i, seq, 0, 0);
+      rtp_session_rx_rtp(sess, pkt, len, &bench_rem_addr);
+    }
+  }
+}
+
+static void*
+bench_rtp_setup(uint32_t n)
+{
+  bench_rtp_ctx_t*  ctx = malloc(sizeof(bench_rtp_ctx_t));
+
+  memset(ctx, 0, sizeof(*ctx));
+
+  ctx->sess = bench_session_new();
+  ctx->n    = n;
+
+  bench_session_add_senders(ctx->sess, n, BENCH_FIRST_SSRC);
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    ctx->seq[i] = 100;
+  }
+  return ctx;
+}
+
+static void
+bench_rtp_teardown(void* arg)
+{
+  bench_rtp_ctx_t*  ctx = arg;
+
+  bench_session_free(ctx->sess);
+  free(ctx);
+}
+
+////////////////////////////////////////////////////////////
+//
+// rtp_session_rx_rtp. arg is the number of senders. round robin
+//
+////////////////////////////////////////////////////////////
+static void
+bench_rtp_rx_run(void* arg, uint64_t iters)
+{
+  bench_rtp_ctx_t*  ctx = arg;
+  rtp_hdr_t*        hdr = (rtp_hdr_t*)ctx->pkt;
+  uint32_t          ndx = 0,
+                    len;
+
+  len = bench_build_rtp(ctx->pkt, BENCH_FIRST_SSRC, 0, 0, BENCH_PAYLOAD_LEN);
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    hdr->ssrc = htonl(BENCH_FIRST_SSRC + ndx);
+    hdr->seq  = htons(ctx->seq[ndx]++);
+    hdr->ts   = htonl(ctx->ts += BENCH_PAYLOAD_LEN);
+
+    rtp_session_rx_rtp(ctx->sess, ctx->pkt, len, &bench_rem_addr);
+
+    if(++ndx == ctx->n)
+    {
+      ndx = 0;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////
+//
+// rtp_session_tx. arg is the payload length
+//
+////////////////////////////////////////////////////////////
+static void*
+bench_rtp_tx_setup(uint32_t payload_len)
+{
+  bench_rtp_ctx_t*  ctx = bench_rtp_setup(0);
+
+  ctx->pkt_len = payload_len;
+  return ctx;
+}
+
+static void
+bench_rtp_tx_run(void* arg, uint64_t iters)
+{
+  bench_rtp_ctx_t*  ctx = arg;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    rtp_session_tx(ctx->sess, ctx->payload, ctx->pkt_len, ctx->ts += ctx->pkt_len, NULL, 0);
+  }
+}
+
+////////////////////////////////////////////////////////////
+//
+// rtcp_rx. SR with arg report blocks and SDES CNAME from a known sender
+//
+////////////////////////////////////////////////////////////
+static void*
+bench_rtcp_rx_setup(uint32_t blocks)
+{
+  bench_rtp_ctx_t*  ctx = bench_rtp_setup(1);
+  static rtcp_encoder_t enc;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_sr_begin(&enc, BENCH_FIRST_SSRC, 0x12345678, 0x9abcdef0, 1000, 100, 16000);
+  for(uint32_t i = 0; i < blocks; i++)
+  {
+    rtcp_encoder_sr_add_rr(&enc, i == 0 ? BENCH_OWN_SSRC : BENCH_FIRST_SSRC + 100 + i,
+        0, 0, 100, 10, 0, 0);
+  }
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_sdes_begin(&enc);
+  rtcp_encoder_sdes_chunk_begin(&enc, BENCH_FIRST_SSRC);
+  rtcp_encoder_sdes_chunk_add_cname(&enc, (const uint8_t*)"remote@127.0.0.2", 16);
+  rtcp_encoder_sdes_chunk_end(&enc);
+  rtcp_encoder_end_packet(&enc);
+
+  ctx->pkt_len = rtcp_encoder_msg_len(&enc);
+  memcpy(ctx->pkt, enc.buf, ctx->pkt_len);
+
+  rtcp_encoder_deinit(&enc);
+
+  return ctx;
+}
+
+static void
+bench_rtcp_rx_run(void* arg, uint64_t iters)
+{
+  bench_rtp_ctx_t*  ctx = arg;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    rtp_session_rx_rtcp(ctx->sess, ctx->pkt, ctx->pkt_len, &bench_rem_addr);
+  }
+}
+
+////////////////////////////////////////////////////////////
+//
+// rtcp_send_report. arg is the number of senders to report on
+//
+////////////////////////////////////////////////////////////
+static void
+bench_rtcp_send_report_run(void* arg, uint64_t iters)
+{
+  bench_rtp_ctx_t*  ctx = arg;
+  uint32_t          len = 0;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    len += rtcp_send_report(ctx->sess);
+  }
+
+  bench_sink = len;
+}
+
+////////////////////////////////////////////////////////////
+//
+// rtp_metrics_format. arg is the number of senders.
+// an op is one fill of BENCH_METRICS_CHUNK bytes from the cursor
+// position that was the slowest in a whole scrape. so ns_per_op is
+// the worst a scrape adds to one event loop iteration
+//
+////////////////////////////////////////////////////////////
+static uint64_t
+bench_metrics_fill_ns(bench_metrics_ctx_t* ctx, const rtp_metrics_t* from)
+{
+  struct timespec   begin,
+                    end;
+  rtp_metrics_t     mt;
+  uint64_t          ns,
+                    best = UINT64_MAX;
+
+  for(uint32_t i = 0; i < BENCH_METRICS_PROBES; i++)
+  {
+    mt = *from;
+
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    rtp_metrics_format(&mt, ctx->buf, BENCH_METRICS_CHUNK);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    ns = (end.tv_sec - begin.tv_sec) * 1000000000ULL + end.tv_nsec - begin.tv_nsec;
+    if(ns < best)
+    {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+static void*
+bench_metrics_setup(uint32_t n)
+{
+  bench_metrics_ctx_t*  ctx = malloc(sizeof(bench_metrics_ctx_t));
+  rtp_metrics_t         mt;
+  uint64_t              ns,
+                        worst = 0;
+
+  ctx->rtp = bench_rtp_setup(n);
+
+  rtp_metrics_begin(&mt, &ctx->rtp->sess, 1);
+  ctx->worst = mt;
+
+  while(rtp_metrics_done(&mt) == RTP_FALSE)
+  {
+    ns = bench_metrics_fill_ns(ctx, &mt);
+    if(ns > worst)
+    {
+      worst       = ns;
+      ctx->worst  = mt;
+    }
+    rtp_metrics_format(&mt, ctx->buf, BENCH_METRICS_CHUNK);
+  }
+  return ctx;
+}
+
+static void
+bench_metrics_teardown(void* arg)
+{
+  bench_metrics_ctx_t*  ctx = arg;
+
+  bench_rtp_teardown(ctx->rtp);
+  free(ctx);
+}
+
+static void
+bench_metrics_fill_run(void* arg, uint64_t iters)
+{
+  bench_metrics_ctx_t*  ctx = arg;
+  rtp_metrics_t         mt;
+  uint32_t              len = 0;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    mt   = ctx->worst;
+    len += rtp_metrics_format(&mt, ctx->buf, BENCH_METRICS_CHUNK);
+  }
+
+  bench_sink = len;
+}
+
+void
+bench_rtp_add(void)
+{
+  bench_add("rtp_rx",           1,    bench_rtp_setup,      bench_rtp_rx_run,   bench_rtp_teardown);
+  bench_add("rtp_rx",           8,    bench_rtp_setup,      bench_rtp_rx_run,   bench_rtp_teardown);
+  bench_add("rtp_rx",           31,   bench_rtp_setup,      bench_rtp_rx_run,   bench_rtp_teardown);
+
+  bench_add("rtp_tx",           160,  bench_rtp_tx_setup,   bench_rtp_tx_run,   bench_rtp_teardown);
+  bench_add("rtp_tx",           1000, bench_rtp_tx_setup,   bench_rtp_tx_run,   bench_rtp_teardown);
+
+  bench_add("rtcp_rx_sr_sdes",  1,    bench_rtcp_rx_setup,  bench_rtcp_rx_run,  bench_rtp_teardown);
+  bench_add("rtcp_rx_sr_sdes",  31,   bench_rtcp_rx_setup,  bench_rtcp_rx_run,  bench_rtp_teardown);
+
+  bench_add("rtcp_send_report", 0,    bench_rtp_setup,      bench_rtcp_send_report_run,  bench_rtp_teardown);
+  bench_add("rtcp_send_report", 8,    bench_rtp_setup,      bench_rtcp_send_report_run,  bench_rtp_teardown);
+  bench_add("rtcp_send_report", 31,   bench_rtp_setup,      bench_rtcp_send_report_run,  bench_rtp_teardown);
+
+  bench_add("metrics_fill_worst", 8,  bench_metrics_setup,  bench_metrics_fill_run,      bench_metrics_teardown);
+  bench_add("metrics_fill_worst", 31, bench_metrics_setup,  bench_metrics_fill_run,      bench_metrics_teardown);
+}
@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "soft_timer.h"
+#include "rtp_member_table.h"
+
+#define BENCH_TIMER_TICK_RATE     100
+#define BENCH_TIMER_MIN_MS        1000
+#define BENCH_TIMER_MAX_MS        30000
+
+typedef struct
+{
+  SoftTimer       timer;
+  uint32_t        n;
+  SoftTimerElem*  elems;
+} bench_timer_ctx_t;
+
+typedef struct
+{
+  rtp_member_table_t  mt;
+  uint32_t            n;
+} bench_member_ctx_t;
+
+////////////////////////////////////////////////////////////
+//
+// soft_timer_drive. arg is the number of running timers.
+// timers re-arm themselves like member/sender timers do
+//
+////////////////////////////////////////////////////////////
+static void
+bench_timer_cb(SoftTimerElem* e)
+{
+  bench_timer_ctx_t*  ctx = e->priv;
+
+  soft_timer_add(&ctx->timer, e, BENCH_TIMER_MIN_MS + (uint32_t)(e - ctx->elems) % (BENCH_TIMER_MAX_MS - BENCH_TIMER_MIN_MS));
+}
+
+static void*
+bench_timer_setup(uint32_t n)
+{
+  bench_timer_ctx_t*  ctx = malloc(sizeof(bench_timer_ctx_t));
+
+  soft_timer_init(&ctx->timer, BENCH_TIMER_TICK_RATE);
+
+  ctx->n      = n;
+  ctx->elems  = malloc(sizeof(SoftTimerElem) * (n + 1));
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    soft_timer_init_elem(&ctx->elems[i]);
+    ctx->elems[i].cb    = bench_timer_cb;
+    ctx->elems[i].priv  = ctx;
+    bench_timer_cb(&ctx->elems[i]);
+  }
+  return ctx;
+}
+
+static void
+bench_timer_run(void* arg, uint64_t iters)
+{
+  bench_timer_ctx_t*  ctx = arg;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    soft_timer_drive(&ctx->timer);
+  }
+}
+
+static void
+bench_timer_teardown(void* arg)
+{
+  bench_timer_ctx_t*  ctx = arg;
+
+  soft_timer_deinit(&ctx->timer);
+  free(ctx->elems);
+  free(ctx);
+}
+
+////////////////////////////////////////////////////////////
+//
+// rtp_member_table_lookup. arg is the number of members
+//
+////////////////////////////////////////////////////////////
+static void*
+bench_member_setup(uint32_t n)
+{
+  bench_member_ctx_t* ctx = malloc(sizeof(bench_member_ctx_t));
+
+  rtp_member_table_init(&ctx->mt);
+
+  ctx->n = n;
+  for(uint32_t i = 0; i < n; i++)
+  {
+    rtp_member_table_alloc_member(&ctx->mt, 1000 + i);
+  }
+  return ctx;
+}
+
+static void
+bench_member_hit_run(void* arg, uint64_t iters)
+{
+  bench_member_ctx_t* ctx = arg;
+  uint32_t            ndx = 0;
+  uintptr_t           sum = 0;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    sum += (uintptr_t)rtp_member_table_lookup(&ctx->mt, 1000 + ndx);
+    if(++ndx == ctx->n)
+    {
+      ndx = 0;
+    }
+  }
+
+  bench_sink = sum;
+}
+
+static void
+bench_member_miss_run(void* arg, uint64_t iters)
+{
+  bench_member_ctx_t* ctx = arg;
+  uintptr_t           sum = 0;
+
+  for(uint64_t i = 0; i < iters; i++)
+  {
+    sum += (uintptr_t)rtp_member_table_lookup(&ctx->mt, 1);
+  }
+
+  bench_sink = sum;
+}
+
+static void
+bench_member_teardown(void* arg)
+{
+  bench_member_ctx_t* ctx = arg;
+
+  rtp_member_table_deinit(&ctx->mt);
+  free(ctx);
+}
+
+void
+bench_util_add(void)
+{
+  bench_add("soft_timer_drive",   64,     bench_timer_setup,  bench_timer_run,        bench_timer_teardown);
+  bench_add("soft_timer_drive",   1024,   bench_timer_setup,  bench_timer_run,        bench_timer_teardown);
+  bench_add("soft_timer_drive",   16384,  bench_timer_setup,  bench_timer_run,        bench_timer_teardown);
+
+  bench_add("member_lookup_hit",  1,      bench_member_setup, bench_member_hit_run,   bench_member_teardown);
+  bench_add("member_lookup_hit",  8,      bench_member_setup, bench_member_hit_run,   bench_member_teardown);
+  bench_add("member_lookup_hit",  32,     bench_member_setup, bench_member_hit_run,   bench_member_teardown);
+  bench_add("member_lookup_miss", 32,     bench_member_setup, bench_member_miss_run,  bench_member_teardown);
+}
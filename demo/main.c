@@ -22,15 +22,22 @@ int
 main(int argc, char** argv)
 {
   uint8_t blah;
+  uint8_t mux = RTP_FALSE;
 
-  if(argc != 2)
+  if(argc != 2 && argc != 3)
   {
-    printf("%s [0 or 1]\n", argv[0]);
+    printf("%s [0 or 1] [mux]\n", argv[0]);
     return -1;
   }
 
   blah = atoi(argv[1]);
 
+  if(argc == 3 && strcmp(argv[2], "mux") == 0)
+  {
+    // RTP and RTCP on a single socket. RFC 5761
+    mux = RTP_TRUE;
+  }
+
 
   RTPLOGI("main", "starting up demo rtp task\n");
 
@@ -40,7 +47,7 @@ main(int argc, char** argv)
 
   rtp_cli_init();
 
-  rtp_task_init(blah);
+  rtp_task_init(blah, mux);
   RTPLOGI("main", "rtp task initialized\n");
 
   RTPLOGI("main", "entering main loop\n");
@@ -2,6 +2,8 @@
 #include <sys/time.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
 #include "generic_list.h"
 #include "cli.h"
 #include "io_driver.h"
@@ -21,6 +23,10 @@ static void cli_command_conflicts(cli_intf_t* intf, int argc, const char** argv)
 static void cli_command_rtp(cli_intf_t* intf, int argc, const char** argv);
 static void cli_command_rtcp(cli_intf_t* intf, int argc, const char** argv);
 static void cli_command_ssrc(cli_intf_t* intf, int argc, const char** argv);
+static void cli_command_trace(cli_intf_t* intf, int argc, const char** argv);
+static void cli_command_prof(cli_intf_t* intf, int argc, const char** argv);
+static void cli_command_top(cli_intf_t* intf, int argc, const char** argv);
+static void cli_command_capture(cli_intf_t* intf, int argc, const char** argv);
 
 io_driver_t*
 cli_io_driver(void)
@@ -64,21 +70,78 @@ static cli_command_t      _rtp_commands[] =
     "ssrc",
     "change own ssrc",
     cli_command_ssrc,
+  },
+  {
+    "trace",
+    "show session event trace",
+    cli_command_trace,
+  },
+  {
+    "prof",
+    "show/reset stage latency histograms",
+    cli_command_prof,
+  },
+  {
+    "top",
+    "live member view with rates",
+    cli_command_top,
+  },
+  {
+    "capture",
+    "RX/TX packet capture ring",
+    cli_command_capture,
   }
 };
 
+static rtp_capture_t          _capture;
+
+//
+// top view state
+//
+typedef enum
+{
+  top_sort_ssrc,
+  top_sort_pps,
+  top_sort_bps,
+  top_sort_loss,
+  top_sort_jitter,
+  top_sort_age,
+  top_sort_rtt,
+  top_sort_max,
+} top_sort_t;
+
+static const char* _top_columns[top_sort_max] =
+{
+  [top_sort_ssrc]   = "ssrc",
+  [top_sort_pps]    = "pps",
+  [top_sort_bps]    = "bps",
+  [top_sort_loss]   = "loss",
+  [top_sort_jitter] = "jitter",
+  [top_sort_age]    = "age",
+  [top_sort_rtt]    = "rtt",
+};
+
+static struct
+{
+  cli_intf_t*           intf;
+  top_sort_t            sort;
+  uint32_t              remaining;
+  int                   timerfd;
+  io_driver_watcher_t   watcher;
+} _top =
+{
+  .timerfd = -1,
+};
+
+static rtp_member_stats_t   _top_rows[RTP_CONFIG_MAX_MEMBERS_PER_SESSION];
+
 static void
 print_member(cli_intf_t* intf, rtp_member_t* m)
 {
   cli_printf(intf, "rtp addr: %s:%d"CLI_EOL, inet_ntoa(m->rtp_addr.sin_addr), ntohs(m->rtp_addr.sin_port));
   cli_printf(intf, "rtcp addr: %s:%d"CLI_EOL, inet_ntoa(m->rtcp_addr.sin_addr), ntohs(m->rtcp_addr.sin_port));
   cli_printf(intf, "ssrc: %u"CLI_EOL, m->ssrc);
-  cli_printf(intf, "cname len %d, ", m->cname_len);
-  for(int i = 0; i < m->cname_len; i++)
-  {
-    cli_printf(intf, "0x%02x ", m->cname[i]);
-  }
-  cli_printf(intf, CLI_EOL);
+  cli_printf(intf, "cname: %.*s"CLI_EOL, m->cname_len, m->cname);
   cli_printf(intf, "flags : %08x"CLI_EOL, m->flags);
 
   cli_printf(intf, "rtp_src.max_seq : %u"CLI_EOL, m->rtp_src.max_seq);
@@ -103,13 +166,36 @@ print_member(cli_intf_t* intf, rtp_member_t* m)
   cli_printf(intf, "octet_count: %u"CLI_EOL, m->octet_count);
 }
 
+static void
+print_error_counters(cli_intf_t* intf, const char* prefix, const uint32_t* rtp_errors, const uint32_t* rtcp_errors)
+{
+  // zero counters are skipped
+  for(uint32_t i = 0; i < rtp_rx_error_max; i++)
+  {
+    if(rtp_errors[i] != 0)
+    {
+      cli_printf(intf, "%srtp.%s %u"CLI_EOL, prefix, rtp_rx_error_str(i), rtp_errors[i]);
+    }
+  }
+
+  for(uint32_t i = 0; i < rtcp_rx_error_max; i++)
+  {
+    if(rtcp_errors[i] != 0)
+    {
+      cli_printf(intf, "%srtcp.%s %u"CLI_EOL, prefix, rtcp_rx_error_str(i), rtcp_errors[i]);
+    }
+  }
+}
+
 static void
 cli_command_stats(cli_intf_t* intf, int argc, const char** argv)
 {
   rtp_session_t* sess = rtp_task_get_session();
+  rtp_session_stats_t   st;
+  rtp_member_stats_t    mst;
+  rtp_member_t*         m;
 
   cli_printf(intf, "session_bandwidth %d"CLI_EOL, sess->config.session_bw);
-  cli_printf(intf, "seq %d"CLI_EOL, sess->seq);
 
   cli_printf(intf, "rtcp_var.tp   %.2f"CLI_EOL, sess->rtcp_var.tp);
   cli_printf(intf, "rtcp_var.tn   %.2f"CLI_EOL, sess->rtcp_var.tn);
@@ -123,11 +209,35 @@ cli_command_stats(cli_intf_t* intf, int argc, const char** argv)
 
   cli_printf(intf, "pt %d"CLI_EOL, sess->config.pt);
   cli_printf(intf, "invalid_rtcp_pkt %d"CLI_EOL, sess->invalid_rtcp_pkt);
+  cli_printf(intf, "unknown_rtcp_pkt %d"CLI_EOL, sess->unknown_rtcp_pkt);
+  cli_printf(intf, "fb_queue_full %d"CLI_EOL, sess->fb_queue_full);
   cli_printf(intf, "invalid_rtp_pkt %d"CLI_EOL, sess->invalid_rtp_pkt);
   cli_printf(intf, "last_rtp_error %d"CLI_EOL, sess->last_rtp_error);
   cli_printf(intf, "last_rtcp_error %d"CLI_EOL, sess->last_rtcp_error);
-  cli_printf(intf, "tx_pkt_count %d"CLI_EOL, sess->tx_pkt_count);
-  cli_printf(intf, "tx_octet_count %d"CLI_EOL, sess->tx_octet_count);
+
+  rtp_session_get_stats(sess, &st);
+  print_error_counters(intf, "", st.rtp_errors, st.rtcp_errors);
+
+  m = rtp_member_table_get_first(&sess->member_table);
+  while(m != NULL)
+  {
+    if(rtp_session_get_member_stats(sess, m->ssrc, &mst) == 0)
+    {
+      char prefix[32];
+
+      snprintf(prefix, sizeof(prefix), "%u.", mst.ssrc);
+      print_error_counters(intf, prefix, mst.rtp_errors, mst.rtcp_errors);
+    }
+    m = rtp_member_table_get_next(&sess->member_table, m);
+  }
+
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    rtp_stream_t* st = &sess->streams[i];
+
+    cli_printf(intf, "stream %u ssrc %u seq %d tx_pkt_count %u tx_octet_count %u"CLI_EOL,
+        i, st->self->ssrc, st->seq, st->tx_pkt_count, st->tx_octet_count);
+  }
 }
 
 static void
@@ -255,6 +365,395 @@ error:
   cli_printf(intf, "%s ssrc"CLI_EOL, argv[0]);
 }
 
+static void
+cli_command_trace(cli_intf_t* intf, int argc, const char** argv)
+{
+  static rtp_trace_rec_t  recs[RTP_CONFIG_TRACE_RING_SIZE];
+  rtp_session_t*          sess = rtp_task_get_session();
+  uint32_t                n,
+                          max = RTP_CONFIG_TRACE_RING_SIZE;
+  char                    line[128];
+
+  if(argc > 2)
+  {
+    goto error;
+  }
+
+  if(argc == 2)
+  {
+    max = atoi(argv[1]);
+    max = max > RTP_CONFIG_TRACE_RING_SIZE ? RTP_CONFIG_TRACE_RING_SIZE : max;
+  }
+
+  n = rtp_trace_snapshot(&sess->trace, recs, max);
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    rtp_trace_format(&recs[i], line, sizeof(line));
+    cli_printf(intf, "%s"CLI_EOL, line);
+  }
+  return;
+
+error:
+  cli_printf(intf, "Error"CLI_EOL);
+  cli_printf(intf, "%s [count]"CLI_EOL, argv[0]);
+}
+
+static void
+print_prof(cli_intf_t* intf, const char* title, rtp_prof_t* prof)
+{
+  cli_printf(intf, "== %s"CLI_EOL, title);
+
+  for(uint32_t i = 0; i < rtp_prof_stage_max; i++)
+  {
+    rtp_prof_hist_t* h = &prof->hist[i];
+
+    if(h->count == 0)
+    {
+      continue;
+    }
+
+    cli_printf(intf, "%-18s count %u avg %llu max %llu"CLI_EOL,
+        rtp_prof_stage_name(i), h->count,
+        (unsigned long long)(h->sum / h->count), (unsigned long long)h->max);
+
+    for(uint32_t b = 0; b < RTP_PROF_BUCKETS; b++)
+    {
+      if(h->buckets[b] != 0)
+      {
+        cli_printf(intf, "  < 2^%-2u %u"CLI_EOL, b, h->buckets[b]);
+      }
+    }
+  }
+}
+
+static void
+cli_command_prof(cli_intf_t* intf, int argc, const char** argv)
+{
+  static rtp_prof_t   prof;
+  rtp_session_t*      sess = rtp_task_get_session();
+
+  if(argc == 2 && strcmp(argv[1], "reset") == 0)
+  {
+    rtp_session_reset_prof(sess);
+    rtp_prof_init(rtp_prof_process());
+    return;
+  }
+
+  if(argc != 1)
+  {
+    goto error;
+  }
+
+  if(rtp_session_get_prof(sess, &prof) != 0)
+  {
+    cli_printf(intf, "profiling disabled. build with RTP_CONFIG_PROFILE 1"CLI_EOL);
+    return;
+  }
+
+  print_prof(intf, "session", &prof);
+  print_prof(intf, "process", rtp_prof_process());
+  return;
+
+error:
+  cli_printf(intf, "Error"CLI_EOL);
+  cli_printf(intf, "%s [reset]"CLI_EOL, argv[0]);
+}
+
+static uint32_t
+top_sort_key(const rtp_member_stats_t* st)
+{
+  switch(_top.sort)
+  {
+  case top_sort_pps:      return st->pkt_rate;
+  case top_sort_bps:      return st->bit_rate;
+  case top_sort_loss:     return st->loss;
+  case top_sort_jitter:   return st->jitter;
+  case top_sort_age:      return st->last_heard_age;
+  case top_sort_rtt:      return st->rtt == RTP_MEMBER_RTT_UNKNOWN ? 0 : st->rtt;
+  default:                return st->ssrc;
+  }
+}
+
+static int
+top_compare(const void* a, const void* b)
+{
+  uint32_t  ka = top_sort_key((const rtp_member_stats_t*)a),
+            kb = top_sort_key((const rtp_member_stats_t*)b);
+
+  // ssrc ascending. others descending
+  if(_top.sort == top_sort_ssrc)
+  {
+    return ka < kb ? -1 : ka > kb;
+  }
+  return ka > kb ? -1 : ka < kb;
+}
+
+static void
+top_render(cli_intf_t* intf)
+{
+  rtp_session_t*  sess = rtp_task_get_session();
+  rtp_member_t*   m;
+  uint32_t        n = 0;
+
+  m = rtp_member_table_get_first(&sess->member_table);
+  while(m != NULL && n < RTP_CONFIG_MAX_MEMBERS_PER_SESSION)
+  {
+    if(rtp_member_is_self(m) == RTP_FALSE)
+    {
+      rtp_session_get_member_stats(sess, m->ssrc, &_top_rows[n++]);
+    }
+    m = rtp_member_table_get_next(&sess->member_table, m);
+  }
+
+  qsort(_top_rows, n, sizeof(rtp_member_stats_t), top_compare);
+
+  cli_printf(intf, "members %u senders %u sort %s"CLI_EOL,
+      sess->rtcp_var.members, sess->rtcp_var.senders, _top_columns[_top.sort]);
+  cli_printf(intf, "%-10s %5s %8s %9s %6s %8s %8s %8s  %s"CLI_EOL,
+      "ssrc", "flags", "pkt/s", "kbit/s", "loss%", "jitter", "rtt_ms", "age_ms", "cname");
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    rtp_member_stats_t* st = &_top_rows[i];
+
+    m = rtp_member_table_lookup(&sess->member_table, st->ssrc);
+
+    cli_printf(intf, "%-10u %c%c%c%c%c %8u %9.1f %6.1f %8u ",
+        st->ssrc,
+        rtp_member_is_sender(m)           ? 's' : '-',
+        rtp_member_is_validated(m)        ? 'v' : '-',
+        rtp_member_is_rtp_heard(m)        ? 'r' : '-',
+        rtp_member_is_rtcp_heard(m)       ? 'c' : '-',
+        rtp_member_is_bye_received(m)     ? 'b' : '-',
+        st->pkt_rate, st->bit_rate / 1000.0, st->loss / 10.0, st->jitter);
+
+    if(st->rtt == RTP_MEMBER_RTT_UNKNOWN)
+    {
+      cli_printf(intf, "%8s ", "-");
+    }
+    else
+    {
+      cli_printf(intf, "%8u ", (uint32_t)(((uint64_t)st->rtt * 1000) >> 16));
+    }
+
+    cli_printf(intf, "%8u  %.*s"CLI_EOL, st->last_heard_age, m->cname_len, m->cname);
+  }
+}
+
+static void
+top_stop(void)
+{
+  if(_top.timerfd < 0)
+  {
+    return;
+  }
+
+  io_driver_no_watch(main_io_driver(), &_top.watcher, IO_DRIVER_EVENT_RX);
+  close(_top.timerfd);
+
+  _top.intf->on_close = NULL;
+
+  _top.timerfd  = -1;
+  _top.intf     = NULL;
+}
+
+static void
+top_intf_close(cli_intf_t* intf)
+{
+  // the connection is going away. don't refresh into it
+  top_stop();
+}
+
+static void
+top_timer_callback(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  uint64_t  v;
+
+  read(_top.timerfd, &v, sizeof(v));
+  (void)v;
+
+  // user started typing
+  if(_top.intf->cmd_buffer_ndx != 0 || _top.remaining == 0)
+  {
+    top_stop();
+    return;
+  }
+
+  _top.remaining--;
+
+  // clear screen and home
+  cli_printf(_top.intf, "\033[H\033[2J");
+  top_render(_top.intf);
+}
+
+static void
+cli_command_top(cli_intf_t* intf, int argc, const char** argv)
+{
+  struct itimerspec   its;
+  uint32_t            count = 1;
+
+  if(argc >= 2 && strcmp(argv[1], "stop") == 0)
+  {
+    top_stop();
+    return;
+  }
+
+  if(argc > 3)
+  {
+    goto error;
+  }
+
+  _top.sort = top_sort_pps;
+
+  if(argc >= 2)
+  {
+    for(_top.sort = 0; _top.sort < top_sort_max; _top.sort++)
+    {
+      if(strcmp(argv[1], _top_columns[_top.sort]) == 0)
+      {
+        break;
+      }
+    }
+
+    if(_top.sort == top_sort_max)
+    {
+      goto error;
+    }
+  }
+
+  if(argc == 3)
+  {
+    count = atoi(argv[2]);
+  }
+
+  top_stop();
+  top_render(intf);
+
+  if(count <= 1)
+  {
+    return;
+  }
+
+  //
+  // refresh every second. stops by any key, top stop or count
+  //
+  _top.timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+  if(_top.timerfd < 0)
+  {
+    return;
+  }
+
+  its.it_interval.tv_sec  = 1;
+  its.it_interval.tv_nsec = 0;
+  its.it_value            = its.it_interval;
+  timerfd_settime(_top.timerfd, 0, &its, NULL);
+
+  _top.intf       = intf;
+  _top.remaining  = count - 1;
+
+  intf->on_close  = top_intf_close;
+
+  io_driver_watcher_init(&_top.watcher);
+  _top.watcher.fd       = _top.timerfd;
+  _top.watcher.callback = top_timer_callback;
+
+  io_driver_watch(main_io_driver(), &_top.watcher, IO_DRIVER_EVENT_RX);
+  return;
+
+error:
+  cli_printf(intf, "Error"CLI_EOL);
+  cli_printf(intf, "%s [ssrc|pps|bps|loss|jitter|age|rtt] [refresh count]"CLI_EOL, argv[0]);
+  cli_printf(intf, "%s stop"CLI_EOL, argv[0]);
+}
+
+static int
+capture_write_file(void* arg, const void* buf, uint32_t len)
+{
+  return fwrite(buf, 1, len, (FILE*)arg) == len ? 0 : -1;
+}
+
+static void
+cli_command_capture(cli_intf_t* intf, int argc, const char** argv)
+{
+  rtp_session_t*  sess = rtp_task_get_session();
+  uint32_t        flags = 0,
+                  ssrc = 0;
+  FILE*           fp;
+  int             n;
+
+  if(argc == 1)
+  {
+    cli_printf(intf, "%s, captured %u, in ring %u, filtered %u"CLI_EOL,
+        sess->capture != NULL ? "armed" : "disarmed",
+        _capture.head, rtp_capture_count(&_capture), _capture.filtered);
+    return;
+  }
+
+  if(strcmp(argv[1], "on") == 0)
+  {
+    for(int i = 2; i < argc; i++)
+    {
+      if(strcmp(argv[i], "hdr") == 0)
+      {
+        flags |= RTP_CAPTURE_HEADERS_ONLY;
+      }
+      else if(strcmp(argv[i], "ssrc") == 0 && i + 1 < argc)
+      {
+        flags |= RTP_CAPTURE_FILTER_SSRC;
+        ssrc = strtoul(argv[++i], NULL, 0);
+      }
+      else
+      {
+        goto error;
+      }
+    }
+
+    rtp_capture_init(&_capture, flags, ssrc);
+    rtp_session_set_capture(sess, &_capture);
+    return;
+  }
+
+  if(strcmp(argv[1], "off") == 0 && argc == 2)
+  {
+    rtp_session_set_capture(sess, NULL);
+    return;
+  }
+
+  if(strcmp(argv[1], "clear") == 0 && argc == 2)
+  {
+    rtp_capture_clear(&_capture);
+    return;
+  }
+
+  if(strcmp(argv[1], "dump") == 0 && argc == 3)
+  {
+    fp = fopen(argv[2], "wb");
+    if(fp == NULL)
+    {
+      cli_printf(intf, "can't open %s"CLI_EOL, argv[2]);
+      return;
+    }
+
+    n = rtp_capture_write_pcap(&_capture, capture_write_file, fp);
+    fclose(fp);
+
+    if(n < 0)
+    {
+      cli_printf(intf, "write to %s failed"CLI_EOL, argv[2]);
+      return;
+    }
+    cli_printf(intf, "%d packets written to %s"CLI_EOL, n, argv[2]);
+    return;
+  }
+
+error:
+  cli_printf(intf, "Error"CLI_EOL);
+  cli_printf(intf, "%s on [ssrc <ssrc>] [hdr]"CLI_EOL, argv[0]);
+  cli_printf(intf, "%s off|clear"CLI_EOL, argv[0]);
+  cli_printf(intf, "%s dump <file>"CLI_EOL, argv[0]);
+}
+
 void
 rtp_cli_init(void)
 {
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -11,8 +12,15 @@
 #include "generic_list.h"
 #include "cli.h"
 #include "io_driver.h"
+#include "http_metrics.h"
+#include "udp_transport.h"
 
 #include "rtp_task.h"
+#include "rtp_session_util.h"
+#include "rtp_metrics.h"
+
+#define CONFIG_METRICS_PORT       9100
+#define CONFIG_SOCK_BUF_SIZE      (256 * 1024)
 
 extern io_driver_t* main_io_driver(void);
 
@@ -24,10 +32,8 @@ static struct sockaddr_in   _rtp_addr,
 static struct sockaddr_in   _rtp_rem_addr,
                             _rtcp_rem_addr;
 
-static int                  _rtp_sock,
-                            _rtcp_sock;
-static io_driver_watcher_t  _rtp_watcher;
-static io_driver_watcher_t  _rtcp_watcher;
+static udp_transport_t      _rtp_transport,
+                            _rtcp_transport;
 
 static io_driver_watcher_t  _timer_watcher;
 static int                  _timerfd;
@@ -41,10 +47,9 @@ extern void rtp_task_show_rtp_stats(cli_intf_t* intf);
 
 static char *cname;
 
-static uint32_t    _rtp_ts = 0;
-
 static uint8_t    _rtp_tx_enabled = RTP_TRUE;
 static uint8_t    _rtcp_tx_enabled = RTP_TRUE;
+static uint8_t    _rtcp_mux = RTP_FALSE;
 
 #if 0
 #define DLOGI       DLOGI
@@ -58,6 +63,10 @@ static int _test_u8_pcm_fd;
 
 static rtp_session_config_t   _session_cfg;
 
+static rtp_shm_t              _shm;
+
+static http_metrics_t         _metrics_server;
+
 //////////////////////////////////////////////////////////////////////////
 //
 // from session -> user tx rtp routine
@@ -66,14 +75,11 @@ static rtp_session_config_t   _session_cfg;
 static int
 rtp_task_tx_rtp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
 {
-  int ret;
-
   DLOGI(TAG, "TX RTP %d\n", len);
 
-  ret = sendto(_rtp_sock, pkt, len, 0, (struct sockaddr*)&_rtp_rem_addr, sizeof(_rtp_rem_addr));
-  if(ret <= 0)
+  if(udp_transport_send(&_rtp_transport, pkt, len, &_rtp_rem_addr) != 0)
   {
-    DLOGE(TAG, "TX RTP failed: %d\n", ret);
+    DLOGE(TAG, "TX RTP failed: %d\n", len);
   }
   return 0;
 }
@@ -95,10 +101,17 @@ rtp_task_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
 
   DLOGI(TAG, "TX RTCP %d\n", len);
 
-  ret = sendto(_rtp_sock, pkt, len, 0, (struct sockaddr*)&_rtcp_rem_addr, sizeof(_rtcp_rem_addr));
-  if(ret <= 0)
+  if(_rtcp_mux == RTP_TRUE)
+  {
+    ret = udp_transport_send(&_rtp_transport, pkt, len, &_rtp_rem_addr);
+  }
+  else
+  {
+    ret = udp_transport_send(&_rtcp_transport, pkt, len, &_rtcp_rem_addr);
+  }
+  if(ret != 0)
   {
-    DLOGE(TAG, "TX RTCP failed: %d\n", ret);
+    DLOGE(TAG, "TX RTCP failed: %d\n", len);
   }
   return 0;
 }
@@ -109,12 +122,12 @@ rtp_task_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
 //
 //////////////////////////////////////////////////////////////////////////
 static void
-rtp_task_sr_report(rtp_session_t* sess, uint32_t from_ssrc, rtcp_t* r)
+rtp_task_sr_report(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_sr_info_t* sr)
 {
 }
 
 static void
-rtp_task_rr_report(rtp_session_t* sess, uint32_t from_ssrc, rtcp_rr_t* rr)
+rtp_task_rr_report(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_rr_info_t* rr)
 {
 }
 
@@ -131,70 +144,50 @@ rtp_task_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
   return 0;
 }
 
-static uint32_t
-rtp_task_rtp_timestamp(rtp_session_t* sess)
-{
-  return _rtp_ts;
-}
-
 //////////////////////////////////////////////////////////////////////////
 //
-// from io driver -> user rx rtp notification
+// from udp transport -> user rx rtp notification
 //
 //////////////////////////////////////////////////////////////////////////
 static void
-on_rx_rtp_from_sock(io_driver_watcher_t* watcher, io_driver_event event)
+on_rx_rtp_from_sock(udp_transport_t* t, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns)
 {
-  uint8_t buffer[1024];
-  int len;
-  struct sockaddr_in    from;
-  socklen_t             from_len;
-
-  from_len = sizeof(from);
-
-  DLOGI(TAG, "on_rx_rtp_from_sock\n");
+  DLOGI(TAG, "on_rx_rtp_from_sock got %d bytes from %s:%d\n", len,
+      inet_ntoa(from->sin_addr), htons(from->sin_port));
 
-  len = recvfrom(_rtp_sock, buffer, 1024, 0, (struct sockaddr*)&from, &from_len);
-  if(len <= 0)
+  if(_rtcp_mux == RTP_TRUE)
   {
-    DLOGE(TAG, "on_rx_rtp_from_sock error %d\n", len);
+    rtp_session_rx_at(&_rtp_session, pkt, len, from, arrival_ns);
     return;
   }
 
-  DLOGI(TAG, "on_rx_rtcp_from_sock got %d bytes from %s:%d\n", len,
-      inet_ntoa(from.sin_addr), htons(from.sin_port));
-
-  rtp_session_rx_rtp(&_rtp_session, buffer, len, &from);
+  rtp_session_rx_rtp_at(&_rtp_session, pkt, len, from, arrival_ns);
 }
 
 //////////////////////////////////////////////////////////////////////////
 //
-// from io driver -> user rx rtcp notification
+// from udp transport -> user rx rtcp notification
 //
 //////////////////////////////////////////////////////////////////////////
 static void
-on_rx_rtcp_from_sock(io_driver_watcher_t* watcher, io_driver_event event)
+on_rx_rtcp_from_sock(udp_transport_t* t, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns)
 {
-  uint8_t buffer[1024];
-  int len;
-  struct sockaddr_in    from;
-  socklen_t             from_len;
-
-  from_len = sizeof(from);
+  DLOGI(TAG, "on_rx_rtcp_from_sock got %d bytes from %s:%d\n", len,
+      inet_ntoa(from->sin_addr), htons(from->sin_port));
 
-  DLOGI(TAG, "on_rx_rtcp_from_sock\n");
+  rtp_session_rx_rtcp(&_rtp_session, pkt, len, from);
+}
 
-  len = recvfrom(_rtcp_sock, buffer, 1024, 0, (struct sockaddr*)&from, &from_len);
-  if(len <= 0)
+static void
+rtp_task_flush(void)
+{
+  udp_transport_flush(&_rtp_transport);
+  if(_rtcp_mux == RTP_FALSE)
   {
-    DLOGE(TAG, "on_rx_rtcp_from_sock error %d\n", len);
-    return;
+    udp_transport_flush(&_rtcp_transport);
   }
-
-  DLOGI(TAG, "on_rx_rtcp_from_sock got %d bytes from %s:%d\n", len,
-      inet_ntoa(from.sin_addr), htons(from.sin_port));
-
-  rtp_session_rx_rtcp(&_rtp_session, buffer, len, &from);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -213,6 +206,7 @@ rtp_task_timer_callback(io_driver_watcher_t* watcher, io_driver_event event)
   // DLOGI(TAG, "rtp task timing tick\n");
 
   rtp_session_timer_tick(&_rtp_session);
+  rtp_task_flush();
 }
 
 static void
@@ -247,9 +241,47 @@ rtp_task_sampler_callback(io_driver_watcher_t* watcher, io_driver_event event)
     }
     nread += ret;
   }
-  _rtp_ts += 160;
+  // sampling instant from the session media clock
+  rtp_session_tx(&_rtp_session, sample, 160, rtp_session_timestamp(&_rtp_session), NULL, 0);
+  rtp_task_flush();
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+// metrics endpoint
+//
+//////////////////////////////////////////////////////////////////////////
+static void
+rtp_task_metrics_begin(http_metrics_conn_t* conn)
+{
+  static rtp_session_t* sessions[] = { &_rtp_session };
+  rtp_metrics_t*        mt;
+
+  mt = malloc(sizeof(rtp_metrics_t));
+  if(mt != NULL)
+  {
+    rtp_metrics_begin(mt, sessions, NARRAY(sessions));
+  }
+  conn->priv = mt;
+}
 
-  rtp_session_tx(&_rtp_session, sample, 160,  _rtp_ts, NULL, 0);
+static int
+rtp_task_metrics_fill(http_metrics_conn_t* conn, char* buf, int len)
+{
+  rtp_metrics_t*  mt = (rtp_metrics_t*)conn->priv;
+
+  if(mt == NULL || rtp_metrics_done(mt))
+  {
+    return -1;
+  }
+  return rtp_metrics_format(mt, buf, len);
+}
+
+static void
+rtp_task_metrics_end(http_metrics_conn_t* conn)
+{
+  free(conn->priv);
+  conn->priv = NULL;
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -264,7 +296,7 @@ rtp_task_init_timing_service(void)
 
   DLOGI(TAG, "initializing rtp timing service\n");
 
-  _timerfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+  _timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
   new_value.it_interval.tv_sec     = 0;
   new_value.it_interval.tv_nsec    = 100 * 1000000;   // nano sec - 20ms
   new_value.it_value = new_value.it_interval;
@@ -288,7 +320,7 @@ rtp_task_init_sampler(void)
 
   DLOGI(TAG, "initializing rtp timing service\n");
 
-  _samplerfd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC);
+  _samplerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
   new_value.it_interval.tv_sec     = 0;
   new_value.it_interval.tv_nsec    = 20 * 1000000;   // nano sec - 20ms
   new_value.it_value = new_value.it_interval;
@@ -311,42 +343,32 @@ rtp_task_init_sampler(void)
 static inline void
 rtp_task_init_sock(void)
 {
-  _rtp_sock = socket(AF_INET, SOCK_DGRAM, 0);
-  if(_rtp_sock < 0)
-  {
-    DLOGE(TAG, "_rtp_sock socket() failed\n");
-    exit(-1);
-  }
+  udp_transport_config_t    cfg;
 
-  if(bind(_rtp_sock, (struct sockaddr*)&_rtp_addr, sizeof(_rtp_addr)) != 0)
+  udp_transport_config_init(&cfg);
+  cfg.rcvbuf = CONFIG_SOCK_BUF_SIZE;
+  cfg.sndbuf = CONFIG_SOCK_BUF_SIZE;
+  cfg.timestamp = RTP_TRUE;
+
+  cfg.bind_addr = _rtp_addr;
+  if(udp_transport_init(main_io_driver(), &_rtp_transport, &cfg, on_rx_rtp_from_sock) != 0)
   {
-    DLOGE(TAG, "_rtp_sock bind() failed\n");
+    DLOGE(TAG, "RTP transport init failed\n");
     exit(-1);
   }
 
-  _rtcp_sock = socket(AF_INET, SOCK_DGRAM, 0);
-  if(_rtcp_sock < 0)
+  if(_rtcp_mux == RTP_TRUE)
   {
-    DLOGE(TAG, "_rtcp_sock socket() failed\n");
-    exit(-1);
+    // RTCP comes in through RTP socket
+    return;
   }
 
-  if(bind(_rtcp_sock, (struct sockaddr*)&_rtcp_addr, sizeof(_rtcp_addr)) != 0)
+  cfg.bind_addr = _rtcp_addr;
+  if(udp_transport_init(main_io_driver(), &_rtcp_transport, &cfg, on_rx_rtcp_from_sock) != 0)
   {
-    DLOGE(TAG, "_rtcp_sock bind() failed\n");
+    DLOGE(TAG, "RTCP transport init failed\n");
     exit(-1);
   }
-
-  io_driver_watcher_init(&_rtp_watcher);
-  _rtp_watcher.fd = _rtp_sock;
-  _rtp_watcher.callback = on_rx_rtp_from_sock;
-
-  io_driver_watcher_init(&_rtcp_watcher);
-  _rtcp_watcher.fd = _rtcp_sock;
-  _rtcp_watcher.callback = on_rx_rtcp_from_sock;
-
-  io_driver_watch(main_io_driver(), &_rtp_watcher, IO_DRIVER_EVENT_RX);
-  io_driver_watch(main_io_driver(), &_rtcp_watcher, IO_DRIVER_EVENT_RX);
 }
 
 void
@@ -362,14 +384,15 @@ rtp_task_rtcp_control(uint8_t enable)
 }
 
 void
-rtp_task_init(uint8_t blah)
+rtp_task_init(uint8_t blah, uint8_t mux)
 {
+  _rtcp_mux = mux;
+
   _rtp_session.sr_rpt         = rtp_task_sr_report;
   _rtp_session.rr_rpt         = rtp_task_rr_report;
   _rtp_session.tx_rtp         = rtp_task_tx_rtp;
   _rtp_session.tx_rtcp        = rtp_task_tx_rtcp;
   _rtp_session.rx_rtp         = rtp_task_rx_rtp;
-  _rtp_session.rtp_timestamp  = rtp_task_rtp_timestamp;
 
   memset(&_rtp_addr, 0, sizeof(_rtp_addr));
   memset(&_rtcp_addr, 0, sizeof(_rtcp_addr));
@@ -432,9 +455,23 @@ rtp_task_init(uint8_t blah)
   _session_cfg.session_bw = 64000;
   _session_cfg.pt = 0;
   _session_cfg.align_by_4 = RTP_FALSE;
+  _session_cfg.rtcp_mux = _rtcp_mux;
+  _session_cfg.clock_rate = 8000;
+  _session_cfg.media_clock = RTP_TRUE;
 
   rtp_session_init(&_rtp_session, &_session_cfg);
 
+  // counters for prtp_top
+  if(rtp_shm_create(&_shm, RTP_SHM_DEFAULT_NAME) == 0)
+  {
+    rtp_session_set_shm(&_rtp_session, &_shm);
+  }
+
+  _metrics_server.begin = rtp_task_metrics_begin;
+  _metrics_server.fill  = rtp_task_metrics_fill;
+  _metrics_server.end   = rtp_task_metrics_end;
+  http_metrics_init(main_io_driver(), &_metrics_server, CONFIG_METRICS_PORT);
+
   rtp_task_init_sampler();
 
   DLOGI(TAG, "done initializing session\n");
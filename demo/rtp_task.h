@@ -3,7 +3,7 @@
 
 #include "rtp_session.h"
 
-extern void rtp_task_init(uint8_t blah);
+extern void rtp_task_init(uint8_t blah, uint8_t mux);
 extern rtp_session_t* rtp_task_get_session(void);
 extern void rtp_task_rtp_control(uint8_t enable);
 extern void rtp_task_rtcp_control(uint8_t enable);
@@ -91,4 +91,32 @@ circ_buffer_is_empty(circ_buffer_t* cb)
    return FALSE;
 }
 
+/*
+ * get free space in circular buffer
+ *
+ * @param cb   circular buffer
+ * @return free space size
+ */
+static inline int
+circ_buffer_get_free_size(circ_buffer_t* cb)
+{
+   return cb->size - cb->data_size;
+}
+
+/*
+ * get the contiguous data at the head of circular buffer.
+ * consume it with circ_buffer_advance()
+ *
+ * @param cb   circular buffer
+ * @param data pointer to the head data
+ * @return contiguous data size
+ */
+static inline int
+circ_buffer_get_contiguous(circ_buffer_t* cb, uint8_t** data)
+{
+   *data = &cb->buffer[cb->begin];
+
+   return MIN(cb->data_size, cb->size - cb->begin);
+}
+
 #endif //!__CIRC_BUFFER_DEF_H__
@@ -228,6 +228,7 @@ cli_intf_register(cli_intf_t* intf)
 {
   INIT_LIST_HEAD(&intf->le);
   intf->cmd_buffer_ndx = 0;
+  intf->on_close       = NULL;
 
   list_add_tail(&intf->le, &_cli_intf_list);
 }
@@ -235,5 +236,13 @@ cli_intf_register(cli_intf_t* intf)
 void
 cli_intf_unregister(cli_intf_t* intf)
 {
+  void    (*on_close)(cli_intf_t* intf) = intf->on_close;
+
+  intf->on_close = NULL;
+  if(on_close != NULL)
+  {
+    on_close(intf);
+  }
+
   list_del_init(&intf->le);
 }
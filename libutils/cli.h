@@ -21,6 +21,9 @@ struct __cli_intf
   void          (*put_tx_data)(cli_intf_t* intf, const char* data, int len);
   void          (*print_status)(cli_intf_t* intf);
 
+  // optional. called once when the interface is unregistered. cleared by cli_intf_register
+  void          (*on_close)(cli_intf_t* intf);
+
   struct list_head      le;
 };
 
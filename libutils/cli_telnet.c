@@ -80,11 +80,16 @@ alloc_cli_connection(cli_server_t* server, int newsd)
     return;
   }
 
+  if(stream_init_with_fd(cli_io_driver(), &conn->stream, newsd, conn->rx_buf, 128, 128) != 0)
+  {
+    free(conn);
+    close(newsd);
+    return;
+  }
+
   INIT_LIST_HEAD(&conn->le);
   list_add_tail(&conn->le,  &server->conns);
 
-  stream_init_with_fd(cli_io_driver(), &conn->stream, newsd, conn->rx_buf, 128, 128);
-
   sock_util_put_nonblock(newsd);
 
   //
@@ -185,7 +190,7 @@ handle_stream_event(stream_t* stream, stream_event_t evt)
     break;
 
   case stream_event_tx:
-    // never occurs
+    // nothing more to send
     break;
   }
 }
@@ -0,0 +1,347 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+
+#include "common_def.h"
+#include "http_metrics.h"
+#include "tcp_server_ipv4.h"
+#include "sock_util.h"
+
+static const char* TAG = "http_metrics";
+
+typedef enum
+{
+  http_metrics_state_request,         // reading request header
+  http_metrics_state_body,            // pulling body from user
+  http_metrics_state_drain,           // waiting for queued data to go out
+  http_metrics_state_closing,         // FIN sent. waiting for peer close
+} http_metrics_state_t;
+
+static const char _ok_hdr[] =
+  "HTTP/1.0 200 OK\r\n"
+  "Content-Type: text/plain; version=0.0.4\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+static const char _not_found[] =
+  "HTTP/1.0 404 Not Found\r\n"
+  "Content-Type: text/plain\r\n"
+  "Connection: close\r\n"
+  "\r\n"
+  "not found\n";
+
+static const char _bad_request[] =
+  "HTTP/1.0 400 Bad Request\r\n"
+  "Connection: close\r\n"
+  "\r\n";
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// private utilities
+//
+////////////////////////////////////////////////////////////////////////////////
+static void
+dealloc_conn(http_metrics_conn_t* conn)
+{
+  if(conn->state == http_metrics_state_body || conn->state == http_metrics_state_drain)
+  {
+    conn->server->end(conn);
+  }
+
+  stream_deinit(&conn->stream);
+  list_del_init(&conn->le);
+  conn->server->num_conns--;
+  free(conn);
+}
+
+static inline void
+set_deadline(http_metrics_conn_t* conn)
+{
+  conn->deadline = conn->server->ticks + HTTP_METRICS_TIMEOUT;
+}
+
+static void
+finish_response(http_metrics_conn_t* conn)
+{
+  //
+  // HTTP/1.0 body ends with connection close.
+  // half close here and let peer close the connection.
+  //
+  shutdown(conn->stream.watcher.fd, SHUT_WR);
+  conn->state = http_metrics_state_closing;
+  set_deadline(conn);
+}
+
+static void
+pump_body(http_metrics_conn_t* conn)
+{
+  int     len;
+
+  if(conn->state == http_metrics_state_drain)
+  {
+    // called on drained TX
+    conn->server->end(conn);
+    finish_response(conn);
+    return;
+  }
+
+  if(circ_buffer_get_free_size(&conn->stream.tx_buf) >= HTTP_METRICS_CHUNK_SIZE)
+  {
+    len = conn->server->fill(conn, conn->chunk, HTTP_METRICS_CHUNK_SIZE);
+    if(len < 0)
+    {
+      conn->state = http_metrics_state_drain;
+    }
+    else if(len > 0 && stream_write(&conn->stream, (uint8_t*)conn->chunk, len) == FALSE)
+    {
+      LOGE(TAG, "tx failed\n");
+      conn->server->end(conn);
+      finish_response(conn);
+      return;
+    }
+  }
+
+  // next chunk on next loop
+  stream_request_tx(&conn->stream);
+}
+
+static void
+handle_request(http_metrics_conn_t* conn)
+{
+  if(strncmp(conn->req, "GET /metrics ", 13) != 0 && strncmp(conn->req, "GET / ", 6) != 0)
+  {
+    stream_write(&conn->stream, (uint8_t*)_not_found, sizeof(_not_found) - 1);
+    finish_response(conn);
+    return;
+  }
+
+  stream_write(&conn->stream, (uint8_t*)_ok_hdr, sizeof(_ok_hdr) - 1);
+
+  conn->state = http_metrics_state_body;
+  conn->server->begin(conn);
+
+  pump_body(conn);
+}
+
+static void
+handle_rx(http_metrics_conn_t* conn)
+{
+  stream_t*   stream = &conn->stream;
+  int         len;
+
+  if(conn->state != http_metrics_state_request)
+  {
+    // don't care
+    return;
+  }
+
+  len = MIN(stream->rx_data_len, HTTP_METRICS_RX_BUF_SIZE - 1 - conn->req_len);
+
+  memcpy(&conn->req[conn->req_len], stream->rx_buf, len);
+  conn->req_len += len;
+  conn->req[conn->req_len] = '\0';
+
+  if(strstr(conn->req, "\r\n\r\n") != NULL || strstr(conn->req, "\n\n") != NULL)
+  {
+    handle_request(conn);
+    return;
+  }
+
+  if(conn->req_len >= HTTP_METRICS_RX_BUF_SIZE - 1)
+  {
+    stream_write(stream, (uint8_t*)_bad_request, sizeof(_bad_request) - 1);
+    finish_response(conn);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// stream callback
+//
+////////////////////////////////////////////////////////////////////////////////
+static void
+handle_stream_event(stream_t* stream, stream_event_t evt)
+{
+  http_metrics_conn_t* conn = container_of(stream, http_metrics_conn_t, stream);
+
+  switch(evt)
+  {
+  case stream_event_rx:
+    handle_rx(conn);
+    break;
+
+  case stream_event_eof:
+  case stream_event_err:
+    dealloc_conn(conn);
+    break;
+
+  case stream_event_tx:
+    if(conn->state == http_metrics_state_body || conn->state == http_metrics_state_drain)
+    {
+      pump_body(conn);
+    }
+    break;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// timer callback
+//
+////////////////////////////////////////////////////////////////////////////////
+static void
+http_metrics_timer_callback(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  http_metrics_t*       server = container_of(watcher, http_metrics_t, timer_watcher);
+  http_metrics_conn_t   *conn,
+                        *n;
+  uint64_t              v;
+
+  read(watcher->fd, &v, sizeof(v));
+  (void)v;
+
+  server->ticks++;
+
+  //
+  // a peer that never finishes its request or never closes
+  // would hold the connection forever
+  //
+  list_for_each_entry_safe(conn, n, &server->conns, le)
+  {
+    if((conn->state == http_metrics_state_request || conn->state == http_metrics_state_closing) &&
+        (int32_t)(server->ticks - conn->deadline) >= 0)
+    {
+      dealloc_conn(conn);
+    }
+  }
+}
+
+static int
+http_metrics_timer_init(http_metrics_t* server)
+{
+  struct itimerspec   its;
+  int                 fd;
+
+  fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+  if(fd < 0)
+  {
+    LOGE(TAG, "timerfd_create failed\n");
+    return -1;
+  }
+
+  its.it_interval.tv_sec  = 1;
+  its.it_interval.tv_nsec = 0;
+  its.it_value            = its.it_interval;
+  timerfd_settime(fd, 0, &its, NULL);
+
+  io_driver_watcher_init(&server->timer_watcher);
+  server->timer_watcher.fd        = fd;
+  server->timer_watcher.callback  = http_metrics_timer_callback;
+
+  if(io_driver_watch(server->driver, &server->timer_watcher, IO_DRIVER_EVENT_RX) != 0)
+  {
+    close(fd);
+    return -1;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// tcp server callback
+//
+////////////////////////////////////////////////////////////////////////////////
+static void
+http_metrics_new_connection(tcp_server_t* tcp_server, int newsd, struct sockaddr* from)
+{
+  http_metrics_t*       server = container_of(tcp_server, http_metrics_t, tcp_server);
+  http_metrics_conn_t*  conn;
+
+  if(server->num_conns >= HTTP_METRICS_MAX_CONNS)
+  {
+    LOGE(TAG, "too many connections\n");
+    close(newsd);
+    return;
+  }
+
+  conn = malloc(sizeof(http_metrics_conn_t));
+  if(conn == NULL)
+  {
+    LOGE(TAG, "malloc failed\n");
+    close(newsd);
+    return;
+  }
+
+  sock_util_put_nonblock(newsd);
+
+  if(stream_init_with_fd(server->driver, &conn->stream, newsd, conn->rx_buf, sizeof(conn->rx_buf),
+        HTTP_METRICS_TX_BUF_SIZE) != 0)
+  {
+    free(conn);
+    close(newsd);
+    return;
+  }
+  conn->stream.cb = handle_stream_event;
+
+  INIT_LIST_HEAD(&conn->le);
+  list_add_tail(&conn->le, &server->conns);
+  server->num_conns++;
+
+  conn->server    = server;
+  conn->req_len   = 0;
+  conn->state     = http_metrics_state_request;
+  conn->priv      = NULL;
+  set_deadline(conn);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////////////////////////
+int
+http_metrics_init(io_driver_t* driver, http_metrics_t* server, int port)
+{
+  LOGI(TAG, "initializing metrics endpoint on port %d\n", port);
+
+  INIT_LIST_HEAD(&server->conns);
+
+  server->driver              = driver;
+  server->num_conns           = 0;
+  server->ticks               = 0;
+  server->tcp_server.conn_cb  = http_metrics_new_connection;
+
+  if(http_metrics_timer_init(server) != 0)
+  {
+    return -1;
+  }
+
+  if(tcp_server_ipv4_init(driver, &server->tcp_server, port, 5) != 0)
+  {
+    io_driver_no_watch(driver, &server->timer_watcher, IO_DRIVER_EVENT_RX);
+    close(server->timer_watcher.fd);
+    return -1;
+  }
+
+  tcp_server_start(&server->tcp_server);
+  return 0;
+}
+
+void
+http_metrics_deinit(http_metrics_t* server)
+{
+  http_metrics_conn_t   *conn,
+                        *n;
+
+  list_for_each_entry_safe(conn, n, &server->conns, le)
+  {
+    dealloc_conn(conn);
+  }
+
+  io_driver_no_watch(server->driver, &server->timer_watcher, IO_DRIVER_EVENT_RX);
+  close(server->timer_watcher.fd);
+
+  tcp_server_deinit(&server->tcp_server);
+}
@@ -0,0 +1,66 @@
+#ifndef __HTTP_METRICS_DEF_H__
+#define __HTTP_METRICS_DEF_H__
+
+#include "common_def.h"
+#include "generic_list.h"
+#include "io_driver.h"
+#include "tcp_server.h"
+#include "stream.h"
+
+//
+// a tiny HTTP/1.0 server for GET /metrics.
+//
+// the body is pulled from user in chunks of HTTP_METRICS_CHUNK_SIZE,
+// one chunk per io loop iteration, only when the socket drained what was
+// queued before. so a huge body never stalls the loop for long.
+//
+// a connection gets HTTP_METRICS_TIMEOUT seconds to send its request and
+// another HTTP_METRICS_TIMEOUT to close after the response. it is closed
+// when it doesn't. connections over HTTP_METRICS_MAX_CONNS are refused.
+//
+#define HTTP_METRICS_RX_BUF_SIZE          512
+#define HTTP_METRICS_TX_BUF_SIZE          16384
+#define HTTP_METRICS_CHUNK_SIZE           4096
+#define HTTP_METRICS_TIMEOUT              5
+#define HTTP_METRICS_MAX_CONNS            8
+
+struct __http_metrics;
+typedef struct __http_metrics http_metrics_t;
+
+typedef struct
+{
+  struct list_head    le;
+  http_metrics_t*     server;
+  stream_t            stream;
+  uint8_t             rx_buf[128];
+  char                req[HTTP_METRICS_RX_BUF_SIZE];
+  int                 req_len;
+  uint8_t             state;
+  uint32_t            deadline;         // in server ticks
+  void*               priv;             // for user
+  char                chunk[HTTP_METRICS_CHUNK_SIZE];
+} http_metrics_conn_t;
+
+struct __http_metrics
+{
+  tcp_server_t        tcp_server;
+  io_driver_t*        driver;
+  struct list_head    conns;
+  uint32_t            num_conns;
+
+  io_driver_watcher_t timer_watcher;    // 1 second timerfd
+  uint32_t            ticks;
+
+  //
+  // user callbacks.
+  // begin/end bracket a response. fill returns bytes put into buf. -1 when done
+  //
+  void (*begin)(http_metrics_conn_t* conn);
+  int  (*fill)(http_metrics_conn_t* conn, char* buf, int len);
+  void (*end)(http_metrics_conn_t* conn);
+};
+
+extern int http_metrics_init(io_driver_t* driver, http_metrics_t* server, int port);
+extern void http_metrics_deinit(http_metrics_t* server);
+
+#endif /* !__HTTP_METRICS_DEF_H__ */
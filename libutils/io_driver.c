@@ -173,17 +173,33 @@ io_driver_watcher_init(io_driver_watcher_t* watcher)
   watcher->event_listening = 0;
 }
 
-void
+/**
+ * start watching event on watcher->fd
+ *
+ * @return 0 on success, -1 if the fd can't be watched by select.
+ *         the watcher is left untouched then
+ */
+int
 io_driver_watch(io_driver_t* driver, io_driver_watcher_t* watcher, io_driver_event event)
 {
   uint8_t   old_set = watcher->event_listening;
 
+  //
+  // FD_SET beyond FD_SETSIZE writes past the fd_set
+  //
+  if(watcher->fd < 0 || watcher->fd >= FD_SETSIZE)
+  {
+    LOGE(TAG, "can't watch fd %d. select handles up to %d\n", watcher->fd, FD_SETSIZE - 1);
+    return -1;
+  }
+
   watcher->event_listening |= event;
 
   if(old_set == 0 && watcher->event_listening != 0)
   {
     list_add_tail(&watcher->le, &driver->watchers);
   }
+  return 0;
 }
 
 void
@@ -9,45 +9,42 @@ static const char* TAG = "stream";
 static void
 stream_handle_tx_event(stream_t* stream)
 {
-  uint8_t   buffer[128];
-  int       data_size,
-            ret,
+  uint8_t*  data;
+  int       ret,
             len;
 
-  if(circ_buffer_is_empty(&stream->tx_buf))
+  if(circ_buffer_is_empty(&stream->tx_buf) == FALSE)
   {
-    LOGI(TAG, "disabling TX event. circ buffer empty now");
-    io_driver_no_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_TX);
-    return;
-  }
+    // straight out of the circ buffer. no bounce copy
+    len = circ_buffer_get_contiguous(&stream->tx_buf, &data);
 
-  // XXX
-  // looping would be more efficient but
-  // on the other hand, this has better time sharing feature
-  //
-  data_size = circ_buffer_get_data_size(&stream->tx_buf);
-  len = data_size < 128 ? data_size : 128;
-  circ_buffer_peek(&stream->tx_buf, buffer, len);
-
-  ret = write(stream->watcher.fd, buffer, len);
-  if(ret <= 0)
-  {
-    // definitely stream got into a trouble
-    io_driver_no_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_TX);
+    ret = write(stream->watcher.fd, data, len);
+    if(ret < 0)
+    {
+      if(errno == EWOULDBLOCK || errno == EAGAIN)
+      {
+        return;
+      }
 
-    LOGI(TAG, "XXXXXXXX this should not happen");
-    CRASH();
-    return;
-  }
+      io_driver_no_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_TX);
+      stream->cb(stream, stream_event_err);
+      return;
+    }
 
-  circ_buffer_advance(&stream->tx_buf, ret);
+    circ_buffer_advance(&stream->tx_buf, ret);
 
-  if(circ_buffer_is_empty(&stream->tx_buf))
-  {
-    io_driver_no_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_TX);
+    if(circ_buffer_is_empty(&stream->tx_buf) == FALSE)
+    {
+      return;
+    }
   }
 
-  return;
+  //
+  // all queued data is out.
+  // tell user so that more can be written without blocking anybody
+  //
+  io_driver_no_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_TX);
+  stream->cb(stream, stream_event_tx);
 }
 
 static void
@@ -90,7 +87,11 @@ stream_watcher_callback(io_driver_watcher_t* watcher, io_driver_event evt)
 }
 
 
-void
+/**
+ * @return 0 on success, -1 if fd can't be watched.
+ *         fd is not closed then. it is still caller's
+ */
+int
 stream_init_with_fd(io_driver_t* driver, stream_t* stream, int fd, uint8_t* rx_buf, int rx_buf_size, int tx_buf_size)
 {
   // XXX return value check
@@ -105,8 +106,13 @@ stream_init_with_fd(io_driver_t* driver, stream_t* stream, int fd, uint8_t* rx_b
   stream->watcher.fd = fd;
   stream->watcher.callback = stream_watcher_callback;
 
-  io_driver_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_RX);
+  if(io_driver_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_RX) != 0)
+  {
+    circ_buffer_deinit(&stream->tx_buf);
+    return -1;
+  }
   io_driver_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_EX);
+  return 0;
 }
 
 void
@@ -121,6 +127,16 @@ stream_deinit(stream_t* stream)
   close(stream->watcher.fd);
 }
 
+/*
+ * request stream_event_tx when all queued data is written out.
+ * fired on the next loop if nothing is queued
+ */
+void
+stream_request_tx(stream_t* stream)
+{
+  io_driver_watch(stream->driver, &stream->watcher, IO_DRIVER_EVENT_TX);
+}
+
 bool
 stream_write(stream_t* stream, uint8_t* data, int len)
 {
@@ -13,7 +13,7 @@ typedef enum
   stream_event_rx,        // just received data
   stream_event_eof,       // eof detect
   stream_event_err,       // error catched
-  stream_event_tx,        // tx buffer available
+  stream_event_tx,        // tx buffer drained
 } stream_event_t;
 
 typedef void (*stream_callback)(stream_t* stream, stream_event_t evt);
@@ -29,8 +29,9 @@ struct __stream
   circ_buffer_t       tx_buf;
 };
 
-extern void stream_init_with_fd(io_driver_t* driver, stream_t* stream, int fd, uint8_t* rx_buf, int rx_buf_size, int tx_buf_size);
+extern int stream_init_with_fd(io_driver_t* driver, stream_t* stream, int fd, uint8_t* rx_buf, int rx_buf_size, int tx_buf_size);
 extern void stream_deinit(stream_t* stream);
 extern bool stream_write(stream_t* stream, uint8_t* data, int len);
+extern void stream_request_tx(stream_t* stream);
 
 #endif /* !__STREAM_DEF_H__ */
@@ -24,7 +24,10 @@ __tcp_server_watcher_callback(io_driver_watcher_t*  watcher, io_driver_event evt
 // public interfaces
 //
 ///////////////////////////////////////////////////////////////////////////////
-void
+/**
+ * @return 0 on success, -1 if sd can't be watched
+ */
+int
 tcp_server_init(io_driver_t* driver, tcp_server_t* server, int sd, tcp_server_rx_event cb)
 {
   server->sd            = sd;
@@ -36,7 +39,7 @@ tcp_server_init(io_driver_t* driver, tcp_server_t* server, int sd, tcp_server_rx
   server->watcher.fd = sd;
   server->watcher.callback = __tcp_server_watcher_callback;
 
-  io_driver_watch(server->driver, &server->watcher, IO_DRIVER_EVENT_RX);
+  return io_driver_watch(server->driver, &server->watcher, IO_DRIVER_EVENT_RX);
 }
 
 void
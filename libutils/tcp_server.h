@@ -50,7 +50,7 @@ struct __tcp_server
   io_driver_t*              driver;
 };
 
-extern void tcp_server_init(io_driver_t* driver, tcp_server_t* server, int sd, tcp_server_rx_event cb);
+extern int tcp_server_init(io_driver_t* driver, tcp_server_t* server, int sd, tcp_server_rx_event cb);
 extern void tcp_server_deinit(tcp_server_t* server);
 extern void tcp_server_start(tcp_server_t* server);
 extern void tcp_server_stop(tcp_server_t* server);
@@ -90,7 +90,11 @@ __init_tcp_server_ipv4(io_driver_t* driver, tcp_server_t* server, struct sockadd
     return -1;
   }
 
-  tcp_server_init(driver, server, sd, tcp_server_ipv4_rx_event);
+  if(tcp_server_init(driver, server, sd, tcp_server_ipv4_rx_event) != 0)
+  {
+    close(sd);
+    return -1;
+  }
   server->get_bound_addr    = tcp_server_ipv4_get_bound_addr;
 
   return 0;
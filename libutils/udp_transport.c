@@ -0,0 +1,372 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netinet/udp.h>
+
+#include "udp_transport.h"
+#include "sock_util.h"
+
+static const char* TAG = "udp_transport";
+
+#ifndef SOL_UDP
+#define SOL_UDP     IPPROTO_UDP
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// private utilities
+//
+////////////////////////////////////////////////////////////////////////////////
+static inline uint8_t*
+udp_transport_rx_buf(udp_transport_t* t, uint32_t ndx)
+{
+  return &t->pool[ndx * t->rx_buf_size];
+}
+
+static inline uint8_t*
+udp_transport_tx_buf(udp_transport_t* t, uint32_t ndx)
+{
+  return &t->pool[t->cfg.rx_batch * t->rx_buf_size + ndx * t->cfg.buf_size];
+}
+
+static void
+udp_transport_rx_reset(udp_transport_t* t)
+{
+  for(uint32_t i = 0; i < t->cfg.rx_batch; i++)
+  {
+    t->rx_msg[i].msg_hdr.msg_namelen    = sizeof(struct sockaddr_in);
+    t->rx_msg[i].msg_hdr.msg_controllen = t->gro || t->cfg.timestamp ? sizeof(t->rx_ctrl[i]) : 0;
+    t->rx_msg[i].msg_hdr.msg_flags      = 0;
+  }
+}
+
+/**
+ * GRO segment size of a coalesced buffer and the receive timestamp.
+ * 0 for whichever isn't there
+ */
+static void
+udp_transport_parse_cmsg(struct msghdr* hdr, uint32_t* seg, uint64_t* arrival_ns)
+{
+  struct cmsghdr*   cm;
+  struct timespec   ts;
+
+  *seg        = 0;
+  *arrival_ns = 0;
+
+  if(hdr->msg_controllen == 0)
+  {
+    return;
+  }
+
+  for(cm = CMSG_FIRSTHDR(hdr); cm != NULL; cm = CMSG_NXTHDR(hdr, cm))
+  {
+#ifdef UDP_GRO
+    if(cm->cmsg_level == SOL_UDP && cm->cmsg_type == UDP_GRO)
+    {
+      int   size;
+
+      memcpy(&size, CMSG_DATA(cm), sizeof(size));
+      *seg = size > 0 ? (uint32_t)size : 0;
+    }
+#endif
+    if(cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_TIMESTAMPNS)
+    {
+      memcpy(&ts, CMSG_DATA(cm), sizeof(ts));
+      *arrival_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+  }
+}
+
+static void
+udp_transport_deliver(udp_transport_t* t, uint32_t ndx)
+{
+  struct msghdr*  hdr = &t->rx_msg[ndx].msg_hdr;
+  uint8_t*        buf = udp_transport_rx_buf(t, ndx);
+  uint32_t        len = t->rx_msg[ndx].msg_len,
+                  seg;
+  uint64_t        arrival_ns;
+
+  if(hdr->msg_flags & MSG_TRUNC)
+  {
+    t->stats.rx_truncated++;
+    return;
+  }
+
+  udp_transport_parse_cmsg(hdr, &seg, &arrival_ns);
+
+  if(seg == 0 || seg >= len)
+  {
+    t->stats.rx_pkts++;
+    t->rx(t, buf, len, &t->rx_from[ndx], arrival_ns);
+    return;
+  }
+
+  // same flow datagrams back to back. only the last one can be short
+  t->stats.rx_gro++;
+  for(uint32_t off = 0; off < len; off += seg)
+  {
+    t->stats.rx_pkts++;
+    t->rx(t, &buf[off], MIN(seg, len - off), &t->rx_from[ndx], arrival_ns);
+  }
+}
+
+static void
+udp_transport_on_rx(io_driver_watcher_t* watcher, io_driver_event event)
+{
+  udp_transport_t*  t = container_of(watcher, udp_transport_t, watcher);
+  int               num;
+
+  do
+  {
+    udp_transport_rx_reset(t);
+
+    num = recvmmsg(watcher->fd, t->rx_msg, t->cfg.rx_batch, MSG_DONTWAIT, NULL);
+    if(num <= 0)
+    {
+      if(num < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+      {
+        LOGE(TAG, "recvmmsg failed %d\n", errno);
+      }
+      break;
+    }
+
+    t->stats.rx_calls++;
+
+    for(int i = 0; i < num; i++)
+    {
+      udp_transport_deliver(t, i);
+    }
+  } while((uint32_t)num == t->cfg.rx_batch);
+
+  // replies queued by rx handlers, like RTCP feedback
+  udp_transport_flush(t);
+}
+
+static void
+udp_transport_set_buf(int fd, int opt, int size, const char* name)
+{
+  if(size <= 0)
+  {
+    return;
+  }
+
+  if(setsockopt(fd, SOL_SOCKET, opt, &size, sizeof(size)) != 0)
+  {
+    LOGE(TAG, "failed to set %s to %d\n", name, size);
+  }
+}
+
+static uint8_t
+udp_transport_enable_gro(int fd)
+{
+#ifdef UDP_GRO
+  int   on = 1;
+
+  if(setsockopt(fd, SOL_UDP, UDP_GRO, &on, sizeof(on)) == 0)
+  {
+    return TRUE;
+  }
+#endif
+  LOGI(TAG, "UDP GRO not supported\n");
+  return FALSE;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////////////////////////
+void
+udp_transport_config_init(udp_transport_config_t* cfg)
+{
+  memset(cfg, 0, sizeof(*cfg));
+
+  cfg->bind_addr.sin_family = AF_INET;
+  cfg->rx_batch             = UDP_TRANSPORT_DEFAULT_BATCH;
+  cfg->tx_batch             = UDP_TRANSPORT_DEFAULT_BATCH;
+  cfg->buf_size             = UDP_TRANSPORT_DEFAULT_BUF_SIZE;
+}
+
+int
+udp_transport_init(io_driver_t* driver, udp_transport_t* t, const udp_transport_config_t* cfg,
+    udp_transport_rx_t rx)
+{
+  int   fd,
+        on = 1;
+
+  memset(t, 0, sizeof(*t));
+
+  t->driver = driver;
+  t->rx     = rx;
+  t->cfg    = *cfg;
+
+  if(t->cfg.rx_batch == 0 || t->cfg.rx_batch > UDP_TRANSPORT_BATCH_MAX)
+  {
+    t->cfg.rx_batch = t->cfg.rx_batch == 0 ? UDP_TRANSPORT_DEFAULT_BATCH : UDP_TRANSPORT_BATCH_MAX;
+  }
+  if(t->cfg.tx_batch == 0 || t->cfg.tx_batch > UDP_TRANSPORT_BATCH_MAX)
+  {
+    t->cfg.tx_batch = t->cfg.tx_batch == 0 ? UDP_TRANSPORT_DEFAULT_BATCH : UDP_TRANSPORT_BATCH_MAX;
+  }
+  if(t->cfg.buf_size == 0)
+  {
+    t->cfg.buf_size = UDP_TRANSPORT_DEFAULT_BUF_SIZE;
+  }
+
+  fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if(fd < 0)
+  {
+    LOGE(TAG, "socket() failed %d\n", errno);
+    return -1;
+  }
+
+  if(bind(fd, (struct sockaddr*)&t->cfg.bind_addr, sizeof(t->cfg.bind_addr)) != 0)
+  {
+    LOGE(TAG, "bind() failed %d\n", errno);
+    close(fd);
+    return -1;
+  }
+
+  sock_util_put_nonblock(fd);
+
+  udp_transport_set_buf(fd, SO_RCVBUF, t->cfg.rcvbuf, "SO_RCVBUF");
+  udp_transport_set_buf(fd, SO_SNDBUF, t->cfg.sndbuf, "SO_SNDBUF");
+
+  t->gro          = t->cfg.gro ? udp_transport_enable_gro(fd) : FALSE;
+
+  if(t->cfg.timestamp && setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on)) != 0)
+  {
+    LOGE(TAG, "SO_TIMESTAMPNS not supported\n");
+    t->cfg.timestamp = FALSE;
+  }
+  t->rx_buf_size  = t->gro ? UDP_TRANSPORT_GRO_BUF_SIZE : t->cfg.buf_size;
+
+  t->pool = malloc(t->cfg.rx_batch * t->rx_buf_size + t->cfg.tx_batch * t->cfg.buf_size);
+  if(t->pool == NULL)
+  {
+    LOGE(TAG, "malloc failed\n");
+    close(fd);
+    return -1;
+  }
+
+  for(uint32_t i = 0; i < t->cfg.rx_batch; i++)
+  {
+    t->rx_iov[i].iov_base = udp_transport_rx_buf(t, i);
+    t->rx_iov[i].iov_len  = t->rx_buf_size;
+
+    t->rx_msg[i].msg_hdr.msg_name     = &t->rx_from[i];
+    t->rx_msg[i].msg_hdr.msg_iov      = &t->rx_iov[i];
+    t->rx_msg[i].msg_hdr.msg_iovlen   = 1;
+    t->rx_msg[i].msg_hdr.msg_control  = t->rx_ctrl[i];
+  }
+
+  for(uint32_t i = 0; i < t->cfg.tx_batch; i++)
+  {
+    t->tx_iov[i].iov_base = udp_transport_tx_buf(t, i);
+
+    t->tx_msg[i].msg_hdr.msg_name     = &t->tx_to[i];
+    t->tx_msg[i].msg_hdr.msg_namelen  = sizeof(struct sockaddr_in);
+    t->tx_msg[i].msg_hdr.msg_iov      = &t->tx_iov[i];
+    t->tx_msg[i].msg_hdr.msg_iovlen   = 1;
+  }
+
+  io_driver_watcher_init(&t->watcher);
+  t->watcher.fd       = fd;
+  t->watcher.callback = udp_transport_on_rx;
+
+  if(io_driver_watch(driver, &t->watcher, IO_DRIVER_EVENT_RX) != 0)
+  {
+    free(t->pool);
+    t->pool = NULL;
+    close(fd);
+    return -1;
+  }
+  return 0;
+}
+
+void
+udp_transport_deinit(udp_transport_t* t)
+{
+  udp_transport_flush(t);
+
+  io_driver_no_watch(t->driver, &t->watcher, IO_DRIVER_EVENT_RX);
+  close(t->watcher.fd);
+
+  free(t->pool);
+  t->pool = NULL;
+}
+
+/**
+ * queues a packet. goes out when tx_batch packets are queued
+ *
+ * @return 0 on success, -1 if packet is larger than buf_size
+ */
+int
+udp_transport_send(udp_transport_t* t, const uint8_t* pkt, uint32_t len, const struct sockaddr_in* to)
+{
+  uint32_t  ndx = t->tx_pending;
+
+  if(len > t->cfg.buf_size)
+  {
+    t->stats.tx_dropped++;
+    return -1;
+  }
+
+  memcpy(t->tx_iov[ndx].iov_base, pkt, len);
+  t->tx_iov[ndx].iov_len = len;
+  t->tx_to[ndx]          = *to;
+
+  t->tx_pending++;
+  if(t->tx_pending >= t->cfg.tx_batch)
+  {
+    udp_transport_flush(t);
+  }
+  return 0;
+}
+
+void
+udp_transport_flush(udp_transport_t* t)
+{
+  uint32_t  sent = 0;
+  int       ret;
+
+  while(sent < t->tx_pending)
+  {
+    ret = sendmmsg(t->watcher.fd, &t->tx_msg[sent], t->tx_pending - sent, 0);
+    if(ret == 0)
+    {
+      // nothing went out and errno is not ours to look at
+      t->stats.tx_dropped += t->tx_pending - sent;
+      break;
+    }
+
+    if(ret < 0)
+    {
+      if(errno == EINTR)
+      {
+        continue;
+      }
+
+      if(errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        // socket buffer full. late RTP is no better than lost RTP
+        t->stats.tx_dropped += t->tx_pending - sent;
+        break;
+      }
+
+      // this one is bad. keep going with the rest
+      LOGE(TAG, "sendmmsg failed %d\n", errno);
+      t->stats.tx_dropped++;
+      sent++;
+      continue;
+    }
+
+    t->stats.tx_calls++;
+    t->stats.tx_pkts += ret;
+    sent += ret;
+  }
+
+  t->tx_pending = 0;
+}
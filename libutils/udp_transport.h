@@ -0,0 +1,96 @@
+#ifndef __UDP_TRANSPORT_DEF_H__
+#define __UDP_TRANSPORT_DEF_H__
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+
+#include "common_def.h"
+#include "io_driver.h"
+
+//
+// a UDP socket on io_driver for RTP/RTCP.
+//
+// RX drains the socket with recvmmsg into a buffer pool allocated once
+// at init, batch datagrams per call, until it would block. with GRO the
+// kernel may coalesce same flow datagrams into one buffer and they are
+// split back into segments here, so user always sees one datagram per
+// callback. truncated datagrams are counted and dropped, never handed
+// up half. with timestamp set, each datagram comes with the kernel
+// receive time from SO_TIMESTAMPNS, CLOCK_REALTIME in ns. 0 if none.
+//
+// TX copies into the pool and goes out with sendmmsg once batch
+// packets are queued, at the end of an RX drain, or on
+// udp_transport_flush(). tx_batch 1 sends right away.
+//
+// struct mmsghdr needs _GNU_SOURCE defined before any system header
+//
+#define UDP_TRANSPORT_BATCH_MAX             64
+#define UDP_TRANSPORT_DEFAULT_BATCH         16
+#define UDP_TRANSPORT_DEFAULT_BUF_SIZE      2048
+#define UDP_TRANSPORT_GRO_BUF_SIZE          65535
+
+struct __udp_transport;
+typedef struct __udp_transport udp_transport_t;
+
+typedef void (*udp_transport_rx_t)(udp_transport_t* t, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns);
+
+typedef struct
+{
+  struct sockaddr_in    bind_addr;
+  uint32_t              rx_batch;       // datagrams per recvmmsg. 0 for default
+  uint32_t              tx_batch;       // packets per sendmmsg. 0 for default
+  uint32_t              buf_size;       // largest datagram. 0 for default
+  int                   rcvbuf;         // SO_RCVBUF. 0 keeps kernel default
+  int                   sndbuf;         // SO_SNDBUF. 0 keeps kernel default
+  uint8_t               gro;            // ask for UDP GRO. ignored where unsupported
+  uint8_t               timestamp;      // kernel receive timestamps
+} udp_transport_config_t;
+
+typedef struct
+{
+  uint64_t    rx_pkts;
+  uint64_t    rx_calls;         // recvmmsg calls that returned data
+  uint64_t    rx_gro;           // coalesced buffers split
+  uint64_t    rx_truncated;
+  uint64_t    tx_pkts;
+  uint64_t    tx_calls;
+  uint64_t    tx_dropped;       // too big or send failed
+} udp_transport_stats_t;
+
+struct __udp_transport
+{
+  io_driver_t*            driver;
+  io_driver_watcher_t     watcher;
+  udp_transport_config_t  cfg;
+  uint8_t                 gro;          // GRO actually on
+  uint32_t                rx_buf_size;
+
+  udp_transport_rx_t      rx;
+  void*                   priv;         // for user
+
+  uint8_t*                pool;         // rx_batch rx buffers then tx_batch tx buffers
+
+  struct mmsghdr          rx_msg[UDP_TRANSPORT_BATCH_MAX];
+  struct iovec            rx_iov[UDP_TRANSPORT_BATCH_MAX];
+  struct sockaddr_in      rx_from[UDP_TRANSPORT_BATCH_MAX];
+  uint8_t                 rx_ctrl[UDP_TRANSPORT_BATCH_MAX][64];
+
+  struct mmsghdr          tx_msg[UDP_TRANSPORT_BATCH_MAX];
+  struct iovec            tx_iov[UDP_TRANSPORT_BATCH_MAX];
+  struct sockaddr_in      tx_to[UDP_TRANSPORT_BATCH_MAX];
+  uint32_t                tx_pending;
+
+  udp_transport_stats_t   stats;
+};
+
+extern void udp_transport_config_init(udp_transport_config_t* cfg);
+extern int udp_transport_init(io_driver_t* driver, udp_transport_t* t, const udp_transport_config_t* cfg,
+    udp_transport_rx_t rx);
+extern void udp_transport_deinit(udp_transport_t* t);
+extern int udp_transport_send(udp_transport_t* t, const uint8_t* pkt, uint32_t len, const struct sockaddr_in* to);
+extern void udp_transport_flush(udp_transport_t* t);
+
+#endif /* !__UDP_TRANSPORT_DEF_H__ */
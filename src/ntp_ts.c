@@ -14,6 +14,13 @@ ntp_ts_from_unix_time(ntp_ts_t* nt, struct timeval* ut)
   nt->fraction  = (uint32_t)( (double)(ut->tv_usec+1) * (double)(1LL<<32) * 1.0e-6 );
 }
 
+void
+ntp_ts_from_timespec(ntp_ts_t* nt, const struct timespec* ts)
+{
+  nt->second    = ts->tv_sec + 0x83AA7E80;
+  nt->fraction  = (uint32_t)(((uint64_t)ts->tv_nsec << 32) / 1000000000ULL);
+}
+
 void
 ntp_ts_now(ntp_ts_t* nt)
 {
@@ -11,6 +11,7 @@ typedef struct
 
 extern void ntp_ts_to_unix_time(ntp_ts_t* nt, struct timeval* ut);
 extern void ntp_ts_from_unix_time(ntp_ts_t* nt, struct timeval* ut);
+extern void ntp_ts_from_timespec(ntp_ts_t* nt, const struct timespec* ts);
 extern void ntp_ts_now(ntp_ts_t* nt);
 extern double ntp_ts_diff_in_sec(ntp_ts_t* a, ntp_ts_t* b);
 
@@ -21,4 +22,13 @@ ntp_ts_init(ntp_ts_t* nt)
   nt->fraction    = 0;
 }
 
+//
+// middle 32 bits. the compact form used for LSR and RTT in RTCP
+//
+static inline uint32_t
+ntp_ts_middle32(const ntp_ts_t* nt)
+{
+  return nt->second << 16 | nt->fraction >> 16;
+}
+
 #endif /* !__NTP_TS_DEF_H__ */
@@ -172,6 +172,21 @@ typedef struct {
   } r;
 } rtcp_t;
 
+//
+// RFC 3550 6.2. RTCP packet sizes for the interval include the lower
+// layer headers. IPv4 + UDP assumed
+//
+#define RTCP_IP_UDP_OVERHEAD        28
+
+//
+// encoded sizes. SR header includes the sender info
+//
+#define RTCP_SR_HDR_SIZE            28
+#define RTCP_RR_HDR_SIZE            8
+#define RTCP_REPORT_BLOCK_SIZE      24
+#define RTCP_SDES_HDR_SIZE          4
+#define RTCP_SDES_CNAME_CHUNK_SIZE(len)   ((4 + 2 + (len) + 1 + 3) & ~3)
+
 typedef struct
 {
   double      tp;           // the last time an RTCP packet was transmitted
@@ -179,10 +194,13 @@ typedef struct
   uint32_t    pmembers;     // the estimated number of session members at the time tn was last recomputed
   uint32_t    members;      // the most current estimate for the number of session members
   uint32_t    senders;      // the most current estimate for the number of senders in the session
-  double      rtcp_bw;      // the target RTCP bandwidth
+  double      rtcp_bw;      // the target RTCP bandwidth in octets/sec
   double      avg_rtcp_size;
+  double      avg_rsize_rtcp_size;  // reduced-size packets. RFC 5506. kept out of avg_rtcp_size
+  double      rsize_share;          // fraction of packets that are reduced-size, averaged like the sizes
   uint8_t     we_sent;
   uint8_t     initial;
+  uint32_t    member_timeout; // ms. M * Td of 6.3.5, refreshed with the interval
 } rtcp_control_var_t;
 
 typedef struct rtcp_sdes rtcp_sdes_t;
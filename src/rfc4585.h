@@ -0,0 +1,64 @@
+#ifndef __RFC4585_DEF_H__
+#define __RFC4585_DEF_H__
+
+#include "common_inc.h"
+#include "rfc3550.h"
+
+/*
+ * RTCP feedback packet types (RFC 4585 6.1)
+ */
+#define RTCP_RTPFB                        205       /* transport layer feedback   */
+#define RTCP_PSFB                         206       /* payload specific feedback  */
+
+/*
+ * feedback message types (FMT) carried in the count field
+ */
+#define RTCP_RTPFB_FMT_NACK               1         /* generic NACK, RFC 4585 6.2.1     */
+#define RTCP_PSFB_FMT_PLI                 1         /* picture loss indication, 6.3.1   */
+#define RTCP_PSFB_FMT_FIR                 4         /* full intra request, RFC 5104     */
+
+/*
+ * common packet format for feedback messages
+ */
+typedef struct {
+  rtcp_common_t common;     /* common header. count is FMT */
+  uint32_t sender_ssrc;     /* SSRC of packet sender */
+  uint32_t media_ssrc;      /* SSRC of media source */
+  uint32_t fci[1];          /* feedback control information */
+} rtcp_fb_t;
+
+/*
+ * generic NACK FCI
+ */
+typedef struct {
+  uint16_t pid;             /* packet ID of the lost packet */
+  uint16_t blp;             /* bitmask of following lost packets */
+} rtcp_fb_nack_t;
+
+/*
+ * FIR FCI
+ */
+typedef struct {
+  uint32_t ssrc;            /* SSRC of the media sender requested to send a decoder refresh */
+  uint8_t  seq;             /* command sequence number */
+  uint8_t  reserved[3];
+} rtcp_fb_fir_t;
+
+#define RTCP_FB_HDR_SIZE                  12
+#define RTCP_FB_NACK_SIZE                 4
+#define RTCP_FB_FIR_SIZE                  8
+
+/*
+ * AVPF timing rules state (RFC 4585 3.5)
+ */
+typedef struct
+{
+  double      t_rr_interval;          // minimal interval between regular RTCP packets
+  double      t_rr_current_interval;  // randomized T_rr_interval currently in effect
+  double      t_rr_last;              // the last time a regular RTCP packet was transmitted
+  double      t_rr;                   // the last calculated regular RTCP interval
+  double      te;                     // the scheduled transmission time of early RTCP packet
+  uint8_t     allow_early;
+} rtcp_avpf_var_t;
+
+#endif /* !__RFC4585_DEF_H__ */
@@ -0,0 +1,26 @@
+#ifndef __RFC5761_DEF_H__
+#define __RFC5761_DEF_H__
+
+#include "common_inc.h"
+
+/*
+ * RTP and RTCP multiplexed on a single port (RFC 5761 4)
+ *
+ * a packet is RTCP if the second octet, that is M bit + RTP payload type
+ * or RTCP packet type, is in the range below.
+ * RTP payload types 64-95 must not be used with rtcp-mux.
+ */
+#define RTCP_MUX_PT_MIN                   192
+#define RTCP_MUX_PT_MAX                   223
+
+static inline uint8_t
+rtcp_mux_is_rtcp(const uint8_t* pkt, uint32_t len)
+{
+  if(len < 2)
+  {
+    return RTP_FALSE;
+  }
+  return (pkt[1] >= RTCP_MUX_PT_MIN && pkt[1] <= RTCP_MUX_PT_MAX) ? RTP_TRUE : RTP_FALSE;
+}
+
+#endif /* !__RFC5761_DEF_H__ */
@@ -4,6 +4,20 @@
 #include "rtp_timers.h"
 #include "rtp_session_util.h"
 #include "rtcp_encoder.h"
+#include "rtcp_reader.h"
+#include "rtp_bundle.h"
+
+#define RTCP_MAX_REPORT_BLOCKS            31
+
+//
+// RFC 3550 6.2. RTCP gets 5% of the session bandwidth
+//
+#define RTCP_BW_FRACTION                  0.05
+
+//
+// RFC 3550 6.3.5 timeout multiplier M
+//
+#define RTCP_MEMBER_TIMEOUT_MULTIPLIER    5
 
 #define RTCP_INTERVAL_FLAGS_MEMBER        0x01
 #define RTCP_INTERVAL_FLAGS_SENDER        0x02
@@ -12,10 +26,16 @@
 #define RTCP_EVENT_RX_BYE                 0x02
 #define RTCP_EVENT_TIMEOUT                0x04
 
+//
+// RFC 4585 3.4 & 3.5.2
+//
+#define RTCP_AVPF_INITIAL_MIN_TIME        1.0
+#define RTCP_AVPF_DITHER_L                0.5
+
 static const char* TAG = "rtcp";
 
-static inline double rtcp_interval_calc(rtcp_control_var_t* cvar);
-static uint32_t rtcp_send_report(rtp_session_t* sess);
+static inline double rtcp_interval_calc(rtp_session_t* sess);
+static uint32_t rtcp_send_feedback(rtp_session_t* sess);
 
 ////////////////////////////////////////////////////////////
 //
@@ -48,59 +68,73 @@ rtcp_current_time(rtp_session_t* sess)
 
 ////////////////////////////////////////////////////////////
 //
-// RTCP packet check
+// bundle. sessions sharing one transport and RTCP scheduler
 //
 ////////////////////////////////////////////////////////////
-static inline uint8_t
-rtcp_check_pkt(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+static inline rtp_session_t*
+rtcp_scheduler(rtp_session_t* sess)
 {
-  uint32_t    len_4 = len / 4;
-  rtcp_t      *r,
-              *end;
+  return sess->bundle == NULL ? sess : rtp_bundle_primary(sess->bundle);
+}
 
-  if(len < sizeof(rtcp_common_t))
+static inline rtp_session_t**
+rtcp_report_sessions(rtp_session_t* sess, rtp_session_t** single, uint32_t* num)
+{
+  if(sess->bundle == NULL)
   {
-    RTPLOGE(TAG, "packet is smaller than minimum header: %u\n", len);
-    sess->last_rtcp_error = rtcp_rx_error_header_too_short;
-    return RTP_FALSE;
+    single[0] = sess;
+    *num      = 1;
+    return single;
   }
 
-  if((len % 4) != 0)
-  {
-    RTPLOGE(TAG, "len is not multiple of 4: %u\n", len);
-    sess->last_rtcp_error = rtcp_rx_error_len_not_multiple_4;
-    return RTP_FALSE;
-  }
+  *num = sess->bundle->num_sessions;
+  return sess->bundle->sessions;
+}
+
+static inline uint8_t
+rtcp_fb_pending(rtp_session_t* sess)
+{
+  rtp_session_t*    single[1];
+  rtp_session_t**   sessions;
+  uint32_t          num;
 
-  r = (rtcp_t*)pkt;
+  sessions = rtcp_report_sessions(sess, single, &num);
 
-  if ((*(uint16_t *)r & RTCP_VALID_MASK) != RTCP_VALID_VALUE)
+  for(uint32_t i = 0; i < num; i++)
   {
-    RTPLOGE(TAG, "invalid header for the first rtcp packet %u\n", *(uint16_t *)r);
-    sess->last_rtcp_error = rtcp_rx_error_invalid_mask;
-    return RTP_FALSE;
+    if(rtcp_fb_queue_is_empty(&sessions[i]->fb_queue) == RTP_FALSE)
+    {
+      return RTP_TRUE;
+    }
   }
+  return RTP_FALSE;
+}
 
-  end = (rtcp_t *)((uint32_t*)r + len_4);
+/**
+ * find the session an incoming SSRC belongs to.
+ * unknown SSRCs are routed by report blocks addressed to us
+ * and the rest goes to the session the packet was received on
+ */
+static inline rtp_session_t*
+rtcp_route(rtp_session_t* sess, uint32_t ssrc, const rtcp_pkt_view_t* report)
+{
+  rtp_session_t*  s;
+  rtcp_rr_info_t  rr;
 
-  do
+  if(sess->bundle == NULL)
   {
-    // RTPLOGI(TAG, "compound pkt: len: %u\n", ntohs(r->common.length));
-    r = (rtcp_t *)((uint32_t *)r + ntohs(r->common.length) + 1);
+    return sess;
   }
-  while (r < end && r->common.version == 2);
 
-  if (r != end) {
-    sess->last_rtcp_error = rtcp_rx_error_invalid_compound_packet;
-    RTPLOGE(TAG, "invalid compound packet\n");
-    return 0;
-  }
+  s = rtp_bundle_route(sess->bundle, ssrc);
 
-  // RTPLOGI(TAG, "rtcp pkt validation pass\n");
-
-  sess->last_rtcp_error = rtcp_rx_error_no_error;
+  for(uint8_t i = 0; s == NULL && report != NULL && i < report->count; i++)
+  {
+    rtcp_view_report_block(report, i, &rr);
+    s = rtp_bundle_route(sess->bundle, rr.ssrc);
+  }
 
-  return RTP_TRUE;
+  return s != NULL ? s : sess;
 }
 
 ////////////////////////////////////////////////////////////
@@ -128,10 +162,14 @@ rtcp_interval_cal_delta_in_ms(double tc, double tn)
 static inline void
 rtcp_interval_schedule(rtp_session_t* sess, double tc, double tn)
 {
+  uint32_t delta = rtcp_interval_cal_delta_in_ms(tc, tn);
+
   sess->rtcp_var.tn = tn;
 
+  RTP_PROBE3(rtcp_schedule, sess, delta, 0);
+
   // RTPLOGI(TAG, "rtcp_interval_schedule %.2f %.2f\n", tc, tn);
-  soft_timer_add(&sess->soft_timer, &sess->rtcp_timer, rtcp_interval_cal_delta_in_ms(tc, tn));
+  soft_timer_add(&sess->soft_timer, &sess->rtcp_timer, delta);
 }
 
 static inline void
@@ -143,12 +181,204 @@ rtcp_interval_stop_timer(rtp_session_t* sess)
 static inline void
 rtcp_interval_reschedule(rtp_session_t* sess, double tc, double tn)
 {
+  uint32_t delta = rtcp_interval_cal_delta_in_ms(tc, tn);
+
   sess->rtcp_var.tn = tn;
 
-  RTPLOGI(TAG, "rtcp_interval_reschedule %.2f %.2f\n", tc, tn);
+  rtp_session_trace(sess, rtp_trace_ev_rtcp_reschedule, (uint32_t)(tc * 1000), (uint32_t)(tn * 1000));
+  RTP_PROBE3(rtcp_schedule, sess, delta, 1);
 
   soft_timer_del(&sess->soft_timer, &sess->rtcp_timer);
-  soft_timer_add(&sess->soft_timer, &sess->rtcp_timer, rtcp_interval_cal_delta_in_ms(tc, tn));
+  soft_timer_add(&sess->soft_timer, &sess->rtcp_timer, delta);
+}
+
+static inline void
+rtcp_interval_update_avg_size(rtp_session_t* sess, uint32_t pkt_size, uint8_t rsize)
+{
+  rtcp_control_var_t* cvar = &sess->rtcp_var;
+
+  pkt_size += RTCP_IP_UDP_OVERHEAD;
+
+  //
+  // reduced-size packets are much smaller than compound ones.
+  // each kind keeps its own average and rtcp_interval_avg_size
+  // weights them by how often each is seen
+  //
+  cvar->rsize_share = (1./16.) * (rsize == RTP_TRUE ? 1. : 0.) + (15./16.)*(cvar->rsize_share);
+
+  if(rsize == RTP_TRUE)
+  {
+    if(cvar->avg_rsize_rtcp_size == 0)
+    {
+      // no reduced-size packet yet. don't average against zero
+      cvar->avg_rsize_rtcp_size = pkt_size;
+      return;
+    }
+    cvar->avg_rsize_rtcp_size = (1./16.) * pkt_size + (15./16.)*(cvar->avg_rsize_rtcp_size);
+    return;
+  }
+
+  cvar->avg_rtcp_size = (1./16.) * pkt_size + (15./16.)*(cvar->avg_rtcp_size);
+}
+
+/**
+ * RFC 5506 5. avg_rtcp_size covers every RTCP packet, compound
+ * or reduced-size, sent and received
+ */
+static inline double
+rtcp_interval_avg_size(rtcp_control_var_t* cvar)
+{
+  return (1. - cvar->rsize_share) * cvar->avg_rtcp_size +
+         cvar->rsize_share * cvar->avg_rsize_rtcp_size;
+}
+
+////////////////////////////////////////////////////////////
+//
+// RTP/AVPF early feedback. RFC 4585 3.5
+//
+////////////////////////////////////////////////////////////
+static uint8_t
+rtcp_avpf_regular_allowed(rtp_session_t* sess, double tc)
+{
+  //
+  // a regular RTCP packet is suppressed if T_rr_interval has not
+  // passed since the last one and there is no feedback to send.
+  //
+  rtcp_avpf_var_t*  avpf = &sess->avpf_var;
+
+  if(sess->config.avpf == RTP_FALSE || avpf->t_rr_interval == 0)
+  {
+    return RTP_TRUE;
+  }
+
+  if(rtcp_fb_pending(sess) == RTP_FALSE &&
+     avpf->t_rr_last + avpf->t_rr_current_interval > tc)
+  {
+    return RTP_FALSE;
+  }
+
+  avpf->t_rr_last             = tc;
+  avpf->t_rr_current_interval = avpf->t_rr_interval * (drand48() + 0.5);
+
+  return RTP_TRUE;
+}
+
+static void
+rtcp_avpf_send_early(rtp_session_t* sess, double tc)
+{
+  rtcp_control_var_t* cvar = &sess->rtcp_var;
+  rtcp_avpf_var_t*    avpf = &sess->avpf_var;
+  double              tn;
+
+  if(rtcp_fb_pending(sess) == RTP_FALSE)
+  {
+    // already flushed by a regular RTCP packet
+    return;
+  }
+
+  //
+  // RFC 5506. if negotiated, early packets carry feedback only
+  //
+  if(sess->config.rtcp_rsize == RTP_TRUE)
+  {
+    rtcp_interval_update_avg_size(sess, rtcp_send_feedback(sess), RTP_TRUE);
+  }
+  else
+  {
+    rtcp_interval_update_avg_size(sess, rtcp_send_report(sess), RTP_FALSE);
+  }
+
+  //
+  // only one early packet is allowed per regular interval and
+  // the next regular packet is pushed out to tp + 2 * T_rr
+  // to keep the average RTCP bandwidth
+  //
+  avpf->allow_early = RTP_FALSE;
+
+  tn = cvar->tp + 2 * avpf->t_rr;
+  if(tn < cvar->tn)
+  {
+    tn = cvar->tn;
+  }
+
+  rtcp_interval_reschedule(sess, tc, tn);
+}
+
+static void
+__rtcp_early_timeout(SoftTimerElem* te)
+{
+  rtp_session_t*      sess = container_of(te, rtp_session_t, rtcp_early_timer);
+
+  RTP_PROBE2(rtcp_timeout, sess, 1);
+
+  rtcp_avpf_send_early(sess, rtcp_current_time(sess));
+}
+
+static void
+rtcp_avpf_request_early(rtp_session_t* sess)
+{
+  rtcp_control_var_t* cvar = &sess->rtcp_var;
+  rtcp_avpf_var_t*    avpf = &sess->avpf_var;
+  double              tc = rtcp_current_time(sess);
+  double              t_dither_max;
+
+  if(sess->config.avpf == RTP_FALSE)
+  {
+    // with AVP, feedback goes with regular RTCP packets only
+    return;
+  }
+
+  if(avpf->allow_early == RTP_FALSE || is_soft_timer_running(&sess->rtcp_early_timer))
+  {
+    // either already scheduled or has to wait for the next regular packet
+    return;
+  }
+
+  //
+  // no dithering is necessary for point to point sessions
+  //
+  if(cvar->members <= 2)
+  {
+    t_dither_max = 0;
+  }
+  else
+  {
+    t_dither_max = RTCP_AVPF_DITHER_L * avpf->t_rr;
+  }
+
+  if(tc + t_dither_max > cvar->tn)
+  {
+    // the next regular packet will be sent earlier anyway
+    return;
+  }
+
+  if(t_dither_max == 0)
+  {
+    avpf->te = tc;
+    rtcp_avpf_send_early(sess, tc);
+    return;
+  }
+
+  avpf->te = tc + drand48() * t_dither_max;
+  soft_timer_add(&sess->soft_timer, &sess->rtcp_early_timer, rtcp_interval_cal_delta_in_ms(tc, avpf->te));
+}
+
+/**
+ * tn was just recomputed. for a bundle, for all the sessions in it
+ */
+static inline void
+rtcp_interval_sync_pmembers(rtp_session_t* sess)
+{
+  rtp_session_t*    single[1];
+  rtp_session_t**   sessions;
+  uint32_t          num;
+
+  sessions = rtcp_report_sessions(sess, single, &num);
+
+  for(uint32_t i = 0; i < num; i++)
+  {
+    sessions[i]->rtcp_var.pmembers = sessions[i]->rtcp_var.members;
+  }
 }
 
 static void
@@ -164,9 +394,10 @@ __rtcp_interval_timeout(SoftTimerElem* te)
   rtcp_control_var_t* cvar = &sess->rtcp_var;
   double              t;     /* Interval */
   double              tn;    /* Next transmit time */
-  double              pkt_size;
   double              tc = rtcp_current_time(sess);
 
+  RTP_PROBE2(rtcp_timeout, sess, 0);
+
   // RTPLOGI(TAG, "__rtcp_interval_timeout\n");
 
    /* In the case of a BYE, we use "timer reconsideration" to
@@ -174,7 +405,7 @@ __rtcp_interval_timeout(SoftTimerElem* te)
   // FIXME : we don't support TX BYE timeout at the moment
   if(0)
   {
-    t   = rtcp_interval_calc(cvar);
+    t   = rtcp_interval_calc(sess);
     tn  = cvar->tp + t;
 
     if(tn <= tc)
@@ -190,16 +421,23 @@ __rtcp_interval_timeout(SoftTimerElem* te)
   }
   else
   {
-    t = rtcp_interval_calc(cvar);
+    t = rtcp_interval_calc(sess);
     tn = cvar->tp + t;
 
     // RTPLOGI(TAG, "XXX tn = %f, tc = %f\n", tn, tc);
 
     if(tn <= tc)
     {
-      pkt_size = rtcp_send_report(sess);
+      if(rtcp_avpf_regular_allowed(sess, tc) == RTP_TRUE)
+      {
+        rtcp_interval_update_avg_size(sess, rtcp_send_report(sess), RTP_FALSE);
 
-      cvar->avg_rtcp_size = (1./16.) * pkt_size + (15./16.)*(cvar->avg_rtcp_size);
+        if(rtcp_fb_pending(sess) == RTP_FALSE)
+        {
+          // pending feedback went out with this one
+          soft_timer_del(&sess->soft_timer, &sess->rtcp_early_timer);
+        }
+      }
       cvar->tp = tc;
 
       // we must redraw the interval. Don't reuse the
@@ -207,11 +445,14 @@ __rtcp_interval_timeout(SoftTimerElem* te)
       // distributed the same, as we are conditioned
       // on it being small enough to cause a packet to
       // be sent.
-      t = rtcp_interval_calc(cvar);
+      t = rtcp_interval_calc(sess);
 
       rtcp_interval_schedule(sess, tc, t + tc);
 
       cvar->initial = RTP_FALSE;
+
+      sess->avpf_var.t_rr         = t;
+      sess->avpf_var.allow_early  = RTP_TRUE;
     }
     else
     {
@@ -219,6 +460,8 @@ __rtcp_interval_timeout(SoftTimerElem* te)
       rtcp_interval_schedule(sess, tc, tn);
     }
   }
+
+  rtcp_interval_sync_pmembers(sess);
 }
 
 ////////////////////////////////////////////////////////////
@@ -226,8 +469,83 @@ __rtcp_interval_timeout(SoftTimerElem* te)
 // RTCP interval calculation
 //
 ////////////////////////////////////////////////////////////
+/**
+ * a bundle is scheduled as one participant with the members,
+ * senders and bandwidth of all the sessions in it
+ */
+static inline rtcp_control_var_t*
+rtcp_interval_cvar(rtp_session_t* sess, rtcp_control_var_t* bundle_var)
+{
+  rtp_session_t*  s;
+
+  if(sess->bundle == NULL)
+  {
+    return &sess->rtcp_var;
+  }
+
+  memcpy(bundle_var, &sess->rtcp_var, sizeof(rtcp_control_var_t));
+
+  bundle_var->members  = 0;
+  bundle_var->pmembers = 0;
+  bundle_var->senders  = 0;
+  bundle_var->rtcp_bw  = 0;
+
+  for(uint32_t i = 0; i < sess->bundle->num_sessions; i++)
+  {
+    s = sess->bundle->sessions[i];
+
+    bundle_var->members  += s->rtcp_var.members;
+    bundle_var->pmembers += s->rtcp_var.pmembers;
+    bundle_var->senders += s->rtcp_var.senders;
+    bundle_var->rtcp_bw += s->rtcp_var.rtcp_bw;
+    bundle_var->we_sent |= s->rtcp_var.we_sent;
+  }
+  return bundle_var;
+}
+
+/**
+ * RFC 3550 6.3.5. a member is timed out after M * Td, Td being the
+ * deterministic interval of a receiver. RTP_CONFIG_MEMBER_TIMEOUT
+ * stands in for the 5 second minimum of Td so small sessions keep it
+ */
+static inline void
+rtcp_interval_update_member_timeout(rtp_session_t* sess, rtcp_control_var_t* cvar)
+{
+  double    rtcp_bw = cvar->rtcp_bw,
+            td;
+  uint32_t  n = cvar->members,
+            timeout = RTP_CONFIG_MEMBER_TIMEOUT;
+
+  // receiver share, same split as rtcp_interval_calc
+  if(cvar->senders <= cvar->members * 0.25)
+  {
+    rtcp_bw *= 0.75;
+    n -= cvar->senders;
+  }
+
+  if(rtcp_bw > 0)
+  {
+    td = rtcp_interval_avg_size(cvar) * n / rtcp_bw;
+    if(td * RTCP_MEMBER_TIMEOUT_MULTIPLIER * 1000 > timeout)
+    {
+      timeout = (uint32_t)(td * RTCP_MEMBER_TIMEOUT_MULTIPLIER * 1000);
+    }
+  }
+
+  if(sess->bundle == NULL)
+  {
+    sess->rtcp_var.member_timeout = timeout;
+    return;
+  }
+
+  for(uint32_t i = 0; i < sess->bundle->num_sessions; i++)
+  {
+    sess->bundle->sessions[i]->rtcp_var.member_timeout = timeout;
+  }
+}
+
 static inline double
-rtcp_interval_calc(rtcp_control_var_t* cvar)
+rtcp_interval_calc(rtp_session_t* sess)
 {
   // RFC 3550, A.7 Computing the RTCP Transmission Interval
 
@@ -256,6 +574,8 @@ rtcp_interval_calc(rtcp_control_var_t* cvar)
    */
   double const COMPENSATION = 2.71828 - 1.5;
 
+  rtcp_control_var_t  bundle_var;
+  rtcp_control_var_t* cvar = rtcp_interval_cvar(sess, &bundle_var);
   double t;                   /* interval */
   double rtcp_min_time = RTCP_MIN_TIME;
   int n;                      /* no. of members for computation */
@@ -275,6 +595,15 @@ rtcp_interval_calc(rtcp_control_var_t* cvar)
     rtcp_min_time /= 2;
   }
 
+  /*
+   * RFC 4585 3.4, AVPF drops the 5 second minimum.
+   * Tmin is 1 second for the initial packet and 0 afterwards.
+   */
+  if(sess->config.avpf == RTP_TRUE)
+  {
+    rtcp_min_time = cvar->initial == RTP_TRUE ? RTCP_AVPF_INITIAL_MIN_TIME : 0;
+  }
+
   /*
    * Dedicate a fraction of the RTCP bandwidth to senders unless
    * the number of senders is large enough that their share is
@@ -306,12 +635,14 @@ rtcp_interval_calc(rtcp_control_var_t* cvar)
    * time interval we send one report so this time is also our
    * average time between reports.
    */
-  t = cvar->avg_rtcp_size * n / rtcp_bw;
+  t = rtcp_interval_avg_size(cvar) * n / rtcp_bw;
   if(t < rtcp_min_time)
   {
     t = rtcp_min_time;
   }
 
+  rtcp_interval_update_member_timeout(sess, cvar);
+
   /*
    * To avoid traffic bursts from unintended synchronization with
    * other sites, we then pick our actual next report interval as a
@@ -326,6 +657,7 @@ static inline void
 rtcp_interval_control_var_init(rtp_session_t* sess)
 {
   rtcp_control_var_t* cvar = &sess->rtcp_var;
+  rtcp_avpf_var_t*    avpf = &sess->avpf_var;
   //
   // RFC 3550, 6.3.2 Initialization
   //
@@ -335,8 +667,21 @@ rtcp_interval_control_var_init(rtp_session_t* sess)
   cvar->members         = 1;
   cvar->we_sent         = RTP_FALSE;
   cvar->initial         = RTP_TRUE;
-  cvar->rtcp_bw         = sess->config.session_bw;
+  cvar->rtcp_bw         = sess->config.session_bw / 8. * RTCP_BW_FRACTION;
+  cvar->member_timeout  = RTP_CONFIG_MEMBER_TIMEOUT;
   cvar->avg_rtcp_size   = RTP_CONFIG_AVERAGE_RTCP_SIZE;
+  cvar->avg_rsize_rtcp_size = 0;
+  cvar->rsize_share     = 0;
+
+  //
+  // RFC 4585 3.5.1
+  //
+  avpf->t_rr_interval         = sess->config.t_rr_interval / 1000.;
+  avpf->t_rr_current_interval = 0;
+  avpf->t_rr_last             = 0;
+  avpf->t_rr                  = 0;
+  avpf->te                    = 0;
+  avpf->allow_early           = RTP_TRUE;
 }
 
 void
@@ -357,48 +702,68 @@ rtcp_interval_handle_rtp_event(rtp_session_t* sess, uint8_t new_member, uint8_t
   }
 }
 
+/**
+ * RFC 3550 6.3.4. when members leave, pull tn and tp in by the
+ * ratio of members now to members when tn was computed.
+ * a bundle is pulled in as one participant with the members of all
+ * the sessions in it, on the scheduler's timer
+ */
 static void
-rtcp_interval_handle_rtcp_event(rtp_session_t* sess, uint32_t event, uint32_t flags, uint32_t pkt_size)
+rtcp_interval_reverse_reconsider(rtp_session_t* sess)
 {
-  rtcp_control_var_t* cvar = &sess->rtcp_var;
-  double              tc = rtcp_current_time(sess);
+  rtp_session_t*      sched = rtcp_scheduler(sess);
+  rtcp_control_var_t  bundle_var;
+  rtcp_control_var_t* all = rtcp_interval_cvar(sched, &bundle_var);
+  rtcp_control_var_t* cvar = &sched->rtcp_var;
+  double              tc = rtcp_current_time(sched);
   double              tn = cvar->tn;
+  double              ratio;
+
+  if(all->members >= all->pmembers)
+  {
+    return;
+  }
+
+  ratio = ((double)all->members) / all->pmembers;
+
+  tn = tc + ratio * (tn - tc);
+  cvar->tp = tc - ratio * (tc - cvar->tp);
+
+  rtcp_interval_reschedule(sched, tc, tn);
+
+  rtcp_interval_sync_pmembers(sched);
+}
+
+static void
+rtcp_interval_handle_rtcp_event(rtp_session_t* sess, uint32_t event, uint32_t flags)
+{
+  rtcp_control_var_t* cvar = &sess->rtcp_var;
 
   switch(event)
   {
   case RTCP_EVENT_RX_NON_BYE:
     if(flags & RTCP_INTERVAL_FLAGS_MEMBER)
     {
-    RTPLOGI(TAG, "rtcp senders += 1\n");
       cvar->members += 1;
+      rtp_session_trace(sess, rtp_trace_ev_rtcp_member_add, cvar->members, 0);
     }
-
-    cvar->avg_rtcp_size = (1./16.) * pkt_size + (15./16.) * (cvar->avg_rtcp_size);
     break;
 
   case RTCP_EVENT_RX_BYE:
   case RTCP_EVENT_TIMEOUT:
     if(flags & RTCP_INTERVAL_FLAGS_SENDER)
     {
-      RTPLOGI(TAG, "rtcp senders -= 1\n");
       cvar->senders -= 1;
+      rtp_session_trace(sess, rtp_trace_ev_rtcp_sender_del, cvar->senders, 0);
     }
 
     if(flags & RTCP_INTERVAL_FLAGS_MEMBER)
     {
-      RTPLOGI(TAG, "rtcp members -= 1\n");
       cvar->members -= 1;
+      rtp_session_trace(sess, rtp_trace_ev_rtcp_member_del, cvar->members, 0);
     }
 
-    if (cvar->members < cvar->pmembers)
-    {
-      tn = tc + (((double) cvar->members)/(cvar->pmembers))*(tn - tc);
-      cvar->tp = tc - (((double) cvar->members)/(cvar->pmembers))*(tc - cvar->tp);
-
-      rtcp_interval_reschedule(sess, tc, tn);
-
-      cvar->pmembers = cvar->members;
-    }
+    rtcp_interval_reverse_reconsider(sess);
     break;
   }
 }
@@ -425,11 +790,11 @@ rtcp_interval_member_timedout(rtp_session_t* sess, rtp_member_t* m)
   //
   if(rtp_member_is_rtp_heard(m))
   {
-    rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_TIMEOUT, RTCP_INTERVAL_FLAGS_SENDER | RTCP_INTERVAL_FLAGS_MEMBER, 0);
+    rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_TIMEOUT, RTCP_INTERVAL_FLAGS_SENDER | RTCP_INTERVAL_FLAGS_MEMBER);
   }
   else
   {
-    rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_TIMEOUT, RTCP_INTERVAL_FLAGS_MEMBER, 0);
+    rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_TIMEOUT, RTCP_INTERVAL_FLAGS_MEMBER);
   }
   rtp_session_dealloc_member(sess, m);
 }
@@ -442,13 +807,13 @@ rtcp_interval_sender_timedout(rtp_session_t* sess, rtp_member_t* m)
   // senders--
   //
   rtp_member_clear_rtp_heard(m);
-  if(sess->self == m)
+  if(rtp_member_is_self(m))
   {
     rtp_member_clear_sender(m);
-    sess->rtcp_var.we_sent = RTP_FALSE;
+    sess->rtcp_var.we_sent = rtp_session_is_sending(sess);
   }
 
-  rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_TIMEOUT, RTCP_INTERVAL_FLAGS_SENDER, 0);
+  rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_TIMEOUT, RTCP_INTERVAL_FLAGS_SENDER);
 }
 
 ////////////////////////////////////////////////////////////
@@ -463,22 +828,42 @@ if(a == RTP_FALSE)                  \
   return 0; \
 }
 
+/**
+ * RFC 3550 6.4. at most max_blocks report blocks, for senders only.
+ * if there are more senders, the next report picks up where this
+ * one stopped so every sender is reported in turn
+ */
 static uint8_t
-rtcp_send_report_gen_rr(rtp_session_t* sess, rtcp_encoder_t* enc, uint8_t sr, ntp_ts_t* now)
+rtcp_send_report_gen_rr(rtp_session_t* sess, rtcp_encoder_t* enc, uint8_t sr, ntp_ts_t* now, uint32_t max_blocks)
 {
-  //
-  // FIXME
-  // 
-  // in case there are many members,
-  // send rr in round robin fashion
-  //
   rtp_member_t*     m;
+  rtp_member_t*     start;
+  uint32_t          blocks = 0;
+
+  start = rtp_member_table_lookup(&sess->member_table, sess->rr_next_ssrc);
+  if(start == NULL)
+  {
+    start = rtp_member_table_get_first(&sess->member_table);
+  }
 
-  m = rtp_member_table_get_first(&sess->member_table);
+  m = start;
   while(m != NULL)
   {
-    if(!(rtp_member_is_self(m) || rtp_member_is_bye_received(m)))
+    //
+    // RFC3550 6.4. only for sources RTP was heard from recently.
+    // a big session of mostly receivers would overflow the packet otherwise
+    //
+    if(!(rtp_member_is_self(m) || rtp_member_is_bye_received(m)) &&
+       is_soft_timer_running(&m->sender_te))
     {
+      if(blocks == max_blocks)
+      {
+        // the rest in the next report
+        sess->rr_next_ssrc = m->ssrc;
+        break;
+      }
+      blocks++;
+
       //
       // RFC3550 A.3
       //
@@ -555,69 +940,278 @@ rtcp_send_report_gen_rr(rtp_session_t* sess, rtcp_encoder_t* enc, uint8_t sr, nt
       }
     }
     m = rtp_member_table_get_next(&sess->member_table, m);
+    if(m == NULL)
+    {
+      m = rtp_member_table_get_first(&sess->member_table);
+    }
+
+    if(m == start)
+    {
+      break;
+    }
   }
   return RTP_TRUE;
 }
 
+/**
+ * SR/RR of stream 0 and SR of other sending streams, without report blocks
+ */
 static uint32_t
-rtcp_send_report(rtp_session_t* sess)
+rtcp_send_report_hdr_len(rtp_session_t* sess)
 {
-  rtcp_encoder_t  enc;
-  ntp_ts_t        ts;
-  uint32_t        rtp_ts;
-  uint32_t        pkt_len;
-
-  RTPLOGI(TAG, "RTCP ==> TX\n");
-
-  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  uint32_t    len;
 
-  ntp_ts_now(&ts);
-  rtp_ts = rtp_session_timestamp(sess);
+  len = rtp_member_is_sender(sess->streams[0].self) == RTP_TRUE ? RTCP_SR_HDR_SIZE : RTCP_RR_HDR_SIZE;
 
-  // send and return packet size
-  if(rtp_member_is_sender(sess->self) == RTP_TRUE)
+  for(uint32_t i = 1; i < sess->num_streams; i++)
   {
-    // SR
-    REPORT_RET_IF_FALSE(
-    rtcp_encoder_sr_begin(&enc,
-        sess->self->ssrc,
-        ts.second,
+    if(rtp_member_is_sender(sess->streams[i].self) == RTP_TRUE)
+    {
+      len += RTCP_SR_HDR_SIZE;
+    }
+  }
+  return len;
+}
+
+static uint32_t
+rtcp_send_report_sdes_len(rtp_session_t** sessions, uint32_t num)
+{
+  uint32_t    len = RTCP_SDES_HDR_SIZE;
+
+  for(uint32_t i = 0; i < num; i++)
+  {
+    for(uint32_t j = 0; j < sessions[i]->num_streams; j++)
+    {
+      len += RTCP_SDES_CNAME_CHUNK_SIZE(sessions[i]->streams[j].self->cname_len);
+    }
+  }
+  return len;
+}
+
+/**
+ * @param reserve bytes to leave for what follows this session's reports
+ */
+static uint8_t
+rtcp_send_report_gen_report(rtp_session_t* sess, rtcp_encoder_t* enc, uint32_t reserve)
+{
+  ntp_ts_t        ts;
+  uint32_t        rtp_ts;
+  rtp_stream_t*   st;
+  uint32_t        max_blocks = 0;
+
+  rtp_session_sr_timestamp(sess, &ts, &rtp_ts);
+
+  reserve += rtcp_send_report_hdr_len(sess);
+  if(rtcp_encoder_space_left(enc) > reserve)
+  {
+    max_blocks = (rtcp_encoder_space_left(enc) - reserve) / RTCP_REPORT_BLOCK_SIZE;
+  }
+
+  if(max_blocks > RTCP_MAX_REPORT_BLOCKS)
+  {
+    max_blocks = RTCP_MAX_REPORT_BLOCKS;
+  }
+
+  st = &sess->streams[0];
+
+  if(rtp_member_is_sender(st->self) == RTP_TRUE)
+  {
+    // SR
+    REPORT_RET_IF_FALSE(
+    rtcp_encoder_sr_begin(enc,
+        st->self->ssrc,
+        ts.second,
         ts.fraction,
         rtp_ts,
-        sess->tx_pkt_count,
-        sess->tx_octet_count)
+        st->tx_pkt_count,
+        st->tx_octet_count)
     );
 
     REPORT_RET_IF_FALSE(
-    rtcp_send_report_gen_rr(sess, &enc, RTP_TRUE, &ts)
+    rtcp_send_report_gen_rr(sess, enc, RTP_TRUE, &ts, max_blocks)
     );
 
-    rtcp_encoder_end_packet(&enc);
+    rtcp_encoder_end_packet(enc);
   }
   else
   {
     // RR
     REPORT_RET_IF_FALSE(
-    rtcp_encoder_rr_begin(&enc, sess->self->ssrc)
+    rtcp_encoder_rr_begin(enc, sess->self->ssrc)
     );
     
     REPORT_RET_IF_FALSE(
-    rtcp_send_report_gen_rr(sess, &enc, RTP_FALSE, &ts)
+    rtcp_send_report_gen_rr(sess, enc, RTP_FALSE, &ts, max_blocks)
+    );
+
+    rtcp_encoder_end_packet(enc);
+  }
+
+  //
+  // additional send streams only carry sender info.
+  // reception report blocks go with stream 0
+  //
+  for(uint32_t i = 1; i < sess->num_streams; i++)
+  {
+    st = &sess->streams[i];
+
+    if(rtp_member_is_sender(st->self) == RTP_FALSE)
+    {
+      continue;
+    }
+
+    REPORT_RET_IF_FALSE(
+    rtcp_encoder_sr_begin(enc,
+        st->self->ssrc,
+        ts.second,
+        ts.fraction,
+        rtp_ts,
+        st->tx_pkt_count,
+        st->tx_octet_count)
     );
+    rtcp_encoder_end_packet(enc);
+  }
+  return RTP_TRUE;
+}
+
+static uint32_t
+rtcp_send_report_pkt(rtp_session_t* sess)
+{
+  rtcp_encoder_t  enc;
+  uint32_t        pkt_len;
+  rtp_session_t*  single[1];
+  rtp_session_t** sessions;
+  uint32_t        num;
+  uint32_t        reserve;
 
-    rtcp_encoder_end_packet(&enc);
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  //
+  // with a bundle, reports for all the sessions
+  // and a single SDES go in one compound packet
+  //
+  sessions = rtcp_report_sessions(sess, single, &num);
+
+  //
+  // report blocks get what is left after the reports of every
+  // session and SDES. APP and feedback take what remains after that
+  //
+  reserve = rtcp_send_report_sdes_len(sessions, num);
+  for(uint32_t i = 0; i < num; i++)
+  {
+    reserve += rtcp_send_report_hdr_len(sessions[i]);
+  }
+
+  // send and return packet size
+  for(uint32_t i = 0; i < num; i++)
+  {
+    reserve -= rtcp_send_report_hdr_len(sessions[i]);
+    REPORT_RET_IF_FALSE(rtcp_send_report_gen_report(sessions[i], &enc, reserve));
   }
 
   // SDES CNAME
   REPORT_RET_IF_FALSE(rtcp_encoder_sdes_begin(&enc));
-  REPORT_RET_IF_FALSE(rtcp_encoder_sdes_chunk_begin(&enc, sess->self->ssrc));
-  REPORT_RET_IF_FALSE(rtcp_encoder_sdes_chunk_add_cname(&enc, sess->self->cname, sess->self->cname_len));
-  REPORT_RET_IF_FALSE(rtcp_encoder_sdes_chunk_end(&enc));
+  for(uint32_t i = 0; i < num; i++)
+  {
+    for(uint32_t j = 0; j < sessions[i]->num_streams; j++)
+    {
+      rtp_member_t* self = sessions[i]->streams[j].self;
+
+      REPORT_RET_IF_FALSE(rtcp_encoder_sdes_chunk_begin(&enc, self->ssrc));
+      REPORT_RET_IF_FALSE(rtcp_encoder_sdes_chunk_add_cname(&enc, self->cname, self->cname_len));
+      REPORT_RET_IF_FALSE(rtcp_encoder_sdes_chunk_end(&enc));
+    }
+  }
   rtcp_encoder_end_packet(&enc);
 
+  // user APP packets
+  for(uint32_t i = 0; i < num; i++)
+  {
+    if(sessions[i]->tx_app != NULL)
+    {
+      sessions[i]->tx_app(sessions[i], &enc);
+    }
+  }
+
+  // pending feedback
+  for(uint32_t i = 0; i < num; i++)
+  {
+    if(rtcp_fb_queue_is_empty(&sessions[i]->fb_queue) == RTP_FALSE)
+    {
+      rtcp_fb_queue_encode(&sessions[i]->fb_queue, &enc, sessions[i]->self->ssrc);
+    }
+  }
+
   pkt_len = rtcp_encoder_msg_len(&enc);
 
-  sess->tx_rtcp(sess, enc.buf, pkt_len);
+  rtp_session_trace(sess, rtp_trace_ev_rtcp_tx, pkt_len, 0);
+  {
+    RTP_PROF_BEGIN(t);
+    rtp_session_capture(sess, RTP_CAPTURE_DIR_TX, RTP_TRUE, enc.buf, pkt_len, &sess->self->rtcp_addr, NULL);
+    sess->tx_rtcp(sess, enc.buf, pkt_len);
+    RTP_PROF_END(sess, rtp_prof_stage_cb_tx_rtcp, t);
+  }
+
+  rtcp_encoder_deinit(&enc);
+
+  return pkt_len;
+}
+
+/**
+ * build and send a regular RTCP compound packet right now.
+ * doesn't touch the RTCP interval
+ *
+ * @return packet size
+ */
+uint32_t
+rtcp_send_report(rtp_session_t* sess)
+{
+  uint32_t    len;
+
+  RTP_PROF_BEGIN(t);
+
+  len = rtcp_send_report_pkt(sess);
+
+  RTP_PROF_END(sess, rtp_prof_stage_rtcp_send_report, t);
+
+  return len;
+}
+
+/**
+ * send pending feedback in a reduced-size RTCP packet. RFC 5506
+ *
+ * @return packet size
+ */
+static uint32_t
+rtcp_send_feedback(rtp_session_t* sess)
+{
+  rtcp_encoder_t  enc;
+  uint32_t        pkt_len;
+  rtp_session_t*  single[1];
+  rtp_session_t** sessions;
+  uint32_t        num;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  sessions = rtcp_report_sessions(sess, single, &num);
+
+  for(uint32_t i = 0; i < num; i++)
+  {
+    rtcp_fb_queue_encode(&sessions[i]->fb_queue, &enc, sessions[i]->self->ssrc);
+  }
+
+  pkt_len = rtcp_encoder_msg_len(&enc);
+
+  if(pkt_len != 0)
+  {
+    RTP_PROF_BEGIN(t);
+
+    rtp_session_trace(sess, rtp_trace_ev_rtcp_fb_tx, pkt_len, 0);
+    rtp_session_capture(sess, RTP_CAPTURE_DIR_TX, RTP_TRUE, enc.buf, pkt_len, &sess->self->rtcp_addr, NULL);
+    sess->tx_rtcp(sess, enc.buf, pkt_len);
+
+    RTP_PROF_END(sess, rtp_prof_stage_cb_tx_rtcp, t);
+  }
 
   rtcp_encoder_deinit(&enc);
 
@@ -630,7 +1224,7 @@ rtcp_send_report(rtp_session_t* sess)
 //
 ////////////////////////////////////////////////////////////
 static rtp_member_t*
-rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, uint32_t pkt_size)
+rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from)
 {
   rtp_member_t*   m;
 
@@ -643,18 +1237,19 @@ rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, u
     m= rtp_session_alloc_member(sess, ssrc);
     if(m == NULL)
     {
-      RTPLOGE(TAG, "failed to rtp_session_alloc_member: %u\n", ssrc);
-      sess->last_rtcp_error = rtcp_rx_error_member_alloc_failed;
+      rtp_session_trace(sess, rtp_trace_ev_member_alloc_failed, ssrc, 1);
+      rtp_session_rtcp_error(sess, NULL, rtcp_rx_error_member_alloc_failed);
       return NULL;
     }
     memcpy(&m->rtcp_addr, from, sizeof(struct sockaddr_in));
     rtp_member_set_rtcp_heard(m);
 
-    rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_RX_NON_BYE, RTCP_INTERVAL_FLAGS_MEMBER, pkt_size);
+    rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_RX_NON_BYE, RTCP_INTERVAL_FLAGS_MEMBER);
 
     rtp_timers_member_start(sess, m);
 
-    sess->last_rtcp_error = rtcp_rx_error_member_first_heard;
+    rtp_session_rtcp_error(sess, m, rtcp_rx_error_member_first_heard);
+    m->last_heard = soft_timer_get_tick_time(&sess->soft_timer);
 
     return m;
   }
@@ -664,7 +1259,7 @@ rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, u
   //
   if(rtp_member_is_bye_received(m))
   {
-    sess->last_rtcp_error = rtcp_rx_error_member_bye_in_progress;
+    rtp_session_rtcp_error(sess, m, rtcp_rx_error_member_bye_in_progress);
     return NULL;
   }
 
@@ -678,7 +1273,8 @@ rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, u
     rtp_member_set_rtcp_heard(m);
 
     rtp_timers_member_restart(sess, m);
-    sess->last_rtcp_error = rtcp_rx_error_member_first_heard;
+    rtp_session_rtcp_error(sess, m, rtcp_rx_error_member_first_heard);
+    m->last_heard = soft_timer_get_tick_time(&sess->soft_timer);
     return m;
   }
 
@@ -689,11 +1285,11 @@ rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, u
   {
     // an identifier collision or a loop is detected
 
-    if(ssrc != sess->self->ssrc)
+    if(rtp_member_is_self(m) == RTP_FALSE)
     {
-      sess->last_rtcp_error = rtcp_rx_error_3rd_party_conflict;
-      // FIXME
-      // count third-party loop/collision
+      // third-party loop/collision
+      RTP_PROBE4(ssrc_conflict, sess, ssrc, 0, 1);
+      rtp_session_rtcp_error(sess, m, rtcp_rx_error_3rd_party_conflict);
       return NULL;
     }
 
@@ -704,27 +1300,29 @@ rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, u
     if(rtp_source_conflict_lookup(&sess->src_conflict, from) == RTP_TRUE)
     {
       // abort processing of data packet or control element
-      sess->last_rtcp_error = rtcp_rx_error_source_in_conflict_list;
+      rtp_session_rtcp_error(sess, m, rtcp_rx_error_source_in_conflict_list);
       return NULL;
     }
 
-    RTPLOGI(TAG, "ssrc conflict: %u\n", ssrc);
+    rtp_session_trace(sess, rtp_trace_ev_ssrc_conflict, ssrc, 1);
+    RTP_PROBE4(ssrc_conflict, sess, ssrc, 1, 1);
 
     rtp_source_conflict_add(&sess->src_conflict, from);
     rtcp_tx_bye(sess);
 
     rtp_member_table_change_random_ssrc(&sess->member_table, m);
-    rtp_session_reset_tx_stats(sess);
+    rtp_session_reset_stream_tx_stats(sess, m);
 
-    sess->last_rtcp_error = rtcp_rx_error_ssrc_conflict;
+    rtp_session_rtcp_error(sess, m, rtcp_rx_error_ssrc_conflict);
     return NULL;
   }
 
   rtp_member_set_rtcp_heard(m);
   rtp_timers_member_restart(sess, m);
 
-  rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_RX_NON_BYE, 0, pkt_size);
+  rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_RX_NON_BYE, 0);
   sess->last_rtcp_error = rtcp_rx_error_no_error;
+  m->last_heard = soft_timer_get_tick_time(&sess->soft_timer);
 
   return m;
 }
@@ -734,108 +1332,136 @@ rtcp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, struct sockaddr_in* from, u
 // RTCP Handling
 //
 ////////////////////////////////////////////////////////////
+static inline void
+rtcp_update_rtt(rtp_session_t* sess, rtp_member_t* m, const rtcp_rr_info_t* rr, uint32_t now)
+{
+  rtp_member_t*   self;
+  uint32_t        rtt;
+
+  // LSR 0 means no SR from us was received yet
+  if(rr->lsr == 0)
+  {
+    return;
+  }
+
+  self = rtp_session_lookup_member(sess, rr->ssrc);
+  if(self == NULL || rtp_member_is_self(self) == RTP_FALSE)
+  {
+    return;
+  }
+
+  // A - LSR - DLSR. a negative result is a clock glitch on either side
+  rtt = now - rr->lsr - rr->dlsr;
+  m->rtt = (int32_t)rtt < 0 ? 0 : rtt;
+}
+
 static void
-rtcp_handle_rr_item(rtp_session_t* sess, uint32_t from_ssrc, rtcp_rr_t* rr)
+rtcp_handle_report_blocks(rtp_session_t* sess, rtp_member_t* m, const rtcp_pkt_view_t* v)
 {
-  sess->rr_rpt(sess, from_ssrc, rr);
+  rtcp_rr_info_t    rr;
+  ntp_ts_t          now;
+
+  if(v->count == 0)
+  {
+    return;
+  }
+
+  ntp_ts_now(&now);
+
+  for(uint8_t i = 0; i < v->count; i++)
+  {
+    rtcp_view_report_block(v, i, &rr);
+    rtcp_update_rtt(sess, m, &rr, ntp_ts_middle32(&now));
+    sess->rr_rpt(sess, m->ssrc, &rr);
+  }
 }
 
 static void
-rtcp_handle_sr(rtp_session_t* sess, rtcp_t* r, struct sockaddr_in* from, uint32_t cpkt_size)
+rtcp_handle_sr(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
 {
   rtp_member_t*   m;
+  rtcp_sr_info_t  sr;
+
+  rtcp_view_sr(v, &sr);
+
+  sess = rtcp_route(sess, sr.ssrc, v);
 
-  m = rtcp_handle_ssrc(sess, ntohl(r->r.sr.ssrc), from, cpkt_size);
+  m = rtcp_handle_ssrc(sess, sr.ssrc, from);
   if(m == NULL)
   {
     return;
   }
 
   // from sender report, create rr for the member
-  m->last_sr.second   = ntohl(r->r.sr.ntp_sec);
-  m->last_sr.fraction = ntohl(r->r.sr.ntp_frac);
-  m->rtp_ts           = ntohl(r->r.sr.rtp_ts);
-  m->pkt_count        = ntohl(r->r.sr.psent);
-  m->octet_count      = ntohl(r->r.sr.osent);
+  m->last_sr.second   = sr.ntp_sec;
+  m->last_sr.fraction = sr.ntp_frac;
+  m->rtp_ts           = sr.rtp_ts;
+  m->pkt_count        = sr.psent;
+  m->octet_count      = sr.osent;
 
   ntp_ts_now(&m->last_sr_local_time);
 
-  for(uint8_t i = 0; i < r->common.count; i++)
-  {
-    rtcp_handle_rr_item(sess, ntohl(r->r.sr.ssrc), &r->r.sr.rr[i]);
-  }
+  rtcp_handle_report_blocks(sess, m, v);
 
-  sess->sr_rpt(sess, ntohl(r->r.sr.ssrc), r);
+  sess->sr_rpt(sess, sr.ssrc, &sr);
 }
 
 static void
-rtcp_handle_rr(rtp_session_t* sess, rtcp_t* r, struct sockaddr_in* from, uint32_t cpkt_size)
+rtcp_handle_rr(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
 {
   rtp_member_t*   m;
+  uint32_t        ssrc = rtcp_view_rr_ssrc(v);
 
-  m = rtcp_handle_ssrc(sess, ntohl(r->r.rr.ssrc), from, cpkt_size);
+  sess = rtcp_route(sess, ssrc, v);
+
+  m = rtcp_handle_ssrc(sess, ssrc, from);
   if(m == NULL)
   {
     return;
   }
 
-  for(uint8_t i = 0; i < r->common.count; i++)
-  {
-    rtcp_handle_rr_item(sess,ntohl(r->r.rr.ssrc),  &r->r.rr.rr[i]);
-  }
+  rtcp_handle_report_blocks(sess, m, v);
 }
 
 static void
-rtcp_handle_sdes(rtp_session_t* sess, rtcp_t* r, struct sockaddr_in* from, uint32_t cpkt_size)
+rtcp_handle_sdes(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
 {
-  int count                 = r->common.count;
-  rtcp_sdes_t *sd           = &r->r.sdes;
-  rtcp_sdes_item_t          *rsp, *rspn;
-  rtcp_sdes_item_t          *end = (rtcp_sdes_item_t *)((uint32_t *)r + r->common.length + 1);
-  rtp_member_t*             m;
+  rtcp_sdes_iter_t    it;
+  rtp_member_t*       m;
+  uint32_t            ssrc;
+  uint8_t             type,
+                      len;
+  const uint8_t*      data;
 
-  while(--count >= 0)
-  {
-    rsp = &sd->item[0];
-    if (rsp >= end)
-      break;
+  rtcp_view_sdes_begin(v, &it);
 
-    m = rtcp_handle_ssrc(sess, ntohl(sd->src), from, cpkt_size);
+  while(rtcp_sdes_next_chunk(&it, &ssrc) == RTP_TRUE)
+  {
+    m = rtcp_handle_ssrc(rtcp_route(sess, ssrc, NULL), ssrc, from);
 
-    for(; rsp->type; rsp = rspn )
+    while(rtcp_sdes_next_item(&it, &type, &data, &len) == RTP_TRUE)
     {
-      rspn = (rtcp_sdes_item_t *)((char*)rsp+rsp->length+2);
-
-      if(rspn >= end)
-      {
-        rsp = rspn;
-        break;
-      }
-
-      if(m != NULL && rsp->type == RTCP_SDES_CNAME)
+      if(m != NULL && type == RTCP_SDES_CNAME)
       {
-        rtp_member_set_cname(m, (uint8_t*)rsp->data, rsp->length);
+        rtp_member_set_cname(m, (uint8_t*)data, len);
         rtp_member_set_validated(m);
       }
     }
-    
-    sd = (rtcp_sdes_t *)((uint32_t*)sd + (((char *)rsp - (char *)sd) >> 2)+1);
-  }
-
-  if (count >= 0)
-  {
-    /* XXX: invalid packet format */
   }
 }
 
 static void
-rtcp_handle_bye(rtp_session_t* sess, rtcp_t* r, struct sockaddr_in* from, uint32_t pkt_size)
+rtcp_handle_bye(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
 {
   rtp_member_t*       m;
+  rtp_session_t*      s;
+  uint32_t            ssrc;
 
-  for(int i = 0; i < r->common.count; i++)
+  for(uint8_t i = 0; i < v->count; i++)
   {
-    m = rtp_session_lookup_member(sess, ntohl(r->r.bye.src[i]));
+    ssrc = rtcp_view_bye_ssrc(v, i);
+    s = rtcp_route(sess, ssrc, NULL);
+    m = rtp_session_lookup_member(s, ssrc);
     if(m == NULL)
     {
       continue;
@@ -847,30 +1473,142 @@ rtcp_handle_bye(rtp_session_t* sess, rtcp_t* r, struct sockaddr_in* from, uint32
     }
 
     // bye handling
-    RTPLOGI(TAG, "bye received from %u\n", m->ssrc);
+    rtp_session_trace(s, rtp_trace_ev_rtcp_bye_rx, m->ssrc, rtp_member_is_rtp_heard(m) ? 1 : 0);
 
     if(rtp_member_is_rtp_heard(m))
     {
-      RTPLOGI(TAG, "bye sender & member\n");
-      rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_RX_BYE,
-          RTCP_INTERVAL_FLAGS_SENDER | RTCP_INTERVAL_FLAGS_MEMBER,
-          pkt_size);
+      rtcp_interval_handle_rtcp_event(s, RTCP_EVENT_RX_BYE,
+          RTCP_INTERVAL_FLAGS_SENDER | RTCP_INTERVAL_FLAGS_MEMBER);
     }
     else
     {
-      RTPLOGI(TAG, "bye member\n");
-      rtcp_interval_handle_rtcp_event(sess, RTCP_EVENT_RX_BYE,
-          RTCP_INTERVAL_FLAGS_MEMBER, 
-          pkt_size);
+      rtcp_interval_handle_rtcp_event(s, RTCP_EVENT_RX_BYE,
+          RTCP_INTERVAL_FLAGS_MEMBER);
     }
 
     rtp_member_set_bye_received(m);
 
-    rtp_timers_sender_stop(sess, m);
-    rtp_timers_member_stop(sess, m);
+    rtp_timers_sender_stop(s, m);
+    rtp_timers_member_stop(s, m);
+
+    rtp_timers_leave_start(s, m);
+  }
+}
+
+static void
+rtcp_handle_fb(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
+{
+  uint32_t        sender_ssrc,
+                  media_ssrc,
+                  fci_len;
+  const uint8_t*  fci;
+  rtp_member_t*   m;
+
+  rtcp_view_fb(v, &sender_ssrc, &media_ssrc, &fci, &fci_len);
 
-    rtp_timers_leave_start(sess, m);
+  sess = rtcp_route(sess, sender_ssrc, NULL);
+
+  m = rtcp_handle_ssrc(sess, sender_ssrc, from);
+  if(m == NULL || sess->fb_rpt == NULL)
+  {
+    return;
   }
+
+  sess->fb_rpt(sess, sender_ssrc, media_ssrc, v->pt, v->count, fci, fci_len);
+}
+
+static inline uint32_t
+rtcp_app_hash(uint32_t name, uint8_t subtype)
+{
+  uint32_t    h = (name ^ subtype) * 2654435761u;
+
+  return (h >> 16) & (RTP_CONFIG_RTCP_APP_TABLE_SIZE - 1);
+}
+
+/**
+ * open addressing with linear probing.
+ * removed entries are kept as used to keep probe chains intact
+ *
+ * @return the entry for name/subtype or, with add, an empty one. NULL otherwise
+ */
+static rtcp_app_handler_t*
+rtcp_app_lookup(rtp_session_t* sess, uint32_t name, uint8_t subtype, uint8_t add)
+{
+  rtcp_app_handler_t*   e;
+  uint32_t              ndx = rtcp_app_hash(name, subtype);
+
+  for(uint32_t i = 0; i < RTP_CONFIG_RTCP_APP_TABLE_SIZE; i++)
+  {
+    e = &sess->app_handlers[ndx];
+
+    if(e->used == RTP_FALSE)
+    {
+      return add == RTP_TRUE ? e : NULL;
+    }
+
+    if(e->name == name && e->subtype == subtype)
+    {
+      return e;
+    }
+    ndx = (ndx + 1) & (RTP_CONFIG_RTCP_APP_TABLE_SIZE - 1);
+  }
+  return NULL;
+}
+
+static void
+rtcp_handle_app(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
+{
+  rtcp_app_handler_t*   e;
+  uint32_t              ssrc,
+                        name,
+                        len;
+  const uint8_t         *pname,
+                        *data;
+
+  rtcp_view_app(v, &ssrc, &pname, &data, &len);
+  memcpy(&name, pname, 4);
+
+  sess = rtcp_route(sess, ssrc, NULL);
+
+  // APP from a known member keeps it alive like SR/RR/SDES
+  if(rtp_session_lookup_member(sess, ssrc) != NULL &&
+     rtcp_handle_ssrc(sess, ssrc, from) == NULL)
+  {
+    return;
+  }
+
+  e = rtcp_app_lookup(sess, name, v->count, RTP_FALSE);
+  if(e == NULL || e->handler == NULL)
+  {
+    sess->unknown_rtcp_pkt++;
+    return;
+  }
+  e->handler(sess, v, from);
+}
+
+static void
+rtcp_dispatch_init(rtp_session_t* sess)
+{
+  memset(sess->rtcp_handlers, 0, sizeof(sess->rtcp_handlers));
+  memset(sess->app_handlers, 0, sizeof(sess->app_handlers));
+
+  sess->rtcp_handlers[RTCP_SR - RTCP_MUX_PT_MIN]     = rtcp_handle_sr;
+  sess->rtcp_handlers[RTCP_RR - RTCP_MUX_PT_MIN]     = rtcp_handle_rr;
+  sess->rtcp_handlers[RTCP_SDES - RTCP_MUX_PT_MIN]   = rtcp_handle_sdes;
+  sess->rtcp_handlers[RTCP_BYE - RTCP_MUX_PT_MIN]    = rtcp_handle_bye;
+  sess->rtcp_handlers[RTCP_APP - RTCP_MUX_PT_MIN]    = rtcp_handle_app;
+  sess->rtcp_handlers[RTCP_RTPFB - RTCP_MUX_PT_MIN]  = rtcp_handle_fb;
+  sess->rtcp_handlers[RTCP_PSFB - RTCP_MUX_PT_MIN]   = rtcp_handle_fb;
+}
+
+static inline rtcp_rx_handler_t
+rtcp_dispatch_lookup(rtp_session_t* sess, uint8_t pt)
+{
+  if(pt < RTCP_MUX_PT_MIN || pt > RTCP_MUX_PT_MAX)
+  {
+    return NULL;
+  }
+  return sess->rtcp_handlers[pt - RTCP_MUX_PT_MIN];
 }
 
 ////////////////////////////////////////////////////////////
@@ -884,70 +1622,90 @@ rtcp_init(rtp_session_t* sess)
   double tc = rtcp_current_time(sess);
 
   rtcp_interval_control_var_init(sess);
+  rtcp_fb_queue_init(&sess->fb_queue);
+  rtcp_dispatch_init(sess);
 
   soft_timer_init_elem(&sess->rtcp_timer);
   sess->rtcp_timer.cb = __rtcp_interval_timeout;
 
-  rtcp_interval_schedule(sess, tc, tc + rtcp_interval_calc(&sess->rtcp_var));
+  sess->rr_next_ssrc = 0;
+
+  soft_timer_init_elem(&sess->rtcp_early_timer);
+  sess->rtcp_early_timer.cb = __rtcp_early_timeout;
+
+  sess->avpf_var.t_rr = rtcp_interval_calc(sess);
+  rtcp_interval_schedule(sess, tc, tc + sess->avpf_var.t_rr);
 }
 
 void
 rtcp_deinit(rtp_session_t* sess)
 {
   rtcp_interval_stop_timer(sess);
+  soft_timer_del(&sess->soft_timer, &sess->rtcp_early_timer);
 }
 
-void
-rtcp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
+static void
+rtcp_rx_pkt(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
 {
-  rtcp_t      *r,
-              *end;
-  uint32_t    len_4 = len / 4;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  rtcp_rx_handler_t handler;
 
-  if(rtcp_check_pkt(sess, pkt, len) == RTP_FALSE)
+  if(rtcp_reader_init(&rd, pkt, len, sess->config.rtcp_rsize) == RTP_FALSE)
   {
+    rtp_session_trace(sess, rtp_trace_ev_rtcp_rx_invalid, rd.error, len);
+    RTP_PROBE3(rtcp_reject, sess, rd.error, len);
+    rtp_session_rtcp_error(sess, NULL, rd.error);
     sess->invalid_rtcp_pkt++;
     return;
   }
 
-  r = (rtcp_t*)pkt;
-  end = (rtcp_t *)((uint32_t*)r + len_4);
+  sess->last_rtcp_error = rtcp_rx_error_no_error;
+
+  rtp_session_trace(sess, rtp_trace_ev_rtcp_rx, len, rd.rsize);
 
-  while(r < end)
+  //
+  // packets are validated as they are read.
+  // dispatching stops at the first invalid one
+  //
+  while(rtcp_reader_next(&rd, &v) == RTP_TRUE)
   {
-    // r is a rtcp packet inside a compound rtcp packet
-    switch(r->common.pt)
+    RTP_PROBE4(rtcp_block, sess, v.pt, v.count, v.len);
+
+    handler = rtcp_dispatch_lookup(sess, v.pt);
+    if(handler == NULL)
     {
-    case RTCP_SR:
-      RTPLOGI(TAG, "rx RTCP_SR\n");
-      rtcp_handle_sr(sess, r, from, len);
-      break;
+      sess->unknown_rtcp_pkt++;
+      continue;
+    }
+    handler(sess, &v, from);
+  }
 
-    case RTCP_RR:
-      RTPLOGI(TAG, "rx RTCP_RR\n");
-      rtcp_handle_rr(sess, r, from, len);
-      break;
+  if(rd.error != rtcp_rx_error_no_error)
+  {
+    rtp_session_trace(sess, rtp_trace_ev_rtcp_rx_invalid, rd.error, len);
+    RTP_PROBE3(rtcp_reject, sess, rd.error, len);
+    rtp_session_rtcp_error(sess, NULL, rd.error);
+    sess->invalid_rtcp_pkt++;
+    return;
+  }
 
-    case RTCP_SDES:
-      RTPLOGI(TAG, "rx RTCP_SDES\n");
-      rtcp_handle_sdes(sess, r, from, len);
-      break;
+  // RFC 3550 6.3.3, once per received compound packet
+  rtcp_interval_update_avg_size(sess, len, rd.rsize);
 
-    case RTCP_BYE:
-      RTPLOGI(TAG, "rx RTCP_BYE\n");
-      rtcp_handle_bye(sess, r, from, len);
-      break;
+  // last_rtcp_error is left with the result of the last SSRC
+  sess->rtcp_errors[rtcp_rx_error_no_error]++;
+}
 
-    case RTCP_APP:
-      RTPLOGI(TAG, "RTCP_APP handling not yet IMPLEMENTED\n");
-      break;
+void
+rtcp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
+{
+  RTP_PROF_BEGIN(t);
 
-    default:
-      RTPLOGI(TAG, "Unknown RTCP Packet %d\n", r->common.pt);
-      break;
-    }
-    r = (rtcp_t*)((uint32_t*)r + (ntohs(r->common.length) + 1));
-  }
+  rtp_session_capture(sess, RTP_CAPTURE_DIR_RX, RTP_TRUE, pkt, len, from, &sess->self->rtcp_addr);
+  rtcp_rx_pkt(sess, pkt, len, from);
+
+  RTP_PROF_END(sess, rtp_prof_stage_rtcp_rx, t);
 }
 
 void
@@ -960,6 +1718,126 @@ rtcp_tx_bye(rtp_session_t* sess)
   //
 }
 
+int
+rtcp_tx_feedback(rtp_session_t* sess, uint8_t kind, uint32_t media_ssrc, uint16_t pid, uint16_t blp)
+{
+  if(rtcp_fb_queue_add(&sess->fb_queue, kind, media_ssrc, pid, blp) == RTP_FALSE)
+  {
+    sess->fb_queue_full++;
+    RTPLOGD(TAG, "feedback queue full\n");
+    return -1;
+  }
+
+  rtcp_avpf_request_early(rtcp_scheduler(sess));
+  return 0;
+}
+
+int
+rtcp_set_handler(rtp_session_t* sess, uint8_t pt, rtcp_rx_handler_t handler)
+{
+  if(pt < RTCP_MUX_PT_MIN || pt > RTCP_MUX_PT_MAX)
+  {
+    return -1;
+  }
+
+  // packet types handled by the library
+  if(pt >= RTCP_SR && pt <= RTCP_PSFB)
+  {
+    return -1;
+  }
+
+  sess->rtcp_handlers[pt - RTCP_MUX_PT_MIN] = handler;
+  return 0;
+}
+
+int
+rtcp_set_app_handler(rtp_session_t* sess, const uint8_t name[4], uint8_t subtype, rtcp_rx_handler_t handler)
+{
+  rtcp_app_handler_t*   e;
+  uint32_t              n;
+
+  memcpy(&n, name, 4);
+  subtype &= 0x1f;
+
+  e = rtcp_app_lookup(sess, n, subtype, handler != NULL ? RTP_TRUE : RTP_FALSE);
+  if(e == NULL)
+  {
+    if(handler != NULL)
+    {
+      RTPLOGE(TAG, "APP handler table full\n");
+      return -1;
+    }
+    return 0;
+  }
+
+  e->used     = RTP_TRUE;
+  e->name     = n;
+  e->subtype  = subtype;
+  e->handler  = handler;
+
+  return 0;
+}
+
+void
+rtcp_bundle_join(rtp_session_t* sess)
+{
+  //
+  // from now on, RTCP for this session goes out
+  // with the compound packets of the bundle primary
+  //
+  rtcp_interval_stop_timer(sess);
+  soft_timer_del(&sess->soft_timer, &sess->rtcp_early_timer);
+}
+
+/**
+ * sess is out of its bundle and schedules its own RTCP again
+ */
+void
+rtcp_bundle_leave(rtp_session_t* sess)
+{
+  double  tc = rtcp_current_time(sess);
+
+  sess->rtcp_var.pmembers     = sess->rtcp_var.members;
+  sess->avpf_var.t_rr         = rtcp_interval_calc(sess);
+  sess->avpf_var.allow_early  = RTP_TRUE;
+
+  rtcp_interval_reschedule(sess, tc, tc + sess->avpf_var.t_rr);
+}
+
+/**
+ * the bundle primary from left and to is the new one.
+ * to carries on the schedule of from. every session ticks
+ * its own timer, so times move over relative to now
+ */
+void
+rtcp_bundle_handover(rtp_session_t* from, rtp_session_t* to)
+{
+  rtcp_control_var_t* f = &from->rtcp_var;
+  rtcp_control_var_t* t = &to->rtcp_var;
+  double              tc = rtcp_current_time(to),
+                      delta = tc - rtcp_current_time(from);
+
+  t->tp                   = f->tp + delta;
+  t->initial              = f->initial;
+  t->avg_rtcp_size        = f->avg_rtcp_size;
+  t->avg_rsize_rtcp_size  = f->avg_rsize_rtcp_size;
+  t->rsize_share          = f->rsize_share;
+
+  to->avpf_var.t_rr_current_interval  = from->avpf_var.t_rr_current_interval;
+  to->avpf_var.t_rr_last              = from->avpf_var.t_rr_last + delta;
+  to->avpf_var.t_rr                   = from->avpf_var.t_rr;
+  to->avpf_var.allow_early            = from->avpf_var.allow_early;
+
+  rtcp_interval_reschedule(to, tc, f->tn + delta);
+
+  // early packet from was waiting for
+  if(is_soft_timer_running(&from->rtcp_early_timer) && rtcp_fb_pending(to))
+  {
+    to->avpf_var.allow_early = RTP_TRUE;
+    rtcp_avpf_request_early(to);
+  }
+}
+
 void
 rtcp_compute_jitter(rtp_session_t* sess, rtp_member_t* m, uint32_t rtp_ts, uint32_t arrival)
 {
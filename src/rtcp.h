@@ -8,6 +8,13 @@ extern void rtcp_init(rtp_session_t* sess);
 extern void rtcp_deinit(rtp_session_t* sess);
 extern void rtcp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from);
 extern void rtcp_tx_bye(rtp_session_t* sess);
+extern uint32_t rtcp_send_report(rtp_session_t* sess);
+extern int rtcp_tx_feedback(rtp_session_t* sess, uint8_t kind, uint32_t media_ssrc, uint16_t pid, uint16_t blp);
+extern int rtcp_set_handler(rtp_session_t* sess, uint8_t pt, rtcp_rx_handler_t handler);
+extern int rtcp_set_app_handler(rtp_session_t* sess, const uint8_t name[4], uint8_t subtype, rtcp_rx_handler_t handler);
+extern void rtcp_bundle_join(rtp_session_t* sess);
+extern void rtcp_bundle_leave(rtp_session_t* sess);
+extern void rtcp_bundle_handover(rtp_session_t* from, rtp_session_t* to);
 
 extern void rtcp_interval_handle_rtp_event(rtp_session_t* sess, uint8_t new_member, uint8_t new_sender);
 extern void rtcp_interval_tx_bye(rtp_session_t* sess);
@@ -39,6 +39,50 @@ rtcp_encoder_msg_len(rtcp_encoder_t* re)
   return re->write_ndx;
 }
 
+uint8_t
+rtcp_encoder_app_begin(rtcp_encoder_t* re, uint8_t subtype, uint32_t ssrc, const uint8_t name[4])
+{
+  #define RTCP_APP_SIZE_BEGIN_IN_4BYTES_WITH_HEADER        3
+
+  uint8_t*    p;
+
+  if(rtcp_encoder_space_left(re) < (RTCP_APP_SIZE_BEGIN_IN_4BYTES_WITH_HEADER*4))
+  {
+    return RTP_FALSE;
+  }
+
+  rtcp_encoder_set_current_pkt(re);
+
+  re->rtcp->common.pt       = RTCP_APP;
+  re->rtcp->common.count    = subtype & 0x1f;
+
+  p = &re->buf[re->write_ndx + 4];
+
+  *(uint32_t*)p = htonl(ssrc);
+  memcpy(&p[4], name, 4);
+
+  re->write_ndx += (RTCP_APP_SIZE_BEGIN_IN_4BYTES_WITH_HEADER * 4);
+
+  return RTP_TRUE;
+}
+
+/**
+ * application dependent data. RFC 3550 6.7 requires a multiple of 32 bits
+ */
+uint8_t
+rtcp_encoder_app_add_data(rtcp_encoder_t* re, const uint8_t* data, uint32_t len)
+{
+  if((len % 4) != 0 || rtcp_encoder_space_left(re) < len)
+  {
+    return RTP_FALSE;
+  }
+
+  memcpy(&re->buf[re->write_ndx], data, len);
+  re->write_ndx += len;
+
+  return RTP_TRUE;
+}
+
 void
 rtcp_encoder_end_packet(rtcp_encoder_t* re)
 {
@@ -352,3 +396,70 @@ rtcp_encoder_bye_add_reason(rtcp_encoder_t* re, const char* reason)
 
   return RTP_TRUE;
 }
+
+uint8_t
+rtcp_encoder_fb_begin(rtcp_encoder_t* re, uint8_t pt, uint8_t fmt, uint32_t sender_ssrc, uint32_t media_ssrc)
+{
+  rtcp_fb_t*    fb;
+
+  if(rtcp_encoder_space_left(re) < RTCP_FB_HDR_SIZE)
+  {
+    return RTP_FALSE;
+  }
+
+  rtcp_encoder_set_current_pkt(re);
+
+  fb = (rtcp_fb_t*)re->rtcp;
+
+  fb->common.pt     = pt;
+  fb->common.count  = fmt;
+  fb->sender_ssrc   = htonl(sender_ssrc);
+  fb->media_ssrc    = htonl(media_ssrc);
+
+  re->write_ndx += RTCP_FB_HDR_SIZE;
+
+  return RTP_TRUE;
+}
+
+uint8_t
+rtcp_encoder_fb_add_nack(rtcp_encoder_t* re, uint16_t pid, uint16_t blp)
+{
+  rtcp_fb_nack_t*   nack;
+
+  if(rtcp_encoder_space_left(re) < RTCP_FB_NACK_SIZE)
+  {
+    return RTP_FALSE;
+  }
+
+  nack = (rtcp_fb_nack_t*)&re->buf[re->write_ndx];
+
+  nack->pid = htons(pid);
+  nack->blp = htons(blp);
+
+  re->write_ndx += RTCP_FB_NACK_SIZE;
+
+  return RTP_TRUE;
+}
+
+uint8_t
+rtcp_encoder_fb_add_fir(rtcp_encoder_t* re, uint32_t ssrc, uint8_t seq)
+{
+  rtcp_fb_fir_t*    fir;
+
+  if(rtcp_encoder_space_left(re) < RTCP_FB_FIR_SIZE)
+  {
+    return RTP_FALSE;
+  }
+
+  fir = (rtcp_fb_fir_t*)&re->buf[re->write_ndx];
+
+  fir->ssrc         = htonl(ssrc);
+  fir->seq          = seq;
+  fir->reserved[0]  = 0;
+  fir->reserved[1]  = 0;
+  fir->reserved[2]  = 0;
+
+  re->write_ndx += RTCP_FB_FIR_SIZE;
+
+  return RTP_TRUE;
+}
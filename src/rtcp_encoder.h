@@ -3,6 +3,7 @@
 
 #include "common_inc.h"
 #include "rfc3550.h"
+#include "rfc4585.h"
 
 typedef struct
 {
@@ -53,6 +54,13 @@ extern uint8_t rtcp_encoder_bye_begin(rtcp_encoder_t* re);
 extern uint8_t rtcp_encoder_bye_add_ssrc(rtcp_encoder_t* re, uint32_t ssrc);
 extern uint8_t rtcp_encoder_bye_add_reason(rtcp_encoder_t* re, const char* reason);
 
+extern uint8_t rtcp_encoder_fb_begin(rtcp_encoder_t* re, uint8_t pt, uint8_t fmt, uint32_t sender_ssrc, uint32_t media_ssrc);
+extern uint8_t rtcp_encoder_fb_add_nack(rtcp_encoder_t* re, uint16_t pid, uint16_t blp);
+extern uint8_t rtcp_encoder_fb_add_fir(rtcp_encoder_t* re, uint32_t ssrc, uint8_t seq);
+
+extern uint8_t rtcp_encoder_app_begin(rtcp_encoder_t* re, uint8_t subtype, uint32_t ssrc, const uint8_t name[4]);
+extern uint8_t rtcp_encoder_app_add_data(rtcp_encoder_t* re, const uint8_t* data, uint32_t len);
+
 extern void rtcp_encoder_end_packet(rtcp_encoder_t* re);
 
 static inline uint32_t
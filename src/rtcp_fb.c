@@ -0,0 +1,146 @@
+#include "rtcp_fb.h"
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static inline uint8_t
+rtcp_fb_queue_merge(rtcp_fb_queue_t* q, uint8_t kind, uint32_t media_ssrc, uint16_t pid, uint16_t blp)
+{
+  rtcp_fb_item_t*   item;
+  uint16_t          delta;
+
+  for(uint32_t i = 0; i < q->num_items; i++)
+  {
+    item = &q->items[i];
+
+    if(item->kind != kind || item->media_ssrc != media_ssrc)
+    {
+      continue;
+    }
+
+    if(kind != rtcp_fb_kind_nack)
+    {
+      // PLI/FIR for the same media source is pending already
+      return RTP_TRUE;
+    }
+
+    //
+    // a lost packet that fits in BLP of a pending NACK
+    //
+    delta = pid - item->pid;
+    if(delta == 0 && blp == 0)
+    {
+      return RTP_TRUE;
+    }
+
+    if(delta >= 1 && delta <= 16 && blp == 0)
+    {
+      item->blp |= (1 << (delta - 1));
+      return RTP_TRUE;
+    }
+  }
+  return RTP_FALSE;
+}
+
+static inline uint32_t
+rtcp_fb_item_size(rtcp_fb_item_t* item)
+{
+  switch(item->kind)
+  {
+  case rtcp_fb_kind_nack:
+    return RTCP_FB_HDR_SIZE + RTCP_FB_NACK_SIZE;
+
+  case rtcp_fb_kind_fir:
+    return RTCP_FB_HDR_SIZE + RTCP_FB_FIR_SIZE;
+  }
+  return RTCP_FB_HDR_SIZE;
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtcp_fb_queue_init(rtcp_fb_queue_t* q)
+{
+  q->num_items  = 0;
+  q->fir_seq    = 0;
+}
+
+uint8_t
+rtcp_fb_queue_add(rtcp_fb_queue_t* q, uint8_t kind, uint32_t media_ssrc, uint16_t pid, uint16_t blp)
+{
+  rtcp_fb_item_t*   item;
+
+  if(rtcp_fb_queue_merge(q, kind, media_ssrc, pid, blp) == RTP_TRUE)
+  {
+    return RTP_TRUE;
+  }
+
+  if(q->num_items >= RTP_CONFIG_RTCP_FB_QUEUE_SIZE)
+  {
+    return RTP_FALSE;
+  }
+
+  item = &q->items[q->num_items++];
+
+  item->kind        = kind;
+  item->media_ssrc  = media_ssrc;
+  item->pid         = pid;
+  item->blp         = blp;
+
+  return RTP_TRUE;
+}
+
+/**
+ * encode pending feedback messages into an RTCP packet being built
+ * items that don't fit into the encoder are kept for the next packet
+ *
+ * @return number of items encoded
+ */
+uint32_t
+rtcp_fb_queue_encode(rtcp_fb_queue_t* q, rtcp_encoder_t* enc, uint32_t sender_ssrc)
+{
+  rtcp_fb_item_t*   item;
+  uint32_t          n;
+
+  for(n = 0; n < q->num_items; n++)
+  {
+    item = &q->items[n];
+
+    if(rtcp_encoder_space_left(enc) < rtcp_fb_item_size(item))
+    {
+      break;
+    }
+
+    switch(item->kind)
+    {
+    case rtcp_fb_kind_nack:
+      rtcp_encoder_fb_begin(enc, RTCP_RTPFB, RTCP_RTPFB_FMT_NACK, sender_ssrc, item->media_ssrc);
+      rtcp_encoder_fb_add_nack(enc, item->pid, item->blp);
+      break;
+
+    case rtcp_fb_kind_pli:
+      rtcp_encoder_fb_begin(enc, RTCP_PSFB, RTCP_PSFB_FMT_PLI, sender_ssrc, item->media_ssrc);
+      break;
+
+    case rtcp_fb_kind_fir:
+      // RFC 5104 4.3.1.1 media source SSRC is unused and set to 0
+      rtcp_encoder_fb_begin(enc, RTCP_PSFB, RTCP_PSFB_FMT_FIR, sender_ssrc, 0);
+      rtcp_encoder_fb_add_fir(enc, item->media_ssrc, q->fir_seq++);
+      break;
+    }
+    rtcp_encoder_end_packet(enc);
+  }
+
+  if(n != 0)
+  {
+    memmove(&q->items[0], &q->items[n], (q->num_items - n) * sizeof(rtcp_fb_item_t));
+    q->num_items -= n;
+  }
+
+  return n;
+}
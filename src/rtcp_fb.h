@@ -0,0 +1,40 @@
+#ifndef __RTCP_FB_DEF_H__
+#define __RTCP_FB_DEF_H__
+
+#include "common_inc.h"
+#include "rfc4585.h"
+#include "rtcp_encoder.h"
+
+typedef enum
+{
+  rtcp_fb_kind_nack,
+  rtcp_fb_kind_pli,
+  rtcp_fb_kind_fir,
+} rtcp_fb_kind_t;
+
+typedef struct
+{
+  uint8_t         kind;
+  uint32_t        media_ssrc;
+  uint16_t        pid;
+  uint16_t        blp;
+} rtcp_fb_item_t;
+
+typedef struct
+{
+  rtcp_fb_item_t  items[RTP_CONFIG_RTCP_FB_QUEUE_SIZE];
+  uint32_t        num_items;
+  uint8_t         fir_seq;
+} rtcp_fb_queue_t;
+
+extern void rtcp_fb_queue_init(rtcp_fb_queue_t* q);
+extern uint8_t rtcp_fb_queue_add(rtcp_fb_queue_t* q, uint8_t kind, uint32_t media_ssrc, uint16_t pid, uint16_t blp);
+extern uint32_t rtcp_fb_queue_encode(rtcp_fb_queue_t* q, rtcp_encoder_t* enc, uint32_t sender_ssrc);
+
+static inline uint8_t
+rtcp_fb_queue_is_empty(rtcp_fb_queue_t* q)
+{
+  return q->num_items == 0 ? RTP_TRUE : RTP_FALSE;
+}
+
+#endif /* !__RTCP_FB_DEF_H__ */
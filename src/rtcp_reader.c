@@ -0,0 +1,320 @@
+#include "rtcp_reader.h"
+
+#define RTCP_HDR_SIZE                     4
+#define RTCP_SR_SIZE                      28
+#define RTCP_RR_SIZE                      8
+#define RTCP_REPORT_BLOCK_SIZE            24
+#define RTCP_APP_SIZE                     12
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static inline uint32_t
+rtcp_reader_u32(const uint8_t* p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline const uint8_t*
+rtcp_view_body(const rtcp_pkt_view_t* v)
+{
+  return (const uint8_t*)v->r + RTCP_HDR_SIZE;
+}
+
+static inline uint32_t
+rtcp_reader_min_size(uint8_t pt, uint8_t count)
+{
+  switch(pt)
+  {
+  case RTCP_SR:
+    return RTCP_SR_SIZE + count * RTCP_REPORT_BLOCK_SIZE;
+
+  case RTCP_RR:
+    return RTCP_RR_SIZE + count * RTCP_REPORT_BLOCK_SIZE;
+
+  case RTCP_BYE:
+    return RTCP_HDR_SIZE + count * 4;
+
+  case RTCP_APP:
+    return RTCP_APP_SIZE;
+
+  case RTCP_RTPFB:
+  case RTCP_PSFB:
+    return RTCP_FB_HDR_SIZE;
+  }
+  return RTCP_HDR_SIZE;
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+/**
+ * check the compound packet header and the first packet
+ *
+ * @param allow_rsize accept reduced-size packets. RFC 5506
+ * @return RTP_FALSE with rd->error set if the packet is to be discarded
+ */
+uint8_t
+rtcp_reader_init(rtcp_reader_t* rd, const uint8_t* pkt, uint32_t len, uint8_t allow_rsize)
+{
+  const rtcp_t*   r = (const rtcp_t*)pkt;
+
+  rd->pkt     = pkt;
+  rd->len     = len;
+  rd->offset  = 0;
+  rd->rsize   = RTP_FALSE;
+  rd->error   = rtcp_rx_error_no_error;
+
+  if(len < sizeof(rtcp_common_t))
+  {
+    rd->error = rtcp_rx_error_header_too_short;
+    return RTP_FALSE;
+  }
+
+  if((len % 4) != 0)
+  {
+    rd->error = rtcp_rx_error_len_not_multiple_4;
+    return RTP_FALSE;
+  }
+
+  if((*(uint16_t *)r & RTCP_VALID_MASK) == RTCP_VALID_VALUE)
+  {
+    return RTP_TRUE;
+  }
+
+  //
+  // RFC 5506 3.4.2
+  // a reduced-size packet can start with any RTCP packet type.
+  // version and padding are still checked
+  //
+  if(allow_rsize == RTP_TRUE &&
+     r->common.version == RTP_VERSION && r->common.p == 0 &&
+     r->common.pt >= RTCP_SR && r->common.pt <= RTCP_PSFB)
+  {
+    rd->rsize = RTP_TRUE;
+    return RTP_TRUE;
+  }
+
+  rd->error = rtcp_rx_error_invalid_mask;
+  return RTP_FALSE;
+}
+
+/**
+ * validate and yield the next packet in the compound packet
+ *
+ * @return RTP_FALSE at the end or on an invalid packet.
+ *         rd->error tells which
+ */
+uint8_t
+rtcp_reader_next(rtcp_reader_t* rd, rtcp_pkt_view_t* v)
+{
+  const rtcp_t*   r;
+  uint32_t        left = rd->len - rd->offset;
+  uint32_t        len;
+  uint32_t        pad = 0;
+
+  if(left == 0 || rd->error != rtcp_rx_error_no_error)
+  {
+    return RTP_FALSE;
+  }
+
+  r   = (const rtcp_t*)&rd->pkt[rd->offset];
+  len = (ntohs(r->common.length) + 1) * 4;
+
+  if(left < RTCP_HDR_SIZE || r->common.version != RTP_VERSION || len > left)
+  {
+    rd->error = rtcp_rx_error_invalid_compound_packet;
+    return RTP_FALSE;
+  }
+
+  //
+  // only the last packet can be padded
+  //
+  if(r->common.p)
+  {
+    pad = ((const uint8_t*)r)[len - 1];
+
+    if(len != left || pad == 0 || pad > len - RTCP_HDR_SIZE)
+    {
+      rd->error = rtcp_rx_error_invalid_compound_packet;
+      return RTP_FALSE;
+    }
+  }
+
+  if(len - pad < rtcp_reader_min_size(r->common.pt, r->common.count))
+  {
+    rd->error = rtcp_rx_error_invalid_compound_packet;
+    return RTP_FALSE;
+  }
+
+  v->r      = r;
+  v->pt     = r->common.pt;
+  v->count  = r->common.count;
+  v->len    = len - pad;
+
+  rd->offset += len;
+
+  return RTP_TRUE;
+}
+
+void
+rtcp_view_sr(const rtcp_pkt_view_t* v, rtcp_sr_info_t* sr)
+{
+  const uint8_t*  p = rtcp_view_body(v);
+
+  sr->ssrc      = rtcp_reader_u32(&p[0]);
+  sr->ntp_sec   = rtcp_reader_u32(&p[4]);
+  sr->ntp_frac  = rtcp_reader_u32(&p[8]);
+  sr->rtp_ts    = rtcp_reader_u32(&p[12]);
+  sr->psent     = rtcp_reader_u32(&p[16]);
+  sr->osent     = rtcp_reader_u32(&p[20]);
+}
+
+uint32_t
+rtcp_view_rr_ssrc(const rtcp_pkt_view_t* v)
+{
+  return rtcp_reader_u32(rtcp_view_body(v));
+}
+
+/**
+ * reception report block of SR or RR. ndx must be less than v->count
+ */
+void
+rtcp_view_report_block(const rtcp_pkt_view_t* v, uint8_t ndx, rtcp_rr_info_t* rr)
+{
+  const uint8_t*  p = (const uint8_t*)v->r;
+  uint32_t        w;
+
+  p += (v->pt == RTCP_SR ? RTCP_SR_SIZE : RTCP_RR_SIZE) + ndx * RTCP_REPORT_BLOCK_SIZE;
+
+  w = rtcp_reader_u32(&p[4]);
+
+  rr->ssrc      = rtcp_reader_u32(&p[0]);
+  rr->fraction  = (uint8_t)(w >> 24);
+  rr->lost      = (int32_t)(w << 8) >> 8;     // 24 bit signed
+  rr->last_seq  = rtcp_reader_u32(&p[8]);
+  rr->jitter    = rtcp_reader_u32(&p[12]);
+  rr->lsr       = rtcp_reader_u32(&p[16]);
+  rr->dlsr      = rtcp_reader_u32(&p[20]);
+}
+
+uint32_t
+rtcp_view_bye_ssrc(const rtcp_pkt_view_t* v, uint8_t ndx)
+{
+  return rtcp_reader_u32(rtcp_view_body(v) + ndx * 4);
+}
+
+/**
+ * name is 4 octets. not null terminated
+ */
+void
+rtcp_view_app(const rtcp_pkt_view_t* v, uint32_t* ssrc, const uint8_t** name,
+    const uint8_t** data, uint32_t* data_len)
+{
+  const uint8_t*  p = rtcp_view_body(v);
+
+  *ssrc     = rtcp_reader_u32(p);
+  *name     = &p[4];
+  *data     = &p[8];
+  *data_len = v->len - RTCP_APP_SIZE;
+}
+
+/**
+ * fci is in network order
+ */
+void
+rtcp_view_fb(const rtcp_pkt_view_t* v, uint32_t* sender_ssrc, uint32_t* media_ssrc,
+    const uint8_t** fci, uint32_t* fci_len)
+{
+  const uint8_t*  p = rtcp_view_body(v);
+
+  *sender_ssrc  = rtcp_reader_u32(&p[0]);
+  *media_ssrc   = rtcp_reader_u32(&p[4]);
+  *fci          = &p[8];
+  *fci_len      = v->len - RTCP_FB_HDR_SIZE;
+}
+
+void
+rtcp_view_sdes_begin(const rtcp_pkt_view_t* v, rtcp_sdes_iter_t* it)
+{
+  it->base        = (const uint8_t*)v->r;
+  it->p           = rtcp_view_body(v);
+  it->end         = it->base + v->len;
+  it->chunks_left = v->count;
+  it->in_chunk    = RTP_FALSE;
+}
+
+/**
+ * move to the next SDES chunk. unread items of the current chunk are skipped
+ */
+uint8_t
+rtcp_sdes_next_chunk(rtcp_sdes_iter_t* it, uint32_t* ssrc)
+{
+  uint8_t           type,
+                    len;
+  const uint8_t*    data;
+
+  while(it->in_chunk == RTP_TRUE)
+  {
+    rtcp_sdes_next_item(it, &type, &data, &len);
+  }
+
+  if(it->chunks_left == 0 || it->p + 4 > it->end)
+  {
+    return RTP_FALSE;
+  }
+
+  *ssrc = rtcp_reader_u32(it->p);
+
+  it->p += 4;
+  it->chunks_left--;
+  it->in_chunk = RTP_TRUE;
+
+  return RTP_TRUE;
+}
+
+/**
+ * @return RTP_FALSE at the end of the current chunk
+ */
+uint8_t
+rtcp_sdes_next_item(rtcp_sdes_iter_t* it, uint8_t* type, const uint8_t** data, uint8_t* len)
+{
+  if(it->in_chunk == RTP_FALSE)
+  {
+    return RTP_FALSE;
+  }
+
+  if(it->p >= it->end)
+  {
+    // no terminating null item
+    it->in_chunk = RTP_FALSE;
+    return RTP_FALSE;
+  }
+
+  if(it->p[0] == RTCP_SDES_END)
+  {
+    // null item and padding up to the next 32 bit boundary
+    it->p = it->base + (((it->p - it->base) / 4) + 1) * 4;
+    it->in_chunk = RTP_FALSE;
+    return RTP_FALSE;
+  }
+
+  if(it->p + 2 > it->end || it->p + 2 + it->p[1] > it->end)
+  {
+    it->p = it->end;
+    it->in_chunk = RTP_FALSE;
+    return RTP_FALSE;
+  }
+
+  *type = it->p[0];
+  *len  = it->p[1];
+  *data = &it->p[2];
+
+  it->p += 2 + it->p[1];
+
+  return RTP_TRUE;
+}
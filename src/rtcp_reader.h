@@ -0,0 +1,77 @@
+#ifndef __RTCP_READER_DEF_H__
+#define __RTCP_READER_DEF_H__
+
+#include "common_inc.h"
+#include "rfc3550.h"
+#include "rfc4585.h"
+#include "rtp_error.h"
+
+//
+// a single pass, bounds checked reader for compound RTCP packets.
+// each packet is validated as it is yielded and accessors below
+// decode fields in host order directly from the received buffer.
+//
+typedef struct
+{
+  const rtcp_t*     r;          // points into the compound packet
+  uint8_t           pt;
+  uint8_t           count;      // RC/SC/FMT/subtype
+  uint32_t          len;        // in octets. header included, padding excluded
+} rtcp_pkt_view_t;
+
+typedef struct
+{
+  const uint8_t*    pkt;
+  uint32_t          len;
+  uint32_t          offset;
+  uint8_t           rsize;      // reduced-size. first packet is not SR/RR
+  rtcp_rx_error_t   error;
+} rtcp_reader_t;
+
+typedef struct
+{
+  uint32_t          ssrc;
+  uint32_t          ntp_sec;
+  uint32_t          ntp_frac;
+  uint32_t          rtp_ts;
+  uint32_t          psent;
+  uint32_t          osent;
+} rtcp_sr_info_t;
+
+typedef struct
+{
+  uint32_t          ssrc;
+  uint8_t           fraction;
+  int32_t           lost;
+  uint32_t          last_seq;
+  uint32_t          jitter;
+  uint32_t          lsr;
+  uint32_t          dlsr;
+} rtcp_rr_info_t;
+
+typedef struct
+{
+  const uint8_t*    base;
+  const uint8_t*    p;
+  const uint8_t*    end;
+  uint32_t          chunks_left;
+  uint8_t           in_chunk;
+} rtcp_sdes_iter_t;
+
+extern uint8_t rtcp_reader_init(rtcp_reader_t* rd, const uint8_t* pkt, uint32_t len, uint8_t allow_rsize);
+extern uint8_t rtcp_reader_next(rtcp_reader_t* rd, rtcp_pkt_view_t* v);
+
+extern void rtcp_view_sr(const rtcp_pkt_view_t* v, rtcp_sr_info_t* sr);
+extern uint32_t rtcp_view_rr_ssrc(const rtcp_pkt_view_t* v);
+extern void rtcp_view_report_block(const rtcp_pkt_view_t* v, uint8_t ndx, rtcp_rr_info_t* rr);
+extern uint32_t rtcp_view_bye_ssrc(const rtcp_pkt_view_t* v, uint8_t ndx);
+extern void rtcp_view_app(const rtcp_pkt_view_t* v, uint32_t* ssrc, const uint8_t** name,
+    const uint8_t** data, uint32_t* data_len);
+extern void rtcp_view_fb(const rtcp_pkt_view_t* v, uint32_t* sender_ssrc, uint32_t* media_ssrc,
+    const uint8_t** fci, uint32_t* fci_len);
+
+extern void rtcp_view_sdes_begin(const rtcp_pkt_view_t* v, rtcp_sdes_iter_t* it);
+extern uint8_t rtcp_sdes_next_chunk(rtcp_sdes_iter_t* it, uint32_t* ssrc);
+extern uint8_t rtcp_sdes_next_item(rtcp_sdes_iter_t* it, uint8_t* type, const uint8_t** data, uint8_t* len);
+
+#endif /* !__RTCP_READER_DEF_H__ */
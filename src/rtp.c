@@ -116,16 +116,16 @@ rtp_header_validity_check(rtp_session_t* sess, uint8_t* msg, uint32_t len, uint8
   // The length of the packet must be consistent with CC
   if(len < (sizeof(rtp_hdr_t) - 4))
   {
-    sess->last_rtp_error = rtp_rx_error_header_too_short;
-    RTPLOGE(TAG, "rtp packet too small: %u\n", len);
+    rtp_session_rtp_error(sess, NULL, rtp_rx_error_header_too_short);
+    rtp_session_trace(sess, rtp_trace_ev_rtp_rx_invalid, sess->last_rtp_error, len);
     return RTP_FALSE;
   }
 
   hdr_size = (sizeof(rtp_hdr_t) - 4) + (sizeof(uint32_t) * hdr->cc);
   if(len < hdr_size)
   {
-    sess->last_rtp_error = rtp_rx_error_invalid_csrc_count;
-    RTPLOGE(TAG, "rtp invalid hdr size: %u:%u\n", len, hdr_size);
+    rtp_session_rtp_error(sess, NULL, rtp_rx_error_invalid_csrc_count);
+    rtp_session_trace(sess, rtp_trace_ev_rtp_rx_invalid, sess->last_rtp_error, hdr_size);
     return RTP_FALSE;
   }
 
@@ -133,8 +133,8 @@ rtp_header_validity_check(rtp_session_t* sess, uint8_t* msg, uint32_t len, uint8
   // RTP version field must equal 2
   if(hdr->version != RTP_VERSION)
   {
-    sess->last_rtp_error = rtp_rx_error_invalid_rtp_version;
-    RTPLOGE(TAG, "invalid RTP version %d\n", hdr->version);
+    rtp_session_rtp_error(sess, NULL, rtp_rx_error_invalid_rtp_version);
+    rtp_session_trace(sess, rtp_trace_ev_rtp_rx_invalid, sess->last_rtp_error, hdr->version);
     return RTP_FALSE;
   }
 
@@ -142,8 +142,8 @@ rtp_header_validity_check(rtp_session_t* sess, uint8_t* msg, uint32_t len, uint8
   // equal to SR or RR
   if(hdr->pt != pt)
   {
-    sess->last_rtp_error = rtp_rx_error_invalid_payload_type;
-    RTPLOGE(TAG, "payload type mismatch %d:%d\n", pt, hdr->pt);
+    rtp_session_rtp_error(sess, NULL, rtp_rx_error_invalid_payload_type);
+    rtp_session_trace(sess, rtp_trace_ev_rtp_rx_invalid, sess->last_rtp_error, hdr->pt);
     return RTP_FALSE;
   }
 
@@ -156,8 +156,8 @@ rtp_header_validity_check(rtp_session_t* sess, uint8_t* msg, uint32_t len, uint8
 
     if(padding_len >= (len - hdr_size))
     {
-      RTPLOGE(TAG, "P bit is set. Invalid last octet count: %u:%u\n", padding_len, len);
-      sess->last_rtp_error = rtp_rx_error_invalid_octet_count;
+      rtp_session_rtp_error(sess, NULL, rtp_rx_error_invalid_octet_count);
+      rtp_session_trace(sess, rtp_trace_ev_rtp_rx_invalid, sess->last_rtp_error, padding_len);
       return RTP_FALSE;
     }
   }
@@ -172,8 +172,8 @@ rtp_header_validity_check(rtp_session_t* sess, uint8_t* msg, uint32_t len, uint8
   //
   if(hdr->x)
   {
-    sess->last_rtp_error = rtp_rx_error_not_implemented;
-    RTPLOGE(TAG, "NOT IMPLEMENTED. Extension bit is set\n");
+    rtp_session_rtp_error(sess, NULL, rtp_rx_error_not_implemented);
+    rtp_session_trace(sess, rtp_trace_ev_rtp_rx_invalid, sess->last_rtp_error, 0);
     return RTP_FALSE;
   }
 
@@ -207,8 +207,8 @@ rtp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, uint16_t seq, struct sockadd
     m = rtp_session_alloc_member(sess, ssrc);
     if(m == NULL)
     {
-      sess->last_rtp_error = rtp_rx_error_member_alloc_failed;
-      RTPLOGE(TAG, "failed to rtp_session_alloc_member: %u\n", ssrc);
+      rtp_session_rtp_error(sess, NULL, rtp_rx_error_member_alloc_failed);
+      rtp_session_trace(sess, rtp_trace_ev_member_alloc_failed, ssrc, 0);
       return NULL;
     }
 
@@ -221,7 +221,7 @@ rtp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, uint16_t seq, struct sockadd
     rtp_timers_sender_start(sess, m);
     rtp_timers_member_start(sess, m);
 
-    sess->last_rtp_error = rtp_rx_error_member_first_heard;
+    rtp_session_rtp_error(sess, m, rtp_rx_error_member_first_heard);
 
     if(csrc == RTP_TRUE)
     {
@@ -238,7 +238,7 @@ rtp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, uint16_t seq, struct sockadd
   //
   if(rtp_member_is_bye_received(m))
   {
-    sess->last_rtp_error = rtp_rx_error_member_bye_in_progress;
+    rtp_session_rtp_error(sess, m, rtp_rx_error_member_bye_in_progress);
     return NULL;
   }
 
@@ -257,7 +257,7 @@ rtp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, uint16_t seq, struct sockadd
     rtp_timers_sender_start(sess, m);
     rtp_timers_member_restart(sess, m);
 
-    sess->last_rtp_error = rtp_rx_error_member_first_heard;
+    rtp_session_rtp_error(sess, m, rtp_rx_error_member_first_heard);
 
     return NULL;
   }
@@ -273,9 +273,9 @@ rtp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, uint16_t seq, struct sockadd
     // source identifier is not the participants' own
     if(rtp_member_is_self(m) == RTP_FALSE)
     {
-      // FIXME
-      // count third-party loop/collision
-      sess->last_rtp_error = rtp_rx_error_3rd_party_conflict;
+      // third-party loop/collision
+      RTP_PROBE4(ssrc_conflict, sess, ssrc, 0, 0);
+      rtp_session_rtp_error(sess, m, rtp_rx_error_3rd_party_conflict);
       return NULL;
     }
     // a collision or loop of the participant's own packets
@@ -293,20 +293,21 @@ rtp_handle_ssrc(rtp_session_t* sess, uint32_t ssrc, uint16_t seq, struct sockadd
     if(rtp_source_conflict_lookup(&sess->src_conflict, from) == RTP_TRUE)
     {
       // abort processing of data packet or control element
-      sess->last_rtp_error = rtp_rx_error_source_in_conflict_list;
+      rtp_session_rtp_error(sess, m, rtp_rx_error_source_in_conflict_list);
       return NULL;
     }
 
     // new collision, change SSRC identifier
-    RTPLOGI(TAG, "ssrc conflict: %u\n", ssrc);
+    rtp_session_trace(sess, rtp_trace_ev_ssrc_conflict, ssrc, 0);
+    RTP_PROBE4(ssrc_conflict, sess, ssrc, 1, 0);
 
     rtp_source_conflict_add(&sess->src_conflict, from);
     rtcp_tx_bye(sess);
 
     rtp_member_table_change_random_ssrc(&sess->member_table, m);
-    rtp_session_reset_tx_stats(sess);
+    rtp_session_reset_stream_tx_stats(sess, m);
 
-    sess->last_rtp_error = rtp_rx_error_ssrc_conflict;
+    rtp_session_rtp_error(sess, m, rtp_rx_error_ssrc_conflict);
 
     return NULL;
   }
@@ -334,14 +335,14 @@ rtp_deinit(rtp_session_t* sess)
 {
 }
 
-void
-rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
+static void
+rtp_rx_pkt(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from, uint32_t arrival)
 {
   rtp_member_t*   m;
+  rtp_member_t*   c;
   uint8_t*        payload;
   uint32_t        payload_len;
   rtp_hdr_t*      hdr;
-  uint32_t        arrival = rtp_session_timestamp(sess);
   uint32_t        csrc_list[15];
 
   if(rtp_header_validity_check(sess, pkt, len, sess->config.pt, &payload, &payload_len) == RTP_FALSE)
@@ -360,7 +361,7 @@ rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from
 
   if(rtp_update_seq(&m->rtp_src, ntohs(hdr->seq)) == RTP_FALSE)
   {
-    sess->last_rtp_error = rtp_rx_error_seq_error;
+    rtp_session_rtp_error(sess, m, rtp_rx_error_seq_error);
     return;
   }
 
@@ -382,14 +383,18 @@ rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from
     //
     csrc_list[i] = ntohl(hdr->csrc[i]);
 
-    m = rtp_handle_ssrc(sess, ntohl(hdr->csrc[i]), ntohs(hdr->seq), from, RTP_TRUE);
-    if(m != NULL)
+    c = rtp_handle_ssrc(sess, ntohl(hdr->csrc[i]), ntohs(hdr->seq), from, RTP_TRUE);
+    if(c != NULL)
     {
-      rtcp_compute_jitter(sess, m, ntohl(hdr->ts), arrival);
+      rtcp_compute_jitter(sess, c, ntohl(hdr->ts), arrival);
     }
   }
 
-  sess->last_rtp_error = rtp_rx_error_no_error;
+  rtp_session_rtp_error(sess, m, rtp_rx_error_no_error);
+
+  m->last_heard = soft_timer_get_tick_time(&sess->soft_timer);
+  rtp_member_window_count(m, payload_len);
+  RTP_PROBE4(rtp_accept, sess, m->ssrc, ntohs(hdr->seq), payload_len);
 
   {
     rtp_rx_report_t rpt;
@@ -401,28 +406,46 @@ rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from
     rpt.csrc        = csrc_list;
     rpt.ncsrc       = hdr->cc;
 
+    RTP_PROF_BEGIN(t);
     sess->rx_rtp(sess, &rpt);
+    RTP_PROF_END(sess, rtp_prof_stage_cb_rx_rtp, t);
   }
 }
 
+/**
+ * arrival_ns 0 if the transport doesn't know when the packet arrived
+ */
 void
-rtp_tx(rtp_session_t* sess, uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc)
+rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from, uint64_t arrival_ns)
+{
+  uint32_t    arrival = rtp_session_arrival_timestamp(sess, arrival_ns);
+
+  RTP_PROF_BEGIN(t);
+
+  rtp_session_capture(sess, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, from, &sess->self->rtp_addr);
+  rtp_rx_pkt(sess, pkt, len, from, arrival);
+
+  RTP_PROF_END(sess, rtp_prof_stage_rtp_rx, t);
+}
+
+void
+rtp_tx(rtp_session_t* sess, rtp_stream_t* st, uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc)
 {
   rtp_hdr_t*  hdr;
   uint32_t    pkt_size;
 
-  if(sess->rtcp_var.we_sent == RTP_FALSE)
+  if(rtp_member_is_sender(st->self) == RTP_FALSE)
   {
     sess->rtcp_var.we_sent = RTP_TRUE;
 
-    rtp_member_set_sender(sess->self);
+    rtp_member_set_sender(st->self);
     rtcp_interval_handle_rtp_event(sess, RTP_FALSE, RTP_TRUE);
   }
 
-  rtp_timers_sender_restart(sess, sess->self);
+  rtp_timers_sender_restart(sess, st->self);
 
-  sess->tx_pkt_count++;
-  sess->tx_octet_count += payload_len;
+  st->tx_pkt_count++;
+  st->tx_octet_count += payload_len;
 
   if(RTP_PKT_SIZE(ncsrc, payload_len) > RTP_CONFIG_MAX_RTP_PKT_SIZE)
   {
@@ -444,9 +467,9 @@ rtp_tx(rtp_session_t* sess, uint8_t* payload, uint32_t payload_len, uint32_t rtp
   hdr->cc       = ncsrc;
   hdr->m        = 0;
   hdr->pt       = sess->config.pt;
-  hdr->seq      = htons(sess->seq);
+  hdr->seq      = htons(st->seq);
   hdr->ts       = htonl(rtp_ts);
-  hdr->ssrc     = htonl(sess->self->ssrc);
+  hdr->ssrc     = htonl(st->self->ssrc);
 
   for(uint8_t i = 0; i < ncsrc; i++)
   {
@@ -479,7 +502,12 @@ rtp_tx(rtp_session_t* sess, uint8_t* payload, uint32_t payload_len, uint32_t rtp
     }
   }
 
-  sess->tx_rtp(sess, sess->rtp_pkt, pkt_size);
+  {
+    RTP_PROF_BEGIN(t);
+    rtp_session_capture(sess, RTP_CAPTURE_DIR_TX, RTP_FALSE, sess->rtp_pkt, pkt_size, &st->self->rtp_addr, NULL);
+    sess->tx_rtp(sess, sess->rtp_pkt, pkt_size);
+    RTP_PROF_END(sess, rtp_prof_stage_cb_tx_rtp, t);
+  }
 
-  sess->seq++;
+  st->seq++;
 }
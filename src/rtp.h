@@ -5,7 +5,7 @@
 
 extern void rtp_init(rtp_session_t* sess);
 extern void rtp_deinit(rtp_session_t* sess);
-extern void rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from);
-extern void rtp_tx(rtp_session_t* sess, uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc);
+extern void rtp_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from, uint64_t arrival_ns);
+extern void rtp_tx(rtp_session_t* sess, rtp_stream_t* st, uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc);
 
 #endif /* !__RTP_DEF_H__ */
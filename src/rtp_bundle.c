@@ -0,0 +1,148 @@
+#include "rtp_bundle.h"
+#include "rtp.h"
+#include "rtcp.h"
+#include "rfc5761.h"
+
+static const char* TAG = "bundle";
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static rtp_session_t*
+rtp_bundle_route_rtp(rtp_bundle_t* b, uint8_t* pkt, uint32_t len)
+{
+  rtp_hdr_t*      hdr = (rtp_hdr_t*)pkt;
+  rtp_session_t*  sess;
+
+  if(len < RTP_HDR_SIZE(0))
+  {
+    // let the primary reject it
+    return rtp_bundle_primary(b);
+  }
+
+  //
+  // known source first. then by payload type
+  //
+  sess = rtp_bundle_route(b, ntohl(hdr->ssrc));
+  if(sess != NULL)
+  {
+    return sess;
+  }
+
+  for(uint32_t i = 0; i < b->num_sessions; i++)
+  {
+    if(b->sessions[i]->config.pt == hdr->pt)
+    {
+      return b->sessions[i];
+    }
+  }
+  return rtp_bundle_primary(b);
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtp_bundle_init(rtp_bundle_t* b)
+{
+  b->num_sessions = 0;
+}
+
+/**
+ * add an initialized session to the bundle
+ *
+ * @return 0 on success, -1 if the bundle is full or
+ *         the session is already bundled
+ */
+int
+rtp_bundle_add(rtp_bundle_t* b, rtp_session_t* sess)
+{
+  if(b->num_sessions >= RTP_CONFIG_BUNDLE_MAX_SESSIONS || sess->bundle != NULL)
+  {
+    RTPLOGE(TAG, "can't add session to bundle: %u\n", b->num_sessions);
+    return -1;
+  }
+
+  b->sessions[b->num_sessions++] = sess;
+  sess->bundle = b;
+
+  if(b->num_sessions > 1)
+  {
+    rtcp_bundle_join(sess);
+  }
+  return 0;
+}
+
+/**
+ * take a session out of the bundle. it schedules its own RTCP again.
+ * done by rtp_session_deinit() for bundled sessions
+ *
+ * @return 0 on success, -1 if the session is not in the bundle
+ */
+int
+rtp_bundle_remove(rtp_bundle_t* b, rtp_session_t* sess)
+{
+  uint32_t  ndx;
+
+  for(ndx = 0; ndx < b->num_sessions && b->sessions[ndx] != sess; ndx++)
+    ;
+
+  if(ndx == b->num_sessions)
+  {
+    RTPLOGE(TAG, "session not in bundle\n");
+    return -1;
+  }
+
+  for(uint32_t i = ndx; i + 1 < b->num_sessions; i++)
+  {
+    b->sessions[i] = b->sessions[i + 1];
+  }
+  b->num_sessions--;
+  sess->bundle = NULL;
+
+  if(ndx == 0 && b->num_sessions > 0)
+  {
+    rtcp_bundle_handover(sess, rtp_bundle_primary(b));
+  }
+  rtcp_bundle_leave(sess);
+  return 0;
+}
+
+/**
+ * @return session that has ssrc in its member table. NULL if none
+ */
+rtp_session_t*
+rtp_bundle_route(rtp_bundle_t* b, uint32_t ssrc)
+{
+  for(uint32_t i = 0; i < b->num_sessions; i++)
+  {
+    if(rtp_member_table_lookup(&b->sessions[i]->member_table, ssrc) != NULL)
+    {
+      return b->sessions[i];
+    }
+  }
+  return NULL;
+}
+
+void
+rtp_bundle_rx(rtp_bundle_t* b, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
+{
+  rtp_bundle_rx_at(b, pkt, len, from, 0);
+}
+
+void
+rtp_bundle_rx_at(rtp_bundle_t* b, uint8_t* pkt, uint32_t len, struct sockaddr_in* from, uint64_t arrival_ns)
+{
+  if(rtcp_mux_is_rtcp(pkt, len) == RTP_TRUE)
+  {
+    // split by SSRC inside
+    rtcp_rx(rtp_bundle_primary(b), pkt, len, from);
+    return;
+  }
+
+  rtp_rx(rtp_bundle_route_rtp(b, pkt, len), pkt, len, from, arrival_ns);
+}
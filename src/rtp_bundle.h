@@ -0,0 +1,37 @@
+#ifndef __RTP_BUNDLE_DEF_H__
+#define __RTP_BUNDLE_DEF_H__
+
+#include "rtp_session.h"
+
+//
+// several sessions sharing one transport and one RTCP scheduler.
+// the first session added is the primary. its RTCP timer and
+// tx_rtcp are used for the compound packets of the whole bundle.
+// when the primary is removed, the next session takes over
+// the RTCP schedule and becomes the primary.
+//
+typedef struct __rtp_bundle_t
+{
+  rtp_session_t*      sessions[RTP_CONFIG_BUNDLE_MAX_SESSIONS];
+  uint32_t            num_sessions;
+} rtp_bundle_t;
+
+extern void rtp_bundle_init(rtp_bundle_t* b);
+extern int rtp_bundle_add(rtp_bundle_t* b, rtp_session_t* sess);
+extern int rtp_bundle_remove(rtp_bundle_t* b, rtp_session_t* sess);
+extern rtp_session_t* rtp_bundle_route(rtp_bundle_t* b, uint32_t ssrc);
+
+//
+// RX event from the shared transport
+//
+extern void rtp_bundle_rx(rtp_bundle_t* b, uint8_t* pkt, uint32_t len, struct sockaddr_in* from);
+// with arrival time. see rtp_session_rx_rtp_at()
+extern void rtp_bundle_rx_at(rtp_bundle_t* b, uint8_t* pkt, uint32_t len, struct sockaddr_in* from, uint64_t arrival_ns);
+
+static inline rtp_session_t*
+rtp_bundle_primary(rtp_bundle_t* b)
+{
+  return b->sessions[0];
+}
+
+#endif /* !__RTP_BUNDLE_DEF_H__ */
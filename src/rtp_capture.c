@@ -0,0 +1,276 @@
+#include "rtp_capture.h"
+
+//
+// pcap file format. LINKTYPE_IPV4, records start with an IPv4 header
+//
+#define PCAP_MAGIC                0xa1b2c3d4
+#define PCAP_VERSION_MAJOR        2
+#define PCAP_VERSION_MINOR        4
+#define PCAP_LINKTYPE_IPV4        228
+
+#define CAPTURE_IP_HDR_LEN        20
+#define CAPTURE_UDP_HDR_LEN       8
+
+typedef struct
+{
+  uint32_t    magic;
+  uint16_t    version_major;
+  uint16_t    version_minor;
+  int32_t     thiszone;
+  uint32_t    sigfigs;
+  uint32_t    snaplen;
+  uint32_t    linktype;
+} pcap_file_hdr_t;
+
+typedef struct
+{
+  uint32_t    ts_sec;
+  uint32_t    ts_usec;
+  uint32_t    incl_len;
+  uint32_t    orig_len;
+} pcap_rec_hdr_t;
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static inline uint32_t
+rtp_capture_get_u32(const uint8_t* p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * SSRC of RTP or sender SSRC of the first RTCP packet in a compound
+ *
+ * @return 0 if too short
+ */
+static uint8_t
+rtp_capture_get_ssrc(const uint8_t* pkt, uint32_t len, uint8_t rtcp, uint32_t* ssrc)
+{
+  uint32_t    off = rtcp ? 4 : 8;
+
+  if(len < off + 4)
+  {
+    return RTP_FALSE;
+  }
+
+  *ssrc = rtp_capture_get_u32(&pkt[off]);
+  return RTP_TRUE;
+}
+
+/**
+ * length of RTP fixed header, CSRC list and header extension
+ */
+static uint32_t
+rtp_capture_rtp_hdr_len(const uint8_t* pkt, uint32_t len)
+{
+  uint32_t    hdr_len;
+
+  if(len < 12)
+  {
+    return len;
+  }
+
+  hdr_len = 12 + (pkt[0] & 0x0f) * 4;
+
+  // extension. 16 bit profile, 16 bit length in words
+  if((pkt[0] & 0x10) && len >= hdr_len + 4)
+  {
+    hdr_len += 4 + (((uint32_t)pkt[hdr_len + 2] << 8) | pkt[hdr_len + 3]) * 4;
+  }
+
+  return hdr_len < len ? hdr_len : len;
+}
+
+static uint16_t
+rtp_capture_ip_csum(const uint8_t* hdr, uint32_t len)
+{
+  uint32_t    sum = 0;
+
+  for(uint32_t i = 0; i < len; i += 2)
+  {
+    sum += ((uint32_t)hdr[i] << 8) | hdr[i + 1];
+  }
+
+  while(sum >> 16)
+  {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+
+  return (uint16_t)~sum;
+}
+
+/**
+ * IPv4 + UDP header for a record. UDP checksum is left 0
+ */
+static void
+rtp_capture_build_ip_udp(const rtp_capture_rec_t* r, uint8_t* hdr)
+{
+  uint8_t*    ip  = hdr;
+  uint8_t*    udp = hdr + CAPTURE_IP_HDR_LEN;
+  uint32_t    ip_len  = CAPTURE_IP_HDR_LEN + CAPTURE_UDP_HDR_LEN + r->orig_len;
+  uint32_t    udp_len = CAPTURE_UDP_HDR_LEN + r->orig_len;
+  uint16_t    csum;
+
+  memset(hdr, 0, CAPTURE_IP_HDR_LEN + CAPTURE_UDP_HDR_LEN);
+
+  ip[0]   = 0x45;                     // version 4, 5 words
+  ip[2]   = ip_len >> 8;
+  ip[3]   = ip_len & 0xff;
+  ip[8]   = 64;                       // ttl
+  ip[9]   = IPPROTO_UDP;
+  memcpy(&ip[12], &r->src.sin_addr.s_addr, 4);
+  memcpy(&ip[16], &r->dst.sin_addr.s_addr, 4);
+
+  csum    = rtp_capture_ip_csum(ip, CAPTURE_IP_HDR_LEN);
+  ip[10]  = csum >> 8;
+  ip[11]  = csum & 0xff;
+
+  memcpy(&udp[0], &r->src.sin_port, 2);
+  memcpy(&udp[2], &r->dst.sin_port, 2);
+  udp[4]  = udp_len >> 8;
+  udp[5]  = udp_len & 0xff;
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtp_capture_init(rtp_capture_t* c, uint32_t flags, uint32_t ssrc)
+{
+  c->flags  = flags;
+  c->ssrc   = ssrc;
+
+  rtp_capture_clear(c);
+}
+
+void
+rtp_capture_clear(rtp_capture_t* c)
+{
+  c->head     = 0;
+  c->filtered = 0;
+}
+
+uint32_t
+rtp_capture_count(const rtp_capture_t* c)
+{
+  return c->head < RTP_CONFIG_CAPTURE_SLOTS ? c->head : RTP_CONFIG_CAPTURE_SLOTS;
+}
+
+/**
+ * copy a packet into the ring. src/dst may be NULL when unknown
+ */
+void
+rtp_capture_pkt(rtp_capture_t* c, uint8_t dir, uint8_t rtcp,
+    const uint8_t* pkt, uint32_t len, const struct sockaddr_in* src, const struct sockaddr_in* dst)
+{
+  rtp_capture_rec_t*  r;
+  struct timespec     now;
+  uint32_t            ssrc,
+                      cap_len = len;
+
+  if(c->flags & RTP_CAPTURE_FILTER_SSRC)
+  {
+    if(rtp_capture_get_ssrc(pkt, len, rtcp, &ssrc) == RTP_FALSE || ssrc != c->ssrc)
+    {
+      c->filtered++;
+      return;
+    }
+  }
+
+  if((c->flags & RTP_CAPTURE_HEADERS_ONLY) && rtcp == RTP_FALSE)
+  {
+    cap_len = rtp_capture_rtp_hdr_len(pkt, len);
+  }
+
+  if(cap_len > RTP_CONFIG_CAPTURE_SNAPLEN)
+  {
+    cap_len = RTP_CONFIG_CAPTURE_SNAPLEN;
+  }
+
+  r = &c->recs[c->head % RTP_CONFIG_CAPTURE_SLOTS];
+
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  r->ts_sec   = (uint32_t)now.tv_sec;
+  r->ts_usec  = (uint32_t)(now.tv_nsec / 1000);
+  r->orig_len = len > 0xffff ? 0xffff : len;
+  r->cap_len  = cap_len;
+  r->dir      = dir;
+  r->rtcp     = rtcp;
+
+  if(src != NULL)
+  {
+    r->src = *src;
+  }
+  else
+  {
+    memset(&r->src, 0, sizeof(r->src));
+  }
+
+  if(dst != NULL)
+  {
+    r->dst = *dst;
+  }
+  else
+  {
+    memset(&r->dst, 0, sizeof(r->dst));
+  }
+
+  memcpy(r->data, pkt, cap_len);
+
+  c->head++;
+}
+
+/**
+ * write the ring as a pcap file, oldest packet first
+ *
+ * @return number of packets written. -1 on write error
+ */
+int
+rtp_capture_write_pcap(const rtp_capture_t* c, rtp_capture_write_t write, void* arg)
+{
+  pcap_file_hdr_t     fh;
+  pcap_rec_hdr_t      rh;
+  uint8_t             ip_udp[CAPTURE_IP_HDR_LEN + CAPTURE_UDP_HDR_LEN];
+  uint32_t            n    = rtp_capture_count(c),
+                      tail = c->head - n;
+
+  fh.magic          = PCAP_MAGIC;
+  fh.version_major  = PCAP_VERSION_MAJOR;
+  fh.version_minor  = PCAP_VERSION_MINOR;
+  fh.thiszone       = 0;
+  fh.sigfigs        = 0;
+  fh.snaplen        = RTP_CONFIG_CAPTURE_SNAPLEN + sizeof(ip_udp);
+  fh.linktype       = PCAP_LINKTYPE_IPV4;
+
+  if(write(arg, &fh, sizeof(fh)) != 0)
+  {
+    return -1;
+  }
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    const rtp_capture_rec_t*  r = &c->recs[(tail + i) % RTP_CONFIG_CAPTURE_SLOTS];
+
+    rh.ts_sec   = r->ts_sec;
+    rh.ts_usec  = r->ts_usec;
+    rh.incl_len = sizeof(ip_udp) + r->cap_len;
+    rh.orig_len = sizeof(ip_udp) + r->orig_len;
+
+    rtp_capture_build_ip_udp(r, ip_udp);
+
+    if(write(arg, &rh, sizeof(rh)) != 0 ||
+       write(arg, ip_udp, sizeof(ip_udp)) != 0 ||
+       write(arg, r->data, r->cap_len) != 0)
+    {
+      return -1;
+    }
+  }
+
+  return (int)n;
+}
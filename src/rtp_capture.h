@@ -0,0 +1,58 @@
+#ifndef __RTP_CAPTURE_DEF_H__
+#define __RTP_CAPTURE_DEF_H__
+
+#include "common_inc.h"
+
+//
+// packet capture ring for RX/TX traffic.
+//
+// a capture is attached to one or more sessions with rtp_session_set_capture().
+// sessions without a capture pay a single NULL check per packet.
+// packets are copied into preallocated slots, truncated to
+// RTP_CONFIG_CAPTURE_SNAPLEN. the oldest slot is overwritten when full.
+// the ring is written out as a pcap file with a synthesized IPv4/UDP header.
+//
+// single writer. the ring must be dumped from the thread driving the sessions
+//
+#define RTP_CAPTURE_DIR_RX            0
+#define RTP_CAPTURE_DIR_TX            1
+
+// filter flags
+#define RTP_CAPTURE_HEADERS_ONLY      0x01      // RTP fixed header, CSRCs and extension only
+#define RTP_CAPTURE_FILTER_SSRC       0x02      // RTP SSRC or RTCP sender SSRC matches
+
+typedef struct
+{
+  uint32_t            ts_sec;
+  uint32_t            ts_usec;
+  struct sockaddr_in  src;
+  struct sockaddr_in  dst;
+  uint16_t            orig_len;
+  uint16_t            cap_len;
+  uint8_t             dir;
+  uint8_t             rtcp;
+  uint8_t             data[RTP_CONFIG_CAPTURE_SNAPLEN];
+} rtp_capture_rec_t;
+
+typedef struct
+{
+  uint32_t            flags;
+  uint32_t            ssrc;
+  uint32_t            head;             // number of packets ever captured
+  uint32_t            filtered;         // number of packets rejected by filter
+  rtp_capture_rec_t   recs[RTP_CONFIG_CAPTURE_SLOTS];
+} rtp_capture_t;
+
+//
+// write callback for pcap output. returns 0 on success, -1 on error
+//
+typedef int (*rtp_capture_write_t)(void* arg, const void* buf, uint32_t len);
+
+extern void rtp_capture_init(rtp_capture_t* c, uint32_t flags, uint32_t ssrc);
+extern void rtp_capture_clear(rtp_capture_t* c);
+extern uint32_t rtp_capture_count(const rtp_capture_t* c);
+extern void rtp_capture_pkt(rtp_capture_t* c, uint8_t dir, uint8_t rtcp,
+    const uint8_t* pkt, uint32_t len, const struct sockaddr_in* src, const struct sockaddr_in* dst);
+extern int rtp_capture_write_pcap(const rtp_capture_t* c, rtp_capture_write_t write, void* arg);
+
+#endif /* !__RTP_CAPTURE_DEF_H__ */
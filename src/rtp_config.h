@@ -6,9 +6,13 @@
  * @desc 
  * this definitions decides the maximum number of members possible per session
  */
+#ifndef RTP_CONFIG_MAX_MEMBERS_PER_SESSION
 #define RTP_CONFIG_MAX_MEMBERS_PER_SESSION        32
+#endif
 
+#ifndef RTP_CONFIG_MAX_RTP_PKT_SIZE
 #define RTP_CONFIG_MAX_RTP_PKT_SIZE               1024
+#endif
 
 /*
  *
@@ -28,20 +32,145 @@
 
 #define RTP_CONFIG_RANDOM_TYPE                    time(NULL)
 
+#ifndef RTP_CONFIG_SOURCE_CONFLICT_TABLE_SIZE
 #define RTP_CONFIG_SOURCE_CONFLICT_TABLE_SIZE     16
+#endif
 #define RTP_CONFIG_SOURCE_CONFLICT_TIMEOUT        5000      // 5000 ms
 
+#ifndef RTP_CONFIG_SDES_CNAME_MAX
 #define RTP_CONFIG_SDES_CNAME_MAX                 256
+#endif
 
 #define RTP_CONFIG_SENDER_TIMEOUT                 5000
-#define RTP_CONFIG_MEMBER_TIMEOUT                 10000
+#define RTP_CONFIG_MEMBER_TIMEOUT                 10000     // minimum. grows to 5 * Td in large sessions
 #define RTP_CONFIG_LEAVE_TIMEOUT                  3000
 
 #define RTP_CONFIG_MAX_DROPOUT                    3000
 #define RTP_CONFIG_MAX_MISORDER                   100
 #define RTP_CONFIG_MIN_SEQUENTIAL                 2
 
-#define RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN        256
+#ifndef RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN
+#define RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN        1024
+#endif
+
+/*
+ *
+ * @desc
+ * maximum number of pending RTCP feedback messages(NACK/PLI/FIR)
+ * waiting for an early or regular RTCP packet
+ */
+#ifndef RTP_CONFIG_RTCP_FB_QUEUE_SIZE
+#define RTP_CONFIG_RTCP_FB_QUEUE_SIZE             8
+#endif
+
+/*
+ *
+ * @desc
+ * maximum number of sessions sharing a transport and RTCP compound packets
+ */
+#ifndef RTP_CONFIG_BUNDLE_MAX_SESSIONS
+#define RTP_CONFIG_BUNDLE_MAX_SESSIONS            4
+#endif
+
+/*
+ *
+ * @desc
+ * maximum number of local send streams(SSRCs) per session
+ */
+#ifndef RTP_CONFIG_MAX_STREAMS_PER_SESSION
+#define RTP_CONFIG_MAX_STREAMS_PER_SESSION        4
+#endif
+
+/*
+ *
+ * @desc
+ * size of RTCP APP handler table per session. must be a power of 2
+ */
+#ifndef RTP_CONFIG_RTCP_APP_TABLE_SIZE
+#define RTP_CONFIG_RTCP_APP_TABLE_SIZE            8
+#endif
+
+#if (RTP_CONFIG_RTCP_APP_TABLE_SIZE & (RTP_CONFIG_RTCP_APP_TABLE_SIZE - 1)) != 0
+#error "RTP_CONFIG_RTCP_APP_TABLE_SIZE must be a power of 2"
+#endif
+
+/*
+ *
+ * @desc
+ * per session binary event trace ring. size must be a power of 2
+ */
+#ifndef RTP_CONFIG_TRACE
+#define RTP_CONFIG_TRACE                          1
+#endif
+#ifndef RTP_CONFIG_TRACE_RING_SIZE
+#define RTP_CONFIG_TRACE_RING_SIZE                128
+#endif
+
+#if (RTP_CONFIG_TRACE_RING_SIZE & (RTP_CONFIG_TRACE_RING_SIZE - 1)) != 0
+#error "RTP_CONFIG_TRACE_RING_SIZE must be a power of 2"
+#endif
+
+/*
+ *
+ * @desc
+ * stage latency histograms per session and process. 0 to compile out
+ */
+#ifndef RTP_CONFIG_PROFILE
+#define RTP_CONFIG_PROFILE                        0
+#endif
+
+/*
+ *
+ * @desc
+ * USDT probe points. nops unless a tracer attaches.
+ * no-ops without sys/sdt.h. 0 to compile out
+ */
+#ifndef RTP_CONFIG_PROBE
+#define RTP_CONFIG_PROBE                          1
+#endif
+
+/*
+ *
+ * @desc
+ * shared memory stats region. number of session slots and
+ * publish period in 100ms ticks
+ */
+#ifndef RTP_CONFIG_SHM_MAX_SESSIONS
+#define RTP_CONFIG_SHM_MAX_SESSIONS               8
+#endif
+#define RTP_CONFIG_SHM_PUBLISH_TICKS              10
+
+/*
+ *
+ * @desc
+ * per member sliding window RX counters for rates.
+ * slot length in 100ms ticks and number of slots
+ */
+#define RTP_CONFIG_MEMBER_WINDOW_TICKS            10
+#ifndef RTP_CONFIG_MEMBER_WINDOW_SLOTS
+#define RTP_CONFIG_MEMBER_WINDOW_SLOTS            5
+#endif
+
+/*
+ *
+ * @desc
+ * packet capture ring. number of slots and bytes kept per packet
+ */
+#ifndef RTP_CONFIG_CAPTURE_SLOTS
+#define RTP_CONFIG_CAPTURE_SLOTS                  1024
+#endif
+#ifndef RTP_CONFIG_CAPTURE_SNAPLEN
+#define RTP_CONFIG_CAPTURE_SNAPLEN                256
+#endif
+
+/*
+ *
+ * @desc
+ * network impairment shim. packets in flight per shim
+ */
+#ifndef RTP_CONFIG_IMPAIR_SLOTS
+#define RTP_CONFIG_IMPAIR_SLOTS                   256
+#endif
 
 #define RTP_CONFIG_BIGENDIAN                      1
 #define RTP_CONFIG_LITTLEENDIAN                   0
@@ -56,6 +185,16 @@
 #error "Invalid RTP_CONFRIG_ENDIAN"
 #endif
 
+/*
+ *
+ * @desc
+ * 1 to print debug logs. these are on paths a busy session can hit
+ * every packet, so they are off by default
+ */
+#ifndef RTP_CONFIG_LOG_DEBUG
+#define RTP_CONFIG_LOG_DEBUG                      0
+#endif
+
 #if 1
 #define RTPLOGI(tag, str, ...)       printf("%ld:%s:%d, %s:"str, time(NULL), __func__, __LINE__, tag, ##__VA_ARGS__); fflush(stdout)
 #define RTPLOGE(tag, str, ...)       printf("%ld:%s:%d, %s:"str, time(NULL), __func__, __LINE__, tag, ##__VA_ARGS__); fflush(stdout)
@@ -64,4 +203,10 @@
 #define RTPLOGE(tag, str, ...)     (void)tag
 #endif
 
+#if RTP_CONFIG_LOG_DEBUG == 1
+#define RTPLOGD(tag, str, ...)       printf("%ld:%s:%d, %s:"str, time(NULL), __func__, __LINE__, tag, ##__VA_ARGS__); fflush(stdout)
+#else
+#define RTPLOGD(tag, str, ...)     (void)tag
+#endif
+
 #endif /* !__RTP_CONFIG_DEF_H__ */
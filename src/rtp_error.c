@@ -0,0 +1,56 @@
+#include "common_inc.h"
+#include "rtp_error.h"
+
+static const char* _rtp_rx_error_str[rtp_rx_error_max] =
+{
+  [rtp_rx_error_no_error]                     = "no_error",
+  [rtp_rx_error_header_too_short]             = "header_too_short",
+  [rtp_rx_error_invalid_csrc_count]           = "invalid_csrc_count",
+  [rtp_rx_error_invalid_rtp_version]          = "invalid_rtp_version",
+  [rtp_rx_error_invalid_payload_type]         = "invalid_payload_type",
+  [rtp_rx_error_invalid_octet_count]          = "invalid_octet_count",
+  [rtp_rx_error_not_implemented]              = "not_implemented",
+  [rtp_rx_error_seq_error]                    = "seq_error",
+  [rtp_rx_error_member_alloc_failed]          = "member_alloc_failed",
+  [rtp_rx_error_member_first_heard]           = "member_first_heard",
+  [rtp_rx_error_member_bye_in_progress]       = "member_bye_in_progress",
+  [rtp_rx_error_member_first_rtp_after_rtcp]  = "member_first_rtp_after_rtcp",
+  [rtp_rx_error_3rd_party_conflict]           = "3rd_party_conflict",
+  [rtp_rx_error_source_in_conflict_list]      = "source_in_conflict_list",
+  [rtp_rx_error_ssrc_conflict]                = "ssrc_conflict",
+};
+
+static const char* _rtcp_rx_error_str[rtcp_rx_error_max] =
+{
+  [rtcp_rx_error_no_error]                    = "no_error",
+  [rtcp_rx_error_header_too_short]            = "header_too_short",
+  [rtcp_rx_error_len_not_multiple_4]          = "len_not_multiple_4",
+  [rtcp_rx_error_invalid_mask]                = "invalid_mask",
+  [rtcp_rx_error_invalid_compound_packet]     = "invalid_compound_packet",
+  [rtcp_rx_error_member_alloc_failed]         = "member_alloc_failed",
+  [rtcp_rx_error_member_first_heard]          = "member_first_heard",
+  [rtcp_rx_error_member_bye_in_progress]      = "member_bye_in_progress",
+  [rtcp_rx_error_3rd_party_conflict]          = "3rd_party_conflict",
+  [rtcp_rx_error_source_in_conflict_list]     = "source_in_conflict_list",
+  [rtcp_rx_error_ssrc_conflict]               = "ssrc_conflict",
+};
+
+const char*
+rtp_rx_error_str(rtp_rx_error_t err)
+{
+  if(err >= rtp_rx_error_max)
+  {
+    return "unknown";
+  }
+  return _rtp_rx_error_str[err];
+}
+
+const char*
+rtcp_rx_error_str(rtcp_rx_error_t err)
+{
+  if(err >= rtcp_rx_error_max)
+  {
+    return "unknown";
+  }
+  return _rtcp_rx_error_str[err];
+}
@@ -18,6 +18,7 @@ typedef enum
   rtp_rx_error_3rd_party_conflict,
   rtp_rx_error_source_in_conflict_list,
   rtp_rx_error_ssrc_conflict,
+  rtp_rx_error_max,
 } rtp_rx_error_t;
 
 typedef enum
@@ -33,6 +34,10 @@ typedef enum
   rtcp_rx_error_3rd_party_conflict,
   rtcp_rx_error_source_in_conflict_list,
   rtcp_rx_error_ssrc_conflict,
+  rtcp_rx_error_max,
 } rtcp_rx_error_t;
 
+extern const char* rtp_rx_error_str(rtp_rx_error_t err);
+extern const char* rtcp_rx_error_str(rtcp_rx_error_t err);
+
 #endif /* !__RTP_ERROR_DEF_H__ */
@@ -0,0 +1,238 @@
+#include "rtp_impair.h"
+
+//
+// number of uniforms summed for a normal draw. Irwin-Hall with 12
+// has variance 1 and needs no libm
+//
+#define IMPAIR_NORMAL_SUM         12
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static inline uint32_t
+rtp_impair_rand(rtp_impair_t* imp)
+{
+  // xorshift32
+  uint32_t  x = imp->rand;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+
+  imp->rand = x;
+  return x;
+}
+
+/**
+ * uniform in [0, 1)
+ */
+static inline double
+rtp_impair_uniform(rtp_impair_t* imp)
+{
+  return (rtp_impair_rand(imp) >> 8) / 16777216.;
+}
+
+static inline uint8_t
+rtp_impair_chance(rtp_impair_t* imp, double p)
+{
+  if(p <= 0)
+  {
+    return RTP_FALSE;
+  }
+  return rtp_impair_uniform(imp) < p ? RTP_TRUE : RTP_FALSE;
+}
+
+/**
+ * one Gilbert-Elliott step. state moves first, then the packet is
+ * lost with the loss probability of the new state
+ */
+static uint8_t
+rtp_impair_lose(rtp_impair_t* imp)
+{
+  if(imp->bad)
+  {
+    if(rtp_impair_chance(imp, imp->cfg.p_bg))
+    {
+      imp->bad = RTP_FALSE;
+    }
+  }
+  else
+  {
+    if(rtp_impair_chance(imp, imp->cfg.p_gb))
+    {
+      imp->bad = RTP_TRUE;
+    }
+  }
+
+  return rtp_impair_chance(imp, imp->bad ? imp->cfg.loss_bad : imp->cfg.loss_good);
+}
+
+static uint32_t
+rtp_impair_delay(rtp_impair_t* imp)
+{
+  double    d = imp->cfg.delay_ms,
+            sum = 0;
+
+  switch(imp->cfg.delay_dist)
+  {
+  case rtp_impair_delay_uniform:
+    d += (rtp_impair_uniform(imp) * 2 - 1) * imp->cfg.jitter_ms;
+    break;
+
+  case rtp_impair_delay_normal:
+    for(uint32_t i = 0; i < IMPAIR_NORMAL_SUM; i++)
+    {
+      sum += rtp_impair_uniform(imp);
+    }
+    d += (sum - IMPAIR_NORMAL_SUM / 2.) * imp->cfg.jitter_ms;
+    break;
+
+  default:
+    break;
+  }
+
+  return d > 0 ? (uint32_t)(d + 0.5) : 0;
+}
+
+/**
+ * packets with the same due time stay in send order
+ */
+static void
+rtp_impair_enqueue(rtp_impair_t* imp, rtp_impair_slot_t* s)
+{
+  rtp_impair_slot_t*  p;
+
+  list_for_each_entry_reverse(p, &imp->queue, le)
+  {
+    if((int32_t)(p->due - s->due) <= 0)
+    {
+      list_add(&s->le, &p->le);
+      return;
+    }
+  }
+  list_add(&s->le, &imp->queue);
+}
+
+static void
+rtp_impair_queue_one(rtp_impair_t* imp, uint8_t tag, const uint8_t* pkt, uint32_t len, uint32_t now)
+{
+  rtp_impair_slot_t*  s;
+  uint32_t            delay;
+
+  if(list_empty(&imp->free_list))
+  {
+    imp->stats.overflow++;
+    return;
+  }
+
+  delay = rtp_impair_delay(imp);
+  if(rtp_impair_chance(imp, imp->cfg.reorder))
+  {
+    delay += imp->cfg.reorder_ms;
+    imp->stats.reordered++;
+  }
+
+  s = list_first_entry(&imp->free_list, rtp_impair_slot_t, le);
+  list_del_init(&s->le);
+
+  s->due  = now + delay;
+  s->tag  = tag;
+  s->len  = len;
+  memcpy(s->data, pkt, len);
+
+  rtp_impair_enqueue(imp, s);
+  imp->num_queued++;
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtp_impair_init(rtp_impair_t* imp, const rtp_impair_config_t* cfg)
+{
+  memset(&imp->stats, 0, sizeof(imp->stats));
+
+  imp->cfg  = *cfg;
+  imp->rand = cfg->seed != 0 ? cfg->seed : 1;
+  imp->bad  = RTP_FALSE;
+
+  imp->num_queued = 0;
+
+  INIT_LIST_HEAD(&imp->free_list);
+  INIT_LIST_HEAD(&imp->queue);
+
+  for(uint32_t i = 0; i < RTP_CONFIG_IMPAIR_SLOTS; i++)
+  {
+    INIT_LIST_HEAD(&imp->slots[i].le);
+    list_add_tail(&imp->slots[i].le, &imp->free_list);
+  }
+}
+
+void
+rtp_impair_send(rtp_impair_t* imp, uint8_t tag, const uint8_t* pkt, uint32_t len, uint32_t now)
+{
+  imp->stats.sent++;
+
+  if(len > RTP_CONFIG_MAX_RTP_PKT_SIZE)
+  {
+    imp->stats.overflow++;
+    return;
+  }
+
+  if(rtp_impair_lose(imp))
+  {
+    imp->stats.lost++;
+    return;
+  }
+
+  rtp_impair_queue_one(imp, tag, pkt, len, now);
+
+  if(rtp_impair_chance(imp, imp->cfg.duplicate))
+  {
+    imp->stats.duplicated++;
+    rtp_impair_queue_one(imp, tag, pkt, len, now);
+  }
+}
+
+/**
+ * hands every packet due by now to deliver, earliest first.
+ * deliver may call rtp_impair_send() on the same shim
+ *
+ * @return number of packets delivered
+ */
+uint32_t
+rtp_impair_poll(rtp_impair_t* imp, uint32_t now, rtp_impair_deliver_t deliver, void* arg)
+{
+  rtp_impair_slot_t*  s;
+  uint32_t            n = 0;
+
+  while(!list_empty(&imp->queue))
+  {
+    s = list_first_entry(&imp->queue, rtp_impair_slot_t, le);
+    if((int32_t)(s->due - now) > 0)
+    {
+      break;
+    }
+
+    list_del_init(&s->le);
+    imp->num_queued--;
+
+    deliver(arg, s->tag, s->data, s->len);
+
+    list_add_tail(&s->le, &imp->free_list);
+
+    imp->stats.delivered++;
+    n++;
+  }
+  return n;
+}
+
+uint32_t
+rtp_impair_queued(const rtp_impair_t* imp)
+{
+  return imp->num_queued;
+}
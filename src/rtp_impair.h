@@ -0,0 +1,92 @@
+#ifndef __RTP_IMPAIR_DEF_H__
+#define __RTP_IMPAIR_DEF_H__
+
+#include "common_inc.h"
+#include "generic_list.h"
+
+//
+// in-process network impairment between a session's tx_rtp/tx_rtcp
+// and the peer's rx functions.
+//
+// packets given to rtp_impair_send() go through Gilbert-Elliott loss,
+// duplication, a delay drawn from the configured distribution and
+// reordering, then wait in preallocated slots until rtp_impair_poll()
+// hands them to the deliver callback in due time order. a variable
+// delay reorders like a real network does.
+//
+// time is whatever ms clock the caller drives, usually the session
+// tick time. everything is drawn from a private PRNG seeded from the
+// config, so a run is reproducible regardless of other rand users
+//
+typedef enum
+{
+  rtp_impair_delay_constant,      // delay_ms
+  rtp_impair_delay_uniform,       // delay_ms +- jitter_ms
+  rtp_impair_delay_normal,        // mean delay_ms, stddev jitter_ms. clipped at 0
+} rtp_impair_delay_dist_t;
+
+typedef struct
+{
+  // Gilbert-Elliott loss. per packet state transitions and loss
+  // probability in each state, all in [0, 1]. all 0 for no loss.
+  // p_gb 0 and loss_good p gives plain random loss p
+  double                    p_gb;             // good -> bad
+  double                    p_bg;             // bad -> good
+  double                    loss_good;
+  double                    loss_bad;
+
+  rtp_impair_delay_dist_t   delay_dist;
+  uint32_t                  delay_ms;
+  uint32_t                  jitter_ms;
+
+  // a reordered packet is held back reorder_ms more so later ones overtake it
+  double                    reorder;
+  uint32_t                  reorder_ms;
+
+  double                    duplicate;
+
+  uint32_t                  seed;
+} rtp_impair_config_t;
+
+typedef struct
+{
+  uint32_t      sent;
+  uint32_t      lost;
+  uint32_t      duplicated;
+  uint32_t      reordered;
+  uint32_t      delivered;
+  uint32_t      overflow;         // no free slot or larger than a slot
+} rtp_impair_stats_t;
+
+typedef struct
+{
+  struct list_head    le;
+  uint32_t            due;
+  uint8_t             tag;
+  uint16_t            len;
+  uint8_t             data[RTP_CONFIG_MAX_RTP_PKT_SIZE];
+} rtp_impair_slot_t;
+
+typedef struct
+{
+  rtp_impair_config_t   cfg;
+  rtp_impair_stats_t    stats;
+  uint32_t              rand;
+  uint8_t               bad;              // Gilbert-Elliott state
+  struct list_head      free_list;
+  struct list_head      queue;            // ordered by due
+  uint32_t              num_queued;
+  rtp_impair_slot_t     slots[RTP_CONFIG_IMPAIR_SLOTS];
+} rtp_impair_t;
+
+//
+// tag is the caller's packet kind, like RTP or RTCP, handed back as is
+//
+typedef void (*rtp_impair_deliver_t)(void* arg, uint8_t tag, uint8_t* pkt, uint32_t len);
+
+extern void rtp_impair_init(rtp_impair_t* imp, const rtp_impair_config_t* cfg);
+extern void rtp_impair_send(rtp_impair_t* imp, uint8_t tag, const uint8_t* pkt, uint32_t len, uint32_t now);
+extern uint32_t rtp_impair_poll(rtp_impair_t* imp, uint32_t now, rtp_impair_deliver_t deliver, void* arg);
+extern uint32_t rtp_impair_queued(const rtp_impair_t* imp);
+
+#endif /* !__RTP_IMPAIR_DEF_H__ */
@@ -0,0 +1,49 @@
+#include "rtp_media_clock.h"
+#include "rtp_random.h"
+
+void
+rtp_media_clock_init(rtp_media_clock_t* c, uint32_t clock_rate)
+{
+  c->clock_rate = clock_rate;
+  c->offset     = rtp_random32(RTP_CONFIG_RANDOM_TYPE);
+  c->base_ns    = rtp_media_clock_mono_ns();
+}
+
+/**
+ * timestamp at a CLOCK_MONOTONIC time in ns
+ */
+uint32_t
+rtp_media_clock_at(const rtp_media_clock_t* c, uint64_t mono_ns)
+{
+  uint64_t  elapsed = mono_ns - c->base_ns,
+            rate = c->clock_rate;
+
+  // split so that neither product overflows
+  return c->offset + (uint32_t)(elapsed / 1000000000ULL * rate + elapsed % 1000000000ULL * rate / 1000000000ULL);
+}
+
+uint32_t
+rtp_media_clock_now(const rtp_media_clock_t* c)
+{
+  return rtp_media_clock_at(c, rtp_media_clock_mono_ns());
+}
+
+/**
+ * NTP wall clock and RTP timestamp of the same instant for SR.
+ * wall clock is read between two monotonic reads and paired with
+ * their midpoint
+ */
+void
+rtp_media_clock_sample(const rtp_media_clock_t* c, ntp_ts_t* ntp, uint32_t* rtp_ts)
+{
+  struct timespec   wall;
+  uint64_t          before,
+                    after;
+
+  before = rtp_media_clock_mono_ns();
+  clock_gettime(CLOCK_REALTIME, &wall);
+  after  = rtp_media_clock_mono_ns();
+
+  ntp_ts_from_timespec(ntp, &wall);
+  *rtp_ts = rtp_media_clock_at(c, before + (after - before) / 2);
+}
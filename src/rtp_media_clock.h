@@ -0,0 +1,36 @@
+#ifndef __RTP_MEDIA_CLOCK_DEF_H__
+#define __RTP_MEDIA_CLOCK_DEF_H__
+
+#include "common_inc.h"
+#include "ntp_ts.h"
+
+//
+// RTP timestamp from CLOCK_MONOTONIC.
+//
+// timestamp is a random offset plus time since init at clock_rate,
+// RFC 3550 5.1. integer math only, so it neither drifts from the
+// monotonic clock nor jumps with wall clock changes. wraps at 2^32
+// like any RTP timestamp.
+//
+typedef struct
+{
+  uint32_t      clock_rate;       // timestamp units/sec
+  uint32_t      offset;           // timestamp at base_ns
+  uint64_t      base_ns;          // CLOCK_MONOTONIC at init
+} rtp_media_clock_t;
+
+extern void rtp_media_clock_init(rtp_media_clock_t* c, uint32_t clock_rate);
+extern uint32_t rtp_media_clock_at(const rtp_media_clock_t* c, uint64_t mono_ns);
+extern uint32_t rtp_media_clock_now(const rtp_media_clock_t* c);
+extern void rtp_media_clock_sample(const rtp_media_clock_t* c, ntp_ts_t* ntp, uint32_t* rtp_ts);
+
+static inline uint64_t
+rtp_media_clock_mono_ns(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#endif /* !__RTP_MEDIA_CLOCK_DEF_H__ */
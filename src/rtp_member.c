@@ -8,7 +8,80 @@ rtp_member_init(rtp_member_t* m, uint32_t ssrc)
   m->cname[0]   = '\0';
   m->cname_len  = 0;
   m->flags      = 0;
+  m->rtt        = RTP_MEMBER_RTT_UNKNOWN;
+  m->last_heard = 0;
+
+  memset(&m->win, 0, sizeof(m->win));
+
+  memset(m->rtp_errors, 0, sizeof(m->rtp_errors));
+  memset(m->rtcp_errors, 0, sizeof(m->rtcp_errors));
 
   ntp_ts_init(&m->last_sr);
   ntp_ts_init(&m->last_sr_local_time);
 }
+
+void
+rtp_member_window_rotate(rtp_member_t* m)
+{
+  rtp_member_window_t*  w = &m->win;
+  rtp_source_t*         s = &m->rtp_src;
+  uint32_t              ext_max = s->cycles + s->max_seq;
+
+  w->pkts[w->ndx]     = w->cur_pkts;
+  w->octets[w->ndx]   = w->cur_octets;
+
+  // nothing expected before the sequence space is known
+  w->expected[w->ndx] = s->received == 0 || w->ext_max_prior == 0 ? w->cur_pkts : ext_max - w->ext_max_prior;
+  w->ext_max_prior    = s->received == 0 ? 0 : ext_max;
+
+  w->cur_pkts   = 0;
+  w->cur_octets = 0;
+
+  w->ndx = (w->ndx + 1) % RTP_CONFIG_MEMBER_WINDOW_SLOTS;
+  if(w->filled < RTP_CONFIG_MEMBER_WINDOW_SLOTS)
+  {
+    w->filled++;
+  }
+}
+
+/**
+ * rates over the completed slots
+ *
+ * @param pkt_rate packets per second
+ * @param bit_rate payload bits per second
+ * @param loss     lost packets per thousand expected
+ */
+void
+rtp_member_window_rates(rtp_member_t* m, uint32_t* pkt_rate, uint32_t* bit_rate, uint32_t* loss)
+{
+  rtp_member_window_t*  w = &m->win;
+  uint64_t              pkts = 0,
+                        octets = 0,
+                        expected = 0;
+  uint32_t              ms = w->filled * RTP_CONFIG_MEMBER_WINDOW_TICKS * 100;
+
+  *pkt_rate = 0;
+  *bit_rate = 0;
+  *loss     = 0;
+
+  if(w->filled == 0)
+  {
+    return;
+  }
+
+  // unfilled slots are zero
+  for(uint32_t i = 0; i < RTP_CONFIG_MEMBER_WINDOW_SLOTS; i++)
+  {
+    pkts      += w->pkts[i];
+    octets    += w->octets[i];
+    expected  += w->expected[i];
+  }
+
+  *pkt_rate = (uint32_t)(pkts * 1000 / ms);
+  *bit_rate = (uint32_t)(octets * 8 * 1000 / ms);
+
+  if(expected > pkts)
+  {
+    *loss = (uint32_t)((expected - pkts) * 1000 / expected);
+  }
+}
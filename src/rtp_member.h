@@ -6,6 +6,7 @@
 #include "generic_list.h"
 #include "rfc3550.h"
 #include "ntp_ts.h"
+#include "rtp_error.h"
 
 #define RTP_FLAG_SELF                   0x01
 #define RTP_FLAG_RTP_HEARD              0x02
@@ -15,6 +16,25 @@
 #define RTP_FLAG_SENDER                 0x20
 #define RTP_FLAG_CSRC                   0x40
 
+#define RTP_MEMBER_RTT_UNKNOWN          0xffffffff
+
+//
+// sliding window RX counters.
+// RX path only bumps cur_xxx. the session rotates slots on its timer
+//
+typedef struct
+{
+  uint32_t            cur_pkts;
+  uint32_t            cur_octets;
+
+  uint32_t            pkts[RTP_CONFIG_MEMBER_WINDOW_SLOTS];
+  uint32_t            octets[RTP_CONFIG_MEMBER_WINDOW_SLOTS];
+  uint32_t            expected[RTP_CONFIG_MEMBER_WINDOW_SLOTS];
+  uint32_t            ext_max_prior;      // extended highest seq at the last rotation
+  uint8_t             ndx;
+  uint8_t             filled;             // number of valid slots
+} rtp_member_window_t;
+
 typedef struct
 {
   struct list_head    le;
@@ -37,9 +57,30 @@ typedef struct
   uint32_t            rtp_ts;
   uint32_t            pkt_count;
   uint32_t            octet_count;
+
+  // round trip time in 1/65536 sec from this member's report blocks
+  // about our streams. RFC 3550 6.4.1
+  uint32_t            rtt;
+
+  // session tick time in ms of the last valid RTP/RTCP packet
+  uint32_t            last_heard;
+  rtp_member_window_t win;
+
+  // RX drop/event counters by reason. indexed by rtp_rx_error_t/rtcp_rx_error_t
+  uint32_t            rtp_errors[rtp_rx_error_max];
+  uint32_t            rtcp_errors[rtcp_rx_error_max];
 } rtp_member_t;
 
 extern void rtp_member_init(rtp_member_t* m, uint32_t ssrc);
+extern void rtp_member_window_rotate(rtp_member_t* m);
+extern void rtp_member_window_rates(rtp_member_t* m, uint32_t* pkt_rate, uint32_t* bit_rate, uint32_t* loss);
+
+static inline void
+rtp_member_window_count(rtp_member_t* m, uint32_t octets)
+{
+  m->win.cur_pkts++;
+  m->win.cur_octets += octets;
+}
 
 static inline uint8_t
 rtp_member_is_self(rtp_member_t* m)
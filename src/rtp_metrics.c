@@ -0,0 +1,368 @@
+#include "rtp_metrics.h"
+#include "rtp_session_util.h"
+
+typedef enum
+{
+  rtp_metrics_scope_session,
+  rtp_metrics_scope_member,
+  rtp_metrics_scope_rtp_error,
+  rtp_metrics_scope_rtcp_error,
+} rtp_metrics_scope_t;
+
+typedef struct
+{
+  const char*           name;
+  const char*           type;
+  const char*           help;
+  rtp_metrics_scope_t   scope;
+
+  // RTP_FALSE to skip the sample
+  uint8_t (*get)(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v);
+} rtp_metrics_family_t;
+
+////////////////////////////////////////////////////////////
+//
+// value getters
+//
+////////////////////////////////////////////////////////////
+static uint8_t
+get_tx_packets(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = 0;
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    *v += sess->streams[i].tx_pkt_count;
+  }
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_tx_octets(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = 0;
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    *v += sess->streams[i].tx_octet_count;
+  }
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_members(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = sess->rtcp_var.members;
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_senders(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = sess->rtcp_var.senders;
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_rtcp_interval(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = sess->avpf_var.t_rr;
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_fb_queue_full(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = sess->fb_queue_full;
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_rtp_errors(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = sess->rtp_errors[item];
+  return sess->rtp_errors[item] != 0;
+}
+
+static uint8_t
+get_rtcp_errors(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = sess->rtcp_errors[item];
+  return sess->rtcp_errors[item] != 0;
+}
+
+static uint8_t
+get_received(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = m->rtp_src.received;
+  return rtp_member_is_self(m) == RTP_FALSE;
+}
+
+static uint8_t
+get_lost(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  rtp_source_t*   s = &m->rtp_src;
+
+  if(rtp_member_is_self(m) || s->received == 0)
+  {
+    return RTP_FALSE;
+  }
+
+  *v = (int32_t)(s->cycles + s->max_seq - s->base_seq + 1 - s->received);
+  return RTP_TRUE;
+}
+
+static uint8_t
+get_jitter(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = m->rtp_src.jitter;
+  return rtp_member_is_self(m) == RTP_FALSE;
+}
+
+static uint8_t
+get_rtt(rtp_session_t* sess, rtp_member_t* m, uint32_t item, double* v)
+{
+  *v = m->rtt / 65536.0;
+  return m->rtt != RTP_MEMBER_RTT_UNKNOWN;
+}
+
+static const rtp_metrics_family_t _families[] =
+{
+  { "prtp_tx_packets_total",      "counter",  "RTP packets sent",                   rtp_metrics_scope_session,    get_tx_packets },
+  { "prtp_tx_octets_total",       "counter",  "RTP payload octets sent",            rtp_metrics_scope_session,    get_tx_octets },
+  { "prtp_members",               "gauge",    "session members",                    rtp_metrics_scope_session,    get_members },
+  { "prtp_senders",               "gauge",    "session senders",                    rtp_metrics_scope_session,    get_senders },
+  { "prtp_rtcp_interval_seconds", "gauge",    "last calculated RTCP interval",      rtp_metrics_scope_session,    get_rtcp_interval },
+  { "prtp_rtcp_fb_queue_full_total", "counter", "feedback dropped for a full queue", rtp_metrics_scope_session, get_fb_queue_full },
+  { "prtp_rtp_rx_total",          "counter",  "RTP packets received by result",     rtp_metrics_scope_rtp_error,  get_rtp_errors },
+  { "prtp_rtcp_rx_total",         "counter",  "RTCP packets received by result",    rtp_metrics_scope_rtcp_error, get_rtcp_errors },
+  { "prtp_member_rx_packets_total", "counter", "RTP packets received from member",  rtp_metrics_scope_member,     get_received },
+  { "prtp_member_lost_packets",   "gauge",    "cumulative packets lost",            rtp_metrics_scope_member,     get_lost },
+  { "prtp_member_jitter",         "gauge",    "interarrival jitter in timestamp units", rtp_metrics_scope_member, get_jitter },
+  { "prtp_member_rtt_seconds",    "gauge",    "round trip time",                    rtp_metrics_scope_member,     get_rtt },
+};
+
+#define RTP_METRICS_NUM_FAMILIES      (sizeof(_families) / sizeof(_families[0]))
+
+// bounds a call even when most samples are skipped
+#define RTP_METRICS_MAX_STEPS         1024
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static uint32_t
+rtp_metrics_num_items(const rtp_metrics_family_t* f, rtp_session_t* sess)
+{
+  switch(f->scope)
+  {
+  case rtp_metrics_scope_rtp_error:
+    return rtp_rx_error_max;
+  case rtp_metrics_scope_rtcp_error:
+    return rtcp_rx_error_max;
+  default:
+    return 1;
+  }
+}
+
+static inline void
+rtp_metrics_set_member(rtp_metrics_t* mt, rtp_member_t* m)
+{
+  mt->member      = m;
+  mt->member_ssrc = m != NULL ? m->ssrc : 0;
+}
+
+/**
+ * cursor to the first item of the current session
+ */
+static void
+rtp_metrics_cursor_reset(rtp_metrics_t* mt)
+{
+  mt->item = 0;
+
+  if(mt->sess >= mt->num_sessions)
+  {
+    rtp_metrics_set_member(mt, NULL);
+    return;
+  }
+  rtp_metrics_set_member(mt, rtp_member_table_get_first(&mt->sessions[mt->sess]->member_table));
+}
+
+/**
+ * members may have left or changed SSRC since the last call.
+ * if the cursor member is gone, walk to the same position again
+ */
+static void
+rtp_metrics_cursor_revalidate(rtp_metrics_t* mt)
+{
+  rtp_session_t*  sess;
+  rtp_member_t*   m;
+  uint32_t        n = mt->item;
+
+  if(mt->member == NULL || mt->family >= RTP_METRICS_NUM_FAMILIES || mt->sess >= mt->num_sessions ||
+      _families[mt->family].scope != rtp_metrics_scope_member)
+  {
+    return;
+  }
+
+  sess = mt->sessions[mt->sess];
+  if(rtp_member_table_lookup(&sess->member_table, mt->member_ssrc) == mt->member)
+  {
+    return;
+  }
+
+  m = rtp_member_table_get_first(&sess->member_table);
+  while(m != NULL && n-- != 0)
+  {
+    m = rtp_member_table_get_next(&sess->member_table, m);
+  }
+  rtp_metrics_set_member(mt, m);
+}
+
+static inline uint8_t
+rtp_metrics_session_done(rtp_metrics_t* mt, const rtp_metrics_family_t* f)
+{
+  if(f->scope == rtp_metrics_scope_member)
+  {
+    return mt->member == NULL;
+  }
+  return mt->item >= rtp_metrics_num_items(f, mt->sessions[mt->sess]);
+}
+
+static inline void
+rtp_metrics_next_item(rtp_metrics_t* mt, const rtp_metrics_family_t* f)
+{
+  mt->item++;
+
+  if(f->scope == rtp_metrics_scope_member)
+  {
+    rtp_metrics_set_member(mt, rtp_member_table_get_next(&mt->sessions[mt->sess]->member_table, mt->member));
+  }
+}
+
+/**
+ * format a sample at the cursor
+ *
+ * @return line length. 0 to skip. -1 if it doesn't fit
+ */
+static int
+rtp_metrics_format_sample(rtp_metrics_t* mt, const rtp_metrics_family_t* f, char* buf, uint32_t len)
+{
+  rtp_session_t*  sess = mt->sessions[mt->sess];
+  rtp_member_t*   m = NULL;
+  uint32_t        ssrc = sess->self->ssrc;
+  double          v;
+  int             n;
+
+  if(f->scope == rtp_metrics_scope_member)
+  {
+    m     = mt->member;
+    ssrc  = m->ssrc;
+  }
+
+  if(f->get(sess, m, mt->item, &v) == RTP_FALSE)
+  {
+    return 0;
+  }
+
+  switch(f->scope)
+  {
+  case rtp_metrics_scope_rtp_error:
+    n = snprintf(buf, len, "%s{session=\"%u\",ssrc=\"%u\",result=\"%s\"} %.10g\n",
+        f->name, mt->sess, ssrc, rtp_rx_error_str(mt->item), v);
+    break;
+
+  case rtp_metrics_scope_rtcp_error:
+    n = snprintf(buf, len, "%s{session=\"%u\",ssrc=\"%u\",result=\"%s\"} %.10g\n",
+        f->name, mt->sess, ssrc, rtcp_rx_error_str(mt->item), v);
+    break;
+
+  default:
+    n = snprintf(buf, len, "%s{session=\"%u\",ssrc=\"%u\"} %.10g\n", f->name, mt->sess, ssrc, v);
+    break;
+  }
+
+  return n < (int)len ? n : -1;
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtp_metrics_begin(rtp_metrics_t* mt, rtp_session_t** sessions, uint32_t num_sessions)
+{
+  mt->sessions      = sessions;
+  mt->num_sessions  = num_sessions;
+  mt->family        = 0;
+  mt->sess          = 0;
+  mt->header_done   = RTP_FALSE;
+
+  rtp_metrics_cursor_reset(mt);
+}
+
+uint8_t
+rtp_metrics_done(rtp_metrics_t* mt)
+{
+  return mt->family >= RTP_METRICS_NUM_FAMILIES;
+}
+
+/**
+ * continue formatting from where the last call stopped.
+ * all samples of a family are grouped under its HELP/TYPE lines
+ *
+ * @return number of bytes put into buf. may be 0 before done.
+ *         check rtp_metrics_done()
+ */
+uint32_t
+rtp_metrics_format(rtp_metrics_t* mt, char* buf, uint32_t len)
+{
+  const rtp_metrics_family_t* f;
+  uint32_t                    off = 0;
+  int                         n;
+
+  rtp_metrics_cursor_revalidate(mt);
+
+  for(uint32_t step = 0; step < RTP_METRICS_MAX_STEPS && mt->family < RTP_METRICS_NUM_FAMILIES; step++)
+  {
+    f = &_families[mt->family];
+
+    if(mt->header_done == RTP_FALSE)
+    {
+      n = snprintf(&buf[off], len - off, "# HELP %s %s\n# TYPE %s %s\n", f->name, f->help, f->name, f->type);
+      if(n >= (int)(len - off))
+      {
+        break;
+      }
+      off += n;
+      mt->header_done = RTP_TRUE;
+      continue;
+    }
+
+    if(mt->sess >= mt->num_sessions)
+    {
+      mt->family++;
+      mt->sess        = 0;
+      mt->header_done = RTP_FALSE;
+      rtp_metrics_cursor_reset(mt);
+      continue;
+    }
+
+    if(rtp_metrics_session_done(mt, f))
+    {
+      mt->sess++;
+      rtp_metrics_cursor_reset(mt);
+      continue;
+    }
+
+    n = rtp_metrics_format_sample(mt, f, &buf[off], len - off);
+    if(n < 0)
+    {
+      break;
+    }
+    off += n;
+    rtp_metrics_next_item(mt, f);
+  }
+
+  return off;
+}
@@ -0,0 +1,34 @@
+#ifndef __RTP_METRICS_DEF_H__
+#define __RTP_METRICS_DEF_H__
+
+#include "rtp_session.h"
+
+//
+// text exposition of session/member counters for pull based scrapers.
+//
+// the output is produced incrementally. each rtp_metrics_format() call
+// does a bounded amount of work, fills at most len bytes with whole lines
+// and remembers where it stopped, so a large scrape can be spread over
+// many event loop iterations.
+// sessions must stay alive until the scrape is done. members coming and
+// going between calls may be missed or reported twice.
+//
+typedef struct
+{
+  rtp_session_t**   sessions;
+  uint32_t          num_sessions;
+
+  // cursor
+  uint32_t          family;
+  uint32_t          sess;
+  uint32_t          item;
+  uint8_t           header_done;
+  rtp_member_t*     member;         // at item for member families. NULL past the last
+  uint32_t          member_ssrc;    // to check member is still there on the next call
+} rtp_metrics_t;
+
+extern void rtp_metrics_begin(rtp_metrics_t* mt, rtp_session_t** sessions, uint32_t num_sessions);
+extern uint32_t rtp_metrics_format(rtp_metrics_t* mt, char* buf, uint32_t len);
+extern uint8_t rtp_metrics_done(rtp_metrics_t* mt);
+
+#endif /* !__RTP_METRICS_DEF_H__ */
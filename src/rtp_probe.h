@@ -0,0 +1,52 @@
+#ifndef __RTP_PROBE_DEF_H__
+#define __RTP_PROBE_DEF_H__
+
+#include "rtp_config.h"
+
+//
+// static probe points for perf/bpftrace/systemtap.
+//
+// with sys/sdt.h, each probe is a single nop plus an ELF note describing
+// where its arguments live. nothing is evaluated until a tracer attaches.
+// without sys/sdt.h or with RTP_CONFIG_PROBE 0, probes compile to nothing.
+//
+// provider is prtp. list them with
+//    perf list sdt_prtp:*
+//    bpftrace -l 'usdt:./petra_rtp:prtp:*'
+//
+// probe                 arguments
+// rtp_accept            sess, ssrc, seq, payload_len
+// rtp_reject            sess, rtp_rx_error_t, ssrc or 0
+// rtcp_block            sess, pt, count, len
+// rtcp_reject           sess, rtcp_rx_error_t, len
+// member_alloc          sess, ssrc, member or NULL on failure
+// member_free           sess, ssrc
+// ssrc_conflict         sess, ssrc, 1 own/0 third party, 0 by RTP/1 by RTCP
+// rtcp_schedule         sess, delay in ms, 0 schedule/1 reschedule
+// rtcp_timeout          sess, 0 regular/1 early
+// member_timeout        sess, ssrc, 0 member/1 sender/2 leave
+//
+#if RTP_CONFIG_PROBE == 1 && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define RTP_PROBE_SDT
+#endif
+#endif
+
+#ifdef RTP_PROBE_SDT
+
+#define RTP_PROBE1(name, a0)                    DTRACE_PROBE1(prtp, name, a0)
+#define RTP_PROBE2(name, a0, a1)                DTRACE_PROBE2(prtp, name, a0, a1)
+#define RTP_PROBE3(name, a0, a1, a2)            DTRACE_PROBE3(prtp, name, a0, a1, a2)
+#define RTP_PROBE4(name, a0, a1, a2, a3)        DTRACE_PROBE4(prtp, name, a0, a1, a2, a3)
+
+#else
+
+#define RTP_PROBE1(name, a0)                    do { } while(0)
+#define RTP_PROBE2(name, a0, a1)                do { } while(0)
+#define RTP_PROBE3(name, a0, a1, a2)            do { } while(0)
+#define RTP_PROBE4(name, a0, a1, a2, a3)        do { } while(0)
+
+#endif
+
+#endif /* !__RTP_PROBE_DEF_H__ */
@@ -0,0 +1,58 @@
+#include "rtp_prof.h"
+
+static rtp_prof_t   _process_prof;
+
+static const char* _stage_names[rtp_prof_stage_max] =
+{
+  [rtp_prof_stage_rtp_rx]             = "rtp_rx",
+  [rtp_prof_stage_rtcp_rx]            = "rtcp_rx",
+  [rtp_prof_stage_rtcp_send_report]   = "rtcp_send_report",
+  [rtp_prof_stage_timer_tick]         = "timer_tick",
+  [rtp_prof_stage_cb_rx_rtp]          = "cb_rx_rtp",
+  [rtp_prof_stage_cb_tx_rtp]          = "cb_tx_rtp",
+  [rtp_prof_stage_cb_tx_rtcp]         = "cb_tx_rtcp",
+};
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtp_prof_init(rtp_prof_t* p)
+{
+  memset(p, 0, sizeof(rtp_prof_t));
+}
+
+void
+rtp_prof_record(rtp_prof_t* p, rtp_prof_stage_t stage, uint64_t ticks)
+{
+  rtp_prof_hist_t*    h = &p->hist[stage];
+
+  h->count++;
+  h->sum += ticks;
+  if(ticks > h->max)
+  {
+    h->max = ticks;
+  }
+  h->buckets[rtp_prof_bucket(ticks)]++;
+}
+
+const char*
+rtp_prof_stage_name(rtp_prof_stage_t stage)
+{
+  if(stage >= rtp_prof_stage_max)
+  {
+    return "unknown";
+  }
+  return _stage_names[stage];
+}
+
+/**
+ * aggregate of all the sessions in the process
+ */
+rtp_prof_t*
+rtp_prof_process(void)
+{
+  return &_process_prof;
+}
@@ -0,0 +1,93 @@
+#ifndef __RTP_PROF_DEF_H__
+#define __RTP_PROF_DEF_H__
+
+#include "common_inc.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//
+// stage latency histograms.
+// a stage is timed with a cheap cycle counter and the elapsed ticks
+// are put into log2 buckets. bucket n holds [2^(n-1), 2^n) ticks
+//
+#define RTP_PROF_BUCKETS              32
+
+typedef enum
+{
+  rtp_prof_stage_rtp_rx = 0,
+  rtp_prof_stage_rtcp_rx,
+  rtp_prof_stage_rtcp_send_report,
+  rtp_prof_stage_timer_tick,
+  rtp_prof_stage_cb_rx_rtp,
+  rtp_prof_stage_cb_tx_rtp,
+  rtp_prof_stage_cb_tx_rtcp,
+  rtp_prof_stage_max,
+} rtp_prof_stage_t;
+
+typedef struct
+{
+  uint32_t          count;
+  uint64_t          sum;
+  uint64_t          max;
+  uint32_t          buckets[RTP_PROF_BUCKETS];
+} rtp_prof_hist_t;
+
+typedef struct
+{
+  rtp_prof_hist_t   hist[rtp_prof_stage_max];
+} rtp_prof_t;
+
+extern void rtp_prof_init(rtp_prof_t* p);
+extern void rtp_prof_record(rtp_prof_t* p, rtp_prof_stage_t stage, uint64_t ticks);
+extern const char* rtp_prof_stage_name(rtp_prof_stage_t stage);
+extern rtp_prof_t* rtp_prof_process(void);
+
+/**
+ * TSC on x86. monotonic clock in ns elsewhere
+ */
+static inline uint64_t
+rtp_prof_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+static inline uint32_t
+rtp_prof_bucket(uint64_t ticks)
+{
+  uint32_t    b;
+
+  if(ticks == 0)
+  {
+    return 0;
+  }
+
+  b = 64 - __builtin_clzll(ticks);
+  return b < RTP_PROF_BUCKETS ? b : RTP_PROF_BUCKETS - 1;
+}
+
+//
+// instrumentation points. compiled out unless RTP_CONFIG_PROFILE is 1
+//
+#if RTP_CONFIG_PROFILE == 1
+#define RTP_PROF_BEGIN(t)                 uint64_t t = rtp_prof_now()
+#define RTP_PROF_END(sess, stage, t)                      \
+{                                                         \
+  uint64_t __d = rtp_prof_now() - (t);                    \
+  rtp_prof_record(&(sess)->prof, stage, __d);             \
+  rtp_prof_record(rtp_prof_process(), stage, __d);        \
+}
+#else
+#define RTP_PROF_BEGIN(t)
+#define RTP_PROF_END(sess, stage, t)
+#endif
+
+#endif /* !__RTP_PROF_DEF_H__ */
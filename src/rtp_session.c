@@ -4,24 +4,68 @@
 #include "rtcp.h"
 #include "rtp_random.h"
 #include "rtp_timers.h"
+#include "rfc5761.h"
+#include "rtp_bundle.h"
 
 ////////////////////////////////////////////////////////////
 //
 // module privates
 //
 ////////////////////////////////////////////////////////////
+static rtp_stream_t*
+rtp_session_init_stream(rtp_session_t* sess, const struct sockaddr_in* rtp_addr, const struct sockaddr_in* rtcp_addr,
+    const uint8_t* cname, uint8_t cname_len)
+{
+  rtp_stream_t*   st;
+  rtp_member_t*   self;
+
+  if(sess->num_streams >= RTP_CONFIG_MAX_STREAMS_PER_SESSION)
+  {
+    return NULL;
+  }
+
+  self = rtp_session_alloc_member(sess, rtp_random32(RTP_CONFIG_RANDOM_TYPE));
+  if(self == NULL)
+  {
+    return NULL;
+  }
+
+  rtp_member_set_self(self);
+  rtp_member_set_cname(self, cname, cname_len);
+
+  memcpy(&self->rtp_addr, rtp_addr, sizeof(struct sockaddr_in));
+  memcpy(&self->rtcp_addr, rtcp_addr, sizeof(struct sockaddr_in));
+
+  st = &sess->streams[sess->num_streams++];
+
+  st->self            = self;
+  st->seq             = (uint16_t)rtp_random32(RTP_CONFIG_RANDOM_TYPE);
+  st->tx_pkt_count    = 0;
+  st->tx_octet_count  = 0;
+
+  return st;
+}
+
 static void
 rtp_session_init_self(rtp_session_t* sess, const struct sockaddr_in* rtp_addr, const struct sockaddr_in* rtcp_addr,
     const uint8_t* cname, uint8_t cname_len)
 {
-  // initialize self
-  sess->self = rtp_session_alloc_member(sess, rtp_random32(RTP_CONFIG_RANDOM_TYPE));
+  // initialize self. stream 0
+  sess->num_streams = 0;
+  sess->self = rtp_session_init_stream(sess, rtp_addr, rtcp_addr, cname, cname_len)->self;
+}
 
-  rtp_member_set_self(sess->self);
-  rtp_member_set_cname(sess->self, cname, cname_len);
+static void
+rtp_session_rotate_windows(rtp_session_t* sess)
+{
+  rtp_member_t*   m;
 
-  memcpy(&sess->self->rtp_addr, rtp_addr, sizeof(struct sockaddr_in));
-  memcpy(&sess->self->rtcp_addr, rtcp_addr, sizeof(struct sockaddr_in));
+  m = rtp_member_table_get_first(&sess->member_table);
+  while(m != NULL)
+  {
+    rtp_member_window_rotate(m);
+    m = rtp_member_table_get_next(&sess->member_table, m);
+  }
 }
 
 ////////////////////////////////////////////////////////////
@@ -38,17 +82,45 @@ rtp_session_init(rtp_session_t* sess, const rtp_session_config_t* config)
   sess->last_rtcp_error   = rtcp_rx_error_no_error;
 
   soft_timer_init(&sess->soft_timer, 100);
+
+  if(config->clock_rate == 0)
+  {
+    sess->config.media_clock = RTP_FALSE;
+  }
+  if(sess->config.media_clock == RTP_TRUE)
+  {
+    rtp_media_clock_init(&sess->media_clock, config->clock_rate);
+  }
+  sess->arrival_clock     = rtp_arrival_clock_unknown;
+  sess->last_arrival_ns   = 0;
+
   rtp_source_conflict_table_init(&sess->src_conflict, &sess->soft_timer);
   rtp_member_table_init(&sess->member_table);
 
   sess->invalid_rtcp_pkt  = 0;
   sess->invalid_rtp_pkt   = 0;
+  sess->unknown_rtcp_pkt  = 0;
+  sess->fb_queue_full     = 0;
+
+  memset(sess->rtp_errors, 0, sizeof(sess->rtp_errors));
+  memset(sess->rtcp_errors, 0, sizeof(sess->rtcp_errors));
+
+  sess->bundle            = NULL;
 
-  sess->seq = (uint16_t)rtp_random32(RTP_CONFIG_RANDOM_TYPE);
+  rtp_trace_init(&sess->trace);
 
-  rtp_session_reset_tx_stats(sess);
+  sess->shm               = NULL;
+  sess->shm_ticks         = 0;
+  sess->win_ticks         = 0;
+  sess->capture           = NULL;
 
-  rtp_session_init_self(sess, &config->rtp_addr, &config->rtcp_addr, config->cname, config->cname_len);
+#if RTP_CONFIG_PROFILE == 1
+  rtp_prof_init(&sess->prof);
+#endif
+
+  rtp_session_init_self(sess, &config->rtp_addr,
+      config->rtcp_mux == RTP_TRUE ? &config->rtp_addr : &config->rtcp_addr,
+      config->cname, config->cname_len);
 
   rtp_init(sess);
   rtcp_init(sess);
@@ -57,8 +129,11 @@ rtp_session_init(rtp_session_t* sess, const rtp_session_config_t* config)
 void
 rtp_session_reset_tx_stats(rtp_session_t* sess)
 {
-  sess->tx_pkt_count      = 0;
-  sess->tx_octet_count    = 0;
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    sess->streams[i].tx_pkt_count    = 0;
+    sess->streams[i].tx_octet_count  = 0;
+  }
 }
 
 void
@@ -66,6 +141,11 @@ rtp_session_deinit(rtp_session_t* sess)
 {
   rtp_member_t*     m;
 
+  if(sess->bundle != NULL)
+  {
+    rtp_bundle_remove(sess->bundle, sess);
+  }
+
   rtp_deinit(sess);
   rtcp_deinit(sess);
 
@@ -79,16 +159,230 @@ rtp_session_deinit(rtp_session_t* sess)
 
   rtp_source_conflict_table_deinit(&sess->src_conflict);
 
+  rtp_session_set_shm(sess, NULL);
+
   soft_timer_deinit(&sess->soft_timer);
 }
 
 int
 rtp_session_tx(rtp_session_t* sess, uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc)
 {
-  rtp_tx(sess, payload, payload_len, rtp_ts, csrc, ncsrc);
+  rtp_tx(sess, &sess->streams[0], payload, payload_len, rtp_ts, csrc, ncsrc);
   return 0;
 }
 
+/**
+ * add a local send stream with a new SSRC
+ *
+ * @return stream index to use with rtp_session_tx_stream(). -1 on failure
+ */
+int
+rtp_session_add_stream(rtp_session_t* sess)
+{
+  rtp_stream_t*   st;
+
+  st = rtp_session_init_stream(sess, &sess->self->rtp_addr, &sess->self->rtcp_addr,
+      sess->self->cname, sess->self->cname_len);
+  if(st == NULL)
+  {
+    return -1;
+  }
+
+  rtcp_interval_handle_rtp_event(sess, RTP_TRUE, RTP_FALSE);
+
+  return (int)(st - &sess->streams[0]);
+}
+
+int
+rtp_session_tx_stream(rtp_session_t* sess, uint32_t stream,
+    uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc)
+{
+  if(stream >= sess->num_streams)
+  {
+    return -1;
+  }
+
+  rtp_tx(sess, &sess->streams[stream], payload, payload_len, rtp_ts, csrc, ncsrc);
+  return 0;
+}
+
+int
+rtp_session_tx_nack(rtp_session_t* sess, uint32_t media_ssrc, uint16_t pid, uint16_t blp)
+{
+  return rtcp_tx_feedback(sess, rtcp_fb_kind_nack, media_ssrc, pid, blp);
+}
+
+int
+rtp_session_tx_pli(rtp_session_t* sess, uint32_t media_ssrc)
+{
+  return rtcp_tx_feedback(sess, rtcp_fb_kind_pli, media_ssrc, 0, 0);
+}
+
+int
+rtp_session_tx_fir(rtp_session_t* sess, uint32_t media_ssrc)
+{
+  return rtcp_tx_feedback(sess, rtcp_fb_kind_fir, media_ssrc, 0, 0);
+}
+
+int
+rtp_session_set_rtcp_handler(rtp_session_t* sess, uint8_t pt, rtcp_rx_handler_t handler)
+{
+  return rtcp_set_handler(sess, pt, handler);
+}
+
+int
+rtp_session_set_app_handler(rtp_session_t* sess, const uint8_t name[4], uint8_t subtype, rtcp_rx_handler_t handler)
+{
+  return rtcp_set_app_handler(sess, name, subtype, handler);
+}
+
+void
+rtp_session_get_stats(rtp_session_t* sess, rtp_session_stats_t* st)
+{
+  st->invalid_rtp_pkt   = sess->invalid_rtp_pkt;
+  st->invalid_rtcp_pkt  = sess->invalid_rtcp_pkt;
+  st->unknown_rtcp_pkt  = sess->unknown_rtcp_pkt;
+
+  memcpy(st->rtp_errors, sess->rtp_errors, sizeof(st->rtp_errors));
+  memcpy(st->rtcp_errors, sess->rtcp_errors, sizeof(st->rtcp_errors));
+}
+
+int
+rtp_session_get_member_stats(rtp_session_t* sess, uint32_t ssrc, rtp_member_stats_t* st)
+{
+  rtp_member_t*   m;
+
+  m = rtp_session_lookup_member(sess, ssrc);
+  if(m == NULL)
+  {
+    return -1;
+  }
+
+  st->ssrc = m->ssrc;
+  st->rtt  = m->rtt;
+
+  rtp_member_window_rates(m, &st->pkt_rate, &st->bit_rate, &st->loss);
+  st->jitter          = (uint32_t)m->rtp_src.jitter;
+  st->last_heard_age  = soft_timer_get_tick_time(&sess->soft_timer) - m->last_heard;
+  memcpy(st->rtp_errors, m->rtp_errors, sizeof(st->rtp_errors));
+  memcpy(st->rtcp_errors, m->rtcp_errors, sizeof(st->rtcp_errors));
+
+  return 0;
+}
+
+int
+rtp_session_set_shm(rtp_session_t* sess, rtp_shm_t* shm)
+{
+  if(sess->shm != NULL)
+  {
+    rtp_shm_free_session(sess->shm);
+    sess->shm = NULL;
+  }
+
+  if(shm == NULL)
+  {
+    return 0;
+  }
+
+  sess->shm = rtp_shm_alloc_session(shm);
+  if(sess->shm == NULL)
+  {
+    return -1;
+  }
+
+  sess->shm_ticks = 0;
+  rtp_session_publish_shm(sess);
+
+  return 0;
+}
+
+void
+rtp_session_set_capture(rtp_session_t* sess, rtp_capture_t* capture)
+{
+  sess->capture = capture;
+}
+
+void
+rtp_session_publish_shm(rtp_session_t* sess)
+{
+  rtp_shm_session_t*  s = sess->shm;
+  rtp_shm_member_t*   sm;
+  rtp_member_t*       m;
+  rtp_source_t*       src;
+
+  if(s == NULL)
+  {
+    return;
+  }
+
+  rtp_shm_write_begin(s);
+
+  s->ssrc             = sess->self->ssrc;
+  s->updated          = soft_timer_get_tick_time(&sess->soft_timer);
+  s->num_streams      = sess->num_streams;
+  s->tx_pkt_count     = 0;
+  s->tx_octet_count   = 0;
+
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    s->tx_pkt_count   += sess->streams[i].tx_pkt_count;
+    s->tx_octet_count += sess->streams[i].tx_octet_count;
+  }
+
+  s->members          = sess->rtcp_var.members;
+  s->senders          = sess->rtcp_var.senders;
+  s->invalid_rtp_pkt  = sess->invalid_rtp_pkt;
+  s->invalid_rtcp_pkt = sess->invalid_rtcp_pkt;
+  s->unknown_rtcp_pkt = sess->unknown_rtcp_pkt;
+
+  memcpy(s->rtp_errors, sess->rtp_errors, sizeof(s->rtp_errors));
+  memcpy(s->rtcp_errors, sess->rtcp_errors, sizeof(s->rtcp_errors));
+
+  s->num_members = 0;
+
+  m = rtp_member_table_get_first(&sess->member_table);
+  while(m != NULL && s->num_members < RTP_CONFIG_MAX_MEMBERS_PER_SESSION)
+  {
+    sm  = &s->member[s->num_members++];
+    src = &m->rtp_src;
+
+    sm->ssrc      = m->ssrc;
+    sm->flags     = m->flags;
+    sm->received  = src->received;
+    sm->expected  = src->received == 0 ? 0 : src->cycles + src->max_seq - src->base_seq + 1;
+    sm->lost      = (int32_t)(sm->expected - sm->received);
+    sm->jitter    = (uint32_t)src->jitter;
+    sm->rtt_us    = m->rtt == RTP_MEMBER_RTT_UNKNOWN ?
+                      RTP_SHM_RTT_UNKNOWN : (uint32_t)(((uint64_t)m->rtt * 1000000) >> 16);
+
+    memcpy(sm->rtp_errors, m->rtp_errors, sizeof(sm->rtp_errors));
+    memcpy(sm->rtcp_errors, m->rtcp_errors, sizeof(sm->rtcp_errors));
+
+    m = rtp_member_table_get_next(&sess->member_table, m);
+  }
+
+  rtp_shm_write_end(s);
+}
+
+int
+rtp_session_get_prof(rtp_session_t* sess, rtp_prof_t* prof)
+{
+#if RTP_CONFIG_PROFILE == 1
+  memcpy(prof, &sess->prof, sizeof(rtp_prof_t));
+  return 0;
+#else
+  return -1;
+#endif
+}
+
+void
+rtp_session_reset_prof(rtp_session_t* sess)
+{
+#if RTP_CONFIG_PROFILE == 1
+  rtp_prof_init(&sess->prof);
+#endif
+}
+
 int
 rtp_session_bye(rtp_session_t* sess)
 {
@@ -99,7 +393,14 @@ rtp_session_bye(rtp_session_t* sess)
 void
 rtp_session_rx_rtp(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
 {
-  rtp_rx(sess, pkt, len, from);
+  rtp_rx(sess, pkt, len, from, 0);
+}
+
+void
+rtp_session_rx_rtp_at(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns)
+{
+  rtp_rx(sess, pkt, len, from, arrival_ns);
 }
 
 void
@@ -108,8 +409,52 @@ rtp_session_rx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sock
   rtcp_rx(sess, pkt, len, from);
 }
 
+/**
+ * RX entry for a transport with RTP and RTCP multiplexed. RFC 5761
+ */
+void
+rtp_session_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from)
+{
+  if(rtcp_mux_is_rtcp(pkt, len) == RTP_TRUE)
+  {
+    rtcp_rx(sess, pkt, len, from);
+    return;
+  }
+
+  rtp_rx(sess, pkt, len, from, 0);
+}
+
+void
+rtp_session_rx_at(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns)
+{
+  if(rtcp_mux_is_rtcp(pkt, len) == RTP_TRUE)
+  {
+    rtcp_rx(sess, pkt, len, from);
+    return;
+  }
+
+  rtp_rx(sess, pkt, len, from, arrival_ns);
+}
+
 void
 rtp_session_timer_tick(rtp_session_t* sess)
 {
+  RTP_PROF_BEGIN(t);
+
   soft_timer_drive(&sess->soft_timer);
+
+  if(++sess->win_ticks >= RTP_CONFIG_MEMBER_WINDOW_TICKS)
+  {
+    sess->win_ticks = 0;
+    rtp_session_rotate_windows(sess);
+  }
+
+  if(sess->shm != NULL && ++sess->shm_ticks >= RTP_CONFIG_SHM_PUBLISH_TICKS)
+  {
+    sess->shm_ticks = 0;
+    rtp_session_publish_shm(sess);
+  }
+
+  RTP_PROF_END(sess, rtp_prof_stage_timer_tick, t);
 }
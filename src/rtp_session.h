@@ -7,9 +7,44 @@
 #include "rtp_member_table.h"
 #include "rtp_source_conflict.h"
 #include "rtp_error.h"
+#include "rtcp_fb.h"
+#include "rtcp_reader.h"
+#include "rtcp_encoder.h"
+#include "rfc5761.h"
+#include "rtp_trace.h"
+#include "rtp_prof.h"
+#include "rtp_shm.h"
+#include "rtp_capture.h"
+#include "rtp_media_clock.h"
 
 struct __rtp_session_t;
 typedef struct __rtp_session_t rtp_session_t;
+struct __rtp_bundle_t;
+
+//
+// RTCP packet handler. v is valid only during the call
+//
+typedef void (*rtcp_rx_handler_t)(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from);
+
+#define RTCP_PT_TABLE_SIZE          (RTCP_MUX_PT_MAX - RTCP_MUX_PT_MIN + 1)
+
+typedef struct
+{
+  uint8_t             used;
+  uint8_t             subtype;
+  uint32_t            name;
+  rtcp_rx_handler_t   handler;
+} rtcp_app_handler_t;
+
+//
+// clock RTP arrival times come from. decided by the first RTP packet
+//
+typedef enum
+{
+  rtp_arrival_clock_unknown,
+  rtp_arrival_clock_transport,      // arrival_ns from the transport
+  rtp_arrival_clock_local,          // rtp_timestamp() at processing time
+} rtp_arrival_clock_t;
 
 typedef struct
 {
@@ -21,15 +56,61 @@ typedef struct
   uint8_t       ncsrc;
 } rtp_rx_report_t;
 
+//
+// RX counter snapshots
+//
+typedef struct
+{
+  uint32_t      invalid_rtp_pkt;
+  uint32_t      invalid_rtcp_pkt;
+  uint32_t      unknown_rtcp_pkt;
+  uint32_t      rtp_errors[rtp_rx_error_max];
+  uint32_t      rtcp_errors[rtcp_rx_error_max];
+} rtp_session_stats_t;
+
+typedef struct
+{
+  uint32_t      ssrc;
+  uint32_t      rtt;              // 1/65536 sec. RTP_MEMBER_RTT_UNKNOWN if none
+
+  // over the last RTP_CONFIG_MEMBER_WINDOW_SLOTS slots
+  uint32_t      pkt_rate;         // packets/sec
+  uint32_t      bit_rate;         // payload bits/sec
+  uint32_t      loss;             // per thousand expected
+  uint32_t      jitter;           // timestamp units
+  uint32_t      last_heard_age;   // ms since the last valid RTP/RTCP packet
+
+  uint32_t      rtp_errors[rtp_rx_error_max];
+  uint32_t      rtcp_errors[rtcp_rx_error_max];
+} rtp_member_stats_t;
+
+//
+// a local send stream with its own SSRC, sequence space and SR counters.
+// stream 0 is the session's own SSRC, that is sess->self
+//
+typedef struct
+{
+  rtp_member_t*         self;
+  uint16_t              seq;
+  uint32_t              tx_pkt_count;
+  uint32_t              tx_octet_count;
+} rtp_stream_t;
+
 typedef struct
 {
   struct sockaddr_in    rtp_addr;
   struct sockaddr_in    rtcp_addr;
-  uint32_t              session_bw;
+  uint32_t              session_bw;       // bits/sec. RTCP gets 5% of it
   uint8_t               cname[256 + 16];
   uint8_t               cname_len;
   uint8_t               pt;
   uint8_t               align_by_4;
+  uint8_t               avpf;             // RTP/AVPF profile. enables early RTCP feedback
+  uint32_t              t_rr_interval;    // AVPF minimal interval between regular RTCP packets in ms. 0 to disable
+  uint8_t               rtcp_rsize;       // reduced-size RTCP negotiated. RFC 5506
+  uint8_t               rtcp_mux;         // RTP and RTCP share rtp_addr. rtcp_addr is ignored. RFC 5761
+  uint32_t              clock_rate;       // RTP timestamp units/sec. 0 if not known
+  uint8_t               media_clock;      // RTP timestamp from built-in media clock at clock_rate. rtp_timestamp not called
 } rtp_session_config_t;
 
 struct __rtp_session_t
@@ -45,8 +126,15 @@ struct __rtp_session_t
   //
   int (*rx_rtp)(rtp_session_t* sess, rtp_rx_report_t* rpt);
   uint32_t (*rtp_timestamp)(rtp_session_t* sess);
-  void (*sr_rpt)(rtp_session_t* sess, uint32_t from_ssrc, rtcp_t* r);
-  void (*rr_rpt)(rtp_session_t* sess, uint32_t from_ssrc, rtcp_rr_t* rr);
+  void (*sr_rpt)(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_sr_info_t* sr);
+  void (*rr_rpt)(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_rr_info_t* rr);
+
+  // optional. RTPFB/PSFB feedback messages. fmt is feedback message type. fci in network order
+  void (*fb_rpt)(rtp_session_t* sess, uint32_t from_ssrc, uint32_t media_ssrc,
+                 uint8_t pt, uint8_t fmt, const uint8_t* fci, uint32_t fci_len);
+
+  // optional. append APP packets to a regular RTCP compound packet
+  void (*tx_app)(rtp_session_t* sess, rtcp_encoder_t* enc);
 
   //
   // transport layer services for network I/O
@@ -61,13 +149,31 @@ struct __rtp_session_t
   ////////////////////////////////////////////////////////////
   SoftTimer   soft_timer;
 
+  ////////////////////////////////////////////////////////////
+  //
+  // built-in media clock. config.media_clock
+  //
+  ////////////////////////////////////////////////////////////
+  rtp_media_clock_t   media_clock;
+
+  // jitter arrival clock. last_arrival_ns stands in for a missing one
+  rtp_arrival_clock_t arrival_clock;
+  uint64_t            last_arrival_ns;
+
   ////////////////////////////////////////////////////////////
   //
   // RTP packet
   //
   ////////////////////////////////////////////////////////////
-  uint8_t             rtp_pkt[RTP_CONFIG_AVERAGE_RTCP_SIZE];
-  uint16_t            seq;
+  uint8_t             rtp_pkt[RTP_CONFIG_MAX_RTP_PKT_SIZE];
+
+  ////////////////////////////////////////////////////////////
+  //
+  // local send streams
+  //
+  ////////////////////////////////////////////////////////////
+  rtp_stream_t        streams[RTP_CONFIG_MAX_STREAMS_PER_SESSION];
+  uint32_t            num_streams;
 
   ////////////////////////////////////////////////////////////
   //
@@ -78,6 +184,34 @@ struct __rtp_session_t
   rtcp_control_var_t    rtcp_var;
   SoftTimerElem         rtcp_timer;
 
+  // report blocks go round robin when senders don't fit in a report.
+  // SSRC of the sender the next report starts at
+  uint32_t              rr_next_ssrc;
+
+  ////////////////////////////////////////////////////////////
+  //
+  // RTCP feedback. RFC 4585
+  //
+  ////////////////////////////////////////////////////////////
+  rtcp_avpf_var_t       avpf_var;
+  SoftTimerElem         rtcp_early_timer;
+  rtcp_fb_queue_t       fb_queue;
+
+  ////////////////////////////////////////////////////////////
+  //
+  // RTCP RX dispatch. indexed by packet type and APP name/subtype
+  //
+  ////////////////////////////////////////////////////////////
+  rtcp_rx_handler_t     rtcp_handlers[RTCP_PT_TABLE_SIZE];
+  rtcp_app_handler_t    app_handlers[RTP_CONFIG_RTCP_APP_TABLE_SIZE];
+
+  ////////////////////////////////////////////////////////////
+  //
+  // bundle this session belongs to. NULL if not bundled
+  //
+  ////////////////////////////////////////////////////////////
+  struct __rtp_bundle_t*  bundle;
+
   ////////////////////////////////////////////////////////////
   //
   // how am I gonna call it? interesting
@@ -99,12 +233,49 @@ struct __rtp_session_t
   ////////////////////////////////////////////////////////////
   uint32_t            invalid_rtcp_pkt;
   uint32_t            invalid_rtp_pkt;
+  uint32_t            unknown_rtcp_pkt;     // no handler for packet type or APP name/subtype
+  uint32_t            fb_queue_full;        // feedback dropped for a full queue
 
   rtp_rx_error_t      last_rtp_error;
   rtcp_rx_error_t     last_rtcp_error;
 
-  uint32_t            tx_pkt_count;
-  uint32_t            tx_octet_count;
+  // by reason. no_error counts accepted RTP/RTCP compound packets
+  uint32_t            rtp_errors[rtp_rx_error_max];
+  uint32_t            rtcp_errors[rtcp_rx_error_max];
+
+  ////////////////////////////////////////////////////////////
+  //
+  // event trace
+  //
+  ////////////////////////////////////////////////////////////
+  rtp_trace_t         trace;
+
+#if RTP_CONFIG_PROFILE == 1
+  ////////////////////////////////////////////////////////////
+  //
+  // stage latency histograms
+  //
+  ////////////////////////////////////////////////////////////
+  rtp_prof_t          prof;
+#endif
+
+  ////////////////////////////////////////////////////////////
+  //
+  // shared memory stats slot. NULL if not published
+  //
+  ////////////////////////////////////////////////////////////
+  rtp_shm_session_t*  shm;
+  uint32_t            shm_ticks;
+
+  // member sliding window rotation
+  uint32_t            win_ticks;
+
+  ////////////////////////////////////////////////////////////
+  //
+  // packet capture ring. NULL if disarmed
+  //
+  ////////////////////////////////////////////////////////////
+  rtp_capture_t*      capture;
 
   ////////////////////////////////////////////////////////////
   //
@@ -123,12 +294,78 @@ extern void rtp_session_reset_tx_stats(rtp_session_t* sess);
 
 extern int rtp_session_bye(rtp_session_t* sess);
 extern int rtp_session_tx(rtp_session_t* sess, uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc);
+
+//
+// additional local send streams. all of them are reported in one RTCP compound
+//
+extern int rtp_session_add_stream(rtp_session_t* sess);
+extern int rtp_session_tx_stream(rtp_session_t* sess, uint32_t stream,
+    uint8_t* payload, uint32_t payload_len, uint32_t rtp_ts, uint32_t* csrc, uint8_t ncsrc);
+
+//
+// RTCP feedback requests.
+// with AVPF, these are sent in an early RTCP packet if allowed.
+// Otherwise, they are sent with the next regular RTCP packet.
+//
+extern int rtp_session_tx_nack(rtp_session_t* sess, uint32_t media_ssrc, uint16_t pid, uint16_t blp);
+extern int rtp_session_tx_pli(rtp_session_t* sess, uint32_t media_ssrc);
+extern int rtp_session_tx_fir(rtp_session_t* sess, uint32_t media_ssrc);
+
+//
+// RTCP RX handlers for packet types the library doesn't handle
+// and for APP packets by name and subtype. NULL handler to remove.
+// with a bundle, packet type handlers of the bundle primary are used
+// and APP packets go to the session the sender SSRC belongs to.
+//
+extern int rtp_session_set_rtcp_handler(rtp_session_t* sess, uint8_t pt, rtcp_rx_handler_t handler);
+extern int rtp_session_set_app_handler(rtp_session_t* sess, const uint8_t name[4], uint8_t subtype, rtcp_rx_handler_t handler);
  
+//
+// RX counters by reason
+//
+extern void rtp_session_get_stats(rtp_session_t* sess, rtp_session_stats_t* st);
+extern int rtp_session_get_member_stats(rtp_session_t* sess, uint32_t ssrc, rtp_member_stats_t* st);
+
+//
+// stage latency histograms. -1 if RTP_CONFIG_PROFILE is off
+//
+extern int rtp_session_get_prof(rtp_session_t* sess, rtp_prof_t* prof);
+extern void rtp_session_reset_prof(rtp_session_t* sess);
+
+//
+// publish counters into a shared memory region every
+// RTP_CONFIG_SHM_PUBLISH_TICKS. NULL shm to stop publishing
+//
+extern int rtp_session_set_shm(rtp_session_t* sess, rtp_shm_t* shm);
+extern void rtp_session_publish_shm(rtp_session_t* sess);
+
+//
+// capture RX/TX packets into a ring. a capture can be shared by sessions
+// driven from the same thread. NULL to disarm
+//
+extern void rtp_session_set_capture(rtp_session_t* sess, rtp_capture_t* capture);
+
 //
 // RX events from transport
 //
 extern void rtp_session_rx_rtp(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from);
 extern void rtp_session_rx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from);
+// rtcp-mux. RTP or RTCP is classified by packet type
+extern void rtp_session_rx(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from);
+
+//
+// same as above with the time the packet arrived in ns, like from
+// SO_TIMESTAMPNS. jitter is computed from it converted with
+// config.clock_rate, instead of rtp_timestamp() at processing time,
+// so time spent waiting for us doesn't show up as network jitter.
+// any clock will do but stick to one per session. the first RTP packet
+// decides. with arrival_ns, a later 0 reuses the last arrival_ns. with
+// 0 arrival_ns or 0 clock_rate, it's rtp_timestamp() for the session
+//
+extern void rtp_session_rx_rtp_at(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns);
+extern void rtp_session_rx_at(rtp_session_t* sess, uint8_t* pkt, uint32_t len, struct sockaddr_in* from,
+    uint64_t arrival_ns);
 
 //
 // 100ms tick event from library user
@@ -7,6 +7,9 @@ rtp_session_alloc_member(rtp_session_t* sess, uint32_t ssrc)
   rtp_member_t*   m;
 
   m = rtp_member_table_alloc_member(&sess->member_table, ssrc);
+
+  RTP_PROBE3(member_alloc, sess, ssrc, m);
+
   if(m == NULL)
   {
     return NULL;
@@ -14,12 +17,17 @@ rtp_session_alloc_member(rtp_session_t* sess, uint32_t ssrc)
 
   rtp_timers_init_member(sess, m);
 
+  // a member is allocated when first heard
+  m->last_heard = soft_timer_get_tick_time(&sess->soft_timer);
+
   return m;
 }
 
 void
 rtp_session_dealloc_member(rtp_session_t* sess, rtp_member_t* m)
 {
+  RTP_PROBE2(member_free, sess, m->ssrc);
+
   rtp_timers_deinit_member(sess, m);
 
   rtp_member_table_free(&sess->member_table, m);
@@ -40,5 +48,99 @@ rtp_session_timestamp(rtp_session_t* sess)
   // basically RTP timestamp is
   // RTP timestamp += (sampling rate / (frames per sec))
   //
+  if(sess->config.media_clock == RTP_TRUE)
+  {
+    return rtp_media_clock_now(&sess->media_clock);
+  }
   return sess->rtp_timestamp(sess);
 }
+
+/**
+ * NTP and RTP timestamps of the same instant for SR
+ */
+void
+rtp_session_sr_timestamp(rtp_session_t* sess, ntp_ts_t* ntp, uint32_t* rtp_ts)
+{
+  if(sess->config.media_clock == RTP_TRUE)
+  {
+    rtp_media_clock_sample(&sess->media_clock, ntp, rtp_ts);
+    return;
+  }
+
+  ntp_ts_now(ntp);
+  *rtp_ts = sess->rtp_timestamp(sess);
+}
+
+/**
+ * arrival time in RTP timestamp units. only differences matter for
+ * jitter, so the result is modulo 2^32 on the arrival clock's epoch.
+ * the two clocks have different epochs so one is used for the whole
+ * session
+ */
+uint32_t
+rtp_session_arrival_timestamp(rtp_session_t* sess, uint64_t arrival_ns)
+{
+  uint64_t  rate = sess->config.clock_rate;
+
+  if(sess->arrival_clock == rtp_arrival_clock_unknown)
+  {
+    sess->arrival_clock = (arrival_ns == 0 || rate == 0) ?
+      rtp_arrival_clock_local : rtp_arrival_clock_transport;
+  }
+
+  if(sess->arrival_clock == rtp_arrival_clock_local)
+  {
+    return rtp_session_timestamp(sess);
+  }
+
+  if(arrival_ns == 0)
+  {
+    // transport missed one. closest we know on the same clock
+    arrival_ns = sess->last_arrival_ns;
+  }
+  sess->last_arrival_ns = arrival_ns;
+
+  // split so that neither product overflows
+  return (uint32_t)(arrival_ns / 1000000000ULL * rate + arrival_ns % 1000000000ULL * rate / 1000000000ULL);
+}
+
+rtp_stream_t*
+rtp_session_lookup_stream(rtp_session_t* sess, rtp_member_t* self)
+{
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    if(sess->streams[i].self == self)
+    {
+      return &sess->streams[i];
+    }
+  }
+  return NULL;
+}
+
+void
+rtp_session_reset_stream_tx_stats(rtp_session_t* sess, rtp_member_t* self)
+{
+  rtp_stream_t*   st = rtp_session_lookup_stream(sess, self);
+
+  if(st != NULL)
+  {
+    st->tx_pkt_count    = 0;
+    st->tx_octet_count  = 0;
+  }
+}
+
+/**
+ * @return RTP_TRUE if any of local send streams is a sender
+ */
+uint8_t
+rtp_session_is_sending(rtp_session_t* sess)
+{
+  for(uint32_t i = 0; i < sess->num_streams; i++)
+  {
+    if(rtp_member_is_sender(sess->streams[i].self) == RTP_TRUE)
+    {
+      return RTP_TRUE;
+    }
+  }
+  return RTP_FALSE;
+}
@@ -2,10 +2,65 @@
 #define __RTP_SESSION_UTIL_DEF_H__
 
 #include "rtp_session.h"
+#include "rtp_probe.h"
 
 extern rtp_member_t* rtp_session_alloc_member(rtp_session_t* sess, uint32_t ssrc);
 extern void rtp_session_dealloc_member(rtp_session_t* sess, rtp_member_t* m);
 extern rtp_member_t* rtp_session_lookup_member(rtp_session_t* sess, uint32_t ssrc);
 extern uint32_t rtp_session_timestamp(rtp_session_t* sess);
+extern uint32_t rtp_session_arrival_timestamp(rtp_session_t* sess, uint64_t arrival_ns);
+extern void rtp_session_sr_timestamp(rtp_session_t* sess, ntp_ts_t* ntp, uint32_t* rtp_ts);
+extern rtp_stream_t* rtp_session_lookup_stream(rtp_session_t* sess, rtp_member_t* self);
+extern void rtp_session_reset_stream_tx_stats(rtp_session_t* sess, rtp_member_t* self);
+extern uint8_t rtp_session_is_sending(rtp_session_t* sess);
+
+//
+// record an RX result. m is the member the packet is accounted to. NULL if none
+//
+static inline void
+rtp_session_rtp_error(rtp_session_t* sess, rtp_member_t* m, rtp_rx_error_t err)
+{
+  sess->last_rtp_error = err;
+  sess->rtp_errors[err]++;
+  if(m != NULL)
+  {
+    m->rtp_errors[err]++;
+  }
+
+  if(err != rtp_rx_error_no_error)
+  {
+    RTP_PROBE3(rtp_reject, sess, err, m != NULL ? m->ssrc : 0);
+  }
+}
+
+static inline void
+rtp_session_rtcp_error(rtp_session_t* sess, rtp_member_t* m, rtcp_rx_error_t err)
+{
+  sess->last_rtcp_error = err;
+  sess->rtcp_errors[err]++;
+  if(m != NULL)
+  {
+    m->rtcp_errors[err]++;
+  }
+}
+
+static inline void
+rtp_session_trace(rtp_session_t* sess, uint32_t ev, uint32_t a0, uint32_t a1)
+{
+  rtp_trace_put(&sess->trace, soft_timer_get_tick_time(&sess->soft_timer), ev, a0, a1);
+}
+
+//
+// copy a packet into the attached capture ring. a single branch if none
+//
+static inline void
+rtp_session_capture(rtp_session_t* sess, uint8_t dir, uint8_t rtcp, const uint8_t* pkt, uint32_t len,
+    const struct sockaddr_in* src, const struct sockaddr_in* dst)
+{
+  if(sess->capture != NULL)
+  {
+    rtp_capture_pkt(sess->capture, dir, rtcp, pkt, len, src, dst);
+  }
+}
 
 #endif /* !__RTP_SESSION_UTIL_DEF_H__ */
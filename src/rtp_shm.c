@@ -0,0 +1,218 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rtp_shm.h"
+
+static const char* TAG = "shm";
+
+#define RTP_SHM_READ_RETRY        64
+
+////////////////////////////////////////////////////////////
+//
+// module privates
+//
+////////////////////////////////////////////////////////////
+static void
+rtp_shm_init_region(rtp_shm_region_t* r)
+{
+  memset(r, 0, sizeof(rtp_shm_region_t));
+
+  r->version        = RTP_SHM_VERSION;
+  r->size           = sizeof(rtp_shm_region_t);
+  r->max_sessions   = RTP_CONFIG_SHM_MAX_SESSIONS;
+  r->max_members    = RTP_CONFIG_MAX_MEMBERS_PER_SESSION;
+  r->rtp_error_max  = rtp_rx_error_max;
+  r->rtcp_error_max = rtcp_rx_error_max;
+
+  for(uint32_t i = 0; i < RTP_CONFIG_SHM_MAX_SESSIONS; i++)
+  {
+    r->session[i].id = i;
+  }
+
+  // magic goes last. readers ignore the region until then
+  __atomic_store_n(&r->magic, RTP_SHM_MAGIC, __ATOMIC_RELEASE);
+}
+
+static int
+rtp_shm_check_region(const rtp_shm_region_t* r)
+{
+  if(__atomic_load_n(&r->magic, __ATOMIC_ACQUIRE) != RTP_SHM_MAGIC ||
+     r->version != RTP_SHM_VERSION ||
+     r->size != sizeof(rtp_shm_region_t) ||
+     r->max_sessions != RTP_CONFIG_SHM_MAX_SESSIONS ||
+     r->max_members != RTP_CONFIG_MAX_MEMBERS_PER_SESSION ||
+     r->rtp_error_max != rtp_rx_error_max ||
+     r->rtcp_error_max != rtcp_rx_error_max)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+static int
+rtp_shm_map(rtp_shm_t* shm, const char* name, uint8_t owner)
+{
+  int     fd;
+  void*   p;
+
+  fd = shm_open(name, owner ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  if(fd < 0)
+  {
+    RTPLOGE(TAG, "shm_open %s failed\n", name);
+    return -1;
+  }
+
+  if(owner && ftruncate(fd, sizeof(rtp_shm_region_t)) != 0)
+  {
+    RTPLOGE(TAG, "ftruncate %s failed\n", name);
+    close(fd);
+    return -1;
+  }
+
+  p = mmap(NULL, sizeof(rtp_shm_region_t), owner ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if(p == MAP_FAILED)
+  {
+    RTPLOGE(TAG, "mmap %s failed\n", name);
+    return -1;
+  }
+
+  shm->region = (rtp_shm_region_t*)p;
+  shm->owner  = owner;
+  snprintf(shm->name, sizeof(shm->name), "%s", name);
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+/**
+ * create the named region. an existing one is reinitialized
+ */
+int
+rtp_shm_create(rtp_shm_t* shm, const char* name)
+{
+  if(rtp_shm_map(shm, name, RTP_TRUE) != 0)
+  {
+    return -1;
+  }
+
+  rtp_shm_init_region(shm->region);
+  return 0;
+}
+
+/**
+ * use memory provided by caller. for a monitor in the same process
+ */
+void
+rtp_shm_init(rtp_shm_t* shm, rtp_shm_region_t* region)
+{
+  shm->region   = region;
+  shm->owner    = RTP_FALSE;
+  shm->name[0]  = '\0';
+
+  rtp_shm_init_region(region);
+}
+
+/**
+ * map an existing region read-only. fails on a layout mismatch
+ */
+int
+rtp_shm_open(rtp_shm_t* shm, const char* name)
+{
+  if(rtp_shm_map(shm, name, RTP_FALSE) != 0)
+  {
+    return -1;
+  }
+
+  if(rtp_shm_check_region(shm->region) != 0)
+  {
+    RTPLOGE(TAG, "%s layout mismatch\n", name);
+    rtp_shm_close(shm);
+    return -1;
+  }
+  return 0;
+}
+
+void
+rtp_shm_close(rtp_shm_t* shm)
+{
+  if(shm->name[0] != '\0')
+  {
+    munmap(shm->region, sizeof(rtp_shm_region_t));
+    if(shm->owner)
+    {
+      shm_unlink(shm->name);
+    }
+  }
+  shm->region = NULL;
+}
+
+rtp_shm_session_t*
+rtp_shm_alloc_session(rtp_shm_t* shm)
+{
+  rtp_shm_session_t*  s;
+
+  for(uint32_t i = 0; i < RTP_CONFIG_SHM_MAX_SESSIONS; i++)
+  {
+    s = &shm->region->session[i];
+
+    if(s->in_use == RTP_FALSE)
+    {
+      rtp_shm_write_begin(s);
+      s->in_use       = RTP_TRUE;
+      s->num_members  = 0;
+      rtp_shm_write_end(s);
+      return s;
+    }
+  }
+
+  RTPLOGE(TAG, "no free session slot\n");
+  return NULL;
+}
+
+void
+rtp_shm_free_session(rtp_shm_session_t* s)
+{
+  rtp_shm_write_begin(s);
+  s->in_use = RTP_FALSE;
+  rtp_shm_write_end(s);
+}
+
+/**
+ * copy a consistent snapshot of a session slot
+ *
+ * @return 0 on success. -1 if the writer kept the slot busy
+ */
+int
+rtp_shm_read_session(const rtp_shm_session_t* s, rtp_shm_session_t* out)
+{
+  uint32_t    seq1,
+              seq2;
+
+  for(uint32_t i = 0; i < RTP_SHM_READ_RETRY; i++)
+  {
+    seq1 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    if((seq1 & 1) != 0)
+    {
+      continue;
+    }
+
+    memcpy(out, s, sizeof(rtp_shm_session_t));
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    seq2 = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+
+    if(seq1 == seq2)
+    {
+      return 0;
+    }
+  }
+  return -1;
+}
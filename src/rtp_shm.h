@@ -0,0 +1,110 @@
+#ifndef __RTP_SHM_DEF_H__
+#define __RTP_SHM_DEF_H__
+
+#include "common_inc.h"
+#include "rtp_error.h"
+
+//
+// session and member counters published into shared memory
+// for external monitors like prtp_top.
+//
+// the library is the single writer. each session slot is protected
+// by a sequence lock. sequence is odd while the slot is being written.
+// readers never block the writer and retry when the sequence moved.
+//
+// bump RTP_SHM_VERSION on any layout change
+//
+#define RTP_SHM_MAGIC             0x50525450      // "PRTP"
+#define RTP_SHM_VERSION           1
+#define RTP_SHM_DEFAULT_NAME      "/prtp_stats"
+
+#define RTP_SHM_RTT_UNKNOWN       0xffffffff
+
+typedef struct
+{
+  uint32_t      ssrc;
+  uint32_t      flags;            // RTP_FLAG_XXX
+  uint32_t      received;         // RTP packets received
+  uint32_t      expected;         // RTP packets expected from sequence numbers
+  int32_t       lost;             // cumulative number of packets lost
+  uint32_t      jitter;           // interarrival jitter in timestamp units
+  uint32_t      rtt_us;           // RTP_SHM_RTT_UNKNOWN if none
+  uint32_t      rtp_errors[rtp_rx_error_max];
+  uint32_t      rtcp_errors[rtcp_rx_error_max];
+} rtp_shm_member_t;
+
+typedef struct
+{
+  uint32_t      seq;              // sequence lock
+  uint32_t      in_use;
+  uint32_t      id;               // slot index
+  uint32_t      ssrc;             // session's own SSRC
+  uint32_t      updated;          // session tick time in ms of the last publish
+
+  uint32_t      tx_pkt_count;     // sum over local send streams
+  uint32_t      tx_octet_count;
+  uint32_t      num_streams;
+
+  uint32_t      members;
+  uint32_t      senders;
+
+  uint32_t      invalid_rtp_pkt;
+  uint32_t      invalid_rtcp_pkt;
+  uint32_t      unknown_rtcp_pkt;
+  uint32_t      rtp_errors[rtp_rx_error_max];
+  uint32_t      rtcp_errors[rtcp_rx_error_max];
+
+  uint32_t          num_members;
+  rtp_shm_member_t  member[RTP_CONFIG_MAX_MEMBERS_PER_SESSION];
+} rtp_shm_session_t;
+
+typedef struct
+{
+  uint32_t      magic;
+  uint32_t      version;
+  uint32_t      size;             // sizeof(rtp_shm_region_t)
+  uint32_t      max_sessions;
+  uint32_t      max_members;
+  uint32_t      rtp_error_max;
+  uint32_t      rtcp_error_max;
+
+  rtp_shm_session_t   session[RTP_CONFIG_SHM_MAX_SESSIONS];
+} rtp_shm_region_t;
+
+typedef struct
+{
+  rtp_shm_region_t*   region;
+  uint8_t             owner;
+  char                name[64];
+} rtp_shm_t;
+
+//
+// writer side
+//
+extern int rtp_shm_create(rtp_shm_t* shm, const char* name);
+extern void rtp_shm_init(rtp_shm_t* shm, rtp_shm_region_t* region);
+extern rtp_shm_session_t* rtp_shm_alloc_session(rtp_shm_t* shm);
+extern void rtp_shm_free_session(rtp_shm_session_t* s);
+
+//
+// reader side
+//
+extern int rtp_shm_open(rtp_shm_t* shm, const char* name);
+extern int rtp_shm_read_session(const rtp_shm_session_t* s, rtp_shm_session_t* out);
+
+extern void rtp_shm_close(rtp_shm_t* shm);
+
+static inline void
+rtp_shm_write_begin(rtp_shm_session_t* s)
+{
+  __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void
+rtp_shm_write_end(rtp_shm_session_t* s)
+{
+  __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+}
+
+#endif /* !__RTP_SHM_DEF_H__ */
@@ -30,6 +30,8 @@ __rtp_timers_member_timedout(SoftTimerElem* te)
   rtp_session_t*    sess = (rtp_session_t*)te->priv;
   rtp_member_t*     m = container_of(te, rtp_member_t, member_te);
 
+  RTP_PROBE3(member_timeout, sess, m->ssrc, 0);
+
   rtcp_interval_member_timedout(sess, m);
 }
 
@@ -39,6 +41,8 @@ __rtp_timers_sender_timedout(SoftTimerElem* te)
   rtp_session_t*    sess = (rtp_session_t*)te->priv;
   rtp_member_t*     m = container_of(te, rtp_member_t, sender_te);
 
+  RTP_PROBE3(member_timeout, sess, m->ssrc, 1);
+
   rtcp_interval_sender_timedout(sess, m);
 }
 
@@ -48,6 +52,8 @@ __rtp_timers_leave_timedout(SoftTimerElem* te)
   rtp_session_t*    sess = (rtp_session_t*)te->priv;
   rtp_member_t*     m = container_of(te, rtp_member_t, leave_te);
 
+  RTP_PROBE3(member_timeout, sess, m->ssrc, 2);
+
   rtp_session_dealloc_member(sess, m);
 }
 
@@ -112,7 +118,7 @@ rtp_timers_sender_restart(rtp_session_t* sess, rtp_member_t* m)
 void
 rtp_timers_member_start(rtp_session_t* sess, rtp_member_t* m)
 {
-  soft_timer_add(&sess->soft_timer, &m->member_te, RTP_CONFIG_MEMBER_TIMEOUT);
+  soft_timer_add(&sess->soft_timer, &m->member_te, sess->rtcp_var.member_timeout);
 }
 
 void
@@ -125,7 +131,7 @@ void
 rtp_timers_member_restart(rtp_session_t* sess, rtp_member_t* m)
 {
   soft_timer_del(&sess->soft_timer, &m->member_te);
-  soft_timer_add(&sess->soft_timer, &m->member_te, RTP_CONFIG_MEMBER_TIMEOUT);
+  soft_timer_add(&sess->soft_timer, &m->member_te, sess->rtcp_var.member_timeout);
 }
 
 ////////////////////////////////////////////////////////////
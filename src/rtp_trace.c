@@ -0,0 +1,123 @@
+#include "rtp_trace.h"
+
+static const char* _ev_names[rtp_trace_ev_max] =
+{
+  [rtp_trace_ev_none]                 = "none",
+  [rtp_trace_ev_rtcp_rx]              = "rtcp_rx",
+  [rtp_trace_ev_rtcp_rx_invalid]      = "rtcp_rx_invalid",
+  [rtp_trace_ev_rtcp_tx]              = "rtcp_tx",
+  [rtp_trace_ev_rtcp_fb_tx]           = "rtcp_fb_tx",
+  [rtp_trace_ev_rtcp_reschedule]      = "rtcp_reschedule",
+  [rtp_trace_ev_rtcp_member_add]      = "rtcp_member_add",
+  [rtp_trace_ev_rtcp_sender_del]      = "rtcp_sender_del",
+  [rtp_trace_ev_rtcp_member_del]      = "rtcp_member_del",
+  [rtp_trace_ev_rtcp_bye_rx]          = "rtcp_bye_rx",
+  [rtp_trace_ev_rtp_rx_invalid]       = "rtp_rx_invalid",
+  [rtp_trace_ev_ssrc_conflict]        = "ssrc_conflict",
+  [rtp_trace_ev_member_alloc_failed]  = "member_alloc_failed",
+};
+
+static const char* _ev_fmts[rtp_trace_ev_max] =
+{
+  [rtp_trace_ev_none]                 = "",
+  [rtp_trace_ev_rtcp_rx]              = "len %u rsize %u",
+  [rtp_trace_ev_rtcp_rx_invalid]      = "error %u len %u",
+  [rtp_trace_ev_rtcp_tx]              = "len %u",
+  [rtp_trace_ev_rtcp_fb_tx]           = "len %u",
+  [rtp_trace_ev_rtcp_reschedule]      = "tc %u tn %u",
+  [rtp_trace_ev_rtcp_member_add]      = "members %u",
+  [rtp_trace_ev_rtcp_sender_del]      = "senders %u",
+  [rtp_trace_ev_rtcp_member_del]      = "members %u",
+  [rtp_trace_ev_rtcp_bye_rx]          = "ssrc %u sender %u",
+  [rtp_trace_ev_rtp_rx_invalid]       = "error %u detail %u",
+  [rtp_trace_ev_ssrc_conflict]        = "ssrc %u rtcp %u",
+  [rtp_trace_ev_member_alloc_failed]  = "ssrc %u rtcp %u",
+};
+
+////////////////////////////////////////////////////////////
+//
+// public interfaces
+//
+////////////////////////////////////////////////////////////
+void
+rtp_trace_init(rtp_trace_t* t)
+{
+  memset(t->recs, 0, sizeof(t->recs));
+  t->head = 0;
+}
+
+/**
+ * copy the latest records, oldest first.
+ * records the writer may have overwritten during the copy are dropped.
+ * so a full ring gives at most RTP_CONFIG_TRACE_RING_SIZE - 1 records
+ *
+ * @return number of records copied
+ */
+uint32_t
+rtp_trace_snapshot(const rtp_trace_t* t, rtp_trace_rec_t* out, uint32_t max)
+{
+  uint32_t    head,
+              tail,
+              start,
+              n;
+
+  head = __atomic_load_n(&t->head, __ATOMIC_ACQUIRE);
+
+  n = head < RTP_CONFIG_TRACE_RING_SIZE ? head : RTP_CONFIG_TRACE_RING_SIZE;
+  n = n < max ? n : max;
+  start = head - n;
+
+  for(uint32_t i = 0; i < n; i++)
+  {
+    out[i] = t->recs[(start + i) & (RTP_CONFIG_TRACE_RING_SIZE - 1)];
+  }
+
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  tail = __atomic_load_n(&t->head, __ATOMIC_RELAXED);
+
+  //
+  // record tail - RTP_CONFIG_TRACE_RING_SIZE + 1 and later are safe
+  // even with the writer busy with the slot of record tail
+  //
+  if(tail - start >= RTP_CONFIG_TRACE_RING_SIZE)
+  {
+    uint32_t drop = tail - start - RTP_CONFIG_TRACE_RING_SIZE + 1;
+
+    if(drop >= n)
+    {
+      return 0;
+    }
+    memmove(&out[0], &out[drop], (n - drop) * sizeof(rtp_trace_rec_t));
+    n -= drop;
+  }
+  return n;
+}
+
+const char*
+rtp_trace_ev_name(uint32_t ev)
+{
+  if(ev >= rtp_trace_ev_max)
+  {
+    return "unknown";
+  }
+  return _ev_names[ev];
+}
+
+/**
+ * format a record into a line of text. works on raw records dumped offline
+ *
+ * @return same as snprintf
+ */
+int
+rtp_trace_format(const rtp_trace_rec_t* r, char* buf, uint32_t len)
+{
+  int     n;
+
+  n = snprintf(buf, len, "%u.%03u %s ", r->ts / 1000, r->ts % 1000, rtp_trace_ev_name(r->ev));
+  if(n < 0 || (uint32_t)n >= len || r->ev >= rtp_trace_ev_max)
+  {
+    return n;
+  }
+
+  return n + snprintf(&buf[n], len - n, _ev_fmts[r->ev], r->a0, r->a1);
+}
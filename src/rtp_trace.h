@@ -0,0 +1,71 @@
+#ifndef __RTP_TRACE_DEF_H__
+#define __RTP_TRACE_DEF_H__
+
+#include "common_inc.h"
+
+//
+// binary event trace ring.
+// records are written by the session without any formatting or I/O.
+// formatting happens only when somebody reads the ring.
+//
+typedef enum
+{
+  rtp_trace_ev_none = 0,
+  rtp_trace_ev_rtcp_rx,               // a0 : len,        a1 : reduced-size
+  rtp_trace_ev_rtcp_rx_invalid,       // a0 : error,      a1 : len
+  rtp_trace_ev_rtcp_tx,               // a0 : len
+  rtp_trace_ev_rtcp_fb_tx,            // a0 : len
+  rtp_trace_ev_rtcp_reschedule,       // a0 : tc in ms,   a1 : tn in ms
+  rtp_trace_ev_rtcp_member_add,       // a0 : members
+  rtp_trace_ev_rtcp_sender_del,       // a0 : senders
+  rtp_trace_ev_rtcp_member_del,       // a0 : members
+  rtp_trace_ev_rtcp_bye_rx,           // a0 : ssrc,       a1 : was a sender
+  rtp_trace_ev_rtp_rx_invalid,        // a0 : error,      a1 : detail
+  rtp_trace_ev_ssrc_conflict,         // a0 : ssrc,       a1 : 0 by RTP, 1 by RTCP
+  rtp_trace_ev_member_alloc_failed,   // a0 : ssrc,       a1 : 0 by RTP, 1 by RTCP
+  rtp_trace_ev_max,
+} rtp_trace_ev_t;
+
+typedef struct
+{
+  uint32_t          ts;               // session tick time in ms
+  uint32_t          ev;
+  uint32_t          a0;
+  uint32_t          a1;
+} rtp_trace_rec_t;
+
+//
+// single writer. readers take a consistent snapshot with
+// rtp_trace_snapshot() without locking the writer
+//
+typedef struct
+{
+  rtp_trace_rec_t   recs[RTP_CONFIG_TRACE_RING_SIZE];
+  uint32_t          head;             // number of records ever written
+} rtp_trace_t;
+
+extern void rtp_trace_init(rtp_trace_t* t);
+extern uint32_t rtp_trace_snapshot(const rtp_trace_t* t, rtp_trace_rec_t* out, uint32_t max);
+extern const char* rtp_trace_ev_name(uint32_t ev);
+extern int rtp_trace_format(const rtp_trace_rec_t* r, char* buf, uint32_t len);
+
+static inline void
+rtp_trace_put(rtp_trace_t* t, uint32_t ts, uint32_t ev, uint32_t a0, uint32_t a1)
+{
+#if RTP_CONFIG_TRACE == 1
+  uint32_t          head = t->head;
+  rtp_trace_rec_t*  r = &t->recs[head & (RTP_CONFIG_TRACE_RING_SIZE - 1)];
+
+  r->ts = ts;
+  r->ev = ev;
+  r->a0 = a0;
+  r->a1 = a1;
+
+  // publish the record
+  __atomic_store_n(&t->head, head + 1, __ATOMIC_RELEASE);
+#else
+  (void)t; (void)ts; (void)ev; (void)a0; (void)a1;
+#endif
+}
+
+#endif /* !__RTP_TRACE_DEF_H__ */
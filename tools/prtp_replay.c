@@ -0,0 +1,811 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+
+#include "rtp_session.h"
+#include "rtp_member_table.h"
+#include "rfc5761.h"
+
+//
+// replays RTP/RTCP traffic from a pcap or pcapng file into a session.
+// only IPv4/UDP is picked up. session timer is ticked from capture
+// timestamps, so member timeouts and RTCP intervals follow the capture
+// whether it's replayed at full speed or at original timing
+//
+#define PCAP_MAGIC_USEC             0xa1b2c3d4
+#define PCAP_MAGIC_NSEC             0xa1b23c4d
+#define PCAPNG_SHB                  0x0a0d0d0a
+#define PCAPNG_IDB                  0x00000001
+#define PCAPNG_SPB                  0x00000003
+#define PCAPNG_EPB                  0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC     0x1a2b3c4d
+#define PCAPNG_OPT_IF_TSRESOL       9
+#define PCAPNG_MAX_INTERFACES       16
+
+#define LINKTYPE_NULL               0
+#define LINKTYPE_ETHERNET           1
+#define LINKTYPE_RAW                101
+#define LINKTYPE_LOOP               108
+#define LINKTYPE_LINUX_SLL          113
+#define LINKTYPE_IPV4               228
+#define LINKTYPE_LINUX_SLL2         276
+
+#define REPLAY_MAX_PKT              (256 * 1024)
+#define REPLAY_TICK_NS              100000000ULL
+
+typedef struct
+{
+  uint32_t      linktype;
+  uint64_t      ts_per_sec;
+} replay_intf_t;
+
+typedef struct
+{
+  FILE*           fp;
+  uint8_t         pcapng;
+  uint8_t         swap;
+  replay_intf_t   intf[PCAPNG_MAX_INTERFACES];
+  uint32_t        num_intf;
+  uint64_t        last_ts;
+  uint8_t         buf[REPLAY_MAX_PKT];
+} replay_file_t;
+
+typedef struct
+{
+  uint64_t            ts;               // ns
+  uint32_t            linktype;
+  const uint8_t*      data;
+  uint32_t            caplen;
+  uint32_t            len;
+} replay_pkt_t;
+
+typedef struct
+{
+  uint64_t      frames;
+  uint64_t      rtp;
+  uint64_t      rtcp;
+  uint64_t      not_udp;
+  uint64_t      fragments;
+  uint64_t      truncated;
+  uint64_t      filtered;
+  uint64_t      rtcp_tx;
+  uint64_t      ticks;
+} replay_counts_t;
+
+static replay_file_t      _file;
+static rtp_session_t      _sess;
+static replay_counts_t    _counts;
+
+static uint16_t           _port = 0;          // 0 to take any UDP port
+static uint8_t            _mux = RTP_FALSE;
+static int                _pt = -1;
+static uint32_t           _clock_rate = 8000;
+static uint8_t            _realtime = RTP_FALSE;
+
+static uint64_t           _ts_base;
+static uint64_t           _ts_now;
+
+////////////////////////////////////////////////////////////
+//
+// capture file reader
+//
+////////////////////////////////////////////////////////////
+static inline uint32_t
+u32(uint32_t v)
+{
+  return _file.swap ? __builtin_bswap32(v) : v;
+}
+
+static inline uint16_t
+u16(uint16_t v)
+{
+  return _file.swap ? __builtin_bswap16(v) : v;
+}
+
+static int
+replay_read(void* buf, uint32_t len)
+{
+  return fread(buf, 1, len, _file.fp) == len ? 0 : -1;
+}
+
+static int
+replay_open_pcap(uint32_t magic)
+{
+  uint8_t     hdr[20];
+
+  if(replay_read(hdr, sizeof(hdr)) != 0)
+  {
+    return -1;
+  }
+
+  _file.swap = (magic == __builtin_bswap32(PCAP_MAGIC_USEC) || magic == __builtin_bswap32(PCAP_MAGIC_NSEC));
+  magic = u32(magic);
+
+  _file.num_intf            = 1;
+  _file.intf[0].linktype    = u32(*(uint32_t*)&hdr[16]) & 0xffff;
+  _file.intf[0].ts_per_sec  = magic == PCAP_MAGIC_NSEC ? 1000000000ULL : 1000000ULL;
+  return 0;
+}
+
+static void
+replay_pcapng_idb(const uint8_t* body, uint32_t len)
+{
+  replay_intf_t*  intf;
+  uint32_t        off = 8;
+  uint16_t        code,
+                  olen;
+
+  if(_file.num_intf >= PCAPNG_MAX_INTERFACES || len < 8)
+  {
+    return;
+  }
+
+  intf = &_file.intf[_file.num_intf++];
+
+  intf->linktype    = u16(*(uint16_t*)&body[0]);
+  intf->ts_per_sec  = 1000000ULL;
+
+  while(off + 4 <= len)
+  {
+    code = u16(*(uint16_t*)&body[off]);
+    olen = u16(*(uint16_t*)&body[off + 2]);
+
+    if(code == 0 || off + 4 + olen > len)
+    {
+      break;
+    }
+
+    if(code == PCAPNG_OPT_IF_TSRESOL && olen >= 1)
+    {
+      uint8_t   r = body[off + 4];
+
+      intf->ts_per_sec = 1;
+      for(uint8_t i = 0; i < (r & 0x7f); i++)
+      {
+        intf->ts_per_sec *= (r & 0x80) ? 2 : 10;
+      }
+    }
+
+    off += 4 + ((olen + 3) & ~3);
+  }
+}
+
+static uint64_t
+replay_ts_ns(uint64_t ts, uint64_t per_sec)
+{
+  return ts / per_sec * 1000000000ULL + ts % per_sec * 1000000000ULL / per_sec;
+}
+
+/**
+ * @return 1 with a packet, 0 at the end of file, -1 on error
+ */
+static int
+replay_next_pcapng(replay_pkt_t* p)
+{
+  uint32_t    hdr[2],
+              type,
+              len,
+              body_len;
+  uint8_t*    body = _file.buf;
+
+  while(1)
+  {
+    if(replay_read(hdr, sizeof(hdr)) != 0)
+    {
+      return 0;
+    }
+
+    if(hdr[0] == PCAPNG_SHB)
+    {
+      uint32_t  bom;
+
+      // byte order may change per section
+      if(replay_read(&bom, 4) != 0)
+      {
+        return -1;
+      }
+      _file.swap      = bom == __builtin_bswap32(PCAPNG_BYTE_ORDER_MAGIC);
+      _file.num_intf  = 0;
+
+      // rest of the block after type, length and byte order magic
+      len = u32(hdr[1]);
+      if(len < 28 || len - 12 > REPLAY_MAX_PKT || replay_read(body, len - 12) != 0)
+      {
+        return -1;
+      }
+      continue;
+    }
+
+    type = u32(hdr[0]);
+    len  = u32(hdr[1]);
+
+    if(len < 12 || len - 8 > REPLAY_MAX_PKT)
+    {
+      return -1;
+    }
+
+    // body and trailing length
+    if(replay_read(body, len - 8) != 0)
+    {
+      return -1;
+    }
+    body_len = len - 12;
+
+    switch(type)
+    {
+    case PCAPNG_IDB:
+      replay_pcapng_idb(body, body_len);
+      break;
+
+    case PCAPNG_EPB:
+      {
+        uint32_t  id = u32(*(uint32_t*)&body[0]);
+        uint64_t  ts = ((uint64_t)u32(*(uint32_t*)&body[4]) << 32) | u32(*(uint32_t*)&body[8]);
+
+        if(body_len < 20 || id >= _file.num_intf)
+        {
+          return -1;
+        }
+
+        p->caplen   = u32(*(uint32_t*)&body[12]);
+        p->len      = u32(*(uint32_t*)&body[16]);
+        p->data     = &body[20];
+        p->linktype = _file.intf[id].linktype;
+        p->ts       = replay_ts_ns(ts, _file.intf[id].ts_per_sec);
+
+        if(p->caplen > body_len - 20)
+        {
+          return -1;
+        }
+
+        _file.last_ts = p->ts;
+        return 1;
+      }
+
+    case PCAPNG_SPB:
+      if(body_len < 4 || _file.num_intf == 0)
+      {
+        return -1;
+      }
+
+      // no timestamp. the last one is used
+      p->len      = u32(*(uint32_t*)&body[0]);
+      p->caplen   = p->len < body_len - 4 ? p->len : body_len - 4;
+      p->data     = &body[4];
+      p->linktype = _file.intf[0].linktype;
+      p->ts       = _file.last_ts;
+      return 1;
+
+    default:
+      break;
+    }
+  }
+}
+
+static int
+replay_next_pcap(replay_pkt_t* p)
+{
+  uint32_t    hdr[4];
+
+  if(replay_read(hdr, sizeof(hdr)) != 0)
+  {
+    return 0;
+  }
+
+  p->caplen = u32(hdr[2]);
+  p->len    = u32(hdr[3]);
+
+  if(p->caplen > REPLAY_MAX_PKT || replay_read(_file.buf, p->caplen) != 0)
+  {
+    return -1;
+  }
+
+  p->data     = _file.buf;
+  p->linktype = _file.intf[0].linktype;
+  p->ts       = (uint64_t)u32(hdr[0]) * 1000000000ULL +
+                (uint64_t)u32(hdr[1]) * (1000000000ULL / _file.intf[0].ts_per_sec);
+  return 1;
+}
+
+static int
+replay_open(const char* path)
+{
+  uint32_t    magic;
+
+  _file.fp = fopen(path, "rb");
+  if(_file.fp == NULL)
+  {
+    return -1;
+  }
+
+  if(replay_read(&magic, 4) != 0)
+  {
+    return -1;
+  }
+
+  if(magic == PCAPNG_SHB)
+  {
+    _file.pcapng = RTP_TRUE;
+    rewind(_file.fp);
+    return 0;
+  }
+
+  if(magic == PCAP_MAGIC_USEC || magic == PCAP_MAGIC_NSEC ||
+     magic == __builtin_bswap32(PCAP_MAGIC_USEC) || magic == __builtin_bswap32(PCAP_MAGIC_NSEC))
+  {
+    return replay_open_pcap(magic);
+  }
+
+  return -1;
+}
+
+static int
+replay_next(replay_pkt_t* p)
+{
+  return _file.pcapng ? replay_next_pcapng(p) : replay_next_pcap(p);
+}
+
+////////////////////////////////////////////////////////////
+//
+// link/IP/UDP decoding
+//
+////////////////////////////////////////////////////////////
+
+/**
+ * @return offset of the IPv4 header. -1 if not IPv4
+ */
+static int
+replay_l2_skip(const replay_pkt_t* p)
+{
+  const uint8_t*  d = p->data;
+  uint32_t        off;
+  uint16_t        proto;
+
+  switch(p->linktype)
+  {
+  case LINKTYPE_ETHERNET:
+    off = 12;
+    do
+    {
+      if(p->caplen < off + 2)
+      {
+        return -1;
+      }
+      proto = (d[off] << 8) | d[off + 1];
+      off  += 2;
+
+      // VLAN tags
+      if(proto == 0x8100 || proto == 0x88a8)
+      {
+        off += 2;
+        continue;
+      }
+      break;
+    } while(1);
+    return proto == 0x0800 ? off : -1;
+
+  case LINKTYPE_LINUX_SLL:
+    return p->caplen >= 16 && ((d[14] << 8) | d[15]) == 0x0800 ? 16 : -1;
+
+  case LINKTYPE_LINUX_SLL2:
+    return p->caplen >= 20 && ((d[0] << 8) | d[1]) == 0x0800 ? 20 : -1;
+
+  case LINKTYPE_NULL:
+  case LINKTYPE_LOOP:
+    // address family in either byte order
+    return p->caplen >= 4 && (d[0] == AF_INET || d[3] == AF_INET) ? 4 : -1;
+
+  case LINKTYPE_RAW:
+  case LINKTYPE_IPV4:
+    return 0;
+
+  default:
+    return -1;
+  }
+}
+
+/**
+ * @return UDP payload length. -1 to skip the frame
+ */
+static int
+replay_decode(const replay_pkt_t* p, const uint8_t** payload,
+    struct sockaddr_in* src, struct sockaddr_in* dst)
+{
+  const uint8_t*  ip;
+  const uint8_t*  udp;
+  int             off;
+  uint32_t        ihl,
+                  udp_len;
+
+  off = replay_l2_skip(p);
+  if(off < 0 || p->caplen < off + 20)
+  {
+    _counts.not_udp++;
+    return -1;
+  }
+
+  ip  = p->data + off;
+  ihl = (ip[0] & 0x0f) * 4;
+
+  if((ip[0] >> 4) != 4 || ip[9] != IPPROTO_UDP || ihl < 20 || p->caplen < off + ihl + 8)
+  {
+    _counts.not_udp++;
+    return -1;
+  }
+
+  // more fragments or non zero offset
+  if(((ip[6] << 8) | ip[7]) & 0x3fff)
+  {
+    _counts.fragments++;
+    return -1;
+  }
+
+  udp     = ip + ihl;
+  udp_len = (udp[4] << 8) | udp[5];
+
+  if(udp_len < 8 || p->caplen < off + ihl + udp_len)
+  {
+    _counts.truncated++;
+    return -1;
+  }
+
+  memset(src, 0, sizeof(*src));
+  memset(dst, 0, sizeof(*dst));
+
+  src->sin_family = AF_INET;
+  dst->sin_family = AF_INET;
+  memcpy(&src->sin_addr.s_addr, &ip[12], 4);
+  memcpy(&dst->sin_addr.s_addr, &ip[16], 4);
+  memcpy(&src->sin_port, &udp[0], 2);
+  memcpy(&dst->sin_port, &udp[2], 2);
+
+  *payload = udp + 8;
+  return udp_len - 8;
+}
+
+////////////////////////////////////////////////////////////
+//
+// session
+//
+////////////////////////////////////////////////////////////
+static int
+replay_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
+{
+  return 0;
+}
+
+static uint32_t
+replay_rtp_timestamp(rtp_session_t* sess)
+{
+  return (uint32_t)((_ts_now - _ts_base) / 1000 * _clock_rate / 1000000);
+}
+
+static void
+replay_sr_rpt(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_sr_info_t* sr)
+{
+}
+
+static void
+replay_rr_rpt(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_rr_info_t* rr)
+{
+}
+
+static int
+replay_tx_rtp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  return 0;
+}
+
+static int
+replay_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  _counts.rtcp_tx++;
+  return 0;
+}
+
+static void
+replay_session_init(uint8_t pt)
+{
+  rtp_session_config_t    cfg;
+
+  memset(&cfg, 0, sizeof(cfg));
+
+  cfg.rtp_addr.sin_family   = AF_INET;
+  cfg.rtp_addr.sin_port     = htons(_port);
+  cfg.rtcp_addr.sin_family  = AF_INET;
+  cfg.rtcp_addr.sin_port    = htons(_port + 1);
+  cfg.session_bw            = 64 * 1000;
+  cfg.pt                    = pt;
+  cfg.rtcp_mux              = _mux;
+  cfg.cname_len             = strlen("prtp_replay");
+  memcpy(cfg.cname, "prtp_replay", cfg.cname_len);
+
+  _sess.rx_rtp        = replay_rx_rtp;
+  _sess.rtp_timestamp = replay_rtp_timestamp;
+  _sess.sr_rpt        = replay_sr_rpt;
+  _sess.rr_rpt        = replay_rr_rpt;
+  _sess.tx_rtp        = replay_tx_rtp;
+  _sess.tx_rtcp       = replay_tx_rtcp;
+
+  rtp_session_init(&_sess, &cfg);
+}
+
+static inline uint64_t
+now_ns(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+sleep_until(uint64_t ns)
+{
+  struct timespec   ts;
+
+  ts.tv_sec   = ns / 1000000000ULL;
+  ts.tv_nsec  = ns % 1000000000ULL;
+
+  while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+  {
+  }
+}
+
+////////////////////////////////////////////////////////////
+//
+// report
+//
+////////////////////////////////////////////////////////////
+static void
+print_errors(const char* indent, const uint32_t* rtp_errors, const uint32_t* rtcp_errors)
+{
+  // slot 0 counts accepted packets
+  for(uint32_t i = 1; i < rtp_rx_error_max; i++)
+  {
+    if(rtp_errors[i] != 0)
+    {
+      printf("%srtp  %-32s %u\n", indent, rtp_rx_error_str(i), rtp_errors[i]);
+    }
+  }
+
+  for(uint32_t i = 1; i < rtcp_rx_error_max; i++)
+  {
+    if(rtcp_errors[i] != 0)
+    {
+      printf("%srtcp %-32s %u\n", indent, rtcp_rx_error_str(i), rtcp_errors[i]);
+    }
+  }
+}
+
+static void
+print_report(uint64_t wall_ns)
+{
+  rtp_session_stats_t   st;
+  rtp_member_stats_t    ms;
+  rtp_member_t*         m;
+  uint64_t              fed = _counts.rtp + _counts.rtcp;
+  double                secs = wall_ns / 1e9;
+
+  printf("frames %llu rtp %llu rtcp %llu not_udp %llu fragments %llu truncated %llu filtered %llu\n",
+      (unsigned long long)_counts.frames, (unsigned long long)_counts.rtp,
+      (unsigned long long)_counts.rtcp, (unsigned long long)_counts.not_udp,
+      (unsigned long long)_counts.fragments, (unsigned long long)_counts.truncated,
+      (unsigned long long)_counts.filtered);
+
+  printf("capture %.3f s, ticks %llu, rtcp_tx %llu\n",
+      (_ts_now - _ts_base) / 1e9, (unsigned long long)_counts.ticks,
+      (unsigned long long)_counts.rtcp_tx);
+
+  printf("replay %.3f s, %.0f pkt/s\n", secs, secs > 0 ? fed / secs : 0.0);
+
+  rtp_session_get_stats(&_sess, &st);
+
+  printf("session accepted rtp %u rtcp %u invalid_rtp %u invalid_rtcp %u unknown_rtcp %u members %u senders %u\n",
+      st.rtp_errors[rtp_rx_error_no_error], st.rtcp_errors[rtcp_rx_error_no_error],
+      st.invalid_rtp_pkt, st.invalid_rtcp_pkt, st.unknown_rtcp_pkt,
+      _sess.rtcp_var.members, _sess.rtcp_var.senders);
+  print_errors("  ", st.rtp_errors, st.rtcp_errors);
+
+  printf("  %-10s %-5s %10s %10s %8s %8s %10s  %s\n",
+      "ssrc", "flags", "received", "expected", "lost", "jitter", "rtt_us", "cname");
+
+  m = rtp_member_table_get_first(&_sess.member_table);
+  while(m != NULL)
+  {
+    rtp_source_t* s = &m->rtp_src;
+    uint32_t      expected = s->received == 0 ? 0 : s->cycles + s->max_seq - s->base_seq + 1;
+
+    if(rtp_member_is_self(m) == RTP_FALSE)
+    {
+      rtp_session_get_member_stats(&_sess, m->ssrc, &ms);
+
+      printf("  %-10u %c%c%c%c%c %10u %10u %8d %8u ",
+          m->ssrc,
+          is_soft_timer_running(&m->sender_te) ? 's' : '-',
+          rtp_member_is_validated(m)      ? 'v' : '-',
+          rtp_member_is_rtp_heard(m)      ? 'r' : '-',
+          rtp_member_is_rtcp_heard(m)     ? 'c' : '-',
+          rtp_member_is_bye_received(m)   ? 'b' : '-',
+          s->received, expected, (int32_t)(expected - s->received), ms.jitter);
+
+      if(ms.rtt == RTP_MEMBER_RTT_UNKNOWN)
+      {
+        printf("%10s ", "-");
+      }
+      else
+      {
+        printf("%10u ", (uint32_t)(((uint64_t)ms.rtt * 1000000) >> 16));
+      }
+
+      printf(" %.*s\n", m->cname_len, m->cname);
+      print_errors("      ", ms.rtp_errors, ms.rtcp_errors);
+    }
+    m = rtp_member_table_get_next(&_sess.member_table, m);
+  }
+}
+
+static void
+usage(const char* prog)
+{
+  printf("%s [-p rtp_port] [-m] [-P pt] [-c clock_rate] [-t] capture_file\n", prog);
+  printf("  -p : RTP on rtp_port and RTCP on rtp_port + 1. any UDP port if not given\n");
+  printf("  -m : rtcp-mux. RTP and RTCP both on rtp_port\n");
+  printf("  -P : payload type. the first RTP packet decides if not given\n");
+  printf("  -c : RTP clock rate for jitter. default 8000\n");
+  printf("  -t : replay at original timing instead of full speed\n");
+}
+
+int
+main(int argc, char** argv)
+{
+  replay_pkt_t          p;
+  struct sockaddr_in    src,
+                        dst;
+  const uint8_t*        payload;
+  uint64_t              wall_begin = 0,
+                        next_tick = 0;
+  uint8_t               rtcp,
+                        started = RTP_FALSE;
+  int                   len,
+                        ret,
+                        opt;
+
+  while((opt = getopt(argc, argv, "p:mP:c:th")) != -1)
+  {
+    switch(opt)
+    {
+    case 'p':
+      _port = atoi(optarg);
+      break;
+
+    case 'm':
+      _mux = RTP_TRUE;
+      break;
+
+    case 'P':
+      _pt = atoi(optarg);
+      break;
+
+    case 'c':
+      _clock_rate = atoi(optarg);
+      break;
+
+    case 't':
+      _realtime = RTP_TRUE;
+      break;
+
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  if(optind >= argc)
+  {
+    usage(argv[0]);
+    return -1;
+  }
+
+  if(replay_open(argv[optind]) != 0)
+  {
+    printf("can't open %s as pcap or pcapng\n", argv[optind]);
+    return -1;
+  }
+
+  while((ret = replay_next(&p)) == 1)
+  {
+    _counts.frames++;
+
+    len = replay_decode(&p, &payload, &src, &dst);
+    if(len < 0)
+    {
+      continue;
+    }
+
+    if(_port != 0 && ntohs(dst.sin_port) != _port && (_mux || ntohs(dst.sin_port) != _port + 1))
+    {
+      _counts.filtered++;
+      continue;
+    }
+
+    if(_port != 0 && _mux == RTP_FALSE)
+    {
+      rtcp = ntohs(dst.sin_port) == _port + 1;
+    }
+    else
+    {
+      rtcp = rtcp_mux_is_rtcp(payload, len);
+    }
+
+    if(started == RTP_FALSE)
+    {
+      if(_pt < 0)
+      {
+        if(rtcp || len < 2)
+        {
+          _counts.filtered++;
+          continue;
+        }
+        _pt = payload[1] & 0x7f;
+      }
+
+      replay_session_init(_pt);
+
+      _ts_base    = p.ts;
+      next_tick   = p.ts + REPLAY_TICK_NS;
+      wall_begin  = now_ns();
+      started     = RTP_TRUE;
+    }
+
+    // capture time may go backwards across interfaces. never tick back
+    if(p.ts > _ts_now)
+    {
+      _ts_now = p.ts;
+    }
+
+    while(_ts_now >= next_tick)
+    {
+      rtp_session_timer_tick(&_sess);
+      _counts.ticks++;
+      next_tick += REPLAY_TICK_NS;
+    }
+
+    if(_realtime)
+    {
+      sleep_until(wall_begin + (_ts_now - _ts_base));
+    }
+
+    if(rtcp)
+    {
+      _counts.rtcp++;
+      rtp_session_rx_rtcp(&_sess, (uint8_t*)payload, len, &src);
+    }
+    else
+    {
+      _counts.rtp++;
+      rtp_session_rx_rtp(&_sess, (uint8_t*)payload, len, &src);
+    }
+  }
+
+  if(ret < 0)
+  {
+    printf("capture file corrupted after %llu frames\n", (unsigned long long)_counts.frames);
+  }
+
+  if(started == RTP_FALSE)
+  {
+    printf("no RTP packet found\n");
+    return -1;
+  }
+
+  print_report(now_ns() - wall_begin);
+
+  rtp_session_deinit(&_sess);
+  fclose(_file.fp);
+
+  return 0;
+}
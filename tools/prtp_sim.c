@@ -0,0 +1,508 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "rtp_session.h"
+#include "rtp_member_table.h"
+
+//
+// in-process RTCP simulator.
+//
+// N sessions are wired through an in-memory transport. every packet a
+// session sends is delivered to all the other sessions on the next tick.
+// time is the session soft timer, so simulated time runs as fast as the
+// CPU allows. members join, leave silently and start/stop sending at
+// the configured rates.
+//
+// every report period prints aggregate RTCP bandwidth against the
+// RFC 3550 target of 5% of session bandwidth and how far member
+// and sender estimates are from the truth.
+//
+#define SIM_TICK_MS               100
+#define SIM_RTP_PAYLOAD_LEN       160
+#define SIM_RTCP_FRACTION         0.05
+
+typedef struct __sim_node_t sim_node_t;
+
+struct __sim_node_t
+{
+  rtp_session_t         sess;             // must be first
+  struct sockaddr_in    addr;
+  uint8_t               sending;
+  uint32_t              rtp_ts;
+  uint8_t               payload[SIM_RTP_PAYLOAD_LEN];
+};
+
+typedef struct __sim_pkt_t sim_pkt_t;
+
+struct __sim_pkt_t
+{
+  sim_pkt_t*            next;
+  sim_node_t*           from;
+  uint8_t               rtcp;
+  uint32_t              len;
+  uint8_t               data[];
+};
+
+typedef struct
+{
+  uint32_t      n;
+  uint32_t      duration;         // sec
+  uint32_t      session_bw;       // bits/sec
+  uint32_t      senders;
+  uint32_t      pps;              // RTP packets/sec per sender
+  double        join_rate;        // members/sec
+  double        leave_rate;       // members/sec
+  double        sender_churn;     // sender changes/sec
+  uint32_t      report;           // report period in sec
+  uint32_t      seed;
+} sim_config_t;
+
+static sim_config_t   _cfg =
+{
+  .n            = 100,
+  .duration     = 600,
+  .session_bw   = 64000,
+  .senders      = 1,
+  .pps          = 10,
+  .join_rate    = 0,
+  .leave_rate   = 0,
+  .sender_churn = 0,
+  .report       = 30,
+  .seed         = 1,
+};
+
+static sim_node_t**   _nodes;
+static uint32_t       _num_nodes;
+static uint32_t       _max_nodes;
+static uint32_t       _next_addr;
+
+static sim_pkt_t*     _q_head;
+static sim_pkt_t*     _q_tail;
+
+static uint64_t       _tick;
+
+// per report period
+static uint64_t       _rtcp_octets;
+static uint64_t       _rtcp_pkts;
+static uint64_t       _rtcp_octets_total;
+
+////////////////////////////////////////////////////////////
+//
+// in-memory transport
+//
+////////////////////////////////////////////////////////////
+static void
+sim_enqueue(rtp_session_t* sess, uint8_t rtcp, uint8_t* pkt, uint32_t len)
+{
+  sim_pkt_t*  p = malloc(sizeof(sim_pkt_t) + len);
+
+  p->next = NULL;
+  p->from = (sim_node_t*)sess;
+  p->rtcp = rtcp;
+  p->len  = len;
+  memcpy(p->data, pkt, len);
+
+  if(_q_tail == NULL)
+  {
+    _q_head = p;
+  }
+  else
+  {
+    _q_tail->next = p;
+  }
+  _q_tail = p;
+}
+
+static int
+sim_tx_rtp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  sim_enqueue(sess, RTP_FALSE, pkt, len);
+  return 0;
+}
+
+static int
+sim_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  _rtcp_octets += len + RTCP_IP_UDP_OVERHEAD;
+  _rtcp_pkts++;
+
+  sim_enqueue(sess, RTP_TRUE, pkt, len);
+  return 0;
+}
+
+/**
+ * deliver everything sent during the last tick. a packet from a node
+ * that has left in the meantime is still delivered, like it's in flight
+ */
+static void
+sim_deliver(void)
+{
+  sim_pkt_t*  p;
+  sim_node_t* n;
+
+  while((p = _q_head) != NULL)
+  {
+    _q_head = p->next;
+    if(_q_head == NULL)
+    {
+      _q_tail = NULL;
+    }
+
+    for(uint32_t i = 0; i < _num_nodes; i++)
+    {
+      n = _nodes[i];
+      if(n == p->from)
+      {
+        continue;
+      }
+
+      if(p->rtcp)
+      {
+        rtp_session_rx_rtcp(&n->sess, p->data, p->len, &p->from->addr);
+      }
+      else
+      {
+        rtp_session_rx_rtp(&n->sess, p->data, p->len, &p->from->addr);
+      }
+    }
+    free(p);
+  }
+}
+
+////////////////////////////////////////////////////////////
+//
+// nodes
+//
+////////////////////////////////////////////////////////////
+static int
+sim_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
+{
+  return 0;
+}
+
+static uint32_t
+sim_rtp_timestamp(rtp_session_t* sess)
+{
+  return (uint32_t)(_tick * SIM_TICK_MS * 8);
+}
+
+static void
+sim_sr_rpt(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_sr_info_t* sr)
+{
+}
+
+static void
+sim_rr_rpt(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_rr_info_t* rr)
+{
+}
+
+static void
+sim_node_join(void)
+{
+  rtp_session_config_t    cfg;
+  sim_node_t*             n;
+  uint32_t                id = _next_addr++;
+
+  if(_num_nodes >= _max_nodes)
+  {
+    _max_nodes  = _max_nodes ? _max_nodes * 2 : 64;
+    _nodes      = realloc(_nodes, sizeof(sim_node_t*) * _max_nodes);
+  }
+
+  n = calloc(1, sizeof(sim_node_t));
+
+  n->addr.sin_family      = AF_INET;
+  n->addr.sin_addr.s_addr = htonl(0x0a000000 + id);
+  n->addr.sin_port        = htons(5004);
+
+  memset(&cfg, 0, sizeof(cfg));
+  cfg.rtp_addr    = n->addr;
+  cfg.rtcp_addr   = n->addr;
+  cfg.rtcp_mux    = RTP_TRUE;
+  cfg.session_bw  = _cfg.session_bw;
+  cfg.pt          = 0;
+  cfg.cname_len   = snprintf((char*)cfg.cname, sizeof(cfg.cname), "sim%u@10.0.0.0", id);
+
+  n->sess.rx_rtp        = sim_rx_rtp;
+  n->sess.rtp_timestamp = sim_rtp_timestamp;
+  n->sess.sr_rpt        = sim_sr_rpt;
+  n->sess.rr_rpt        = sim_rr_rpt;
+  n->sess.tx_rtp        = sim_tx_rtp;
+  n->sess.tx_rtcp       = sim_tx_rtcp;
+
+  rtp_session_init(&n->sess, &cfg);
+
+  _nodes[_num_nodes++] = n;
+}
+
+/**
+ * silent leave. the library doesn't send BYE, so the others time it out
+ */
+static void
+sim_node_leave(uint32_t ndx)
+{
+  sim_node_t*   n = _nodes[ndx];
+  sim_pkt_t*    p;
+
+  // packets in flight keep the address only
+  for(p = _q_head; p != NULL; p = p->next)
+  {
+    if(p->from == n)
+    {
+      p->from = NULL;
+    }
+  }
+
+  rtp_session_deinit(&n->sess);
+  free(n);
+
+  _nodes[ndx] = _nodes[--_num_nodes];
+}
+
+static uint32_t
+sim_num_senders(void)
+{
+  uint32_t  s = 0;
+
+  for(uint32_t i = 0; i < _num_nodes; i++)
+  {
+    s += _nodes[i]->sending;
+  }
+  return s;
+}
+
+/**
+ * number of events this tick for a rate per second. fractional
+ * rates are spread randomly over ticks
+ */
+static uint32_t
+sim_events(double rate)
+{
+  double    r = rate * SIM_TICK_MS / 1000.;
+  uint32_t  n = (uint32_t)r;
+
+  if(drand48() < r - n)
+  {
+    n++;
+  }
+  return n;
+}
+
+static void
+sim_churn(void)
+{
+  uint32_t  n;
+
+  for(n = sim_events(_cfg.leave_rate); n > 0 && _num_nodes > 1; n--)
+  {
+    sim_node_leave(lrand48() % _num_nodes);
+  }
+
+  for(n = sim_events(_cfg.join_rate); n > 0; n--)
+  {
+    sim_node_join();
+  }
+
+  // one sender stops and another starts
+  for(n = sim_events(_cfg.sender_churn); n > 0 && _num_nodes > 1; n--)
+  {
+    uint32_t  i = lrand48() % _num_nodes;
+
+    if(_nodes[i]->sending)
+    {
+      _nodes[i]->sending = RTP_FALSE;
+      _nodes[(i + 1 + lrand48() % (_num_nodes - 1)) % _num_nodes]->sending = RTP_TRUE;
+    }
+  }
+
+  // departed senders are replaced to keep the configured number
+  while(sim_num_senders() < _cfg.senders && sim_num_senders() < _num_nodes)
+  {
+    _nodes[lrand48() % _num_nodes]->sending = RTP_TRUE;
+  }
+}
+
+static void
+sim_send_rtp(void)
+{
+  uint32_t  per_tick = sim_events(_cfg.pps);
+
+  for(uint32_t i = 0; i < _num_nodes; i++)
+  {
+    sim_node_t* n = _nodes[i];
+
+    if(n->sending == RTP_FALSE)
+    {
+      continue;
+    }
+
+    for(uint32_t k = 0; k < per_tick; k++)
+    {
+      n->rtp_ts += 8000 / _cfg.pps;
+      rtp_session_tx(&n->sess, n->payload, sizeof(n->payload), n->rtp_ts, NULL, 0);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////
+//
+// report
+//
+////////////////////////////////////////////////////////////
+static double
+sim_cpu_sec(void)
+{
+  struct timespec   ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void
+sim_report(uint32_t t, uint32_t period)
+{
+  double    target = _cfg.session_bw * SIM_RTCP_FRACTION,
+            bps = _rtcp_octets * 8. / period,
+            m_sum = 0,
+            s_sum = 0,
+            m_min = 1e9,
+            m_max = 0;
+  uint32_t  senders = sim_num_senders();
+
+  for(uint32_t i = 0; i < _num_nodes; i++)
+  {
+    rtcp_control_var_t* cvar = &_nodes[i]->sess.rtcp_var;
+    double              r = (double)cvar->members / _num_nodes;
+
+    m_sum += r;
+    s_sum += cvar->senders;
+    m_min  = r < m_min ? r : m_min;
+    m_max  = r > m_max ? r : m_max;
+  }
+
+  printf("%6u %6u %6u %8llu %10.0f %8.3f %8.3f %8.3f %8.3f %8.2f\n",
+      t, _num_nodes, senders, (unsigned long long)_rtcp_pkts, bps, bps / target,
+      m_min, m_sum / _num_nodes, m_max, s_sum / _num_nodes);
+  fflush(stdout);
+
+  _rtcp_octets_total += _rtcp_octets;
+  _rtcp_octets  = 0;
+  _rtcp_pkts    = 0;
+}
+
+static void
+usage(const char* prog)
+{
+  printf("%s [options]\n", prog);
+  printf("  -n members      initial number of members. default %u\n", _cfg.n);
+  printf("  -d sec          simulated duration. default %u\n", _cfg.duration);
+  printf("  -b bits/sec     session bandwidth. default %u\n", _cfg.session_bw);
+  printf("  -s senders      number of senders. default %u\n", _cfg.senders);
+  printf("  -p pps          RTP packets/sec per sender. default %u\n", _cfg.pps);
+  printf("  -j rate         joins/sec\n");
+  printf("  -l rate         silent leaves/sec\n");
+  printf("  -c rate         sender changes/sec\n");
+  printf("  -r sec          report period. default %u\n", _cfg.report);
+  printf("  -S seed         random seed. default %u\n", _cfg.seed);
+}
+
+int
+main(int argc, char** argv)
+{
+  uint64_t    ticks_per_report,
+              end;
+  double      cpu_begin,
+              cpu;
+  int         opt;
+
+  while((opt = getopt(argc, argv, "n:d:b:s:p:j:l:c:r:S:h")) != -1)
+  {
+    switch(opt)
+    {
+    case 'n': _cfg.n            = atoi(optarg); break;
+    case 'd': _cfg.duration     = atoi(optarg); break;
+    case 'b': _cfg.session_bw   = atoi(optarg); break;
+    case 's': _cfg.senders      = atoi(optarg); break;
+    case 'p': _cfg.pps          = atoi(optarg); break;
+    case 'j': _cfg.join_rate    = atof(optarg); break;
+    case 'l': _cfg.leave_rate   = atof(optarg); break;
+    case 'c': _cfg.sender_churn = atof(optarg); break;
+    case 'r': _cfg.report       = atoi(optarg); break;
+    case 'S': _cfg.seed         = atoi(optarg); break;
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  if(_cfg.n == 0 || _cfg.pps == 0 || _cfg.report == 0 || _cfg.duration == 0)
+  {
+    usage(argv[0]);
+    return -1;
+  }
+
+  if(_cfg.n >= RTP_CONFIG_MAX_MEMBERS_PER_SESSION)
+  {
+    printf("member table holds %u. build with a bigger RTP_CONFIG_MAX_MEMBERS_PER_SESSION\n",
+        RTP_CONFIG_MAX_MEMBERS_PER_SESSION);
+    return -1;
+  }
+
+  srand48(_cfg.seed);
+
+  cpu_begin = sim_cpu_sec();
+
+  for(uint32_t i = 0; i < _cfg.n; i++)
+  {
+    sim_node_join();
+  }
+
+  printf("# n %u duration %u session_bw %u senders %u pps %u join %.2f leave %.2f sender_churn %.2f seed %u\n",
+      _cfg.n, _cfg.duration, _cfg.session_bw, _cfg.senders, _cfg.pps,
+      _cfg.join_rate, _cfg.leave_rate, _cfg.sender_churn, _cfg.seed);
+  printf("# rtcp target %.0f bits/sec. members/senders estimates are relative to the true member count\n",
+      _cfg.session_bw * SIM_RTCP_FRACTION);
+  printf("# %4s %6s %6s %8s %10s %8s %8s %8s %8s %8s\n",
+      "t", "nodes", "send", "rtcp_pkt", "rtcp_bps", "ratio", "mem_min", "mem_avg", "mem_max", "snd_avg");
+
+  ticks_per_report  = _cfg.report * 1000 / SIM_TICK_MS;
+  end               = (uint64_t)_cfg.duration * 1000 / SIM_TICK_MS;
+
+  for(_tick = 1; _tick <= end; _tick++)
+  {
+    sim_churn();
+    sim_send_rtp();
+
+    for(uint32_t i = 0; i < _num_nodes; i++)
+    {
+      rtp_session_timer_tick(&_nodes[i]->sess);
+    }
+
+    sim_deliver();
+
+    if(_tick % ticks_per_report == 0)
+    {
+      sim_report(_tick * SIM_TICK_MS / 1000, _cfg.report);
+    }
+  }
+
+  cpu = sim_cpu_sec() - cpu_begin;
+
+  printf("summary n %u rtcp_bps %.0f ratio %.3f cpu_sec %.3f cpu_us_per_session_sec %.3f\n",
+      _cfg.n,
+      _rtcp_octets_total * 8. / (end / (1000 / SIM_TICK_MS)),
+      _rtcp_octets_total * 8. / (end / (1000 / SIM_TICK_MS)) / (_cfg.session_bw * SIM_RTCP_FRACTION),
+      cpu, cpu * 1e6 / _cfg.n / _cfg.duration);
+
+  while(_num_nodes > 0)
+  {
+    sim_node_leave(_num_nodes - 1);
+  }
+  sim_deliver();
+  free(_nodes);
+
+  return 0;
+}
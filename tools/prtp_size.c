@@ -0,0 +1,178 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#include "rtp_session.h"
+#include "rtcp_encoder.h"
+#include "rtp_capture.h"
+#include "rtp_shm.h"
+
+//
+// memory footprint of a config profile.
+//
+// built once per profile with the profile's RTP_CONFIG_XXX overrides
+// on the command line. prints struct sizes broken down into field
+// groups and checks the RAM a session needs against a budget.
+//
+// RAM per session is rtp_session_t plus the rtcp_encoder_t that
+// report and feedback generation keep on the stack. capture ring and
+// shm region are opt-in and reported but not counted.
+//
+// a group runs from its first field to the first field of the next
+// group, so padding is charged to the group before it
+//
+typedef struct
+{
+  const char*   name;
+  size_t        offset;
+} prtp_size_group_t;
+
+#define GROUP(type, name, field)    { name, offsetof(type, field) }
+#define NGROUPS(g)                  (sizeof(g) / sizeof(g[0]))
+
+static const prtp_size_group_t  _session_groups[] =
+{
+  GROUP(rtp_session_t, "callbacks",       rx_rtp),
+  GROUP(rtp_session_t, "soft_timer",      soft_timer),
+  GROUP(rtp_session_t, "rtp_pkt",         rtp_pkt),
+  GROUP(rtp_session_t, "streams",         streams),
+  GROUP(rtp_session_t, "member_table",    member_table),
+  GROUP(rtp_session_t, "rtcp_var",        rtcp_var),
+  GROUP(rtp_session_t, "avpf/fb_queue",   avpf_var),
+  GROUP(rtp_session_t, "rtcp_handlers",   rtcp_handlers),
+  GROUP(rtp_session_t, "bundle/self",     bundle),
+  GROUP(rtp_session_t, "src_conflict",    src_conflict),
+  GROUP(rtp_session_t, "stats",           invalid_rtcp_pkt),
+  GROUP(rtp_session_t, "trace",           trace),
+#if RTP_CONFIG_PROFILE == 1
+  GROUP(rtp_session_t, "prof",            prof),
+#endif
+  GROUP(rtp_session_t, "shm/capture",     shm),
+  GROUP(rtp_session_t, "config",          config),
+};
+
+static const prtp_size_group_t  _member_groups[] =
+{
+  GROUP(rtp_member_t, "list/timers",      le),
+  GROUP(rtp_member_t, "addrs",            rtp_addr),
+  GROUP(rtp_member_t, "ssrc",             ssrc),
+  GROUP(rtp_member_t, "cname",            cname),
+  GROUP(rtp_member_t, "flags",            flags),
+  GROUP(rtp_member_t, "rtp_src",          rtp_src),
+  GROUP(rtp_member_t, "sr/rtt",           last_sr),
+  GROUP(rtp_member_t, "window",           last_heard),
+  GROUP(rtp_member_t, "errors",           rtp_errors),
+};
+
+static const prtp_size_group_t  _encoder_groups[] =
+{
+  GROUP(rtcp_encoder_t, "buf",            buf),
+  GROUP(rtcp_encoder_t, "state",          rtcp),
+};
+
+static const prtp_size_group_t  _conflict_groups[] =
+{
+  GROUP(rtp_source_conflict_table_t, "entries",  entries),
+  GROUP(rtp_source_conflict_table_t, "lists",    tmr),
+};
+
+static uint8_t    _quiet = 0;
+
+static void
+prtp_size_struct(const char* name, size_t size, const prtp_size_group_t* groups, uint32_t num_groups)
+{
+  size_t    end;
+
+  if(_quiet)
+  {
+    return;
+  }
+
+  printf("  %-32s %8zu\n", name, size);
+
+  for(uint32_t i = 0; i < num_groups; i++)
+  {
+    end = i + 1 < num_groups ? groups[i + 1].offset : size;
+    printf("    %-30s %8zu\n", groups[i].name, end - groups[i].offset);
+  }
+}
+
+static void
+prtp_size_config(void)
+{
+  if(_quiet)
+  {
+    return;
+  }
+
+  printf("  config\n");
+  printf("    %-30s %8u\n", "MAX_MEMBERS_PER_SESSION",   RTP_CONFIG_MAX_MEMBERS_PER_SESSION);
+  printf("    %-30s %8u\n", "SDES_CNAME_MAX",            RTP_CONFIG_SDES_CNAME_MAX);
+  printf("    %-30s %8u\n", "MAX_RTP_PKT_SIZE",          RTP_CONFIG_MAX_RTP_PKT_SIZE);
+  printf("    %-30s %8u\n", "MAX_STREAMS_PER_SESSION",   RTP_CONFIG_MAX_STREAMS_PER_SESSION);
+  printf("    %-30s %8u\n", "RTCP_ENCODER_BUFFER_LEN",   RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  printf("    %-30s %8u\n", "SOURCE_CONFLICT_TABLE_SIZE", RTP_CONFIG_SOURCE_CONFLICT_TABLE_SIZE);
+  printf("    %-30s %8u\n", "RTCP_FB_QUEUE_SIZE",        RTP_CONFIG_RTCP_FB_QUEUE_SIZE);
+  printf("    %-30s %8u\n", "RTCP_APP_TABLE_SIZE",       RTP_CONFIG_RTCP_APP_TABLE_SIZE);
+  printf("    %-30s %8u\n", "TRACE_RING_SIZE",           RTP_CONFIG_TRACE_RING_SIZE);
+  printf("    %-30s %8u\n", "MEMBER_WINDOW_SLOTS",       RTP_CONFIG_MEMBER_WINDOW_SLOTS);
+  printf("    %-30s %8u\n", "PROFILE",                   RTP_CONFIG_PROFILE);
+}
+
+static void
+usage(const char* prog)
+{
+  fprintf(stderr, "usage: %s [-p profile] [-b budget_bytes] [-q]\n", prog);
+  fprintf(stderr, "  exits 1 if RAM per session is over budget. -q prints the summary line only\n");
+}
+
+int
+main(int argc, char** argv)
+{
+  const char*   profile = "default";
+  size_t        budget = 0,
+                ram;
+  int           opt;
+
+  while((opt = getopt(argc, argv, "p:b:qh")) != -1)
+  {
+    switch(opt)
+    {
+    case 'p': profile = optarg;                     break;
+    case 'b': budget  = strtoul(optarg, NULL, 0);   break;
+    case 'q': _quiet  = 1;                          break;
+    default:
+      usage(argv[0]);
+      return 1;
+    }
+  }
+
+  ram = sizeof(rtp_session_t) + sizeof(rtcp_encoder_t);
+
+  if(!_quiet)
+  {
+    printf("profile %s\n", profile);
+  }
+
+  prtp_size_config();
+
+  prtp_size_struct("rtp_session_t", sizeof(rtp_session_t), _session_groups, NGROUPS(_session_groups));
+  prtp_size_struct("rtp_member_t", sizeof(rtp_member_t), _member_groups, NGROUPS(_member_groups));
+  prtp_size_struct("rtcp_encoder_t", sizeof(rtcp_encoder_t), _encoder_groups, NGROUPS(_encoder_groups));
+  prtp_size_struct("rtp_source_conflict_table_t", sizeof(rtp_source_conflict_table_t),
+      _conflict_groups, NGROUPS(_conflict_groups));
+
+  if(!_quiet)
+  {
+    printf("  optional, not counted\n");
+    printf("    %-30s %8zu\n", "rtp_capture_t", sizeof(rtp_capture_t));
+    printf("    %-30s %8zu\n", "rtp_shm_region_t", sizeof(rtp_shm_region_t));
+  }
+
+  printf("%-10s ram_per_session %8zu budget %8zu %s\n", profile, ram, budget,
+      budget == 0 ? "-" : ram <= budget ? "ok" : "OVER BUDGET");
+
+  return budget != 0 && ram > budget ? 1 : 0;
+}
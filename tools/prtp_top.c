@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "rtp_shm.h"
+#include "rtp_member.h"
+
+//
+// reads the shared memory stats region a petra rtp process publishes.
+// never touches the publishing process. a slot the writer keeps busy
+// is just skipped for this round
+//
+static rtp_shm_session_t    _snap;
+
+static uint32_t
+error_sum(const uint32_t* errors, uint32_t n)
+{
+  uint32_t  sum = 0;
+
+  // slot 0 counts accepted packets
+  for(uint32_t i = 1; i < n; i++)
+  {
+    sum += errors[i];
+  }
+  return sum;
+}
+
+static void
+print_session(const rtp_shm_session_t* s)
+{
+  const rtp_shm_member_t* m;
+
+  printf("session %u ssrc %u streams %u tx_pkt %u tx_octet %u members %u senders %u"
+         " invalid_rtp %u invalid_rtcp %u unknown_rtcp %u updated %u\n",
+      s->id, s->ssrc, s->num_streams, s->tx_pkt_count, s->tx_octet_count,
+      s->members, s->senders, s->invalid_rtp_pkt, s->invalid_rtcp_pkt, s->unknown_rtcp_pkt,
+      s->updated);
+
+  printf("  %-10s %-5s %10s %10s %8s %8s %10s %8s %8s\n",
+      "ssrc", "flags", "received", "expected", "lost", "jitter", "rtt_us", "rtp_err", "rtcp_err");
+
+  for(uint32_t i = 0; i < s->num_members; i++)
+  {
+    m = &s->member[i];
+
+    printf("  %-10u %c%c%c%c%c %10u %10u %8d %8u ",
+        m->ssrc,
+        (m->flags & RTP_FLAG_SELF)          ? 'S' : '-',
+        (m->flags & RTP_FLAG_SENDER)        ? 's' : '-',
+        (m->flags & RTP_FLAG_VALIDATED)     ? 'v' : '-',
+        (m->flags & RTP_FLAG_CSRC)          ? 'c' : '-',
+        (m->flags & RTP_FLAG_BYE_RECEIVED)  ? 'b' : '-',
+        m->received, m->expected, m->lost, m->jitter);
+
+    if(m->rtt_us == RTP_SHM_RTT_UNKNOWN)
+    {
+      printf("%10s ", "-");
+    }
+    else
+    {
+      printf("%10u ", m->rtt_us);
+    }
+
+    printf("%8u %8u\n",
+        error_sum(m->rtp_errors, rtp_rx_error_max),
+        error_sum(m->rtcp_errors, rtcp_rx_error_max));
+  }
+}
+
+static void
+usage(const char* prog)
+{
+  printf("%s [-n shm_name] [-i interval_ms] [-1]\n", prog);
+}
+
+int
+main(int argc, char** argv)
+{
+  rtp_shm_t     shm;
+  const char*   name = RTP_SHM_DEFAULT_NAME;
+  uint32_t      interval = 1000;
+  uint8_t       once = RTP_FALSE;
+  int           opt;
+
+  while((opt = getopt(argc, argv, "n:i:1h")) != -1)
+  {
+    switch(opt)
+    {
+    case 'n':
+      name = optarg;
+      break;
+
+    case 'i':
+      interval = atoi(optarg);
+      break;
+
+    case '1':
+      once = RTP_TRUE;
+      break;
+
+    default:
+      usage(argv[0]);
+      return -1;
+    }
+  }
+
+  if(rtp_shm_open(&shm, name) != 0)
+  {
+    printf("can't open %s\n", name);
+    return -1;
+  }
+
+  while(1)
+  {
+    if(once == RTP_FALSE)
+    {
+      // clear screen
+      printf("\033[H\033[2J");
+    }
+
+    for(uint32_t i = 0; i < shm.region->max_sessions; i++)
+    {
+      if(rtp_shm_read_session(&shm.region->session[i], &_snap) != 0 || _snap.in_use == RTP_FALSE)
+      {
+        continue;
+      }
+      print_session(&_snap);
+    }
+
+    fflush(stdout);
+
+    if(once == RTP_TRUE)
+    {
+      break;
+    }
+    usleep(interval * 1000);
+  }
+
+  rtp_shm_close(&shm);
+  return 0;
+}
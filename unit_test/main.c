@@ -10,11 +10,23 @@
 extern void test_member_table_add(CU_pSuite pSuite);
 extern void test_source_conflict_add(CU_pSuite pSuite);
 extern void test_rtcp_encder_add(CU_pSuite pSuite);
+extern void test_rtcp_reader_add(CU_pSuite pSuite);
 extern void test_basic_add(CU_pSuite pSuite);
 extern void test_rtp_add(CU_pSuite pSuite);
 extern void test_rtcp_add(CU_pSuite pSuite);
 extern void test_bye_add(CU_pSuite pSuite);
 extern void test_jitter_add(CU_pSuite pSuite);
+extern void test_avpf_add(CU_pSuite pSuite);
+extern void test_bundle_add(CU_pSuite pSuite);
+extern void test_stream_add(CU_pSuite pSuite);
+extern void test_trace_add(CU_pSuite pSuite);
+extern void test_prof_add(CU_pSuite pSuite);
+extern void test_shm_add(CU_pSuite pSuite);
+extern void test_metrics_add(CU_pSuite pSuite);
+extern void test_capture_add(CU_pSuite pSuite);
+extern void test_impair_add(CU_pSuite pSuite);
+extern void test_media_clock_add(CU_pSuite pSuite);
+extern void test_udp_transport_add(CU_pSuite pSuite);
 
 int init_suite_success(void) { return 0; }
 int init_suite_failure(void) { return -1; }
@@ -43,11 +55,23 @@ main()
   test_member_table_add(pSuite);
   test_source_conflict_add(pSuite);
   test_rtcp_encder_add(pSuite);
+  test_rtcp_reader_add(pSuite);
   test_basic_add(pSuite);
   test_rtp_add(pSuite);
   test_rtcp_add(pSuite);
   test_bye_add(pSuite);
   test_jitter_add(pSuite);
+  test_avpf_add(pSuite);
+  test_bundle_add(pSuite);
+  test_stream_add(pSuite);
+  test_trace_add(pSuite);
+  test_prof_add(pSuite);
+  test_shm_add(pSuite);
+  test_metrics_add(pSuite);
+  test_capture_add(pSuite);
+  test_impair_add(pSuite);
+  test_media_clock_add(pSuite);
+  test_udp_transport_add(pSuite);
 
   /* Run all tests using the basic interface */
   CU_basic_set_mode(CU_BRM_VERBOSE);
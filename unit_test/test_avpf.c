@@ -0,0 +1,418 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_session_util.h"
+#include "rtcp_encoder.h"
+#include "rtp_metrics.h"
+
+#include "test_common.h"
+
+static uint8_t      _tx_buf[RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN];
+static uint32_t     _tx_len;
+static uint32_t     _tx_count;
+
+static int
+capture_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  memcpy(_tx_buf, pkt, len);
+  _tx_len = len;
+  _tx_count++;
+  return 0;
+}
+
+static rtcp_fb_t*
+find_fb(uint8_t pt, uint8_t fmt)
+{
+  rtcp_t*   r = (rtcp_t*)_tx_buf;
+  rtcp_t*   end = (rtcp_t*)&_tx_buf[_tx_len];
+
+  while(r < end)
+  {
+    if(r->common.pt == pt && r->common.count == fmt)
+    {
+      return (rtcp_fb_t*)r;
+    }
+    r = (rtcp_t*)((uint32_t*)r + ntohs(r->common.length) + 1);
+  }
+  return NULL;
+}
+
+static uint32_t     _fb_count;
+static uint32_t     _fb_media_ssrc;
+static uint8_t      _fb_pt;
+static uint8_t      _fb_fmt;
+
+static void
+capture_fb_rpt(rtp_session_t* sess, uint32_t from_ssrc, uint32_t media_ssrc,
+               uint8_t pt, uint8_t fmt, const uint8_t* fci, uint32_t fci_len)
+{
+  _fb_count++;
+  _fb_media_ssrc  = media_ssrc;
+  _fb_pt          = pt;
+  _fb_fmt         = fmt;
+}
+
+static rtp_session_t*
+avpf_session_init_rsize(uint8_t avpf, uint32_t t_rr_interval, uint8_t rsize)
+{
+  rtp_session_config_t  cfg;
+  rtp_session_t*        sess;
+
+  common_session_config(&cfg);
+  cfg.avpf          = avpf;
+  cfg.t_rr_interval = t_rr_interval;
+  cfg.rtcp_rsize    = rsize;
+
+  sess = common_session_init_with_config(&cfg);
+  sess->tx_rtcp = capture_tx_rtcp;
+
+  _tx_len   = 0;
+  _tx_count = 0;
+
+  return sess;
+}
+
+static rtp_session_t*
+avpf_session_init(uint8_t avpf, uint32_t t_rr_interval)
+{
+  return avpf_session_init_rsize(avpf, t_rr_interval, RTP_FALSE);
+}
+
+static void
+add_remote_member(rtp_session_t* sess, uint32_t ssrc)
+{
+  rtcp_encoder_t    enc;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  rtcp_encoder_rr_begin(&enc, ssrc);
+  rtcp_encoder_end_packet(&enc);
+
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  rtcp_encoder_deinit(&enc);
+}
+
+static void
+tick_until_tx(rtp_session_t* sess, uint32_t max_ticks)
+{
+  uint32_t    count = _tx_count;
+
+  for(uint32_t i = 0; i < max_ticks && count == _tx_count; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+}
+
+static void
+test_avpf_early_feedback(void)
+{
+  rtp_session_t*  sess;
+  rtcp_fb_t*      fb;
+  rtcp_fb_nack_t* nack;
+
+  sess = avpf_session_init(RTP_TRUE, 0);
+  add_remote_member(sess, 1001);
+  CU_ASSERT(sess->rtcp_var.members == 2);
+
+  //
+  // point to point. PLI goes out immediately in an early packet
+  //
+  CU_ASSERT(rtp_session_tx_pli(sess, 1001) == 0);
+  CU_ASSERT(_tx_count == 1);
+  CU_ASSERT(sess->avpf_var.allow_early == RTP_FALSE);
+  CU_ASSERT(rtcp_fb_queue_is_empty(&sess->fb_queue) == RTP_TRUE);
+
+  CU_ASSERT(((rtcp_t*)_tx_buf)->common.pt == RTCP_RR);
+  fb = find_fb(RTCP_PSFB, RTCP_PSFB_FMT_PLI);
+  CU_ASSERT(fb != NULL);
+  CU_ASSERT(ntohl(fb->sender_ssrc) == TEST_OWN_SSRC);
+  CU_ASSERT(ntohl(fb->media_ssrc) == 1001);
+
+  //
+  // one early packet per regular interval.
+  // NACK has to wait for the next regular packet
+  //
+  CU_ASSERT(rtp_session_tx_nack(sess, 1001, 100, 0) == 0);
+  CU_ASSERT(_tx_count == 1);
+  CU_ASSERT(rtcp_fb_queue_is_empty(&sess->fb_queue) == RTP_FALSE);
+
+  tick_until_tx(sess, 100);
+  CU_ASSERT(_tx_count == 2);
+  CU_ASSERT(sess->avpf_var.allow_early == RTP_TRUE);
+  CU_ASSERT(rtcp_fb_queue_is_empty(&sess->fb_queue) == RTP_TRUE);
+
+  fb = find_fb(RTCP_RTPFB, RTCP_RTPFB_FMT_NACK);
+  CU_ASSERT(fb != NULL);
+  nack = (rtcp_fb_nack_t*)&fb->fci[0];
+  CU_ASSERT(ntohs(nack->pid) == 100);
+  CU_ASSERT(ntohs(nack->blp) == 0);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_avpf_avp_no_early(void)
+{
+  rtp_session_t*  sess;
+  rtcp_fb_t*      fb;
+
+  sess = avpf_session_init(RTP_FALSE, 0);
+  add_remote_member(sess, 1001);
+
+  CU_ASSERT(rtp_session_tx_fir(sess, 1001) == 0);
+  CU_ASSERT(_tx_count == 0);
+
+  tick_until_tx(sess, 100);
+  CU_ASSERT(_tx_count == 1);
+
+  fb = find_fb(RTCP_PSFB, RTCP_PSFB_FMT_FIR);
+  CU_ASSERT(fb != NULL);
+  CU_ASSERT(ntohl(fb->media_ssrc) == 0);
+  CU_ASSERT(ntohl(((rtcp_fb_fir_t*)&fb->fci[0])->ssrc) == 1001);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_avpf_rr_interval(void)
+{
+  rtp_session_t*  sess;
+
+  //
+  // without 5 second minimum, regular packets would go out
+  // almost every tick. T_rr_interval of 5 seconds limits that
+  //
+  sess = avpf_session_init(RTP_TRUE, 5000);
+
+  for(uint32_t i = 0; i < 10000 / sess->soft_timer.tick_rate; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  CU_ASSERT(_tx_count >= 2);
+  CU_ASSERT(_tx_count <= 4);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_avpf_fb_queue(void)
+{
+  rtcp_fb_queue_t   q;
+
+  rtcp_fb_queue_init(&q);
+
+  CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_nack, 1001, 100, 0) == RTP_TRUE);
+  CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_nack, 1001, 101, 0) == RTP_TRUE);
+  CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_nack, 1001, 103, 0) == RTP_TRUE);
+  CU_ASSERT(q.num_items == 1);
+  CU_ASSERT(q.items[0].blp == 0x05);
+
+  CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_pli, 1001, 0, 0) == RTP_TRUE);
+  CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_pli, 1001, 0, 0) == RTP_TRUE);
+  CU_ASSERT(q.num_items == 2);
+
+  for(uint32_t i = q.num_items; i < RTP_CONFIG_RTCP_FB_QUEUE_SIZE; i++)
+  {
+    CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_fir, 2000 + i, 0, 0) == RTP_TRUE);
+  }
+  CU_ASSERT(rtcp_fb_queue_add(&q, rtcp_fb_kind_fir, 3000, 0, 0) == RTP_FALSE);
+}
+
+static void
+test_avpf_fb_queue_full(void)
+{
+  rtp_session_t*  sess;
+  rtp_metrics_t   mt;
+  char            buf[4096];
+  char            line[128];
+  uint32_t        len = 0;
+
+  // AVP. feedback waits for the regular packet
+  sess = avpf_session_init(RTP_FALSE, 0);
+
+  for(uint32_t i = 0; i < RTP_CONFIG_RTCP_FB_QUEUE_SIZE; i++)
+  {
+    CU_ASSERT(rtp_session_tx_pli(sess, 1000 + i) == 0);
+  }
+  CU_ASSERT(sess->fb_queue_full == 0);
+
+  CU_ASSERT(rtp_session_tx_pli(sess, 2000) == -1);
+  CU_ASSERT(rtp_session_tx_pli(sess, 2001) == -1);
+  CU_ASSERT(sess->fb_queue_full == 2);
+
+  rtp_metrics_begin(&mt, &sess, 1);
+  while(rtp_metrics_done(&mt) == RTP_FALSE && len < sizeof(buf) - 1)
+  {
+    len += rtp_metrics_format(&mt, &buf[len], sizeof(buf) - 1 - len);
+  }
+  buf[len] = '\0';
+
+  snprintf(line, sizeof(line), "prtp_rtcp_fb_queue_full_total{session=\"0\",ssrc=\"%u\"} 2\n", sess->self->ssrc);
+  CU_ASSERT(strstr(buf, line) != NULL);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_avpf_rsize_tx(void)
+{
+  rtp_session_t*  sess;
+  rtcp_fb_t*      fb;
+  double          avg_rtcp_size;
+
+  sess = avpf_session_init_rsize(RTP_TRUE, 0, RTP_TRUE);
+  add_remote_member(sess, 1001);
+
+  avg_rtcp_size = sess->rtcp_var.avg_rtcp_size;
+
+  //
+  // early packet is feedback only
+  //
+  CU_ASSERT(rtp_session_tx_pli(sess, 1001) == 0);
+  CU_ASSERT(_tx_count == 1);
+  CU_ASSERT(_tx_len == RTCP_FB_HDR_SIZE);
+
+  fb = (rtcp_fb_t*)_tx_buf;
+  CU_ASSERT(fb->common.pt == RTCP_PSFB);
+  CU_ASSERT(fb->common.count == RTCP_PSFB_FMT_PLI);
+  CU_ASSERT(ntohl(fb->media_ssrc) == 1001);
+
+  CU_ASSERT(sess->rtcp_var.avg_rtcp_size == avg_rtcp_size);
+  CU_ASSERT(sess->rtcp_var.avg_rsize_rtcp_size == RTCP_FB_HDR_SIZE + RTCP_IP_UDP_OVERHEAD);
+  CU_ASSERT(sess->rtcp_var.rsize_share == 1./16.);
+
+  //
+  // regular packets are still compound
+  //
+  CU_ASSERT(rtp_session_tx_nack(sess, 1001, 100, 0) == 0);
+  tick_until_tx(sess, 100);
+  CU_ASSERT(_tx_count == 2);
+  CU_ASSERT(((rtcp_t*)_tx_buf)->common.pt == RTCP_RR);
+  CU_ASSERT(find_fb(RTCP_RTPFB, RTCP_RTPFB_FMT_NACK) != NULL);
+  CU_ASSERT(sess->rtcp_var.avg_rtcp_size != avg_rtcp_size);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_avpf_rsize_interval(void)
+{
+  rtp_session_t*  sess;
+  double          avg,
+                  td;
+
+  sess = avpf_session_init_rsize(RTP_TRUE, 0, RTP_TRUE);
+  add_remote_member(sess, 1001);
+
+  CU_ASSERT(rtp_session_tx_pli(sess, 1001) == 0);
+  CU_ASSERT(_tx_count == 1);
+
+  // big enough for the member timeout to follow the average size
+  sess->rtcp_var.members += 100;
+
+  tick_until_tx(sess, 10000);
+  CU_ASSERT(_tx_count == 2);
+  CU_ASSERT(((rtcp_t*)_tx_buf)->common.pt == RTCP_RR);
+
+  //
+  // RFC 5506 5. the interval uses the compound and reduced-size
+  // averages weighted by the share of each
+  //
+  CU_ASSERT(sess->rtcp_var.rsize_share > 0);
+  CU_ASSERT(sess->rtcp_var.rsize_share < 1./16.);
+
+  avg = (1. - sess->rtcp_var.rsize_share) * sess->rtcp_var.avg_rtcp_size +
+        sess->rtcp_var.rsize_share * sess->rtcp_var.avg_rsize_rtcp_size;
+  CU_ASSERT(avg < sess->rtcp_var.avg_rtcp_size);
+
+  td = avg * sess->rtcp_var.members / (sess->rtcp_var.rtcp_bw * 0.75);
+  CU_ASSERT(sess->rtcp_var.member_timeout == (uint32_t)(td * 5 * 1000));
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_avpf_rsize_rx(void)
+{
+  rtp_session_t*  sess;
+  rtcp_encoder_t  enc;
+  double          avg_rtcp_size;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  rtcp_encoder_fb_begin(&enc, RTCP_RTPFB, RTCP_RTPFB_FMT_NACK, 1001, TEST_OWN_SSRC);
+  rtcp_encoder_fb_add_nack(&enc, 200, 0x3);
+  rtcp_encoder_end_packet(&enc);
+
+  //
+  // not negotiated. rejected
+  //
+  sess = avpf_session_init_rsize(RTP_TRUE, 0, RTP_FALSE);
+  sess->fb_rpt = capture_fb_rpt;
+  _fb_count = 0;
+
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  CU_ASSERT(sess->last_rtcp_error == rtcp_rx_error_invalid_mask);
+  CU_ASSERT(sess->invalid_rtcp_pkt == 1);
+  CU_ASSERT(_fb_count == 0);
+
+  rtp_session_deinit(sess);
+  free(sess);
+
+  //
+  // negotiated
+  //
+  sess = avpf_session_init_rsize(RTP_TRUE, 0, RTP_TRUE);
+  sess->fb_rpt = capture_fb_rpt;
+  add_remote_member(sess, 1001);
+  _fb_count = 0;
+
+  avg_rtcp_size = sess->rtcp_var.avg_rtcp_size;
+
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  CU_ASSERT(sess->last_rtcp_error == rtcp_rx_error_no_error);
+  CU_ASSERT(sess->invalid_rtcp_pkt == 0);
+  CU_ASSERT(_fb_count == 1);
+  CU_ASSERT(_fb_media_ssrc == TEST_OWN_SSRC);
+  CU_ASSERT(_fb_pt == RTCP_RTPFB);
+  CU_ASSERT(_fb_fmt == RTCP_RTPFB_FMT_NACK);
+
+  CU_ASSERT(sess->rtcp_var.avg_rtcp_size == avg_rtcp_size);
+  CU_ASSERT(sess->rtcp_var.avg_rsize_rtcp_size != 0);
+
+  //
+  // fb_rpt is optional
+  //
+  sess->fb_rpt = NULL;
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  CU_ASSERT(sess->last_rtcp_error == rtcp_rx_error_no_error);
+
+  rtp_session_deinit(sess);
+  free(sess);
+
+  rtcp_encoder_deinit(&enc);
+}
+
+void
+test_avpf_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "avpf::early_feedback", test_avpf_early_feedback);
+  CU_add_test(pSuite, "avpf::avp_no_early", test_avpf_avp_no_early);
+  CU_add_test(pSuite, "avpf::rr_interval", test_avpf_rr_interval);
+  CU_add_test(pSuite, "avpf::fb_queue", test_avpf_fb_queue);
+  CU_add_test(pSuite, "avpf::fb_queue_full", test_avpf_fb_queue_full);
+  CU_add_test(pSuite, "avpf::rsize_tx", test_avpf_rsize_tx);
+  CU_add_test(pSuite, "avpf::rsize_rx", test_avpf_rsize_rx);
+  CU_add_test(pSuite, "avpf::rsize_interval", test_avpf_rsize_interval);
+}
@@ -7,6 +7,7 @@
 
 #include "rtp_session.h"
 #include "rtp_session_util.h"
+#include "rtcp_encoder.h"
 
 #include "test_common.h"
 
@@ -29,6 +30,8 @@ test_basic_session_init(void)
   CU_ASSERT(sess->rtcp_var.senders == 0);
   CU_ASSERT(sess->rtcp_var.we_sent == RTP_FALSE);
   CU_ASSERT(sess->config.session_bw == (64 * 1000));          // session bandwidth
+  CU_ASSERT(sess->rtcp_var.rtcp_bw == 64 * 1000 / 8 * 0.05);  // 5% in octets/sec
+  CU_ASSERT(sess->rtcp_var.member_timeout == RTP_CONFIG_MEMBER_TIMEOUT);
   CU_ASSERT(sess->rtcp_var.initial == RTP_TRUE);
   CU_ASSERT(sess->rtcp_var.avg_rtcp_size == RTP_CONFIG_AVERAGE_RTCP_SIZE);
   CU_ASSERT(sess->rtcp_var.tn != 0);
@@ -128,9 +131,63 @@ test_basic_self_send(void)
   free(sess);
 }
 
+static void
+test_basic_rtcp_mux(void)
+{
+  rtp_session_config_t  cfg;
+  rtp_session_t*        sess;
+  rtcp_encoder_t        enc;
+  rtp_hdr_t*            hdr;
+  uint8_t               buf[256];
+
+  common_session_config(&cfg);
+  cfg.rtcp_mux = RTP_TRUE;
+
+  sess = common_session_init_with_config(&cfg);
+
+  // single transport address
+  CU_ASSERT(memcmp(&sess->self->rtcp_addr, &_rtp_addr, sizeof(_rtp_addr)) == 0);
+
+  //
+  // RTCP through muxed entry
+  //
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  rtcp_encoder_rr_begin(&enc, 1234);
+  rtcp_encoder_end_packet(&enc);
+
+  rtp_session_rx(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtp_rem_addr);
+  rtcp_encoder_deinit(&enc);
+
+  CU_ASSERT(sess->last_rtcp_error == rtcp_rx_error_member_first_heard);
+  CU_ASSERT(sess->invalid_rtcp_pkt == 0);
+  CU_ASSERT(sess->rtcp_var.members == 2);
+
+  //
+  // RTP through muxed entry. M bit set with PT 0 is still RTP
+  //
+  memset(buf, 0, sizeof(buf));
+  hdr = (rtp_hdr_t*)buf;
+
+  hdr->version  = RTP_VERSION;
+  hdr->pt       = SESSION_PT;
+  hdr->m        = 1;
+  hdr->ssrc     = htonl(1234);
+  hdr->seq      = htons(10);
+
+  rtp_session_rx(sess, buf, RTP_PKT_SIZE(0, 64), &_rtp_rem_addr);
+
+  CU_ASSERT(sess->invalid_rtp_pkt == 0);
+  CU_ASSERT(sess->invalid_rtcp_pkt == 0);
+  CU_ASSERT(rtp_member_is_rtp_heard(rtp_session_lookup_member(sess, 1234)) == RTP_TRUE);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
 void
 test_basic_add(CU_pSuite pSuite)
 {
   CU_add_test(pSuite, "basic::session init", test_basic_session_init);
   CU_add_test(pSuite, "basic::self_send", test_basic_self_send);
+  CU_add_test(pSuite, "basic::rtcp_mux", test_basic_rtcp_mux);
 }
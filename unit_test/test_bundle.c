@@ -0,0 +1,335 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_session_util.h"
+#include "rtp_bundle.h"
+#include "rtcp_encoder.h"
+
+#include "test_common.h"
+
+#define TEST_VIDEO_SSRC       8888
+#define TEST_VIDEO_PT         96
+
+static uint8_t      _tx_buf[RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN];
+static uint32_t     _tx_len;
+static uint32_t     _tx_count;
+static uint32_t     _tx_count_video;
+
+static int
+capture_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  memcpy(_tx_buf, pkt, len);
+  _tx_len = len;
+  _tx_count++;
+  return 0;
+}
+
+static int
+video_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  _tx_count_video++;
+  return 0;
+}
+
+static void
+bundle_sessions_init(rtp_bundle_t* b, rtp_session_t** audio, rtp_session_t** video)
+{
+  rtp_session_config_t  cfg;
+
+  *audio = common_session_init();
+  (*audio)->tx_rtcp = capture_tx_rtcp;
+
+  common_session_config(&cfg);
+  cfg.pt = TEST_VIDEO_PT;
+
+  *video = common_session_init_with_config(&cfg);
+  (*video)->tx_rtcp = video_tx_rtcp;
+  rtp_member_table_change_ssrc(&(*video)->member_table, (*video)->self, TEST_VIDEO_SSRC);
+
+  rtp_bundle_init(b);
+  CU_ASSERT(rtp_bundle_add(b, *audio) == 0);
+  CU_ASSERT(rtp_bundle_add(b, *video) == 0);
+
+  _tx_len         = 0;
+  _tx_count       = 0;
+  _tx_count_video = 0;
+}
+
+static void
+bundle_sessions_deinit(rtp_session_t* audio, rtp_session_t* video)
+{
+  rtp_session_deinit(audio);
+  rtp_session_deinit(video);
+  free(audio);
+  free(video);
+}
+
+static void
+test_bundle_join(void)
+{
+  rtp_bundle_t    b;
+  rtp_session_t   *audio,
+                  *video;
+
+  bundle_sessions_init(&b, &audio, &video);
+
+  CU_ASSERT(b.num_sessions == 2);
+  CU_ASSERT(rtp_bundle_primary(&b) == audio);
+  CU_ASSERT(audio->bundle == &b);
+  CU_ASSERT(video->bundle == &b);
+
+  // only primary schedules RTCP
+  CU_ASSERT(is_soft_timer_running(&audio->rtcp_timer) != 0);
+  CU_ASSERT(is_soft_timer_running(&video->rtcp_timer) == 0);
+
+  // already bundled
+  CU_ASSERT(rtp_bundle_add(&b, video) == -1);
+
+  CU_ASSERT(rtp_bundle_route(&b, TEST_OWN_SSRC) == audio);
+  CU_ASSERT(rtp_bundle_route(&b, TEST_VIDEO_SSRC) == video);
+  CU_ASSERT(rtp_bundle_route(&b, 1234) == NULL);
+
+  bundle_sessions_deinit(audio, video);
+}
+
+static void
+test_bundle_tx(void)
+{
+  rtp_bundle_t    b;
+  rtp_session_t   *audio,
+                  *video;
+  uint8_t         msg[128];
+  rtcp_t          *r,
+                  *end;
+  uint32_t        n = 0;
+
+  bundle_sessions_init(&b, &audio, &video);
+
+  rtp_session_tx(video, msg, 128, 0, NULL, 0);
+
+  for(uint32_t i = 0; i < 100 && _tx_count == 0; i++)
+  {
+    rtp_session_timer_tick(audio);
+    rtp_session_timer_tick(video);
+  }
+
+  CU_ASSERT(_tx_count == 1);
+  CU_ASSERT(_tx_count_video == 0);
+
+  //
+  // RR for audio, SR for video and one SDES for both
+  //
+  r   = (rtcp_t*)_tx_buf;
+  end = (rtcp_t*)&_tx_buf[_tx_len];
+
+  while(r < end)
+  {
+    switch(n)
+    {
+    case 0:
+      CU_ASSERT(r->common.pt == RTCP_RR);
+      CU_ASSERT(ntohl(r->r.rr.ssrc) == TEST_OWN_SSRC);
+      break;
+
+    case 1:
+      CU_ASSERT(r->common.pt == RTCP_SR);
+      CU_ASSERT(ntohl(r->r.sr.ssrc) == TEST_VIDEO_SSRC);
+      CU_ASSERT(ntohl(r->r.sr.psent) == 1);
+      break;
+
+    case 2:
+      CU_ASSERT(r->common.pt == RTCP_SDES);
+      CU_ASSERT(r->common.count == 2);
+      CU_ASSERT(ntohl(r->r.sdes.src) == TEST_OWN_SSRC);
+      break;
+    }
+    n++;
+    r = (rtcp_t*)((uint32_t*)r + ntohs(r->common.length) + 1);
+  }
+  CU_ASSERT(n == 3);
+
+  bundle_sessions_deinit(audio, video);
+}
+
+static void
+test_bundle_rx(void)
+{
+  rtp_bundle_t    b;
+  rtp_session_t   *audio,
+                  *video;
+  rtcp_encoder_t  enc;
+  rtp_hdr_t*      hdr;
+  uint8_t         buf[256];
+
+  bundle_sessions_init(&b, &audio, &video);
+
+  //
+  // remote bundle. 1001 reports on our video, 1002 on our audio
+  //
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_sr_begin(&enc, 1001, 0, 0, 0, 0, 0);
+  rtcp_encoder_sr_add_rr(&enc, TEST_VIDEO_SSRC, 0, 0, 0, 0, 0, 0);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_rr_begin(&enc, 1002);
+  rtcp_encoder_rr_add_rr(&enc, TEST_OWN_SSRC, 0, 0, 0, 0, 0, 0);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_sdes_begin(&enc);
+  rtcp_encoder_sdes_chunk_begin(&enc, 1001);
+  rtcp_encoder_sdes_chunk_add_cname(&enc, (uint8_t*)"remote", 6);
+  rtcp_encoder_sdes_chunk_end(&enc);
+  rtcp_encoder_sdes_chunk_begin(&enc, 1002);
+  rtcp_encoder_sdes_chunk_add_cname(&enc, (uint8_t*)"remote", 6);
+  rtcp_encoder_sdes_chunk_end(&enc);
+  rtcp_encoder_end_packet(&enc);
+
+  rtp_bundle_rx(&b, enc.buf, rtcp_encoder_msg_len(&enc), &_rtp_rem_addr);
+  rtcp_encoder_deinit(&enc);
+
+  CU_ASSERT(audio->invalid_rtcp_pkt == 0);
+
+  CU_ASSERT(rtp_session_lookup_member(video, 1001) != NULL);
+  CU_ASSERT(rtp_session_lookup_member(video, 1002) == NULL);
+  CU_ASSERT(rtp_session_lookup_member(audio, 1002) != NULL);
+  CU_ASSERT(rtp_session_lookup_member(audio, 1001) == NULL);
+
+  CU_ASSERT(rtp_member_is_validated(rtp_session_lookup_member(video, 1001)) == RTP_TRUE);
+  CU_ASSERT(rtp_member_is_validated(rtp_session_lookup_member(audio, 1002)) == RTP_TRUE);
+
+  CU_ASSERT(audio->rtcp_var.members == 2);
+  CU_ASSERT(video->rtcp_var.members == 2);
+
+  //
+  // RTP from a new source goes by payload type
+  //
+  memset(buf, 0, sizeof(buf));
+  hdr = (rtp_hdr_t*)buf;
+
+  hdr->version  = RTP_VERSION;
+  hdr->pt       = TEST_VIDEO_PT;
+  hdr->ssrc     = htonl(2001);
+  hdr->seq      = htons(10);
+
+  rtp_bundle_rx(&b, buf, RTP_PKT_SIZE(0, 64), &_rtp_rem_addr);
+
+  CU_ASSERT(video->invalid_rtp_pkt == 0);
+  CU_ASSERT(rtp_session_lookup_member(video, 2001) != NULL);
+  CU_ASSERT(rtp_session_lookup_member(audio, 2001) == NULL);
+
+  bundle_sessions_deinit(audio, video);
+}
+
+static void
+bundle_rx_rtp(rtp_bundle_t* b, uint8_t pt, uint32_t ssrc)
+{
+  uint8_t     buf[256];
+  rtp_hdr_t*  hdr = (rtp_hdr_t*)buf;
+
+  memset(buf, 0, sizeof(buf));
+
+  hdr->version  = RTP_VERSION;
+  hdr->pt       = pt;
+  hdr->ssrc     = htonl(ssrc);
+  hdr->seq      = htons(10);
+
+  rtp_bundle_rx(b, buf, RTP_PKT_SIZE(0, 64), &_rtp_rem_addr);
+}
+
+static void
+test_bundle_remove_secondary(void)
+{
+  rtp_bundle_t    b;
+  rtp_session_t   *audio,
+                  *video;
+
+  bundle_sessions_init(&b, &audio, &video);
+
+  CU_ASSERT(rtp_bundle_remove(&b, video) == 0);
+  CU_ASSERT(rtp_bundle_remove(&b, video) == -1);
+
+  CU_ASSERT(b.num_sessions == 1);
+  CU_ASSERT(rtp_bundle_primary(&b) == audio);
+  CU_ASSERT(video->bundle == NULL);
+
+  // video is on its own again
+  CU_ASSERT(is_soft_timer_running(&audio->rtcp_timer) != 0);
+  CU_ASSERT(is_soft_timer_running(&video->rtcp_timer) != 0);
+
+  CU_ASSERT(rtp_bundle_route(&b, TEST_VIDEO_SSRC) == NULL);
+
+  // video payload type now falls back to the primary and is not audio
+  bundle_rx_rtp(&b, TEST_VIDEO_PT, 2001);
+  CU_ASSERT(audio->invalid_rtp_pkt == 1);
+  CU_ASSERT(rtp_session_lookup_member(audio, 2001) == NULL);
+  CU_ASSERT(rtp_session_lookup_member(video, 2001) == NULL);
+
+  for(uint32_t i = 0; i < 100 && (_tx_count == 0 || _tx_count_video == 0); i++)
+  {
+    rtp_session_timer_tick(audio);
+    rtp_session_timer_tick(video);
+  }
+
+  CU_ASSERT(_tx_count != 0);
+  CU_ASSERT(_tx_count_video != 0);
+
+  bundle_sessions_deinit(audio, video);
+}
+
+static void
+test_bundle_remove_primary(void)
+{
+  rtp_bundle_t    b;
+  rtp_session_t   *audio,
+                  *video;
+
+  bundle_sessions_init(&b, &audio, &video);
+
+  rtp_session_deinit(audio);
+
+  CU_ASSERT(b.num_sessions == 1);
+  CU_ASSERT(rtp_bundle_primary(&b) == video);
+  CU_ASSERT(audio->bundle == NULL);
+  CU_ASSERT(video->bundle == &b);
+
+  // video schedules RTCP for the bundle now
+  CU_ASSERT(is_soft_timer_running(&audio->rtcp_timer) == 0);
+  CU_ASSERT(is_soft_timer_running(&video->rtcp_timer) != 0);
+
+  CU_ASSERT(rtp_bundle_route(&b, TEST_OWN_SSRC) == NULL);
+  CU_ASSERT(rtp_bundle_route(&b, TEST_VIDEO_SSRC) == video);
+
+  bundle_rx_rtp(&b, TEST_VIDEO_PT, 2001);
+  CU_ASSERT(video->invalid_rtp_pkt == 0);
+  CU_ASSERT(rtp_session_lookup_member(video, 2001) != NULL);
+
+  for(uint32_t i = 0; i < 100 && _tx_count_video == 0; i++)
+  {
+    rtp_session_timer_tick(video);
+  }
+
+  CU_ASSERT(_tx_count == 0);
+  CU_ASSERT(_tx_count_video == 1);
+
+  rtp_session_deinit(video);
+  CU_ASSERT(b.num_sessions == 0);
+
+  free(audio);
+  free(video);
+}
+
+void
+test_bundle_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "bundle::join", test_bundle_join);
+  CU_add_test(pSuite, "bundle::tx", test_bundle_tx);
+  CU_add_test(pSuite, "bundle::rx", test_bundle_rx);
+  CU_add_test(pSuite, "bundle::remove_secondary", test_bundle_remove_secondary);
+  CU_add_test(pSuite, "bundle::remove_primary", test_bundle_remove_primary);
+}
@@ -0,0 +1,192 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_capture.h"
+
+#include "test_common.h"
+
+static rtp_capture_t      _cap;
+static uint8_t            _out[64 * 1024];
+static uint32_t           _out_len;
+
+static int
+test_capture_write(void* arg, const void* buf, uint32_t len)
+{
+  if(_out_len + len > sizeof(_out))
+  {
+    return -1;
+  }
+
+  memcpy(&_out[_out_len], buf, len);
+  _out_len += len;
+  return 0;
+}
+
+static uint32_t
+test_capture_build_rtp(uint8_t* buf, uint32_t ssrc, uint16_t seq, uint8_t cc, uint32_t payload_len)
+{
+  uint32_t    len = 12 + cc * 4 + payload_len;
+
+  memset(buf, 0xab, len);
+
+  buf[0] = 0x80 | cc;
+  buf[1] = SESSION_PT;
+  buf[2] = seq >> 8;
+  buf[3] = seq & 0xff;
+  buf[8]  = ssrc >> 24;
+  buf[9]  = (ssrc >> 16) & 0xff;
+  buf[10] = (ssrc >> 8) & 0xff;
+  buf[11] = ssrc & 0xff;
+
+  return len;
+}
+
+static int
+test_capture_tx(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  return 0;
+}
+
+static void
+test_capture_ring(void)
+{
+  uint8_t     pkt[512];
+  uint32_t    len;
+
+  rtp_capture_init(&_cap, 0, 0);
+  CU_ASSERT(rtp_capture_count(&_cap) == 0);
+
+  // truncated to snaplen
+  len = test_capture_build_rtp(pkt, 1234, 1, 0, 400);
+  rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, &_rtp_rem_addr, &_rtp_addr);
+  CU_ASSERT(rtp_capture_count(&_cap) == 1);
+  CU_ASSERT(_cap.recs[0].orig_len == len);
+  CU_ASSERT(_cap.recs[0].cap_len == RTP_CONFIG_CAPTURE_SNAPLEN);
+  CU_ASSERT(_cap.recs[0].dir == RTP_CAPTURE_DIR_RX);
+  CU_ASSERT(memcmp(_cap.recs[0].data, pkt, RTP_CONFIG_CAPTURE_SNAPLEN) == 0);
+
+  // headers only. fixed header and 2 CSRCs
+  rtp_capture_init(&_cap, RTP_CAPTURE_HEADERS_ONLY, 0);
+  len = test_capture_build_rtp(pkt, 1234, 1, 2, 100);
+  rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, NULL, NULL);
+  CU_ASSERT(_cap.recs[0].cap_len == 12 + 8);
+  CU_ASSERT(_cap.recs[0].orig_len == len);
+
+  // SSRC filter
+  rtp_capture_init(&_cap, RTP_CAPTURE_FILTER_SSRC, 1234);
+  len = test_capture_build_rtp(pkt, 1234, 1, 0, 10);
+  rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, NULL, NULL);
+  len = test_capture_build_rtp(pkt, 4321, 1, 0, 10);
+  rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, NULL, NULL);
+  CU_ASSERT(rtp_capture_count(&_cap) == 1);
+  CU_ASSERT(_cap.filtered == 1);
+
+  // wrap around keeps the latest
+  rtp_capture_init(&_cap, 0, 0);
+  for(uint32_t i = 0; i < RTP_CONFIG_CAPTURE_SLOTS + 3; i++)
+  {
+    len = test_capture_build_rtp(pkt, 1234, (uint16_t)i, 0, 10);
+    rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, NULL, NULL);
+  }
+  CU_ASSERT(rtp_capture_count(&_cap) == RTP_CONFIG_CAPTURE_SLOTS);
+  CU_ASSERT(_cap.recs[0].data[3] == ((RTP_CONFIG_CAPTURE_SLOTS) & 0xff));
+
+  rtp_capture_clear(&_cap);
+  CU_ASSERT(rtp_capture_count(&_cap) == 0);
+}
+
+static void
+test_capture_pcap(void)
+{
+  uint8_t     pkt[128];
+  uint32_t    len,
+              v;
+  uint8_t*    rec;
+
+  rtp_capture_init(&_cap, 0, 0);
+
+  len = test_capture_build_rtp(pkt, 1234, 7, 0, 20);
+  rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_RX, RTP_FALSE, pkt, len, &_rtp_rem_addr, &_rtp_addr);
+  rtp_capture_pkt(&_cap, RTP_CAPTURE_DIR_TX, RTP_FALSE, pkt, len, &_rtp_addr, NULL);
+
+  _out_len = 0;
+  CU_ASSERT(rtp_capture_write_pcap(&_cap, test_capture_write, NULL) == 2);
+  CU_ASSERT(_out_len == 24 + 2 * (16 + 28 + len));
+
+  memcpy(&v, &_out[0], 4);
+  CU_ASSERT(v == 0xa1b2c3d4);
+  memcpy(&v, &_out[20], 4);
+  CU_ASSERT(v == 228);
+
+  // first record
+  rec = &_out[24];
+  memcpy(&v, &rec[8], 4);
+  CU_ASSERT(v == 28 + len);
+
+  rec += 16;
+  CU_ASSERT(rec[0] == 0x45);
+  CU_ASSERT(rec[9] == IPPROTO_UDP);
+  CU_ASSERT(((rec[2] << 8) | rec[3]) == 28 + len);
+  CU_ASSERT(memcmp(&rec[12], &_rtp_rem_addr.sin_addr.s_addr, 4) == 0);
+  CU_ASSERT(memcmp(&rec[16], &_rtp_addr.sin_addr.s_addr, 4) == 0);
+  CU_ASSERT(memcmp(&rec[20], &_rtp_rem_addr.sin_port, 2) == 0);
+  CU_ASSERT(memcmp(&rec[22], &_rtp_addr.sin_port, 2) == 0);
+  CU_ASSERT(memcmp(&rec[28], pkt, len) == 0);
+
+  // write error
+  _out_len = sizeof(_out) - 10;
+  CU_ASSERT(rtp_capture_write_pcap(&_cap, test_capture_write, NULL) == -1);
+}
+
+static void
+test_capture_session(void)
+{
+  rtp_session_t*  sess;
+  uint8_t         pkt[128];
+  uint8_t         payload[32];
+  uint32_t        len;
+
+  sess = common_session_init();
+  sess->tx_rtp = test_capture_tx;
+
+  rtp_capture_init(&_cap, 0, 0);
+
+  // disarmed
+  len = test_capture_build_rtp(pkt, 1234, 1, 0, 20);
+  rtp_session_rx_rtp(sess, pkt, len, &_rtp_rem_addr);
+  CU_ASSERT(rtp_capture_count(&_cap) == 0);
+
+  rtp_session_set_capture(sess, &_cap);
+
+  rtp_session_rx_rtp(sess, pkt, len, &_rtp_rem_addr);
+  CU_ASSERT(rtp_capture_count(&_cap) == 1);
+  CU_ASSERT(_cap.recs[0].dir == RTP_CAPTURE_DIR_RX);
+  CU_ASSERT(_cap.recs[0].rtcp == RTP_FALSE);
+
+  memset(payload, 0, sizeof(payload));
+  rtp_session_tx(sess, payload, sizeof(payload), 0, NULL, 0);
+  CU_ASSERT(rtp_capture_count(&_cap) == 2);
+  CU_ASSERT(_cap.recs[1].dir == RTP_CAPTURE_DIR_TX);
+  CU_ASSERT(_cap.recs[1].orig_len == 12 + sizeof(payload));
+
+  rtp_session_set_capture(sess, NULL);
+  rtp_session_rx_rtp(sess, pkt, len, &_rtp_rem_addr);
+  CU_ASSERT(rtp_capture_count(&_cap) == 2);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+void
+test_capture_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "capture::ring", test_capture_ring);
+  CU_add_test(pSuite, "capture::pcap", test_capture_pcap);
+  CU_add_test(pSuite, "capture::session", test_capture_session);
+}
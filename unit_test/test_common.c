@@ -32,12 +32,12 @@ dummy_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
 }
 
 static void
-dummy_sr_rpt(rtp_session_t* sess, uint32_t ssrc, rtcp_t* r)
+dummy_sr_rpt(rtp_session_t* sess, uint32_t ssrc, const rtcp_sr_info_t* sr)
 {
 }
 
 static void
-dummy_rr_rpt(rtp_session_t* sess, uint32_t ssrc, rtcp_rr_t* rr)
+dummy_rr_rpt(rtp_session_t* sess, uint32_t ssrc, const rtcp_rr_info_t* rr)
 {
 }
 
@@ -53,35 +53,52 @@ test_rtp_timestamp_set(rtp_session_t* sess, uint32_t ts)
   _own_rtp_ts = ts;
 }
 
+void
+common_session_config(rtp_session_config_t* cfg)
+{
+  memset(cfg, 0, sizeof(rtp_session_config_t));
+
+  memcpy(&cfg->rtp_addr, &_rtp_addr, sizeof(_rtp_addr));
+  memcpy(&cfg->rtcp_addr, &_rtcp_addr, sizeof(_rtcp_addr));
+  cfg->session_bw = 64 * 1000;
+  memcpy(cfg->cname, SESSION_NAME, strlen(SESSION_NAME));
+  cfg->cname_len = strlen(SESSION_NAME);
+  cfg->pt = SESSION_PT;
+  cfg->align_by_4 = RTP_FALSE;
+}
+
 rtp_session_t*
-common_session_init(void)
+common_session_init_with_config(const rtp_session_config_t* cfg)
 {
   rtp_session_t*  sess;
-  rtp_session_config_t      cfg;
 
   sess = malloc(sizeof(rtp_session_t));
   CU_ASSERT(sess != NULL);
 
+  memset(sess, 0, sizeof(rtp_session_t));
+
   sess->sr_rpt = dummy_sr_rpt;
   sess->rr_rpt = dummy_rr_rpt;
   sess->rtp_timestamp = test_rtp_timestamp;
   sess->tx_rtp = dummy_tx_rtp;
   sess->tx_rtcp = dummy_tx_rtcp;
 
-  memcpy(&cfg.rtp_addr, &_rtp_addr, sizeof(_rtp_addr));
-  memcpy(&cfg.rtcp_addr, &_rtcp_addr, sizeof(_rtcp_addr));
-  cfg.session_bw = 64 * 1000;
-  memcpy(cfg.cname, SESSION_NAME, strlen(SESSION_NAME));
-  cfg.cname_len = strlen(SESSION_NAME);
-  cfg.pt = SESSION_PT;
-  cfg.align_by_4 = RTP_FALSE;
-
-  rtp_session_init(sess, &cfg);
+  rtp_session_init(sess, cfg);
   rtp_member_table_change_ssrc(&sess->member_table, sess->self, TEST_OWN_SSRC);
 
   return sess;
 }
 
+rtp_session_t*
+common_session_init(void)
+{
+  rtp_session_config_t      cfg;
+
+  common_session_config(&cfg);
+
+  return common_session_init_with_config(&cfg);
+}
+
 void
 test_common_init(void)
 {
@@ -9,6 +9,8 @@
 #define TEST_OWN_SSRC         9999
 
 extern rtp_session_t* common_session_init(void);
+extern void common_session_config(rtp_session_config_t* cfg);
+extern rtp_session_t* common_session_init_with_config(const rtp_session_config_t* cfg);
 extern void test_common_init(void);
 
 extern struct sockaddr_in     _rtp_addr,
@@ -0,0 +1,345 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_impair.h"
+#include "rtp_member_table.h"
+
+#include "test_common.h"
+
+#define TEST_IMPAIR_SENDER_SSRC     1234
+
+static rtp_impair_t       _imp;
+
+// delivered packet log. payload is a 16 bit sequence
+static uint16_t           _seqs[4096];
+static uint32_t           _num_seqs;
+static uint32_t           _last_due;
+
+static rtp_session_t*     _rx_sess;
+static uint32_t           _rx_rtp_count;
+
+static void
+test_impair_log(void* arg, uint8_t tag, uint8_t* pkt, uint32_t len)
+{
+  if(_num_seqs < sizeof(_seqs) / sizeof(_seqs[0]))
+  {
+    _seqs[_num_seqs++] = (pkt[0] << 8) | pkt[1];
+  }
+}
+
+static void
+test_impair_send_seq(uint16_t seq, uint32_t now)
+{
+  uint8_t   pkt[2] = { seq >> 8, seq & 0xff };
+
+  rtp_impair_send(&_imp, 0, pkt, sizeof(pkt), now);
+}
+
+static void
+test_impair_config(rtp_impair_config_t* cfg)
+{
+  memset(cfg, 0, sizeof(*cfg));
+  cfg->seed = 7;
+}
+
+static void
+test_impair_none(void)
+{
+  rtp_impair_config_t   cfg;
+
+  test_impair_config(&cfg);
+  rtp_impair_init(&_imp, &cfg);
+
+  _num_seqs = 0;
+  for(uint16_t i = 0; i < 100; i++)
+  {
+    test_impair_send_seq(i, 0);
+  }
+
+  CU_ASSERT(rtp_impair_queued(&_imp) == 100);
+  CU_ASSERT(rtp_impair_poll(&_imp, 0, test_impair_log, NULL) == 100);
+  CU_ASSERT(rtp_impair_queued(&_imp) == 0);
+  CU_ASSERT(_num_seqs == 100);
+
+  for(uint16_t i = 0; i < 100; i++)
+  {
+    CU_ASSERT(_seqs[i] == i);
+  }
+
+  CU_ASSERT(_imp.stats.sent == 100);
+  CU_ASSERT(_imp.stats.delivered == 100);
+  CU_ASSERT(_imp.stats.lost == 0);
+
+  // slots run out
+  for(uint32_t i = 0; i < RTP_CONFIG_IMPAIR_SLOTS + 10; i++)
+  {
+    test_impair_send_seq(0, 0);
+  }
+  CU_ASSERT(_imp.stats.overflow == 10);
+  rtp_impair_poll(&_imp, 0, test_impair_log, NULL);
+}
+
+/**
+ * bursts only. stationary loss is p_gb / (p_gb + p_bg) and
+ * the mean burst length 1 / p_bg
+ */
+static uint32_t
+test_impair_run_gilbert(uint32_t seed, uint32_t n, uint32_t* bursts)
+{
+  rtp_impair_config_t   cfg;
+  uint32_t              lost_prior,
+                        in_burst = 0;
+
+  test_impair_config(&cfg);
+  cfg.p_gb      = 0.01;
+  cfg.p_bg      = 0.25;
+  cfg.loss_good = 0;
+  cfg.loss_bad  = 1;
+  cfg.seed      = seed;
+
+  rtp_impair_init(&_imp, &cfg);
+
+  *bursts = 0;
+  for(uint32_t i = 0; i < n; i++)
+  {
+    lost_prior = _imp.stats.lost;
+
+    test_impair_send_seq(i, i);
+    rtp_impair_poll(&_imp, i, test_impair_log, NULL);
+
+    if(_imp.stats.lost != lost_prior)
+    {
+      *bursts += in_burst ? 0 : 1;
+      in_burst = 1;
+    }
+    else
+    {
+      in_burst = 0;
+    }
+  }
+  return _imp.stats.lost;
+}
+
+static void
+test_impair_loss(void)
+{
+  uint32_t    n = 200000,
+              lost,
+              bursts,
+              lost2,
+              bursts2;
+  double      rate;
+
+  _num_seqs = 0;
+  lost = test_impair_run_gilbert(11, n, &bursts);
+  rate = (double)lost / n;
+
+  CU_ASSERT(rate > 0.0385 - 0.005 && rate < 0.0385 + 0.005);
+  CU_ASSERT(bursts != 0);
+  CU_ASSERT((double)lost / bursts > 3.5 && (double)lost / bursts < 4.5);
+  CU_ASSERT(_imp.stats.delivered + _imp.stats.lost == n);
+
+  // same seed, same pattern
+  lost2 = test_impair_run_gilbert(11, n, &bursts2);
+  CU_ASSERT(lost2 == lost);
+  CU_ASSERT(bursts2 == bursts);
+
+  lost2 = test_impair_run_gilbert(12, n, &bursts2);
+  CU_ASSERT(lost2 != lost);
+}
+
+static void
+test_impair_delay_log(void* arg, uint8_t tag, uint8_t* pkt, uint32_t len)
+{
+  uint32_t    now = *(uint32_t*)arg;
+  uint32_t    sent = (pkt[0] << 8) | pkt[1];
+
+  _last_due = now - sent;
+  test_impair_log(arg, tag, pkt, len);
+}
+
+static void
+test_impair_delay(void)
+{
+  rtp_impair_config_t   cfg;
+  uint32_t              now,
+                        min_delay = 0xffffffff,
+                        max_delay = 0;
+
+  // constant
+  test_impair_config(&cfg);
+  cfg.delay_ms = 20;
+  rtp_impair_init(&_imp, &cfg);
+
+  _num_seqs = 0;
+  test_impair_send_seq(0, 100);
+  CU_ASSERT(rtp_impair_poll(&_imp, 119, test_impair_log, NULL) == 0);
+  CU_ASSERT(rtp_impair_poll(&_imp, 120, test_impair_log, NULL) == 1);
+
+  // uniform 50 +- 10. payload is the send time
+  cfg.delay_dist  = rtp_impair_delay_uniform;
+  cfg.delay_ms    = 50;
+  cfg.jitter_ms   = 10;
+  rtp_impair_init(&_imp, &cfg);
+
+  for(now = 0; now < 2000; now++)
+  {
+    if(now < 1000)
+    {
+      test_impair_send_seq(now, now);
+    }
+
+    _last_due = 0xffffffff;
+    while(rtp_impair_poll(&_imp, now, test_impair_delay_log, &now) != 0)
+    {
+    }
+
+    if(_last_due != 0xffffffff)
+    {
+      min_delay = _last_due < min_delay ? _last_due : min_delay;
+      max_delay = _last_due > max_delay ? _last_due : max_delay;
+    }
+  }
+
+  CU_ASSERT(_imp.stats.delivered == 1000);
+  CU_ASSERT(min_delay >= 40 && min_delay <= 42);
+  CU_ASSERT(max_delay >= 58 && max_delay <= 60);
+
+  // normal never goes below 0
+  cfg.delay_dist  = rtp_impair_delay_normal;
+  cfg.delay_ms    = 5;
+  cfg.jitter_ms   = 20;
+  rtp_impair_init(&_imp, &cfg);
+
+  for(uint32_t i = 0; i < 100; i++)
+  {
+    test_impair_send_seq(i, 1000);
+  }
+  CU_ASSERT(rtp_impair_poll(&_imp, 999, test_impair_log, NULL) == 0);
+  rtp_impair_poll(&_imp, 2000, test_impair_log, NULL);
+  CU_ASSERT(_imp.stats.delivered == 100);
+}
+
+static void
+test_impair_reorder(void)
+{
+  rtp_impair_config_t   cfg;
+  uint32_t              out_of_order = 0;
+
+  test_impair_config(&cfg);
+  cfg.reorder     = 0.2;
+  cfg.reorder_ms  = 5;
+  cfg.duplicate   = 0.1;
+  rtp_impair_init(&_imp, &cfg);
+
+  _num_seqs = 0;
+  for(uint32_t now = 0; now < 1100; now++)
+  {
+    if(now < 1000)
+    {
+      test_impair_send_seq(now, now);
+    }
+    rtp_impair_poll(&_imp, now, test_impair_log, NULL);
+  }
+
+  for(uint32_t i = 1; i < _num_seqs; i++)
+  {
+    out_of_order += _seqs[i] < _seqs[i - 1] ? 1 : 0;
+  }
+
+  CU_ASSERT(_imp.stats.reordered > 150 && _imp.stats.reordered < 300);
+  CU_ASSERT(_imp.stats.duplicated > 60 && _imp.stats.duplicated < 140);
+  CU_ASSERT(_imp.stats.delivered == 1000 + _imp.stats.duplicated);
+  CU_ASSERT(_num_seqs == _imp.stats.delivered);
+  CU_ASSERT(out_of_order != 0);
+}
+
+////////////////////////////////////////////////////////////
+//
+// sender session -> shim -> receiver session
+//
+////////////////////////////////////////////////////////////
+static int
+test_impair_tx(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  rtp_impair_send(&_imp, 0, pkt, len, soft_timer_get_tick_time(&sess->soft_timer));
+  return 0;
+}
+
+static void
+test_impair_deliver(void* arg, uint8_t tag, uint8_t* pkt, uint32_t len)
+{
+  rtp_session_rx_rtp(_rx_sess, pkt, len, &_rtp_rem_addr);
+}
+
+static int
+test_impair_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
+{
+  _rx_rtp_count++;
+  return 0;
+}
+
+static void
+test_impair_session(void)
+{
+  rtp_session_config_t  scfg;
+  rtp_impair_config_t   cfg;
+  rtp_session_t*        tx_sess;
+  rtp_member_t*         m;
+  uint8_t               payload[160];
+
+  common_session_config(&scfg);
+  scfg.rtp_addr = _rtp_rem_addr;
+  scfg.rtcp_addr = _rtcp_rem_addr;
+
+  tx_sess = common_session_init_with_config(&scfg);
+  rtp_member_table_change_ssrc(&tx_sess->member_table, tx_sess->self, TEST_IMPAIR_SENDER_SSRC);
+  tx_sess->tx_rtp = test_impair_tx;
+
+  _rx_sess = common_session_init();
+  _rx_sess->rx_rtp = test_impair_rx_rtp;
+  _rx_rtp_count = 0;
+
+  // 10% random loss
+  test_impair_config(&cfg);
+  cfg.loss_good = 0.1;
+  rtp_impair_init(&_imp, &cfg);
+
+  memset(payload, 0, sizeof(payload));
+  for(uint32_t i = 0; i < 1000; i++)
+  {
+    rtp_session_tx(tx_sess, payload, sizeof(payload), i * 160, NULL, 0);
+    rtp_impair_poll(&_imp, 0, test_impair_deliver, NULL);
+  }
+
+  m = rtp_member_table_lookup(&_rx_sess->member_table, TEST_IMPAIR_SENDER_SSRC);
+  CU_ASSERT(m != NULL);
+  if(m != NULL)
+  {
+    CU_ASSERT(_imp.stats.lost > 70 && _imp.stats.lost < 130);
+    CU_ASSERT(m->rtp_src.received <= _imp.stats.delivered);
+    CU_ASSERT(m->rtp_src.received + RTP_CONFIG_MIN_SEQUENTIAL + 1 >= _imp.stats.delivered);
+    CU_ASSERT(_rx_rtp_count == m->rtp_src.received);
+  }
+
+  rtp_session_deinit(tx_sess);
+  rtp_session_deinit(_rx_sess);
+  free(tx_sess);
+  free(_rx_sess);
+}
+
+void
+test_impair_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "impair::none", test_impair_none);
+  CU_add_test(pSuite, "impair::loss", test_impair_loss);
+  CU_add_test(pSuite, "impair::delay", test_impair_delay);
+  CU_add_test(pSuite, "impair::reorder", test_impair_reorder);
+  CU_add_test(pSuite, "impair::session", test_impair_session);
+}
@@ -18,6 +18,21 @@ dummy_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
   return 0;
 }
 
+static void
+__build_test_rtp_pkt(uint8_t* buf, uint16_t seq, uint32_t rtp_ts)
+{
+  rtp_hdr_t*    hdr = (rtp_hdr_t*)buf;
+
+  hdr->version  = RTP_VERSION;
+  hdr->cc       = 0x00;
+  hdr->pt       = SESSION_PT;
+  hdr->p        = 0;
+  hdr->x        = 0;
+  hdr->ssrc     = htonl(1234);
+  hdr->seq      = htons(seq);
+  hdr->ts       = htonl(rtp_ts);
+}
+
 static void
 __send_test_rtp_pkt(rtp_session_t* sess, uint16_t seq, uint32_t rtp_ts)
 {
@@ -71,8 +86,91 @@ test_jitter_basic(void)
   rtp_session_deinit(sess);
 }
 
+/**
+ * 8KHz 20ms packets arriving exactly on time but processed with up to
+ * 20ms delay. arrival_ns 0 uses rtp_timestamp() at processing time.
+ * every missing_every-th packet comes without arrival_ns, 0 for none
+ */
+static uint32_t
+__run_arrival(uint32_t clock_rate, uint8_t with_arrival, uint32_t missing_every)
+{
+  rtp_session_config_t  cfg;
+  rtp_session_t*        sess;
+  rtp_member_t*         m;
+  uint8_t               buf[256];
+  uint64_t              arrival_ns = 1700000000ULL * 1000000000ULL;
+  uint32_t              jitter = 0xffffffff;
+
+  common_session_config(&cfg);
+  cfg.clock_rate = clock_rate;
+
+  sess = common_session_init_with_config(&cfg);
+  sess->rx_rtp = dummy_rx_rtp;
+
+  memset(buf, 0, sizeof(buf));
+  for(uint32_t i = 0; i < 500; i++)
+  {
+    test_rtp_timestamp_set(sess, i * 160 + (i % 3) * 80);
+    __build_test_rtp_pkt(buf, 100 + i, i * 160);
+
+    if(with_arrival == RTP_FALSE || (missing_every != 0 && (i % missing_every) == missing_every - 1))
+    {
+      rtp_session_rx_rtp_at(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr, 0);
+    }
+    else
+    {
+      rtp_session_rx_rtp_at(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr, arrival_ns);
+    }
+    arrival_ns += 20 * 1000000ULL;
+  }
+
+  m = rtp_session_lookup_member(sess, 1234);
+  CU_ASSERT(m != NULL);
+  if(m != NULL)
+  {
+    jitter = m->rtp_src.jitter;
+  }
+
+  rtp_session_deinit(sess);
+  free(sess);
+
+  return jitter;
+}
+
+static void
+test_jitter_arrival(void)
+{
+  uint32_t  jitter;
+
+  jitter = __run_arrival(8000, RTP_TRUE, 0);
+  CU_ASSERT(jitter < 2);
+
+  // processing delay counted as jitter
+  jitter = __run_arrival(8000, RTP_FALSE, 0);
+  CU_ASSERT(jitter > 40 && jitter != 0xffffffff);
+
+  // no clock rate. falls back to rtp_timestamp()
+  jitter = __run_arrival(0, RTP_TRUE, 0);
+  CU_ASSERT(jitter > 40 && jitter != 0xffffffff);
+}
+
+static void
+test_jitter_arrival_mixed(void)
+{
+  uint32_t  jitter;
+
+  //
+  // rtp_timestamp() is on another epoch. a packet without arrival_ns
+  // takes the previous one's, off by a packet time at most
+  //
+  jitter = __run_arrival(8000, RTP_TRUE, 5);
+  CU_ASSERT(jitter < 160);
+}
+
 void
 test_jitter_add(CU_pSuite pSuite)
 {
   CU_add_test(pSuite, "jitter::basic", test_jitter_basic);
+  CU_add_test(pSuite, "jitter::arrival", test_jitter_arrival);
+  CU_add_test(pSuite, "jitter::arrival_mixed", test_jitter_arrival_mixed);
 }
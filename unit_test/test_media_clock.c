@@ -0,0 +1,113 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "rtp_session.h"
+#include "rtp_session_util.h"
+#include "rtp_media_clock.h"
+
+#include "test_common.h"
+
+static uint32_t     _callback_count;
+
+static uint32_t
+test_media_clock_callback(rtp_session_t* sess)
+{
+  _callback_count++;
+  return 0;
+}
+
+static void
+test_media_clock_math(void)
+{
+  rtp_media_clock_t   c;
+  uint64_t            base = 5ULL * 1000000000ULL,
+                      days = 10ULL * 86400ULL;
+
+  c.clock_rate  = 90000;
+  c.offset      = 0xfffffff0;
+  c.base_ns     = base;
+
+  CU_ASSERT(rtp_media_clock_at(&c, base) == 0xfffffff0);
+
+  // wraps
+  CU_ASSERT(rtp_media_clock_at(&c, base + 1000000000ULL) == (uint32_t)(0xfffffff0 + 90000));
+  CU_ASSERT(rtp_media_clock_at(&c, base + 1500000000ULL) == (uint32_t)(0xfffffff0 + 135000));
+
+  // no drift or overflow over days
+  CU_ASSERT(rtp_media_clock_at(&c, base + days * 1000000000ULL) == (uint32_t)(0xfffffff0 + days * 90000));
+  CU_ASSERT(rtp_media_clock_at(&c, base + days * 1000000000ULL + 999999999ULL) ==
+      (uint32_t)(0xfffffff0 + days * 90000 + 89999));
+
+  // 8KHz. one unit every 125us
+  c.clock_rate  = 8000;
+  c.offset      = 0;
+  CU_ASSERT(rtp_media_clock_at(&c, base + 124999) == 0);
+  CU_ASSERT(rtp_media_clock_at(&c, base + 125000) == 1);
+  CU_ASSERT(rtp_media_clock_at(&c, base + 20 * 1000000ULL) == 160);
+}
+
+static void
+test_media_clock_session(void)
+{
+  rtp_session_config_t  cfg;
+  rtp_session_t*        sess;
+  ntp_ts_t              ntp1,
+                        ntp2;
+  uint32_t              ts1,
+                        ts2,
+                        now;
+  double                rtp_sec,
+                        ntp_sec;
+
+  common_session_config(&cfg);
+  cfg.clock_rate  = 8000;
+  cfg.media_clock = RTP_TRUE;
+
+  sess = common_session_init_with_config(&cfg);
+  sess->rtp_timestamp = test_media_clock_callback;
+  _callback_count = 0;
+
+  now = rtp_media_clock_now(&sess->media_clock);
+  ts1 = rtp_session_timestamp(sess);
+  CU_ASSERT(ts1 - now < 80);
+
+  // SR pairs stay consistent between reports
+  rtp_session_sr_timestamp(sess, &ntp1, &ts1);
+  usleep(50 * 1000);
+  rtp_session_sr_timestamp(sess, &ntp2, &ts2);
+
+  rtp_sec = (ts2 - ts1) / 8000.;
+  ntp_sec = ntp_ts_diff_in_sec(&ntp1, &ntp2);
+
+  CU_ASSERT(rtp_sec >= 0.05);
+  CU_ASSERT(rtp_sec - ntp_sec < 0.005 && ntp_sec - rtp_sec < 0.005);
+  CU_ASSERT(_callback_count == 0);
+
+  rtp_session_deinit(sess);
+  free(sess);
+
+  // no clock rate, no media clock
+  cfg.clock_rate = 0;
+  sess = common_session_init_with_config(&cfg);
+  sess->rtp_timestamp = test_media_clock_callback;
+
+  CU_ASSERT(sess->config.media_clock == RTP_FALSE);
+  rtp_session_timestamp(sess);
+  CU_ASSERT(_callback_count == 1);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+void
+test_media_clock_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "media_clock::math", test_media_clock_math);
+  CU_add_test(pSuite, "media_clock::session", test_media_clock_session);
+}
@@ -0,0 +1,158 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_metrics.h"
+#include "rtp_timers.h"
+
+#include "test_common.h"
+
+static char     _whole[16384];
+static char     _chunked[16384];
+
+static uint32_t
+format_all(rtp_metrics_t* mt, char* out, uint32_t out_len, uint32_t chunk)
+{
+  uint32_t    off = 0,
+              n;
+
+  while(rtp_metrics_done(mt) == RTP_FALSE)
+  {
+    n = rtp_metrics_format(mt, &out[off], chunk < out_len - off ? chunk : out_len - off);
+    off += n;
+  }
+  out[off] = '\0';
+  return off;
+}
+
+static void
+test_metrics_format(void)
+{
+  rtp_session_t*    sessions[2];
+  rtp_metrics_t     mt;
+  uint8_t           payload[20];
+  uint32_t          len,
+                    clen;
+  char              line[128];
+
+  sessions[0] = common_session_init();
+  sessions[1] = common_session_init();
+
+  memset(payload, 0, sizeof(payload));
+  rtp_session_tx(sessions[1], payload, sizeof(payload), 160, NULL, 0);
+  rtp_session_tx(sessions[1], payload, sizeof(payload), 320, NULL, 0);
+
+  rtp_metrics_begin(&mt, sessions, 2);
+  len = format_all(&mt, _whole, sizeof(_whole) - 1, sizeof(_whole) - 1);
+
+  // samples of a family are grouped under one header
+  CU_ASSERT(strstr(_whole, "# TYPE prtp_tx_packets_total counter\n"
+                           "prtp_tx_packets_total{session=\"0\"") != NULL);
+
+  snprintf(line, sizeof(line), "prtp_tx_packets_total{session=\"1\",ssrc=\"%u\"} 2\n", sessions[1]->self->ssrc);
+  CU_ASSERT(strstr(_whole, line) != NULL);
+
+  snprintf(line, sizeof(line), "prtp_tx_octets_total{session=\"1\",ssrc=\"%u\"} 40\n", sessions[1]->self->ssrc);
+  CU_ASSERT(strstr(_whole, line) != NULL);
+
+  // only non-zero result counters. self is not reported as a remote member
+  CU_ASSERT(strstr(_whole, "prtp_rtp_rx_total{") == NULL);
+  CU_ASSERT(strstr(_whole, "prtp_member_rx_packets_total{") == NULL);
+
+  // a line never straddles two chunks
+  rtp_metrics_begin(&mt, sessions, 2);
+  clen = format_all(&mt, _chunked, sizeof(_chunked) - 1, 256);
+
+  CU_ASSERT(clen == len);
+  CU_ASSERT(strcmp(_whole, _chunked) == 0);
+
+  // too small for any line
+  rtp_metrics_begin(&mt, sessions, 2);
+  CU_ASSERT(rtp_metrics_format(&mt, _chunked, 10) == 0);
+  CU_ASSERT(rtp_metrics_done(&mt) == RTP_FALSE);
+
+  for(uint32_t i = 0; i < 2; i++)
+  {
+    rtp_session_deinit(sessions[i]);
+    free(sessions[i]);
+  }
+}
+
+static uint32_t
+count_str(const char* haystack, const char* needle)
+{
+  uint32_t    n = 0;
+
+  while((haystack = strstr(haystack, needle)) != NULL)
+  {
+    n++;
+    haystack++;
+  }
+  return n;
+}
+
+static void
+test_metrics_member_leave(void)
+{
+  rtp_session_t*    sess;
+  rtp_metrics_t     mt;
+  uint32_t          off = 0,
+                    gone;
+  char              line[128];
+
+  sess = common_session_init();
+
+  for(uint32_t ssrc = 100; ssrc < 106; ssrc++)
+  {
+    rtp_timers_init_member(sess, rtp_member_table_alloc_member(&sess->member_table, ssrc));
+  }
+
+  //
+  // stop in the middle of the first member family
+  //
+  _whole[0] = '\0';
+
+  rtp_metrics_begin(&mt, &sess, 1);
+  while(rtp_metrics_done(&mt) == RTP_FALSE &&
+      (mt.member == NULL || mt.member_ssrc < 102 || mt.member_ssrc >= 106 ||
+       strstr(_whole, "# TYPE prtp_member_rx_packets_total") == NULL))
+  {
+    off += rtp_metrics_format(&mt, &_whole[off], 160);
+    _whole[off] = '\0';
+  }
+
+  // and the member at the cursor leaves
+  CU_ASSERT(mt.member != NULL && mt.member->ssrc == mt.member_ssrc);
+  if(mt.member == NULL)
+  {
+    rtp_session_deinit(sess);
+    free(sess);
+    return;
+  }
+
+  gone = mt.member_ssrc;
+  rtp_member_table_free(&sess->member_table, mt.member);
+
+  format_all(&mt, &_whole[off], sizeof(_whole) - 1 - off, 160);
+
+  for(uint32_t ssrc = 100; ssrc < 106; ssrc++)
+  {
+    snprintf(line, sizeof(line), "prtp_member_rx_packets_total{session=\"0\",ssrc=\"%u\"} 0\n", ssrc);
+    CU_ASSERT(count_str(_whole, line) == (ssrc == gone ? 0 : 1));
+  }
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+void
+test_metrics_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "metrics::format", test_metrics_format);
+  CU_add_test(pSuite, "metrics::member_leave", test_metrics_member_leave);
+}
@@ -0,0 +1,81 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_prof.h"
+
+#include "test_common.h"
+
+static void
+test_prof_bucket(void)
+{
+  CU_ASSERT(rtp_prof_bucket(0) == 0);
+  CU_ASSERT(rtp_prof_bucket(1) == 1);
+  CU_ASSERT(rtp_prof_bucket(2) == 2);
+  CU_ASSERT(rtp_prof_bucket(3) == 2);
+  CU_ASSERT(rtp_prof_bucket(4) == 3);
+  CU_ASSERT(rtp_prof_bucket(1023) == 10);
+  CU_ASSERT(rtp_prof_bucket(1024) == 11);
+  CU_ASSERT(rtp_prof_bucket(~0ull) == RTP_PROF_BUCKETS - 1);
+}
+
+static void
+test_prof_record(void)
+{
+  rtp_prof_t        prof;
+  rtp_prof_hist_t*  h = &prof.hist[rtp_prof_stage_rtcp_rx];
+
+  rtp_prof_init(&prof);
+
+  rtp_prof_record(&prof, rtp_prof_stage_rtcp_rx, 100);
+  rtp_prof_record(&prof, rtp_prof_stage_rtcp_rx, 120);
+  rtp_prof_record(&prof, rtp_prof_stage_rtcp_rx, 5000);
+
+  CU_ASSERT(h->count == 3);
+  CU_ASSERT(h->sum == 5220);
+  CU_ASSERT(h->max == 5000);
+  CU_ASSERT(h->buckets[7] == 2);
+  CU_ASSERT(h->buckets[13] == 1);
+
+  CU_ASSERT(prof.hist[rtp_prof_stage_rtp_rx].count == 0);
+  CU_ASSERT(strcmp(rtp_prof_stage_name(rtp_prof_stage_rtcp_rx), "rtcp_rx") == 0);
+}
+
+static void
+test_prof_session(void)
+{
+  rtp_session_t*    sess;
+  rtp_prof_t        prof;
+  uint8_t           pkt[8];
+
+  sess = common_session_init();
+
+  memset(pkt, 0, sizeof(pkt));
+  rtp_session_rx_rtcp(sess, pkt, 7, &_rtcp_rem_addr);
+  rtp_session_timer_tick(sess);
+
+#if RTP_CONFIG_PROFILE == 1
+  CU_ASSERT(rtp_session_get_prof(sess, &prof) == 0);
+  CU_ASSERT(prof.hist[rtp_prof_stage_rtcp_rx].count == 1);
+  CU_ASSERT(prof.hist[rtp_prof_stage_timer_tick].count == 1);
+  CU_ASSERT(rtp_prof_process()->hist[rtp_prof_stage_rtcp_rx].count >= 1);
+#else
+  CU_ASSERT(rtp_session_get_prof(sess, &prof) == -1);
+#endif
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+void
+test_prof_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "prof::bucket", test_prof_bucket);
+  CU_add_test(pSuite, "prof::record", test_prof_record);
+  CU_add_test(pSuite, "prof::session", test_prof_session);
+}
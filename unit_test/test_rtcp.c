@@ -9,14 +9,20 @@
 #include "rtp_session.h"
 #include "rtp_session_util.h"
 #include "rtcp_encoder.h"
+#include "rtcp.h"
 
 #include "test_common.h"
 
-static rtcp_rr_t    _rr_rx;
+static rtcp_rr_info_t _rr_rx;
+static uint32_t     _app_count;
+static uint32_t     _app_len;
+static uint32_t     _xr_count;
+static uint8_t      _tx_buf[RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN];
+static uint32_t     _tx_len;
 static uint32_t     _from_ssrc;
 
 static void
-rx_rtcp_rr_callback(rtp_session_t* sess, uint32_t from_ssrc, rtcp_rr_t* rr)
+rx_rtcp_rr_callback(rtp_session_t* sess, uint32_t from_ssrc, const rtcp_rr_info_t* rr)
 {
   _rr_rx = *rr;
   _from_ssrc = from_ssrc;
@@ -29,6 +35,7 @@ test_rtcp_pkt_check(void)
   rtp_session_t*  sess;
   uint8_t         buf[256];
   rtcp_common_t*  hdr;
+  rtp_session_stats_t st;
 
   sess = common_session_init();
 
@@ -65,6 +72,14 @@ test_rtcp_pkt_check(void)
   rtp_session_rx_rtcp(sess, buf, sizeof(rtcp_common_t) + 8, &_rtcp_rem_addr);
   CU_ASSERT(sess->last_rtcp_error == rtcp_rx_error_invalid_compound_packet);
 
+  rtp_session_get_stats(sess, &st);
+  CU_ASSERT(st.invalid_rtcp_pkt == 7);
+  CU_ASSERT(st.rtcp_errors[rtcp_rx_error_no_error] == 0);
+  CU_ASSERT(st.rtcp_errors[rtcp_rx_error_header_too_short] == 1);
+  CU_ASSERT(st.rtcp_errors[rtcp_rx_error_len_not_multiple_4] == 1);
+  CU_ASSERT(st.rtcp_errors[rtcp_rx_error_invalid_mask] == 3);
+  CU_ASSERT(st.rtcp_errors[rtcp_rx_error_invalid_compound_packet] == 2);
+
   rtp_session_deinit(sess);
   free(sess);
 }
@@ -428,18 +443,550 @@ test_rtcp_rx_rr(void)
   rtp_session_rx_rtcp(sess, enc.buf, pkt_len, &_rtcp_rem_addr);
 
   CU_ASSERT(_from_ssrc == 1002);
-  CU_ASSERT(ntohl(_rr_rx.ssrc) == 1234);
+  CU_ASSERT(_rr_rx.ssrc == 1234);
   CU_ASSERT(_rr_rx.fraction == 11);
-  CU_ASSERT(ntohl(_rr_rx.lost << 8) == 2222);
-  CU_ASSERT(ntohl(_rr_rx.last_seq) == 3333);
-  CU_ASSERT(ntohl(_rr_rx.jitter) == 4444);
-  CU_ASSERT(ntohl(_rr_rx.lsr) == 5555);
-  CU_ASSERT(ntohl(_rr_rx.dlsr) == 6666);
+  CU_ASSERT(_rr_rx.lost == 2222);
+  CU_ASSERT(_rr_rx.last_seq == 3333);
+  CU_ASSERT(_rr_rx.jitter == 4444);
+  CU_ASSERT(_rr_rx.lsr == 5555);
+  CU_ASSERT(_rr_rx.dlsr == 6666);
 
   rtcp_encoder_deinit(&enc);
   rtp_session_deinit(sess);
 }
 
+static void
+test_rtcp_rtt(void)
+{
+  rtcp_encoder_t      enc;
+  uint32_t            pkt_len;
+  rtp_session_t*      sess;
+  rtp_member_t*       m;
+  ntp_ts_t            now;
+  rtp_member_stats_t  st;
+
+  sess = common_session_init();
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  //
+  // our SR went out 2 sec ago and the remote held it for 0.5 sec.
+  // a block about somebody else doesn't count
+  //
+  ntp_ts_now(&now);
+
+  rtcp_encoder_rr_begin(&enc, 1003);
+  rtcp_encoder_rr_add_rr(&enc, 1234, 0, 0, 0, 0, ntp_ts_middle32(&now) - 0x10000, 0);
+  rtcp_encoder_rr_add_rr(&enc, sess->self->ssrc, 0, 0, 0, 0, ntp_ts_middle32(&now) - 0x20000, 0x8000);
+  rtcp_encoder_end_packet(&enc);
+
+  pkt_len = rtcp_encoder_msg_len(&enc);
+
+  rtp_session_rx_rtcp(sess, enc.buf, pkt_len, &_rtcp_rem_addr);
+
+  m = rtp_session_lookup_member(sess, 1003);
+  CU_ASSERT(m != NULL);
+  CU_ASSERT(m->rtt >= 0x18000 && m->rtt < 0x18000 + 0x1000);
+
+  CU_ASSERT(rtp_session_get_member_stats(sess, 1003, &st) == 0);
+  CU_ASSERT(st.rtt == m->rtt);
+
+  // LSR 0. no SR from us yet
+  rtcp_encoder_reset(&enc);
+  rtcp_encoder_rr_begin(&enc, 1004);
+  rtcp_encoder_rr_add_rr(&enc, sess->self->ssrc, 0, 0, 0, 0, 0, 0);
+  rtcp_encoder_end_packet(&enc);
+
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+
+  m = rtp_session_lookup_member(sess, 1004);
+  CU_ASSERT(m != NULL);
+  CU_ASSERT(m->rtt == RTP_MEMBER_RTT_UNKNOWN);
+
+  rtcp_encoder_deinit(&enc);
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+rx_app_callback(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
+{
+  uint32_t        ssrc;
+  const uint8_t   *name,
+                  *data;
+
+  rtcp_view_app(v, &ssrc, &name, &data, &_app_len);
+  _app_count++;
+}
+
+static void
+rx_xr_callback(rtp_session_t* sess, const rtcp_pkt_view_t* v, struct sockaddr_in* from)
+{
+  _xr_count++;
+}
+
+static void
+tx_app_callback(rtp_session_t* sess, rtcp_encoder_t* enc)
+{
+  rtcp_encoder_app_begin(enc, 3, sess->self->ssrc, (const uint8_t*)"TELE");
+  rtcp_encoder_app_add_data(enc, (const uint8_t*)"12345678", 8);
+  rtcp_encoder_end_packet(enc);
+}
+
+static int
+capture_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  memcpy(_tx_buf, pkt, len);
+  _tx_len = len;
+  return 0;
+}
+
+static void
+test_rtcp_app_dispatch(void)
+{
+  rtcp_encoder_t    enc;
+  uint32_t          pkt_len;
+  rtp_session_t*    sess;
+  rtcp_t*           xr;
+
+  sess = common_session_init();
+
+  _app_count  = 0;
+  _xr_count   = 0;
+
+  CU_ASSERT(rtp_session_set_rtcp_handler(sess, RTCP_SR, rx_xr_callback) == -1);
+  CU_ASSERT(rtp_session_set_rtcp_handler(sess, 100, rx_xr_callback) == -1);
+  CU_ASSERT(rtp_session_set_app_handler(sess, (const uint8_t*)"TELE", 3, rx_app_callback) == 0);
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_rr_begin(&enc, 1002);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_app_begin(&enc, 3, 1002, (const uint8_t*)"TELE");
+  rtcp_encoder_app_add_data(&enc, (const uint8_t*)"abcdefgh", 8);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_app_begin(&enc, 4, 1002, (const uint8_t*)"TELE");
+  rtcp_encoder_end_packet(&enc);
+
+  // XR. RFC 3611
+  xr = (rtcp_t*)&enc.buf[rtcp_encoder_msg_len(&enc)];
+  rtcp_encoder_rr_begin(&enc, 1002);
+  rtcp_encoder_end_packet(&enc);
+  xr->common.pt = 207;
+
+  pkt_len = rtcp_encoder_msg_len(&enc);
+
+  rtp_session_rx_rtcp(sess, enc.buf, pkt_len, &_rtcp_rem_addr);
+
+  CU_ASSERT(sess->invalid_rtcp_pkt == 0);
+  CU_ASSERT(_app_count == 1);
+  CU_ASSERT(_app_len == 8);
+  CU_ASSERT(_xr_count == 0);
+  CU_ASSERT(sess->unknown_rtcp_pkt == 2);
+
+  CU_ASSERT(rtp_session_set_rtcp_handler(sess, 207, rx_xr_callback) == 0);
+  CU_ASSERT(rtp_session_set_app_handler(sess, (const uint8_t*)"TELE", 3, NULL) == 0);
+
+  rtp_session_rx_rtcp(sess, enc.buf, pkt_len, &_rtcp_rem_addr);
+
+  CU_ASSERT(_app_count == 1);
+  CU_ASSERT(_xr_count == 1);
+  CU_ASSERT(sess->unknown_rtcp_pkt == 4);
+
+  // table full
+  for(uint8_t i = 0; i < RTP_CONFIG_RTCP_APP_TABLE_SIZE - 1; i++)
+  {
+    CU_ASSERT(rtp_session_set_app_handler(sess, (const uint8_t*)"FILL", i, rx_app_callback) == 0);
+  }
+  CU_ASSERT(rtp_session_set_app_handler(sess, (const uint8_t*)"FULL", 0, rx_app_callback) == -1);
+
+  // a removed entry can be reused
+  CU_ASSERT(rtp_session_set_app_handler(sess, (const uint8_t*)"TELE", 3, rx_app_callback) == 0);
+
+  rtcp_encoder_deinit(&enc);
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_rtcp_app_liveness(void)
+{
+  rtcp_encoder_t    enc;
+  rtp_session_t*    sess;
+  uint32_t          ticks;
+
+  sess = common_session_init();
+  ticks = RTP_CONFIG_MEMBER_TIMEOUT / sess->soft_timer.tick_rate * 3 / 4;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  rtcp_encoder_rr_begin(&enc, 1002);
+  rtcp_encoder_end_packet(&enc);
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  CU_ASSERT(rtp_session_lookup_member(sess, 1002) != NULL);
+
+  for(uint32_t i = 0; i < ticks; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  //
+  // 1002 is heard only by APP now. no handler needed to count
+  //
+  rtcp_encoder_reset(&enc);
+  rtcp_encoder_rr_begin(&enc, 1003);
+  rtcp_encoder_end_packet(&enc);
+  rtcp_encoder_app_begin(&enc, 3, 1002, (const uint8_t*)"TELE");
+  rtcp_encoder_end_packet(&enc);
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  CU_ASSERT(sess->unknown_rtcp_pkt == 1);
+
+  for(uint32_t i = 0; i < ticks; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  CU_ASSERT(rtp_session_lookup_member(sess, 1002) != NULL);
+
+  // an APP doesn't make a new member
+  rtcp_encoder_reset(&enc);
+  rtcp_encoder_rr_begin(&enc, 1003);
+  rtcp_encoder_end_packet(&enc);
+  rtcp_encoder_app_begin(&enc, 3, 1004, (const uint8_t*)"TELE");
+  rtcp_encoder_end_packet(&enc);
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  CU_ASSERT(rtp_session_lookup_member(sess, 1004) == NULL);
+
+  rtcp_encoder_deinit(&enc);
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_rtcp_tx_app(void)
+{
+  rtp_session_t*    sess;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  uint32_t          ssrc,
+                    len;
+  const uint8_t     *name,
+                    *data;
+  uint8_t           found = RTP_FALSE;
+
+  sess = common_session_init();
+  sess->tx_rtcp = capture_tx_rtcp;
+  sess->tx_app  = tx_app_callback;
+
+  _tx_len = 0;
+  for(int i = 0; i < 100 && _tx_len == 0; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+  CU_ASSERT(_tx_len != 0);
+
+  CU_ASSERT(rtcp_reader_init(&rd, _tx_buf, _tx_len, RTP_FALSE) == RTP_TRUE);
+  while(rtcp_reader_next(&rd, &v) == RTP_TRUE)
+  {
+    if(v.pt != RTCP_APP)
+    {
+      continue;
+    }
+
+    rtcp_view_app(&v, &ssrc, &name, &data, &len);
+    CU_ASSERT(v.count == 3);
+    CU_ASSERT(ssrc == sess->self->ssrc);
+    CU_ASSERT(memcmp(name, "TELE", 4) == 0);
+    CU_ASSERT(len == 8);
+    CU_ASSERT(memcmp(data, "12345678", 8) == 0);
+    found = RTP_TRUE;
+  }
+  CU_ASSERT(rd.error == rtcp_rx_error_no_error);
+  CU_ASSERT(found == RTP_TRUE);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static int
+report_blocks_rx_rtp(rtp_session_t* sess, rtp_rx_report_t* rpt)
+{
+  return 0;
+}
+
+static void
+test_rtcp_report_blocks(void)
+{
+  rtp_session_t*    sess;
+  rtcp_encoder_t    enc;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  rtcp_rr_info_t    rr;
+  rtp_hdr_t*        hdr;
+  uint8_t           buf[256];
+
+  sess = common_session_init();
+  sess->tx_rtcp = capture_tx_rtcp;
+  sess->rx_rtp  = report_blocks_rx_rtp;
+
+  // RTCP only members. no RTP heard from them
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  for(uint32_t ssrc = 1003; ssrc <= 1004; ssrc++)
+  {
+    rtcp_encoder_reset(&enc);
+    rtcp_encoder_rr_begin(&enc, ssrc);
+    rtcp_encoder_end_packet(&enc);
+    rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  }
+  rtcp_encoder_deinit(&enc);
+
+  // a sender
+  hdr = (rtp_hdr_t*)buf;
+  memset(buf, 0, sizeof(buf));
+  hdr->version  = RTP_VERSION;
+  hdr->pt       = SESSION_PT;
+  hdr->ssrc     = htonl(1234);
+  for(uint16_t seq = 10; seq < 10 + RTP_CONFIG_MIN_SEQUENTIAL + 1; seq++)
+  {
+    hdr->seq = htons(seq);
+    rtp_session_rx_rtp(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr2);
+  }
+  CU_ASSERT(sess->rtcp_var.members == 4);
+
+  _tx_len = 0;
+  CU_ASSERT(rtcp_send_report(sess) != 0);
+  CU_ASSERT(_tx_len != 0);
+
+  CU_ASSERT(rtcp_reader_init(&rd, _tx_buf, _tx_len, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_RR);
+  CU_ASSERT(v.count == 1);
+
+  rtcp_view_report_block(&v, 0, &rr);
+  CU_ASSERT(rr.ssrc == 1234);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+#define TEST_RTCP_RR_SENDERS        (RTP_CONFIG_MAX_MEMBERS_PER_SESSION - 1)
+#define TEST_RTCP_RR_BASE_SSRC      2000
+
+static uint32_t
+report_blocks_collect(uint8_t seen[TEST_RTCP_RR_SENDERS], uint32_t* first)
+{
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  rtcp_rr_info_t    rr;
+
+  CU_ASSERT(rtcp_reader_init(&rd, _tx_buf, _tx_len, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_SR);
+
+  for(uint32_t i = 0; i < v.count; i++)
+  {
+    rtcp_view_report_block(&v, i, &rr);
+    if(i == 0)
+    {
+      *first = rr.ssrc;
+    }
+
+    CU_ASSERT(rr.ssrc >= TEST_RTCP_RR_BASE_SSRC && rr.ssrc < TEST_RTCP_RR_BASE_SSRC + TEST_RTCP_RR_SENDERS);
+    if(rr.ssrc >= TEST_RTCP_RR_BASE_SSRC && rr.ssrc < TEST_RTCP_RR_BASE_SSRC + TEST_RTCP_RR_SENDERS)
+    {
+      seen[rr.ssrc - TEST_RTCP_RR_BASE_SSRC]++;
+    }
+  }
+  return v.count;
+}
+
+static void
+test_rtcp_report_blocks_round_robin(void)
+{
+  rtp_session_config_t  cfg;
+  rtp_session_t*    sess;
+  rtp_hdr_t*        hdr;
+  uint8_t           buf[256];
+  uint8_t           seen[TEST_RTCP_RR_SENDERS];
+  uint32_t          fit,
+                    count,
+                    first = 0;
+
+  //
+  // longest CNAME so that all the senders don't fit
+  // next to SR and SDES in the encoder buffer
+  //
+  common_session_config(&cfg);
+  memset(cfg.cname, 'c', 255);
+  cfg.cname_len = 255;
+
+  sess = common_session_init_with_config(&cfg);
+  sess->tx_rtcp = capture_tx_rtcp;
+  sess->rx_rtp  = report_blocks_rx_rtp;
+
+  rtp_session_tx(sess, buf, 128, 0, NULL, 0);
+
+  hdr = (rtp_hdr_t*)buf;
+  memset(buf, 0, sizeof(buf));
+  hdr->version  = RTP_VERSION;
+  hdr->pt       = SESSION_PT;
+  for(uint32_t i = 0; i < TEST_RTCP_RR_SENDERS; i++)
+  {
+    hdr->ssrc = htonl(TEST_RTCP_RR_BASE_SSRC + i);
+    for(uint16_t seq = 10; seq < 10 + RTP_CONFIG_MIN_SEQUENTIAL + 1; seq++)
+    {
+      hdr->seq = htons(seq);
+      rtp_session_rx_rtp(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr2);
+    }
+  }
+  CU_ASSERT(sess->rtcp_var.senders == TEST_RTCP_RR_SENDERS + 1);
+
+  fit = (RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN - RTCP_SR_HDR_SIZE -
+         RTCP_SDES_HDR_SIZE - RTCP_SDES_CNAME_CHUNK_SIZE(255)) / RTCP_REPORT_BLOCK_SIZE;
+  CU_ASSERT(fit < TEST_RTCP_RR_SENDERS);
+
+  memset(seen, 0, sizeof(seen));
+
+  // as many as fit
+  _tx_len = 0;
+  CU_ASSERT(rtcp_send_report(sess) != 0);
+  CU_ASSERT(_tx_len != 0);
+
+  count = report_blocks_collect(seen, &first);
+  CU_ASSERT(count == fit);
+
+  // the next report starts at the first one left out
+  _tx_len = 0;
+  CU_ASSERT(rtcp_send_report(sess) != 0);
+  CU_ASSERT(_tx_len != 0);
+
+  count = report_blocks_collect(seen, &first);
+  CU_ASSERT(count == fit);
+  CU_ASSERT(seen[first - TEST_RTCP_RR_BASE_SSRC] == 1);
+
+  for(uint32_t i = 0; i < TEST_RTCP_RR_SENDERS; i++)
+  {
+    CU_ASSERT(seen[i] >= 1);
+  }
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+//
+// RFC 3550 A.7 COMPENSATION. the interval is drawn from
+// [0.5, 1.5) * T / COMPENSATION
+//
+#define TEST_RTCP_COMPENSATION      (2.71828 - 1.5)
+
+static uint8_t
+tick_until_rtcp_tx(rtp_session_t* sess, uint32_t max_ticks)
+{
+  _tx_len = 0;
+  for(uint32_t i = 0; i < max_ticks && _tx_len == 0; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+  return _tx_len != 0;
+}
+
+static void
+test_rtcp_interval_bw(void)
+{
+  rtp_session_t*    sess;
+  double            rtcp_bw,
+                    t;
+
+  sess = common_session_init();
+  sess->tx_rtcp = capture_tx_rtcp;
+
+  CU_ASSERT(tick_until_rtcp_tx(sess, 100) == RTP_TRUE);
+
+  // 100 more receivers. big enough to go past the 5 second minimum
+  sess->rtcp_var.members += 100;
+
+  CU_ASSERT(tick_until_rtcp_tx(sess, 10000) == RTP_TRUE);
+
+  //
+  // receivers share 75% of 5% of the session bandwidth.
+  // session_bw is bits/sec, rtcp_bw octets/sec
+  //
+  rtcp_bw = sess->config.session_bw / 8. * 0.05 * 0.75;
+  t       = sess->rtcp_var.avg_rtcp_size * sess->rtcp_var.members / rtcp_bw;
+
+  CU_ASSERT(t > 5.);
+  CU_ASSERT(sess->avpf_var.t_rr >= 0.5 * t / TEST_RTCP_COMPENSATION);
+  CU_ASSERT(sess->avpf_var.t_rr < 1.5 * t / TEST_RTCP_COMPENSATION);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_rtcp_avg_size_overhead(void)
+{
+  rtp_session_t*    sess;
+  double            avg;
+
+  sess = common_session_init();
+  sess->tx_rtcp = capture_tx_rtcp;
+
+  avg = sess->rtcp_var.avg_rtcp_size;
+
+  CU_ASSERT(tick_until_rtcp_tx(sess, 100) == RTP_TRUE);
+
+  // RFC 3550 6.2. the average includes IP and UDP headers
+  CU_ASSERT(sess->rtcp_var.avg_rtcp_size ==
+      (1./16.) * (_tx_len + RTCP_IP_UDP_OVERHEAD) + (15./16.) * avg);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_rtcp_member_timeout_td(void)
+{
+  rtp_session_t*    sess;
+  rtcp_encoder_t    enc;
+  double            td;
+
+  sess = common_session_init();
+  sess->tx_rtcp = capture_tx_rtcp;
+
+  // small session keeps the minimum
+  CU_ASSERT(tick_until_rtcp_tx(sess, 100) == RTP_TRUE);
+  CU_ASSERT(sess->rtcp_var.member_timeout == RTP_CONFIG_MEMBER_TIMEOUT);
+
+  sess->rtcp_var.members += 100;
+
+  CU_ASSERT(tick_until_rtcp_tx(sess, 10000) == RTP_TRUE);
+
+  // RFC 3550 6.3.5. 5 * Td, Td being the deterministic receiver interval
+  td = sess->rtcp_var.avg_rtcp_size * sess->rtcp_var.members / (sess->rtcp_var.rtcp_bw * 0.75);
+  CU_ASSERT(sess->rtcp_var.member_timeout == (uint32_t)(td * 5 * 1000));
+  CU_ASSERT(sess->rtcp_var.member_timeout > RTP_CONFIG_MEMBER_TIMEOUT);
+
+  // a member outlives the minimum
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+  rtcp_encoder_rr_begin(&enc, 1001);
+  rtcp_encoder_end_packet(&enc);
+  rtp_session_rx_rtcp(sess, enc.buf, rtcp_encoder_msg_len(&enc), &_rtcp_rem_addr);
+  rtcp_encoder_deinit(&enc);
+
+  CU_ASSERT(rtp_session_lookup_member(sess, 1001) != NULL);
+
+  for(uint32_t i = 0; i <= (RTP_CONFIG_MEMBER_TIMEOUT / sess->soft_timer.tick_rate); i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  CU_ASSERT(rtp_session_lookup_member(sess, 1001) != NULL);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
 void
 test_rtcp_add(CU_pSuite pSuite)
 {
@@ -453,4 +1000,13 @@ test_rtcp_add(CU_pSuite pSuite)
   CU_add_test(pSuite, "rtcp::own_conflict", test_rtcp_own_conflict);
   CU_add_test(pSuite, "rtcp::rx_sr", test_rtcp_rx_sr);
   CU_add_test(pSuite, "rtcp::rx_rr", test_rtcp_rx_rr);
+  CU_add_test(pSuite, "rtcp::rtt", test_rtcp_rtt);
+  CU_add_test(pSuite, "rtcp::app_dispatch", test_rtcp_app_dispatch);
+  CU_add_test(pSuite, "rtcp::app_liveness", test_rtcp_app_liveness);
+  CU_add_test(pSuite, "rtcp::tx_app", test_rtcp_tx_app);
+  CU_add_test(pSuite, "rtcp::report_blocks", test_rtcp_report_blocks);
+  CU_add_test(pSuite, "rtcp::report_blocks_round_robin", test_rtcp_report_blocks_round_robin);
+  CU_add_test(pSuite, "rtcp::interval_bw", test_rtcp_interval_bw);
+  CU_add_test(pSuite, "rtcp::avg_size_overhead", test_rtcp_avg_size_overhead);
+  CU_add_test(pSuite, "rtcp::member_timeout_td", test_rtcp_member_timeout_td);
 }
@@ -0,0 +1,293 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtcp_encoder.h"
+#include "rtcp_reader.h"
+
+#include "test_common.h"
+
+static void
+test_rtcp_reader_compound(void)
+{
+  rtcp_encoder_t    enc;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  rtcp_sr_info_t    sr;
+  rtcp_rr_info_t    rr;
+  rtcp_sdes_iter_t  it;
+  uint32_t          ssrc;
+  uint8_t           type,
+                    len;
+  const uint8_t*    data;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_sr_begin(&enc, 1001, 11, 22, 33, 44, 55);
+  rtcp_encoder_sr_add_rr(&enc, 1234, 11, -3, 3333, 4444, 5555, 6666);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_sdes_begin(&enc);
+  rtcp_encoder_sdes_chunk_begin(&enc, 1001);
+  rtcp_encoder_sdes_chunk_add_cname(&enc, (const uint8_t*)"test1", 5);
+  rtcp_encoder_sdes_chunk_end(&enc);
+  rtcp_encoder_sdes_chunk_begin(&enc, 1002);
+  rtcp_encoder_sdes_chunk_add_cname(&enc, (const uint8_t*)"test-2", 6);
+  rtcp_encoder_sdes_chunk_end(&enc);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_bye_begin(&enc);
+  rtcp_encoder_bye_add_ssrc(&enc, 1001);
+  rtcp_encoder_bye_add_ssrc(&enc, 1002);
+  rtcp_encoder_end_packet(&enc);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, rtcp_encoder_msg_len(&enc), RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rd.rsize == RTP_FALSE);
+
+  // SR
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_SR);
+  CU_ASSERT(v.count == 1);
+  CU_ASSERT(v.len == 52);
+
+  rtcp_view_sr(&v, &sr);
+  CU_ASSERT(sr.ssrc == 1001);
+  CU_ASSERT(sr.ntp_sec == 11);
+  CU_ASSERT(sr.ntp_frac == 22);
+  CU_ASSERT(sr.rtp_ts == 33);
+  CU_ASSERT(sr.psent == 44);
+  CU_ASSERT(sr.osent == 55);
+
+  rtcp_view_report_block(&v, 0, &rr);
+  CU_ASSERT(rr.ssrc == 1234);
+  CU_ASSERT(rr.fraction == 11);
+  CU_ASSERT(rr.lost == -3);
+  CU_ASSERT(rr.last_seq == 3333);
+  CU_ASSERT(rr.jitter == 4444);
+  CU_ASSERT(rr.lsr == 5555);
+  CU_ASSERT(rr.dlsr == 6666);
+
+  // SDES
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_SDES);
+  CU_ASSERT(v.count == 2);
+
+  rtcp_view_sdes_begin(&v, &it);
+
+  CU_ASSERT(rtcp_sdes_next_chunk(&it, &ssrc) == RTP_TRUE);
+  CU_ASSERT(ssrc == 1001);
+  CU_ASSERT(rtcp_sdes_next_item(&it, &type, &data, &len) == RTP_TRUE);
+  CU_ASSERT(type == RTCP_SDES_CNAME);
+  CU_ASSERT(len == 5);
+  CU_ASSERT(memcmp(data, "test1", 5) == 0);
+  CU_ASSERT(rtcp_sdes_next_item(&it, &type, &data, &len) == RTP_FALSE);
+
+  // items left unread are skipped
+  CU_ASSERT(rtcp_sdes_next_chunk(&it, &ssrc) == RTP_TRUE);
+  CU_ASSERT(ssrc == 1002);
+  CU_ASSERT(rtcp_sdes_next_chunk(&it, &ssrc) == RTP_FALSE);
+
+  // BYE
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_BYE);
+  CU_ASSERT(v.count == 2);
+  CU_ASSERT(rtcp_view_bye_ssrc(&v, 0) == 1001);
+  CU_ASSERT(rtcp_view_bye_ssrc(&v, 1) == 1002);
+
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_no_error);
+
+  rtcp_encoder_deinit(&enc);
+}
+
+static void
+test_rtcp_reader_header(void)
+{
+  rtcp_encoder_t    enc;
+  rtcp_reader_t     rd;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, 3, RTP_FALSE) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_header_too_short);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, 7, RTP_FALSE) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_len_not_multiple_4);
+
+  // feedback first is allowed only with reduced-size
+  rtcp_encoder_fb_begin(&enc, RTCP_PSFB, RTCP_PSFB_FMT_PLI, 1001, 2002);
+  rtcp_encoder_end_packet(&enc);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, rtcp_encoder_msg_len(&enc), RTP_FALSE) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_invalid_mask);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, rtcp_encoder_msg_len(&enc), RTP_TRUE) == RTP_TRUE);
+  CU_ASSERT(rd.rsize == RTP_TRUE);
+
+  rtcp_encoder_deinit(&enc);
+}
+
+static void
+test_rtcp_reader_truncated(void)
+{
+  rtcp_encoder_t    enc;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  rtcp_t*           r = (rtcp_t*)enc.buf;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_rr_begin(&enc, 1001);
+  rtcp_encoder_rr_add_rr(&enc, 1234, 0, 0, 0, 0, 0, 0);
+  rtcp_encoder_end_packet(&enc);
+
+  // length beyond the end of the compound packet
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, 12, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_invalid_compound_packet);
+
+  // report count doesn't fit in length
+  r->common.count = 2;
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, rtcp_encoder_msg_len(&enc), RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_invalid_compound_packet);
+
+  // the error sticks
+  r->common.count = 1;
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, rtcp_encoder_msg_len(&enc), RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(rtcp_view_rr_ssrc(&v) == 1001);
+
+  rtcp_encoder_deinit(&enc);
+}
+
+static void
+test_rtcp_reader_padding(void)
+{
+  rtcp_encoder_t    enc;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  rtcp_t*           r = (rtcp_t*)enc.buf;
+  rtcp_t*           bye;
+  uint32_t          len;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_rr_begin(&enc, 1001);
+  rtcp_encoder_end_packet(&enc);
+
+  bye = (rtcp_t*)&enc.buf[rtcp_encoder_msg_len(&enc)];
+
+  rtcp_encoder_bye_begin(&enc);
+  rtcp_encoder_bye_add_ssrc(&enc, 1001);
+  rtcp_encoder_end_packet(&enc);
+
+  len = rtcp_encoder_msg_len(&enc);
+
+  // 4 octets of padding on the last packet
+  memset(&enc.buf[len], 0, 4);
+  enc.buf[len + 3] = 4;
+  bye->common.p = 1;
+  bye->common.length = htons(ntohs(bye->common.length) + 1);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, len + 4, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_BYE);
+  CU_ASSERT(v.len == 8);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_no_error);
+
+  // invalid pad count
+  enc.buf[len + 3] = 12;
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, len + 4, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_invalid_compound_packet);
+
+  // padding is only allowed on the last packet
+  enc.buf[len + 3] = 4;
+  memcpy(&enc.buf[len + 4], r, 8);
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, len + 12, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_invalid_compound_packet);
+
+  rtcp_encoder_deinit(&enc);
+}
+
+static void
+test_rtcp_reader_app_fb(void)
+{
+  rtcp_encoder_t    enc;
+  rtcp_reader_t     rd;
+  rtcp_pkt_view_t   v;
+  uint8_t*          app;
+  uint32_t          ssrc,
+                    media_ssrc,
+                    len;
+  const uint8_t     *name,
+                    *data;
+
+  rtcp_encoder_init(&enc, RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN);
+
+  rtcp_encoder_rr_begin(&enc, 1001);
+  rtcp_encoder_end_packet(&enc);
+
+  rtcp_encoder_fb_begin(&enc, RTCP_RTPFB, RTCP_RTPFB_FMT_NACK, 1001, 2002);
+  rtcp_encoder_fb_add_nack(&enc, 100, 0x3);
+  rtcp_encoder_end_packet(&enc);
+
+  // APP, subtype 5, name "TEST", 4 octets of data
+  app = &enc.buf[rtcp_encoder_msg_len(&enc)];
+  app[0] = 0x80 | 5;
+  app[1] = RTCP_APP;
+  app[2] = 0;
+  app[3] = 3;
+  app[4] = 0; app[5] = 0; app[6] = 0x03; app[7] = 0xe9;
+  memcpy(&app[8], "TEST", 4);
+  memcpy(&app[12], "abcd", 4);
+
+  CU_ASSERT(rtcp_reader_init(&rd, enc.buf, rtcp_encoder_msg_len(&enc) + 16, RTP_FALSE) == RTP_TRUE);
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_RTPFB);
+  CU_ASSERT(v.count == RTCP_RTPFB_FMT_NACK);
+  rtcp_view_fb(&v, &ssrc, &media_ssrc, &data, &len);
+  CU_ASSERT(ssrc == 1001);
+  CU_ASSERT(media_ssrc == 2002);
+  CU_ASSERT(len == RTCP_FB_NACK_SIZE);
+  CU_ASSERT(data[0] == 0 && data[1] == 100);
+
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_TRUE);
+  CU_ASSERT(v.pt == RTCP_APP);
+  CU_ASSERT(v.count == 5);
+  rtcp_view_app(&v, &ssrc, &name, &data, &len);
+  CU_ASSERT(ssrc == 1001);
+  CU_ASSERT(memcmp(name, "TEST", 4) == 0);
+  CU_ASSERT(len == 4);
+  CU_ASSERT(memcmp(data, "abcd", 4) == 0);
+
+  CU_ASSERT(rtcp_reader_next(&rd, &v) == RTP_FALSE);
+  CU_ASSERT(rd.error == rtcp_rx_error_no_error);
+
+  rtcp_encoder_deinit(&enc);
+}
+
+void
+test_rtcp_reader_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "rtcp_reader::compound", test_rtcp_reader_compound);
+  CU_add_test(pSuite, "rtcp_reader::header", test_rtcp_reader_header);
+  CU_add_test(pSuite, "rtcp_reader::truncated", test_rtcp_reader_truncated);
+  CU_add_test(pSuite, "rtcp_reader::padding", test_rtcp_reader_padding);
+  CU_add_test(pSuite, "rtcp_reader::app_fb", test_rtcp_reader_app_fb);
+}
@@ -459,6 +459,8 @@ test_rtp_3rd_party_conflict(void)
   rtp_hdr_t*    hdr;
   uint8_t      buf[256];
   int seq;
+  rtp_session_stats_t st;
+  rtp_member_stats_t  mst;
 
   sess = common_session_init();
   sess->rx_rtp = dummy_rx_rtp;
@@ -502,6 +504,19 @@ test_rtp_3rd_party_conflict(void)
   CU_ASSERT(_rtp_rx == RTP_FALSE);
   CU_ASSERT(sess->last_rtp_error == rtp_rx_error_3rd_party_conflict);
 
+  // counted for the session and the member
+  rtp_session_get_stats(sess, &st);
+  CU_ASSERT(st.rtp_errors[rtp_rx_error_3rd_party_conflict] == 1);
+  CU_ASSERT(st.rtp_errors[rtp_rx_error_member_first_heard] == 1);
+  CU_ASSERT(st.rtp_errors[rtp_rx_error_no_error] >= 1);
+
+  CU_ASSERT(rtp_session_get_member_stats(sess, 1234, &mst) == 0);
+  CU_ASSERT(mst.ssrc == 1234);
+  CU_ASSERT(mst.rtp_errors[rtp_rx_error_3rd_party_conflict] == 1);
+  CU_ASSERT(mst.rtp_errors[rtp_rx_error_no_error] == st.rtp_errors[rtp_rx_error_no_error]);
+
+  CU_ASSERT(rtp_session_get_member_stats(sess, 4321, &mst) == -1);
+
   rtp_session_deinit(sess);
   free(sess);
 }
@@ -593,6 +608,103 @@ test_rtp_member_by_rtcp(void)
   rtp_session_deinit(sess);
 }
 
+static void
+test_rtp_member_rates(void)
+{
+  rtp_session_t*      sess;
+  rtp_hdr_t*          hdr;
+  uint8_t             buf[256];
+  rtp_member_t*       m;
+  rtp_member_stats_t  st;
+  uint16_t            seq = 10;
+  int                 i;
+
+  sess = common_session_init();
+  sess->rx_rtp = dummy_rx_rtp;
+
+  hdr = (rtp_hdr_t*)buf;
+
+  hdr->version = RTP_VERSION;
+  hdr->cc = 0x00;
+  hdr->pt = SESSION_PT;
+  hdr->p = 0;
+  hdr->x = 0;
+  hdr->ssrc = htonl(1234);
+
+  // probation. only the validating packet is counted
+  for(i = 0; i <= RTP_CONFIG_MIN_SEQUENTIAL; i++)
+  {
+    hdr->seq = htons(seq++);
+    rtp_session_rx_rtp(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr);
+  }
+  m = rtp_session_lookup_member(sess, 1234);
+  CU_ASSERT(m != NULL);
+  CU_ASSERT(rtp_member_is_validated(m) == RTP_TRUE);
+  CU_ASSERT(m->win.cur_pkts == 1);
+  CU_ASSERT(m->win.cur_octets == 64);
+
+  // no slot completed yet
+  CU_ASSERT(rtp_session_get_member_stats(sess, 1234, &st) == 0);
+  CU_ASSERT(st.pkt_rate == 0);
+  CU_ASSERT(st.bit_rate == 0);
+  CU_ASSERT(st.loss == 0);
+
+  for(i = 0; i < RTP_CONFIG_MEMBER_WINDOW_TICKS; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  // slot 2. 20 packets in order
+  for(i = 0; i < 20; i++)
+  {
+    hdr->seq = htons(seq++);
+    rtp_session_rx_rtp(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr);
+  }
+  for(i = 0; i < RTP_CONFIG_MEMBER_WINDOW_TICKS; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  rtp_session_get_member_stats(sess, 1234, &st);
+  CU_ASSERT(st.pkt_rate == 21 * 1000 / (2 * RTP_CONFIG_MEMBER_WINDOW_TICKS * 100));
+  CU_ASSERT(st.bit_rate == 21 * 64 * 8 * 1000 / (2 * RTP_CONFIG_MEMBER_WINDOW_TICKS * 100));
+  CU_ASSERT(st.loss == 0);
+  CU_ASSERT(st.last_heard_age == RTP_CONFIG_MEMBER_WINDOW_TICKS * 100);
+
+  // slot 3. every other packet lost
+  for(i = 0; i < 10; i++)
+  {
+    hdr->seq = htons(seq);
+    seq += 2;
+    rtp_session_rx_rtp(sess, buf, sizeof(rtp_hdr_t) - 4 + 64, &_rtp_rem_addr);
+  }
+  for(i = 0; i < RTP_CONFIG_MEMBER_WINDOW_TICKS; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  rtp_session_get_member_stats(sess, 1234, &st);
+  CU_ASSERT(st.pkt_rate == 31 * 1000 / (3 * RTP_CONFIG_MEMBER_WINDOW_TICKS * 100));
+  // 1 + 20 + 19 expected. 31 received
+  CU_ASSERT(st.loss == 9 * 1000 / 40);
+
+  // old slots fall out of the window
+  for(i = 0; i < RTP_CONFIG_MEMBER_WINDOW_SLOTS * RTP_CONFIG_MEMBER_WINDOW_TICKS; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+
+  if(rtp_session_get_member_stats(sess, 1234, &st) == 0)
+  {
+    CU_ASSERT(st.pkt_rate == 0);
+    CU_ASSERT(st.bit_rate == 0);
+    CU_ASSERT(st.loss == 0);
+  }
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
 void
 test_rtp_add(CU_pSuite pSuite)
 {
@@ -605,4 +717,5 @@ test_rtp_add(CU_pSuite pSuite)
   CU_add_test(pSuite, "rtp::3rd_party_conflict", test_rtp_3rd_party_conflict);
   CU_add_test(pSuite, "rtp::own_ssrc_conflict", test_rtp_own_ssrc_conflict);
   CU_add_test(pSuite, "rtp::member_by_rtcp", test_rtp_member_by_rtcp);
+  CU_add_test(pSuite, "rtp::member_rates", test_rtp_member_rates);
 }
@@ -0,0 +1,105 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "rtp_session.h"
+#include "rtp_shm.h"
+
+#include "test_common.h"
+
+static rtp_shm_session_t    _snap;
+
+static void
+test_shm_publish(void)
+{
+  rtp_shm_t         shm,
+                    mon;
+  char              name[64];
+  rtp_session_t*    sess;
+  uint8_t           payload[32];
+
+  snprintf(name, sizeof(name), "/prtp_test_%d", getpid());
+
+  CU_ASSERT(rtp_shm_open(&mon, name) == -1);
+  CU_ASSERT(rtp_shm_create(&shm, name) == 0);
+  CU_ASSERT(rtp_shm_open(&mon, name) == 0);
+
+  sess = common_session_init();
+  CU_ASSERT(rtp_session_set_shm(sess, &shm) == 0);
+
+  // published once on attach
+  CU_ASSERT(rtp_shm_read_session(&mon.region->session[0], &_snap) == 0);
+  CU_ASSERT(_snap.in_use == RTP_TRUE);
+  CU_ASSERT(_snap.ssrc == sess->self->ssrc);
+  CU_ASSERT(_snap.tx_pkt_count == 0);
+  CU_ASSERT(_snap.num_members == 1);
+  CU_ASSERT(_snap.member[0].rtt_us == RTP_SHM_RTT_UNKNOWN);
+
+  memset(payload, 0, sizeof(payload));
+  rtp_session_tx(sess, payload, sizeof(payload), 160, NULL, 0);
+
+  // not until the publish period
+  for(uint32_t i = 0; i < RTP_CONFIG_SHM_PUBLISH_TICKS - 1; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+  CU_ASSERT(rtp_shm_read_session(&mon.region->session[0], &_snap) == 0);
+  CU_ASSERT(_snap.tx_pkt_count == 0);
+
+  rtp_session_timer_tick(sess);
+  CU_ASSERT(rtp_shm_read_session(&mon.region->session[0], &_snap) == 0);
+  CU_ASSERT(_snap.tx_pkt_count == 1);
+  CU_ASSERT(_snap.tx_octet_count == sizeof(payload));
+
+  // slot is released with the session
+  rtp_session_deinit(sess);
+  free(sess);
+  CU_ASSERT(mon.region->session[0].in_use == RTP_FALSE);
+
+  rtp_shm_close(&mon);
+  rtp_shm_close(&shm);
+  CU_ASSERT(rtp_shm_open(&mon, name) == -1);
+}
+
+static void
+test_shm_seqlock(void)
+{
+  static rtp_shm_region_t   region;
+  rtp_shm_t                 shm;
+  rtp_shm_session_t*        s;
+
+  rtp_shm_init(&shm, &region);
+
+  for(uint32_t i = 0; i < RTP_CONFIG_SHM_MAX_SESSIONS; i++)
+  {
+    CU_ASSERT(rtp_shm_alloc_session(&shm) == &region.session[i]);
+  }
+  CU_ASSERT(rtp_shm_alloc_session(&shm) == NULL);
+
+  s = &region.session[1];
+  rtp_shm_free_session(s);
+  CU_ASSERT(rtp_shm_alloc_session(&shm) == s);
+  CU_ASSERT(s->id == 1);
+
+  // writer in progress
+  rtp_shm_write_begin(s);
+  s->members = 7;
+  CU_ASSERT(rtp_shm_read_session(s, &_snap) == -1);
+  rtp_shm_write_end(s);
+
+  CU_ASSERT(rtp_shm_read_session(s, &_snap) == 0);
+  CU_ASSERT(_snap.members == 7);
+  CU_ASSERT((_snap.seq & 1) == 0);
+}
+
+void
+test_shm_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "shm::publish", test_shm_publish);
+  CU_add_test(pSuite, "shm::seqlock", test_shm_seqlock);
+}
@@ -0,0 +1,203 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_session_util.h"
+
+#include "test_common.h"
+
+#define TEST_STREAM_SSRC      7777
+
+static uint8_t      _tx_rtp_buf[RTP_CONFIG_MAX_RTP_PKT_SIZE];
+static uint8_t      _tx_rtcp_buf[RTP_CONFIG_RTCP_ENCODER_BUFFER_LEN];
+static uint32_t     _tx_rtcp_len;
+static uint32_t     _tx_rtcp_count;
+
+static int
+capture_tx_rtp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  memcpy(_tx_rtp_buf, pkt, len);
+  return 0;
+}
+
+static int
+capture_tx_rtcp(rtp_session_t* sess, uint8_t* pkt, uint32_t len)
+{
+  memcpy(_tx_rtcp_buf, pkt, len);
+  _tx_rtcp_len = len;
+  _tx_rtcp_count++;
+  return 0;
+}
+
+static rtp_session_t*
+stream_session_init(void)
+{
+  rtp_session_t*  sess;
+  int             stream;
+
+  sess = common_session_init();
+  sess->tx_rtp  = capture_tx_rtp;
+  sess->tx_rtcp = capture_tx_rtcp;
+
+  stream = rtp_session_add_stream(sess);
+  CU_ASSERT(stream == 1);
+  rtp_member_table_change_ssrc(&sess->member_table, sess->streams[stream].self, TEST_STREAM_SSRC);
+
+  _tx_rtcp_len    = 0;
+  _tx_rtcp_count  = 0;
+
+  return sess;
+}
+
+static void
+test_stream_create(void)
+{
+  rtp_session_t*  sess;
+  rtp_member_t*   m;
+  int             stream;
+
+  sess = stream_session_init();
+
+  CU_ASSERT(sess->num_streams == 2);
+  CU_ASSERT(sess->streams[0].self == sess->self);
+  CU_ASSERT(sess->rtcp_var.members == 2);
+
+  m = rtp_session_lookup_member(sess, TEST_STREAM_SSRC);
+  CU_ASSERT(m != NULL);
+  CU_ASSERT(rtp_member_is_self(m) == RTP_TRUE);
+  CU_ASSERT(memcmp(m->cname, SESSION_NAME, m->cname_len) == 0);
+
+  while(sess->num_streams < RTP_CONFIG_MAX_STREAMS_PER_SESSION)
+  {
+    stream = rtp_session_add_stream(sess);
+    CU_ASSERT(stream == (int)sess->num_streams - 1);
+  }
+  CU_ASSERT(rtp_session_add_stream(sess) == -1);
+  CU_ASSERT(rtp_session_tx_stream(sess, RTP_CONFIG_MAX_STREAMS_PER_SESSION, NULL, 0, 0, NULL, 0) == -1);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_stream_tx(void)
+{
+  rtp_session_t*  sess;
+  rtp_hdr_t*      hdr = (rtp_hdr_t*)_tx_rtp_buf;
+  uint8_t         msg[160];
+  uint16_t        seq0,
+                  seq1;
+
+  sess = stream_session_init();
+
+  seq0 = sess->streams[0].seq;
+  seq1 = sess->streams[1].seq;
+
+  CU_ASSERT(rtp_session_tx_stream(sess, 1, msg, 160, 0, NULL, 0) == 0);
+  CU_ASSERT(ntohl(hdr->ssrc) == TEST_STREAM_SSRC);
+  CU_ASSERT(ntohs(hdr->seq) == seq1);
+
+  CU_ASSERT(rtp_session_tx_stream(sess, 1, msg, 100, 0, NULL, 0) == 0);
+  CU_ASSERT(ntohs(hdr->seq) == (uint16_t)(seq1 + 1));
+
+  CU_ASSERT(rtp_session_tx(sess, msg, 160, 0, NULL, 0) == 0);
+  CU_ASSERT(ntohl(hdr->ssrc) == TEST_OWN_SSRC);
+  CU_ASSERT(ntohs(hdr->seq) == seq0);
+
+  CU_ASSERT(sess->streams[0].tx_pkt_count == 1);
+  CU_ASSERT(sess->streams[0].tx_octet_count == 160);
+  CU_ASSERT(sess->streams[1].tx_pkt_count == 2);
+  CU_ASSERT(sess->streams[1].tx_octet_count == 260);
+
+  CU_ASSERT(sess->rtcp_var.senders == 2);
+  CU_ASSERT(sess->rtcp_var.we_sent == RTP_TRUE);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+static void
+test_stream_rtcp(void)
+{
+  rtp_session_t*  sess;
+  uint8_t         msg[160];
+  rtcp_t          *r,
+                  *end;
+  uint32_t        n = 0;
+
+  sess = stream_session_init();
+
+  rtp_session_tx(sess, msg, 160, 0, NULL, 0);
+  rtp_session_tx_stream(sess, 1, msg, 100, 0, NULL, 0);
+
+  for(uint32_t i = 0; i < 100 && _tx_rtcp_count == 0; i++)
+  {
+    rtp_session_timer_tick(sess);
+  }
+  CU_ASSERT(_tx_rtcp_count == 1);
+
+  //
+  // SR for both streams in one compound and SDES for both
+  //
+  r   = (rtcp_t*)_tx_rtcp_buf;
+  end = (rtcp_t*)&_tx_rtcp_buf[_tx_rtcp_len];
+
+  while(r < end)
+  {
+    switch(n)
+    {
+    case 0:
+      CU_ASSERT(r->common.pt == RTCP_SR);
+      CU_ASSERT(ntohl(r->r.sr.ssrc) == TEST_OWN_SSRC);
+      CU_ASSERT(ntohl(r->r.sr.osent) == 160);
+      break;
+
+    case 1:
+      CU_ASSERT(r->common.pt == RTCP_SR);
+      CU_ASSERT(r->common.count == 0);
+      CU_ASSERT(ntohl(r->r.sr.ssrc) == TEST_STREAM_SSRC);
+      CU_ASSERT(ntohl(r->r.sr.osent) == 100);
+      break;
+
+    case 2:
+      CU_ASSERT(r->common.pt == RTCP_SDES);
+      CU_ASSERT(r->common.count == 2);
+      break;
+    }
+    n++;
+    r = (rtcp_t*)((uint32_t*)r + ntohs(r->common.length) + 1);
+  }
+  CU_ASSERT(n == 3);
+
+  //
+  // stream 1 stops sending. we_sent stays with stream 0
+  //
+  for(uint32_t i = 0; i < RTP_CONFIG_SENDER_TIMEOUT / sess->soft_timer.tick_rate; i++)
+  {
+    if(i % 10 == 0)
+    {
+      rtp_session_tx(sess, msg, 160, 0, NULL, 0);
+    }
+    rtp_session_timer_tick(sess);
+  }
+
+  CU_ASSERT(rtp_member_is_sender(sess->streams[1].self) == RTP_FALSE);
+  CU_ASSERT(rtp_member_is_sender(sess->streams[0].self) == RTP_TRUE);
+  CU_ASSERT(sess->rtcp_var.we_sent == RTP_TRUE);
+  CU_ASSERT(sess->rtcp_var.senders == 1);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+void
+test_stream_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "stream::create", test_stream_create);
+  CU_add_test(pSuite, "stream::tx", test_stream_tx);
+  CU_add_test(pSuite, "stream::rtcp", test_stream_rtcp);
+}
@@ -0,0 +1,111 @@
+#include "CUnit/Basic.h"
+#include "CUnit/Basic.h"
+#include "CUnit/Console.h"
+#include "CUnit/Automated.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "rtp_session.h"
+#include "rtp_trace.h"
+
+#include "test_common.h"
+
+static rtp_trace_t        _trace;
+static rtp_trace_rec_t    _recs[RTP_CONFIG_TRACE_RING_SIZE];
+
+static void
+test_trace_ring(void)
+{
+  uint32_t    n;
+
+  rtp_trace_init(&_trace);
+
+  CU_ASSERT(rtp_trace_snapshot(&_trace, _recs, RTP_CONFIG_TRACE_RING_SIZE) == 0);
+
+  rtp_trace_put(&_trace, 100, rtp_trace_ev_rtcp_tx, 1, 2);
+  rtp_trace_put(&_trace, 200, rtp_trace_ev_rtcp_rx, 3, 4);
+
+  n = rtp_trace_snapshot(&_trace, _recs, RTP_CONFIG_TRACE_RING_SIZE);
+  CU_ASSERT(n == 2);
+  CU_ASSERT(_recs[0].ts == 100);
+  CU_ASSERT(_recs[0].ev == rtp_trace_ev_rtcp_tx);
+  CU_ASSERT(_recs[0].a0 == 1);
+  CU_ASSERT(_recs[0].a1 == 2);
+  CU_ASSERT(_recs[1].ts == 200);
+
+  // only the latest
+  n = rtp_trace_snapshot(&_trace, _recs, 1);
+  CU_ASSERT(n == 1);
+  CU_ASSERT(_recs[0].ts == 200);
+
+  // wrap around
+  for(uint32_t i = 0; i < RTP_CONFIG_TRACE_RING_SIZE + 10; i++)
+  {
+    rtp_trace_put(&_trace, i, rtp_trace_ev_rtcp_tx, i, 0);
+  }
+
+  // the oldest slot may be under rewrite. it's never returned
+  n = rtp_trace_snapshot(&_trace, _recs, RTP_CONFIG_TRACE_RING_SIZE);
+  CU_ASSERT(n == RTP_CONFIG_TRACE_RING_SIZE - 1);
+  CU_ASSERT(_recs[0].a0 == 11);
+  CU_ASSERT(_recs[n - 1].a0 == RTP_CONFIG_TRACE_RING_SIZE + 9);
+}
+
+static void
+test_trace_format(void)
+{
+  rtp_trace_rec_t   r;
+  char              buf[64];
+
+  r.ts = 12345;
+  r.ev = rtp_trace_ev_rtcp_rx_invalid;
+  r.a0 = rtcp_rx_error_invalid_mask;
+  r.a1 = 28;
+
+  CU_ASSERT(rtp_trace_format(&r, buf, sizeof(buf)) > 0);
+  CU_ASSERT(strcmp(buf, "12.345 rtcp_rx_invalid error 3 len 28") == 0);
+
+  r.ev = rtp_trace_ev_max + 1;
+  rtp_trace_format(&r, buf, sizeof(buf));
+  CU_ASSERT(strcmp(buf, "12.345 unknown ") == 0);
+
+  // truncation
+  r.ev = rtp_trace_ev_rtcp_tx;
+  r.a0 = 100;
+  CU_ASSERT(rtp_trace_format(&r, buf, 8) >= 8);
+  CU_ASSERT(strlen(buf) == 7);
+}
+
+static void
+test_trace_session(void)
+{
+  rtp_session_t*    sess;
+  uint8_t           pkt[8];
+  uint32_t          n;
+
+  sess = common_session_init();
+
+  memset(pkt, 0, sizeof(pkt));
+  rtp_session_rx_rtcp(sess, pkt, 7, &_rtcp_rem_addr);
+  rtp_session_rx_rtp(sess, pkt, 8, &_rtp_rem_addr);
+
+  n = rtp_trace_snapshot(&sess->trace, _recs, RTP_CONFIG_TRACE_RING_SIZE);
+  CU_ASSERT(n == 2);
+  CU_ASSERT(_recs[0].ev == rtp_trace_ev_rtcp_rx_invalid);
+  CU_ASSERT(_recs[0].a0 == rtcp_rx_error_len_not_multiple_4);
+  CU_ASSERT(_recs[0].a1 == 7);
+  CU_ASSERT(_recs[1].ev == rtp_trace_ev_rtp_rx_invalid);
+  CU_ASSERT(_recs[1].a0 == rtp_rx_error_header_too_short);
+
+  rtp_session_deinit(sess);
+  free(sess);
+}
+
+void
+test_trace_add(CU_pSuite pSuite)
+{
+  CU_add_test(pSuite, "trace::ring", test_trace_ring);
+  CU_add_test(pSuite, "trace::format", test_trace_format);
+  CU_add_test(pSuite, "trace::session", test_trace_session);
+}